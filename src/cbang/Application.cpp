@@ -368,6 +368,15 @@ void Application::openConfig(const string &_filename) {
 }
 
 
+unsigned Application::reloadConfig(const string &_filename) {
+  string filename;
+  if (_filename.empty()) filename = cmdLine["--config"];
+  else filename = _filename;
+
+  return options.reload(filename);
+}
+
+
 void Application::saveConfig(const string &_filename) const {
   string filename;
   if (_filename.empty()) filename = cmdLine["--config"];
@@ -127,6 +127,7 @@ namespace cb {
     virtual std::ostream &print(std::ostream &stream) const;
     virtual void usage(std::ostream &stream, const std::string &name) const;
     virtual void openConfig(const std::string &filename = std::string());
+    virtual unsigned reloadConfig(const std::string &filename = std::string());
     virtual void saveConfig(const std::string &filename = std::string()) const;
 
     virtual void writeConfig(std::ostream &stream, uint32_t flags = 0) const;
@@ -102,13 +102,20 @@ Exception::Exception(const string &message, int code,
 
 #ifdef HAVE_DEBUGGER
   if (enableStackTraces) {
+    // Only the raw addresses are recorded here, symbols are resolved on demand
     trace = new StackTrace();
-    Debugger::instance().getStackTrace(*trace);
+    Debugger::instance().captureStackTrace(*trace);
   }
 #endif
 }
 
 
+SmartPointer<StackTrace> Exception::getStackTrace() const {
+  if (!trace.isNull()) trace->resolve();
+  return trace;
+}
+
+
 ostream &Exception::print(ostream &stream, unsigned level) const {
   if (code) stream << code << ": ";
 
@@ -118,6 +125,8 @@ ostream &Exception::print(ostream &stream, unsigned level) const {
     stream << "\n       At: " << location;
 
   if (!trace.isNull()) {
+    trace->resolve();
+
     unsigned count = 0;
     unsigned i = 0;
 
@@ -111,7 +111,7 @@ namespace cb {
      */
     SmartPointer<Exception> getCause() const {return cause;}
     void setCause(SmartPointer<Exception> cause) {this->cause = cause;}
-    SmartPointer<StackTrace> getStackTrace() const {return trace;}
+    SmartPointer<StackTrace> getStackTrace() const;
     void setStackTrace(SmartPointer<StackTrace> trace) {this->trace = trace;}
 
     /**
@@ -37,6 +37,7 @@
 #include "Exception.h"
 
 #include <cbang/util/Regex.h>
+#include <cbang/util/Numeric.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -59,6 +60,55 @@ using namespace cb;
 #define __va_copy(x, y) (x = y)
 #endif
 
+namespace {
+  template <typename T>
+  bool parseDecimal(const string &s, T &x) {
+    const char *start = s.data();
+    const char *end = start + s.length();
+    const char *ptr = start;
+
+    // Leave octal and hex to strto*()
+    if (ptr != end && *ptr == '-') ptr++;
+    if (ptr + 1 < end && *ptr == '0') return false;
+
+    return Numeric::parse(start, end, x) == end;
+  }
+
+
+  bool parseDecimal(const string &s, double &x) {
+    const char *end = s.data() + s.length();
+    return Numeric::parse(s.data(), end, x) == end;
+  }
+
+
+  bool formatFixed(double x, int precision, string &s) {
+    static const double limits[] = {
+      1e15, 1e14, 1e13, 1e12, 1e11, 1e10, 1e9, 1e8, 1e7, 1e6, 1e5, 1e4, 1e3,
+      1e2, 1e1, 1e0};
+
+    // Within these limits the shortest round trip digits are also what
+    // printf("%.*f") produces after trailing zeros are removed
+    if (precision < 0 || 15 < precision || !(fabs(x) < limits[precision]))
+      return false;
+
+    if (!x) {
+      s = "0";
+      return true;
+    }
+
+    char digits[18];
+    int exp;
+    int len = (int)Numeric::shortest(digits, fabs(x), exp);
+    if (exp < -precision || len + exp <= -6) return false;
+
+    char buf[Numeric::BUFFER_SIZE];
+    s.assign(buf, Numeric::format(buf, x));
+
+    return true;
+  }
+}
+
+
 const string String::DEFAULT_DELIMS = " \t\n\r";
 const string String::DEFAULT_LINE_DELIMS = "\n";
 const string String::LETTERS_LOWER_CASE = "abcdefghijklmnopqrstuvwxyz";
@@ -77,14 +127,38 @@ String::String(const char *s, size_type n) {
 }
 
 
-String::String(int32_t x)   : string(printf("%i", x)) {}
-String::String(uint32_t x)  : string(printf("%u", x)) {}
-String::String(int64_t x)   : string(printf("%lli", (long long int)x)) {}
-String::String(uint64_t x)  : string(printf("%llu", (long long unsigned)x)) {}
+String::String(int32_t x) {
+  char buf[Numeric::BUFFER_SIZE];
+  assign(buf, Numeric::format(buf, x));
+}
+
+
+String::String(uint32_t x) {
+  char buf[Numeric::BUFFER_SIZE];
+  assign(buf, Numeric::format(buf, x));
+}
+
+
+String::String(int64_t x) {
+  char buf[Numeric::BUFFER_SIZE];
+  assign(buf, Numeric::format(buf, x));
+}
+
+
+String::String(uint64_t x) {
+  char buf[Numeric::BUFFER_SIZE];
+  assign(buf, Numeric::format(buf, x));
+}
+
+
 String::String(uint128_t x) : string(SSTR(x)) {}
 
 
-String::String(double x, int precision) : string(printf("%.*f", precision, x)) {
+String::String(double x, int precision) {
+  if (formatFixed(x, precision, *this)) return;
+
+  assign(printf("%.*f", precision, x));
+
   int chop = 0;
   char point = use_facet<numpunct<char> >(cout.getloc()).decimal_point();
 
@@ -241,6 +315,10 @@ int16_t String::parseS16(const string &s) {
 
 
 uint32_t String::parseU32(const string &s) {
+  uint64_t x;
+  if (parseDecimal(s, x) && x <= numeric_limits<uint32_t>::max())
+    return (uint32_t)x;
+
   errno = 0;
   unsigned long v = strtoul(s.c_str(), 0, 0);
   if (errno || numeric_limits<uint32_t>::max() < v)
@@ -251,6 +329,10 @@ uint32_t String::parseU32(const string &s) {
 
 
 int32_t String::parseS32(const string &s) {
+  int64_t x;
+  if (parseDecimal(s, x) && -numeric_limits<int32_t>::max() <= x &&
+      x <= numeric_limits<int32_t>::max()) return (int32_t)x;
+
   errno = 0;
   long v = strtol(s.c_str(), 0, 0);
   if (errno|| v < -numeric_limits<int32_t>::max() ||
@@ -262,6 +344,9 @@ int32_t String::parseS32(const string &s) {
 
 
 uint64_t String::parseU64(const string &s) {
+  uint64_t x;
+  if (parseDecimal(s, x)) return x;
+
   errno = 0;
   unsigned long long v = strtoull(s.c_str(), 0, 0);
   if (errno) THROW("Invalid unsigned 64-bit value '" << s << "'");
@@ -271,6 +356,9 @@ uint64_t String::parseU64(const string &s) {
 
 
 int64_t String::parseS64(const string &s) {
+  int64_t x;
+  if (parseDecimal(s, x)) return x;
+
   errno = 0;
   long long int v = strtoll(s.c_str(), 0, 0);
   if (errno) THROW("Invalid signed 64-bit value '" << s << "'");
@@ -295,6 +383,9 @@ uint128_t String::parseU128(const string &s) {
 
 
 double String::parseDouble(const string &s) {
+  double x;
+  if (parseDecimal(s, x)) return x;
+
   errno = 0;
   double v = strtod(s.c_str(), 0);
   if (errno) THROW("Invalid double '" << s << "'");
@@ -0,0 +1,254 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "BufferPool.h"
+
+#include <cbang/Exception.h>
+#include <cbang/util/SmartLock.h>
+#include <cbang/util/HumanSize.h>
+
+#include <stdlib.h>
+
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  thread_local bool threadCacheDone = false;
+
+
+  struct ThreadCache {
+    vector<char *> buffers[BufferPool::CLASSES];
+
+
+    ~ThreadCache() {
+      threadCacheDone = true;
+
+      for (unsigned i = 0; i < BufferPool::CLASSES; i++)
+        for (unsigned j = 0; j < buffers[i].size(); j++)
+          BufferPool::instance().flushThreadCached(i, buffers[i][j]);
+    }
+
+
+    static unsigned getLimit(unsigned sizeClass) {
+      // Cache up to 256KiB per class but at least one buffer
+      unsigned limit = 64 >> sizeClass;
+      return limit ? limit : 1;
+    }
+
+
+    bool get(unsigned sizeClass, char *&buffer) {
+      if (buffers[sizeClass].empty()) return false;
+      buffer = buffers[sizeClass].back();
+      buffers[sizeClass].pop_back();
+      return true;
+    }
+
+
+    bool put(unsigned sizeClass, char *buffer) {
+      if (getLimit(sizeClass) <= buffers[sizeClass].size()) return false;
+      buffers[sizeClass].push_back(buffer);
+      return true;
+    }
+  };
+
+
+  ThreadCache *getThreadCache() {
+    // Buffers may be released after this thread's cache was destroyed
+    if (threadCacheDone) return 0;
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+}
+
+
+BufferPool::BufferPool() :
+  maxBytes(0), maxCached(16 * 1024 * 1024), cached(0), threadCached(0),
+  hits(0), misses(0), inUse(0), held(0), peak(0) {}
+
+
+BufferPool &BufferPool::instance() {
+  // Never deallocated so buffers can be released during static destruction
+  static BufferPool *pool = new BufferPool;
+  return *pool;
+}
+
+
+BufferPool::Stats BufferPool::getStats() const {
+  Stats stats;
+
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.inUse = inUse;
+  stats.cached = cached;
+  stats.threadCached = threadCached;
+  stats.held = held;
+  stats.peak = peak;
+
+  return stats;
+}
+
+
+char *BufferPool::allocate(unsigned &size) {
+  unsigned sizeClass = getSizeClass(size);
+  if (sizeClass < CLASSES) size = getClassSize(sizeClass);
+
+  reserve(size);
+
+  if (sizeClass < CLASSES) {
+    char *buffer;
+    ThreadCache *threadCache = getThreadCache();
+
+    if (threadCache && threadCache->get(sizeClass, buffer)) {
+      threadCached -= size;
+      hits++;
+      return buffer;
+    }
+
+    if (getCached(sizeClass, buffer)) {
+      hits++;
+      return buffer;
+    }
+  }
+
+  misses++;
+
+  char *buffer = (char *)malloc(size);
+  if (!buffer) {
+    inUse -= size;
+    THROW("Failed to allocate memory");
+  }
+
+  updatePeak(held += size);
+
+  return buffer;
+}
+
+
+void BufferPool::release(char *buffer, unsigned size) {
+  if (!buffer) return;
+
+  inUse -= size;
+
+  unsigned sizeClass = getSizeClass(size);
+  if (sizeClass < CLASSES && getClassSize(sizeClass) == size) {
+    ThreadCache *threadCache = getThreadCache();
+
+    if (threadCache && threadCache->put(sizeClass, buffer))
+      threadCached += size;
+    else putCached(sizeClass, buffer);
+
+  } else freeBuffer(buffer, size);
+}
+
+
+void BufferPool::trim() {
+  SmartLock lock(this);
+
+  for (unsigned i = 0; i < CLASSES; i++) {
+    for (unsigned j = 0; j < cache[i].size(); j++)
+      freeBuffer(cache[i][j], getClassSize(i));
+    cache[i].clear();
+  }
+
+  cached = 0;
+}
+
+
+unsigned BufferPool::getSizeClass(unsigned size) {
+  if (getClassSize(CLASSES - 1) < size) return CLASSES;
+
+  unsigned sizeClass = 0;
+  while (getClassSize(sizeClass) < size) sizeClass++;
+
+  return sizeClass;
+}
+
+
+bool BufferPool::getCached(unsigned sizeClass, char *&buffer) {
+  SmartLock lock(this);
+
+  if (cache[sizeClass].empty()) return false;
+
+  buffer = cache[sizeClass].back();
+  cache[sizeClass].pop_back();
+  cached -= getClassSize(sizeClass);
+
+  return true;
+}
+
+
+void BufferPool::putCached(unsigned sizeClass, char *buffer) {
+  unsigned size = getClassSize(sizeClass);
+
+  {
+    SmartLock lock(this);
+
+    if (cached + size <= maxCached) {
+      cache[sizeClass].push_back(buffer);
+      cached += size;
+      return;
+    }
+  }
+
+  freeBuffer(buffer, size);
+}
+
+
+void BufferPool::flushThreadCached(unsigned sizeClass, char *buffer) {
+  threadCached -= getClassSize(sizeClass);
+  putCached(sizeClass, buffer);
+}
+
+
+void BufferPool::reserve(unsigned size) {
+  // Check and claim in one step so concurrent callers cannot pass the cap
+  uint64_t current = inUse;
+
+  do {
+    if (maxBytes && maxBytes < current + size)
+      THROW("Buffer memory limit of " << HumanSize(maxBytes) << " reached");
+  } while (!inUse.compare_exchange_weak(current, current + size));
+}
+
+
+void BufferPool::updatePeak(uint64_t held) {
+  uint64_t current = peak;
+  while (current < held && !peak.compare_exchange_weak(current, held))
+    continue;
+}
+
+
+void BufferPool::freeBuffer(char *buffer, unsigned size) {
+  free(buffer);
+  held -= size;
+}
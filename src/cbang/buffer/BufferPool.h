@@ -0,0 +1,130 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/StdTypes.h>
+#include <cbang/os/Mutex.h>
+
+#include <vector>
+#include <atomic>
+
+
+namespace cb {
+  /**
+   * A process wide pool of buffer memory in power of two size classes
+   * from 4KiB to 1MiB.  Each thread keeps a small cache of free buffers
+   * per class which is refilled from, and overflows to, a shared cache.
+   * Requests larger than the biggest class go straight to malloc() but
+   * still count against the memory cap.
+   *
+   * The cap limits the bytes handed out.  Free buffers are not counted
+   * against it.  They are bounded separately, by setMaxCached() for the
+   * shared cache and by a small per class limit in each thread's cache.
+   * Allocations which would exceed the cap throw.  Callers should check
+   * isExhausted() and stop taking on new work before that happens.
+   */
+  class BufferPool : public Mutex {
+  public:
+    static const unsigned MIN_SHIFT = 12;
+    static const unsigned MAX_SHIFT = 20;
+    static const unsigned CLASSES = MAX_SHIFT - MIN_SHIFT + 1;
+
+    struct Stats {
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t inUse;        ///< Bytes handed out
+      uint64_t cached;       ///< Free bytes in the shared cache
+      uint64_t threadCached; ///< Free bytes in per thread caches
+      uint64_t held;         ///< Bytes obtained from the system, the sum
+      uint64_t peak;         ///< Highest value of held
+
+      double getHitRate() const
+      {return hits + misses ? (double)hits / (hits + misses) : 0;}
+    };
+
+  protected:
+    uint64_t maxBytes;
+    uint64_t maxCached;
+
+    std::vector<char *> cache[CLASSES];
+    std::atomic<uint64_t> cached;
+    std::atomic<uint64_t> threadCached;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> inUse;
+    std::atomic<uint64_t> held;
+    std::atomic<uint64_t> peak;
+
+    BufferPool();
+
+  public:
+    static BufferPool &instance();
+
+    /// Limit the bytes handed out, zero for no limit
+    void setMaxBytes(uint64_t maxBytes) {this->maxBytes = maxBytes;}
+    uint64_t getMaxBytes() const {return maxBytes;}
+
+    /// Limit the bytes kept in the shared cache of free buffers
+    void setMaxCached(uint64_t maxCached) {this->maxCached = maxCached;}
+    uint64_t getMaxCached() const {return maxCached;}
+
+    /// True when less than an eighth of the memory cap is left
+    bool isExhausted() const
+    {return maxBytes && maxBytes - maxBytes / 8 <= inUse.load();}
+
+    Stats getStats() const;
+
+    /// Rounds @param size up to the size actually allocated
+    char *allocate(unsigned &size);
+    /// @param size must be the size returned by allocate()
+    void release(char *buffer, unsigned size);
+
+    /// Free all buffers in the shared cache
+    void trim();
+
+    static unsigned getSizeClass(unsigned size);
+    static unsigned getClassSize(unsigned sizeClass)
+    {return 1U << (MIN_SHIFT + sizeClass);}
+
+    // Used by the per thread caches
+    bool getCached(unsigned sizeClass, char *&buffer);
+    void putCached(unsigned sizeClass, char *buffer);
+    void flushThreadCached(unsigned sizeClass, char *buffer);
+
+  protected:
+    void reserve(unsigned size);
+    void updatePeak(uint64_t held);
+    void freeBuffer(char *buffer, unsigned size);
+  };
+}
@@ -0,0 +1,134 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "FileBuffer.h"
+
+#include <cbang/Exception.h>
+#include <cbang/os/SysError.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define lseek _lseeki64
+#else
+#include <unistd.h>
+#endif
+
+using namespace cb;
+using namespace std;
+
+
+FileBuffer::FileBuffer(const string &path) : fd(-1), offset(0), length(0) {
+  open(path);
+
+  struct stat buf;
+  if (fstat(fd, &buf)) {
+    ::close(fd);
+    THROW("Failed to get file size " << path << ": " << SysError());
+  }
+
+  length = buf.st_size;
+}
+
+
+FileBuffer::FileBuffer(const string &path, uint64_t offset, uint64_t length) :
+  fd(-1), offset(offset), length(length) {
+  open(path);
+}
+
+
+FileBuffer::~FileBuffer() {if (fd != -1) ::close(fd);}
+
+
+void FileBuffer::checkSize() const {
+  struct stat buf;
+  if (fstat(fd, &buf)) THROW("Failed to get file size: " << SysError());
+
+  if ((uint64_t)buf.st_size < offset + length)
+    THROW("File buffer shrank to " << buf.st_size << " bytes, expected "
+          << (offset + length));
+}
+
+
+void FileBuffer::copy(ostream &stream) const {
+  char buf[65536];
+
+  for (uint64_t pos = offset; pos < offset + length && stream;) {
+    uint64_t left = offset + length - pos;
+    unsigned size = left < sizeof(buf) ? left : sizeof(buf);
+    unsigned bytes = readAt(buf, size, pos);
+
+    stream.write(buf, bytes);
+    pos += bytes;
+  }
+}
+
+
+unsigned FileBuffer::read(char *dst, unsigned size) {
+  if (length < size) size = length;
+  if (!size) return 0;
+
+  unsigned bytes = readAt(dst, size, offset);
+  incPosition(bytes);
+
+  return bytes;
+}
+
+
+unsigned FileBuffer::readAt(char *dst, unsigned size, uint64_t pos) const {
+#ifdef _WIN32
+  if (lseek(fd, pos, SEEK_SET) < 0)
+    THROW("Failed to seek file buffer: " << SysError());
+  int bytes = ::read(fd, dst, size);
+#else
+  ssize_t bytes = pread(fd, dst, size, pos);
+#endif
+
+  if (bytes < 0) THROW("Failed to read file buffer: " << SysError());
+  if (!bytes) THROW("Unexpected end of file buffer");
+
+  return bytes;
+}
+
+
+void FileBuffer::open(const string &path) {
+#ifdef _WIN32
+  fd = ::open(path.c_str(), O_RDONLY | O_BINARY);
+#else
+  fd = ::open(path.c_str(), O_RDONLY);
+#endif
+
+  if (fd == -1) THROW("Failed to open file " << path << ": " << SysError());
+}
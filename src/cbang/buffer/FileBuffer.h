@@ -0,0 +1,77 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Buffer.h"
+
+#include <cbang/StdTypes.h>
+
+#include <string>
+#include <ostream>
+
+namespace cb {
+  /// A read only Buffer over a region of a file.  Connections may send it
+  /// directly from the file descriptor with sendfile().
+  class FileBuffer : public Buffer {
+    int fd;
+    uint64_t offset;
+    uint64_t length;
+
+  public:
+    FileBuffer(const std::string &path);
+    FileBuffer(const std::string &path, uint64_t offset, uint64_t length);
+    ~FileBuffer();
+
+    int getFD() const {return fd;}
+    uint64_t getOffset() const {return offset;}
+    /// @return The bytes left to read, which may exceed getFill()
+    uint64_t getLength() const {return length;}
+    void incPosition(uint64_t count) {offset += count; length -= count;}
+
+    /// Throws if the file no longer holds the rest of the buffer
+    void checkSize() const;
+    /// Write the rest of the buffer to @param stream without consuming it
+    void copy(std::ostream &stream) const;
+
+    // From Buffer
+    bool isEmpty() const {return !length;}
+    /// @return The bytes left to read, at most 4GiB - 1
+    unsigned getFill() const
+    {return length < 0xffffffff ? (unsigned)length : 0xffffffff;}
+    unsigned read(char *dst, unsigned size);
+
+  protected:
+    unsigned readAt(char *dst, unsigned size, uint64_t pos) const;
+    void open(const std::string &path);
+  };
+}
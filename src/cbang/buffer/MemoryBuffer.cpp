@@ -31,6 +31,7 @@
 \******************************************************************************/
 
 #include "MemoryBuffer.h"
+#include "BufferPool.h"
 
 #include <cbang/Exception.h>
 
@@ -42,24 +43,20 @@ using namespace std;
 
 
 MemoryBuffer::MemoryBuffer(unsigned capacity, char *buffer, bool deallocate) :
-  capacity(capacity), position(0), fill(0), buffer(buffer),
-  deallocate(deallocate) {
+  capacity(capacity), allocated(capacity), position(0), fill(0),
+  buffer(buffer), deallocate(deallocate), pooled(false) {
 
   if (buffer) fill = capacity;
 
   if (!buffer && capacity) {
-    this->buffer = (char *)malloc(capacity);
-    if (!this->buffer) THROW("Failed to allocate memory");
-    this->deallocate = true;
+    this->buffer = BufferPool::instance().allocate(allocated);
+    this->deallocate = pooled = true;
   }
 }
 
 
 MemoryBuffer::~MemoryBuffer() {
-  if (buffer && deallocate) {
-    free(buffer);
-    buffer = 0;
-  }
+  release();
 }
 
 
@@ -135,12 +132,43 @@ unsigned MemoryBuffer::increase(unsigned size) {
     unsigned newCapacity = capacity + (capacity >> 2); // At least this much
     if (newCapacity < size) newCapacity = size;
 
-    char *newBuffer = (char *)realloc(buffer, newCapacity);
-    if (!newBuffer) THROW("Failed to reallocate memory");
+    if (pooled && newCapacity <= allocated) capacity = newCapacity;
+
+    else if (pooled || !buffer) {
+      BufferPool &pool = BufferPool::instance();
+      unsigned newAllocated = newCapacity;
+      char *newBuffer = pool.allocate(newAllocated);
+
+      if (buffer) {
+        memcpy(newBuffer, buffer, fill);
+        pool.release(buffer, allocated);
+      }
 
-    capacity = newCapacity;
-    buffer = newBuffer;
+      capacity = newCapacity;
+      allocated = newAllocated;
+      buffer = newBuffer;
+      pooled = true;
+
+    } else {
+      char *newBuffer = (char *)realloc(buffer, newCapacity);
+      if (!newBuffer) THROW("Failed to reallocate memory");
+
+      capacity = allocated = newCapacity;
+      buffer = newBuffer;
+    }
   }
 
   return capacity;
 }
+
+
+void MemoryBuffer::release() {
+  if (buffer && deallocate) {
+    if (pooled) BufferPool::instance().release(buffer, allocated);
+    else free(buffer);
+  }
+
+  buffer = 0;
+  capacity = allocated = position = fill = 0;
+  deallocate = pooled = false;
+}
@@ -35,12 +35,18 @@
 #include "Buffer.h"
 
 namespace cb {
+  /**
+   * A buffer over a block of memory.  Memory allocated by the buffer
+   * itself comes from, and is returned to, the BufferPool.
+   */
   class MemoryBuffer : public Buffer {
     unsigned capacity;
+    unsigned allocated;
     unsigned position;
     unsigned fill;
     char *buffer;
     bool deallocate;
+    bool pooled;
 
   public:
     MemoryBuffer(unsigned capacity = 0, char *buffer = 0,
@@ -59,6 +65,10 @@ namespace cb {
 
     unsigned getPosition() const {return position;}
     unsigned getCapacity() const {return capacity;}
+    /// @return The bytes actually allocated, at least the capacity
+    unsigned getAllocated() const {return allocated;}
+    /// True if the memory came from the BufferPool
+    bool isPooled() const {return pooled;}
 
     void incPosition(unsigned count) {position += count;}
     void incFill(unsigned count) {fill += count;}
@@ -73,5 +83,7 @@ namespace cb {
 
     unsigned increase(unsigned size);
     void clear() {position = fill = 0;}
+    /// Clear and give up the underlying memory
+    void release();
   };
 }
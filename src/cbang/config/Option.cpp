@@ -32,6 +32,7 @@
 
 #include "Option.h"
 #include "Options.h"
+#include "OptionValue.h"
 
 #include <cbang/String.h>
 
@@ -51,20 +52,29 @@ Option::Option(const SmartPointer<Option> &parent) :
   name(parent->name), shortName(parent->shortName), type(parent->type),
   help(parent->help), flags(parent->flags & ~(SET_FLAG | DEFAULT_SET_FLAG)),
   filename(parent->filename), aliases(parent->aliases), parent(parent),
-  action(parent->action), defaultSetAction(parent->defaultSetAction) {
-}
+  action(parent->action), defaultSetAction(parent->defaultSetAction),
+  owner(0) {}
 
 
 Option::Option(const string &name, const char shortName,
                SmartPointer<OptionActionBase> action, const string &help) :
   name(name), shortName(shortName), type(STRING_TYPE), help(help), flags(0),
-  filename(0), action(action) {}
+  filename(0), action(action), owner(0) {}
 
 
 Option::Option(const string &name, const string &help,
                const SmartPointer<Constraint> &constraint) :
   name(name), shortName(0), type(STRING_TYPE), help(help), flags(0),
-  filename(0), constraint(constraint) {}
+  filename(0), constraint(constraint), owner(0) {}
+
+
+Option::~Option() {}
+
+
+void Option::setType(type_t type) {
+  this->type = type;
+  update();
+}
 
 
 const string Option::getTypeString() const {
@@ -116,6 +126,7 @@ void Option::setDefault(bool defaultValue) {
 void Option::clearDefault() {
   defaultValue.clear();
   flags &= ~DEFAULT_SET_FLAG;
+  update();
 }
 
 
@@ -139,6 +150,7 @@ void Option::reset() {
 
   flags &= ~SET_FLAG;
   value.clear();
+  update();
 
   if (hasAction()) (*action)(*this);
 }
@@ -147,6 +159,7 @@ void Option::reset() {
 void Option::unset() {
   flags &= ~DEFAULT_SET_FLAG;
   defaultValue.clear();
+  update();
   reset();
 }
 
@@ -156,21 +169,19 @@ void Option::set(const string &value) {
     THROW("Option '" << name << "' has been depreciated: " << help);
   if (isSet() && this->value == value) return;
 
-  uint32_t oldFlags = flags;
-  string oldValue = this->value;
+  try {
+    // Check the new value before it is published
+    validate(value);
 
-  flags |= SET_FLAG;
-  this->value = value;
+    flags |= SET_FLAG;
+    this->value = value;
 
-  // Clear the command line flag
-  flags &= ~COMMAND_LINE_FLAG;
+    // Clear the command line flag
+    flags &= ~COMMAND_LINE_FLAG;
 
-  try {
-    validate();
-  } catch (const Exception &e) {
-    flags = oldFlags;
-    this->value = oldValue;
+    update();
 
+  } catch (const Exception &e) {
     string errStr = string("Invalid value for option '") + name + "'";
 
     if (Options::warnWhenInvalid)
@@ -260,41 +271,57 @@ bool Option::hasValue() const {
 }
 
 
+shared_ptr<const OptionValue> Option::getValue() const {
+  shared_ptr<const OptionValue> value = atomic_load(&current);
+  if (!value && !parent.isNull()) return parent->getValue();
+  return value;
+}
+
+
 bool Option::toBoolean() const {
-  return parseBoolean(toString());
+  shared_ptr<const OptionValue> value = getValue();
+  return value ? value->toBoolean() : parseBoolean(toString());
 }
 
 
 const string &Option::toString() const {
-  if (isSet()) return value;
-  else if (hasDefault()) return getDefault();
-  else if (getType() == STRINGS_TYPE) return value;
+  shared_ptr<const OptionValue> value = getValue();
+  if (value) return value->str;
+  else if (getType() == STRINGS_TYPE) return this->value;
   THROW("Option '" << name << "' has no default and is not set.");
 }
 
 
 int64_t Option::toInteger() const {
-  return parseInteger(toString());
+  shared_ptr<const OptionValue> value = getValue();
+  return value ? value->toInteger() : parseInteger(toString());
 }
 
 
 double Option::toDouble() const {
-  return parseDouble(toString());
+  shared_ptr<const OptionValue> value = getValue();
+  return value ? value->toDouble() : parseDouble(toString());
 }
 
 
 Option::strings_t Option::toStrings(const string &delims) const {
-  return parseStrings(toString());
+  shared_ptr<const OptionValue> value = getValue();
+  if (value && delims == DEFAULT_DELIMS) return value->toStrings();
+  return parseStrings(toString(), delims);
 }
 
 
 Option::integers_t Option::toIntegers(const string &delims) const {
-  return parseIntegers(toString());
+  shared_ptr<const OptionValue> value = getValue();
+  if (value && delims == DEFAULT_DELIMS) return value->toIntegers();
+  return parseIntegers(toString(), delims);
 }
 
 
 Option::doubles_t Option::toDoubles(const string &delims) const {
-  return parseDoubles(toString());
+  shared_ptr<const OptionValue> value = getValue();
+  if (value && delims == DEFAULT_DELIMS) return value->toDoubles();
+  return parseDoubles(toString(), delims);
 }
 
 
@@ -388,16 +415,14 @@ Option::doubles_t Option::parseDoubles(const string &value,
 
 
 void Option::validate() const {
-  switch (type) {
-  case BOOLEAN_TYPE: checkConstraint(toBoolean()); break;
-  case STRING_TYPE: checkConstraint(value); break;
-  case INTEGER_TYPE: checkConstraint(toInteger()); break;
-  case DOUBLE_TYPE: checkConstraint(toDouble()); break;
-  case STRINGS_TYPE: checkConstraint(toStrings()); break;
-  case INTEGERS_TYPE: checkConstraint(toIntegers()); break;
-  case DOUBLES_TYPE: checkConstraint(toDoubles()); break;
-  default: THROW("Invalid type " << type);
-  }
+  shared_ptr<const OptionValue> value = getValue();
+  if (value) validate(*value);
+  else validate(OptionValue(toString(), type));
+}
+
+
+void Option::validate(const string &value) const {
+  validate(OptionValue(value, type));
 }
 
 
@@ -667,6 +692,43 @@ void Option::setDefault(const string &value, type_t type) {
   defaultValue = value;
   flags |= DEFAULT_SET_FLAG;
   this->type = type;
+  update();
 
   if (defaultSetAction.get()) (*defaultSetAction)(*this);
 }
+
+
+void Option::validate(const OptionValue &value) const {
+  switch (type) {
+  case BOOLEAN_TYPE: checkConstraint(value.toBoolean()); break;
+  case STRING_TYPE: checkConstraint(value.str); break;
+  case INTEGER_TYPE: checkConstraint(value.toInteger()); break;
+  case DOUBLE_TYPE: checkConstraint(value.toDouble()); break;
+  case STRINGS_TYPE: checkConstraint(value.toStrings()); break;
+  case INTEGERS_TYPE: checkConstraint(value.toIntegers()); break;
+  case DOUBLES_TYPE: checkConstraint(value.toDoubles()); break;
+  default: THROW("Invalid type " << type);
+  }
+}
+
+
+void Option::update() {
+  const string *str = 0;
+  if (isSet()) str = &value;
+  else if (flags & DEFAULT_SET_FLAG) str = &defaultValue;
+
+  shared_ptr<const OptionValue> old = atomic_load(&current);
+
+  if (!str) {
+    if (old) {
+      atomic_store(&current, shared_ptr<const OptionValue>());
+      if (owner) owner->changed();
+    }
+    return;
+  }
+
+  if (old && old->type == type && old->str == *str) return;
+
+  atomic_store(&current, make_shared<const OptionValue>(*str, type));
+  if (owner) owner->changed();
+}
@@ -44,13 +44,23 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <memory>
 
 namespace cb {
   namespace JSON {class Sink;}
+  class OptionValue;
+  class Options;
 
   /**
    * A Configuration option.  Holds option defaults, user values, and parses
    * option strings.  Can also call an OptionAction when an option is set.
+   *
+   * The current value is kept as an immutable, pre-parsed OptionValue which
+   * is swapped in atomically, after it has been validated, when the option
+   * changes.  The typed to*() accessors read it without locking so they are
+   * safe to call from other threads while the option is being set.  A
+   * replaced value is freed once its last reader releases it.  The
+   * reference returned by toString() is only valid until the option changes.
    */
   class Option {
   public:
@@ -96,6 +106,9 @@ namespace cb {
     SmartPointer<OptionActionBase> defaultSetAction;
     SmartPointer<Constraint> constraint;
 
+    std::shared_ptr<const OptionValue> current;
+    Options *owner;
+
   public:
     Option(const SmartPointer<Option> &parent);
     Option(const std::string &name, char shortName = 0,
@@ -103,11 +116,12 @@ namespace cb {
            const std::string &help = "");
     Option(const std::string &name, const std::string &help,
            const SmartPointer<Constraint> &constraint = 0);
+    ~Option();
 
     const std::string &getName() const {return name;}
     char getShortName() const {return shortName;}
 
-    void setType(type_t type) {this->type = type;}
+    void setType(type_t type);
     type_t getType() const {return type;}
     const std::string getTypeString() const;
 
@@ -132,6 +146,9 @@ namespace cb {
     void setCommandLine() {flags |= COMMAND_LINE_FLAG;}
     bool isCommandLine() const {return flags & COMMAND_LINE_FLAG;}
     void setDepreciated() {flags |= DEPRECIATED_FLAG;}
+    /// The Options notified when the value changes
+    void setOwner(Options *owner) {this->owner = owner;}
+    Options *getOwner() const {return owner;}
     bool isDepreciated() const {return flags & DEPRECIATED_FLAG;}
     bool isHidden() const;
 
@@ -198,6 +215,8 @@ namespace cb {
 
     bool isSet() const {return flags & SET_FLAG;}
     bool hasValue() const;
+    /// @return The current parsed value or null if the option has no value.
+    std::shared_ptr<const OptionValue> getValue() const;
 
     bool toBoolean() const;
     const std::string &toString() const;
@@ -235,6 +254,8 @@ namespace cb {
     }
 
     void validate() const;
+    /// Check @param value against the option's type and constraints.
+    void validate(const std::string &value) const;
 
     bool hasAction() const {return action.get();}
 
@@ -264,6 +285,8 @@ namespace cb {
 
   protected:
     void setDefault(const std::string &value, type_t type);
+    void validate(const OptionValue &value) const;
+    void update();
   };
 
   inline std::ostream &operator<<(std::ostream &stream, const Option &o) {
@@ -97,31 +97,34 @@ bool OptionMap::eval(const Context &ctx) {
 }
 
 
-void OptionMap::startElement(const string &name, const XMLAttributes &attrs) {
-  setDefault = attrs.has("default") && attrs["default"] == "true";
+void OptionMap::cdata(const string &data) {xmlValue.append(data);}
 
-  XMLAttributes::const_iterator it = attrs.find("v");
-  if (it == attrs.end()) it = attrs.find("value");
 
-  if (it != attrs.end()) {
-    set(name, it->second, setDefault);
-    xmlValueSet = true;
-  }
+void OptionMap::startElementView(const XMLStringView &name,
+                                 const XMLAttributesView &attrs) {
+  setDefault = attrs.get("default") == "true";
+
+  const char *value = attrs.find("v");
+  if (!value) value = attrs.find("value");
 
-  xmlValue = "";
+  xmlValueSet = value;
+  if (value) set(name.toString(), value, setDefault);
+
+  xmlValue.clear();
 }
 
 
-void OptionMap::endElement(const string &name) {
+void OptionMap::endElementView(const XMLStringView &name) {
   xmlValue = String::trim(xmlValue);
 
   if (xmlValue.empty()) {
     // Empty option, assume boolean
-    if (!xmlValueSet) set(name, "true");
+    if (!xmlValueSet) set(name.toString(), "true");
 
-  } else set(name, xmlValue, setDefault);
+  } else set(name.toString(), xmlValue, setDefault);
 }
 
 
-void OptionMap::text(const string &text) {xmlValue.append(text);}
-void OptionMap::cdata(const string &data) {xmlValue.append(data);}
+void OptionMap::textView(const XMLStringView &text) {
+  xmlValue.append(text.getData(), text.getLength());
+}
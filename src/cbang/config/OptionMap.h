@@ -42,6 +42,7 @@
 
 #include <cbang/xml/XMLHandlerFactory.h>
 #include <cbang/xml/XMLFileTracker.h>
+#include <cbang/xml/XMLViewHandler.h>
 
 #include <cbang/script/Handler.h>
 
@@ -49,7 +50,7 @@ namespace cb {
   class Option;
 
   /// A base class for configuration option handling
-  class OptionMap : public XMLHandler, public Script::Handler {
+  class OptionMap : public XMLViewHandler, public Script::Handler {
     XMLFileTracker fileTracker;
 
     std::string xmlValue;
@@ -108,6 +109,9 @@ namespace cb {
     Option &operator[](const std::string &key) const {return *get(key);}
     void set(const std::string &name, const std::string &value,
              bool setDefault = false);
+    /// @return The file currently being read or null.
+    const std::string *getCurrentFile()
+    {return fileTracker.hasFile() ? &fileTracker.getCurrentFile() : 0;}
 
     // Virtual interface
     virtual void add(const std::string &name, SmartPointer<Option> option) = 0;
@@ -126,9 +130,12 @@ namespace cb {
     // From XMLHandler
     void pushFile(const std::string &filename) {fileTracker.pushFile(filename);}
     void popFile() {fileTracker.popFile();}
-    void startElement(const std::string &name, const XMLAttributes &attrs);
-    void endElement(const std::string &name);
-    void text(const std::string &text);
     void cdata(const std::string &data);
+
+    // From XMLViewHandler
+    void startElementView(const XMLStringView &name,
+                          const XMLAttributesView &attrs);
+    void endElementView(const XMLStringView &name);
+    void textView(const XMLStringView &text);
   };
 }
@@ -0,0 +1,109 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "OptionMap.h"
+#include "OptionValue.h"
+
+
+namespace cb {
+  /**
+   * A typed handle to an Option.  The key is resolved once, at construction,
+   * and reads use the Option's pre-parsed value so no map lookup or string
+   * parsing is done in hot code paths.  Each read loads the value once so
+   * hasValue() and get() are safe to call while the option is being set.
+   *
+   *   OptionRef<int64_t> maxConns(options, "max-connections");
+   *   if (maxConns < count) ...
+   */
+  template <typename T>
+  class OptionRef {
+    SmartPointer<Option> option;
+
+  public:
+    OptionRef() {}
+    OptionRef(const SmartPointer<Option> &option) : option(option) {}
+    OptionRef(const OptionMap &options, const std::string &key) :
+      option(options.get(key)) {}
+
+    bool isNull() const {return option.isNull();}
+    Option &getOption() const {return *option;}
+    bool hasValue() const {return (bool)option->getValue();}
+
+    T get() const {
+      std::shared_ptr<const OptionValue> value = option->getValue();
+      return value ? convert(*value) : convert(OptionValue
+                                               (option->toString(),
+                                                option->getType()));
+    }
+
+    T get(const T &defaultValue) const {
+      std::shared_ptr<const OptionValue> value = option->getValue();
+      return value ? convert(*value) : defaultValue;
+    }
+
+    operator T() const {return get();}
+
+    static T convert(const OptionValue &value);
+  };
+
+
+  template <> inline bool OptionRef<bool>::convert(const OptionValue &value)
+  {return value.toBoolean();}
+  template <> inline int32_t
+  OptionRef<int32_t>::convert(const OptionValue &value)
+  {return (int32_t)value.toInteger();}
+  template <> inline uint32_t
+  OptionRef<uint32_t>::convert(const OptionValue &value)
+  {return (uint32_t)value.toInteger();}
+  template <> inline int64_t
+  OptionRef<int64_t>::convert(const OptionValue &value)
+  {return value.toInteger();}
+  template <> inline uint64_t
+  OptionRef<uint64_t>::convert(const OptionValue &value)
+  {return (uint64_t)value.toInteger();}
+  template <> inline double OptionRef<double>::convert(const OptionValue &value)
+  {return value.toDouble();}
+  template <> inline std::string
+  OptionRef<std::string>::convert(const OptionValue &value)
+  {return value.str;}
+  template <> inline Option::strings_t
+  OptionRef<Option::strings_t>::convert(const OptionValue &value)
+  {return value.toStrings();}
+  template <> inline Option::integers_t
+  OptionRef<Option::integers_t>::convert(const OptionValue &value)
+  {return value.toIntegers();}
+  template <> inline Option::doubles_t
+  OptionRef<Option::doubles_t>::convert(const OptionValue &value)
+  {return value.toDoubles();}
+}
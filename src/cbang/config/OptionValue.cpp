@@ -0,0 +1,84 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "OptionValue.h"
+
+using namespace std;
+using namespace cb;
+
+
+OptionValue::OptionValue(const string &str, Option::type_t type) :
+  str(str), type(type), valid(true), boolean(false), integer(0), real(0) {
+  try {
+    switch (type) {
+    case Option::BOOLEAN_TYPE: boolean = Option::parseBoolean(str); break;
+    case Option::STRING_TYPE: break;
+    case Option::INTEGER_TYPE: integer = Option::parseInteger(str); break;
+    case Option::DOUBLE_TYPE: real = Option::parseDouble(str); break;
+    case Option::STRINGS_TYPE: strings = Option::parseStrings(str); break;
+    case Option::INTEGERS_TYPE: integers = Option::parseIntegers(str); break;
+    case Option::DOUBLES_TYPE: doubles = Option::parseDoubles(str); break;
+    }
+  } catch (const Exception &e) {
+    valid = false; // Report the error when the value is read
+  }
+}
+
+
+bool OptionValue::toBoolean() const {
+  return is(Option::BOOLEAN_TYPE) ? boolean : Option::parseBoolean(str);
+}
+
+
+int64_t OptionValue::toInteger() const {
+  return is(Option::INTEGER_TYPE) ? integer : Option::parseInteger(str);
+}
+
+
+double OptionValue::toDouble() const {
+  return is(Option::DOUBLE_TYPE) ? real : Option::parseDouble(str);
+}
+
+
+Option::strings_t OptionValue::toStrings() const {
+  return is(Option::STRINGS_TYPE) ? strings : Option::parseStrings(str);
+}
+
+
+Option::integers_t OptionValue::toIntegers() const {
+  return is(Option::INTEGERS_TYPE) ? integers : Option::parseIntegers(str);
+}
+
+
+Option::doubles_t OptionValue::toDoubles() const {
+  return is(Option::DOUBLES_TYPE) ? doubles : Option::parseDoubles(str);
+}
@@ -0,0 +1,71 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Option.h"
+
+
+namespace cb {
+  /**
+   * An immutable, pre-parsed Option value.  The string is parsed once, as the
+   * Option's type, when the value is set so typed reads do not reparse it.
+   * Conversions to any other type fall back to parsing the string.
+   */
+  class OptionValue {
+  public:
+    const std::string str;
+    const Option::type_t type;
+
+  protected:
+    bool valid; // True if str parsed successfully as type
+
+    bool boolean;
+    int64_t integer;
+    double real;
+    Option::strings_t strings;
+    Option::integers_t integers;
+    Option::doubles_t doubles;
+
+  public:
+    OptionValue(const std::string &str, Option::type_t type);
+
+    bool is(Option::type_t type) const {return valid && this->type == type;}
+
+    bool toBoolean() const;
+    int64_t toInteger() const;
+    double toDouble() const;
+    Option::strings_t toStrings() const;
+    Option::integers_t toIntegers() const;
+    Option::doubles_t toDoubles() const;
+  };
+}
@@ -33,6 +33,7 @@
 #include "Options.h"
 
 #include "OptionCategory.h"
+#include "OptionValue.h"
 
 #include <cbang/Exception.h>
 #include <cbang/String.h>
@@ -43,7 +44,12 @@
 
 #include <cbang/log/Logger.h>
 
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/util/SmartLock.h>
+#include <cbang/xml/XMLReader.h>
+
 #include <cctype>
+#include <set>
 #include <iomanip>
 
 using namespace std;
@@ -53,12 +59,16 @@ using namespace cb;
 bool Options::warnWhenInvalid = false;
 
 
-Options::Options() {
+Options::Options() : generation(0), deferPublish(false) {
   pushCategory(""); // Default category
+  publish();
 }
 
 
-Options::~Options() {}
+Options::~Options() {
+  for (iterator it = begin(); it != end(); it++)
+    if (it->second->getOwner() == this) it->second->setOwner(0);
+}
 
 
 void Options::add(const string &_key, SmartPointer<Option> option) {
@@ -69,11 +79,27 @@ void Options::add(const string &_key, SmartPointer<Option> option) {
 
   map[key] = option;
   categoryStack.back()->add(option);
+  option->setOwner(this);
+  changed();
 }
 
 
-bool Options::remove(const string &key) {
-  return map.erase(cleanKey(key));
+bool Options::remove(const string &_key) {
+  iterator it = map.find(cleanKey(_key));
+  if (it == map.end()) return false;
+
+  SmartPointer<Option> option = it->second;
+  map.erase(it);
+
+  // Stop notifications unless the option is still here under an alias
+  bool aliased = false;
+  for (it = begin(); it != end() && !aliased; it++)
+    aliased = it->second == option;
+
+  if (!aliased && option->getOwner() == this) option->setOwner(0);
+  changed();
+
+  return true;
 }
 
 
@@ -89,9 +115,11 @@ const SmartPointer<Option> &Options::get(const string &_key) const {
 
   if (it == map.end()) {
     if (getAutoAdd()) {
-      const SmartPointer<Option> &option =
-        const_cast<Options *>(this)->map[key] = new Option(key);
+      Options *self = const_cast<Options *>(this);
+      const SmartPointer<Option> &option = self->map[key] = new Option(key);
       categoryStack.back()->add(option);
+      option->setOwner(self);
+      self->changed();
       return option;
 
     } else THROW("Option '" << key << "' does not exist.");
@@ -113,6 +141,7 @@ void Options::alias(const string &_key, const string &_alias) {
 
   option->addAlias(alias);
   map[alias] = option;
+  changed();
 }
 
 
@@ -330,6 +359,146 @@ void Options::read(const JSON::Value &options) {
 }
 
 
+unsigned Options::reload(const string &filename) {
+  // Read through a stream since the file may be rewritten at any time and
+  // a truncated mapping would fault rather than fail the parse
+  unsigned changed =
+    reload(*SystemUtilities::open(filename, ios::in), filename);
+
+  LOG_INFO(1, "Reloaded " << filename << ", " << changed << " options changed");
+
+  return changed;
+}
+
+
+unsigned Options::reload(istream &stream, const string &filename) {
+  Options staged;
+  staged.setAutoAdd(true);
+  staged.setAllowReset(true);
+
+  // Nothing reads the staged values concurrently
+  staged.deferPublish = true;
+
+  XMLReader reader;
+  reader.pushFile(filename);
+  reader.read(stream, &staged);
+  reader.popFile();
+
+  return apply(staged, filename);
+}
+
+
+shared_ptr<const Options::values_t> Options::getSnapshot() const {
+  shared_ptr<const Snapshot> current = atomic_load(&snapshot);
+  return shared_ptr<const values_t>(current, &current->values);
+}
+
+
+uint64_t Options::getGeneration() const {
+  return atomic_load(&snapshot)->generation;
+}
+
+
+void Options::changed() {
+  SmartLock lock(&snapshotLock);
+
+  generation++;
+  if (!deferPublish) publish();
+}
+
+
 string Options::cleanKey(const string &key) {
   return String::replace(key, '_', '-');
 }
+
+
+void Options::publish() {
+  SmartLock lock(&snapshotLock);
+
+  shared_ptr<Snapshot> next = make_shared<Snapshot>();
+  next->generation = generation;
+
+  for (const_iterator it = begin(); it != end(); it++) {
+    shared_ptr<const OptionValue> value = it->second->getValue();
+    if (value) next->values[it->first] = value;
+  }
+
+  atomic_store(&snapshot, shared_ptr<const Snapshot>(next));
+}
+
+
+unsigned Options::apply(const Options &staged, const string &filename) {
+  typedef vector<pair<SmartPointer<Option>, string> > changes_t;
+  changes_t changes;
+  vector<SmartPointer<Option> > resets;
+  std::set<const Option *> inFile;
+
+  // Validate everything first
+  for (const_iterator it = staged.begin(); it != staged.end(); it++) {
+    const string &name = it->first;
+    const Option &value = *it->second;
+
+    if (!value.isSet()) continue;
+
+    if (!has(name)) {
+      LOG_WARNING("Unrecognized option '" << name << "'");
+      continue;
+    }
+
+    const SmartPointer<Option> &option = get(name);
+    inFile.insert(option.get());
+
+    // The command line overrides configuration files
+    if (option->isCommandLine()) continue;
+
+    if (option->isSet() && option->toString() == value.toString()) continue;
+
+    if (option->isDepreciated()) {
+      LOG_WARNING("Option '" << name << "' has been depreciated");
+      continue;
+    }
+
+    try {
+      option->validate(value.toString());
+    } catch (const Exception &e) {
+      THROWC("Invalid value for option '" << name << "'", e);
+    }
+
+    changes.push_back(changes_t::value_type(option, value.toString()));
+  }
+
+  // Options read from this file before but no longer in it
+  for (const_iterator it = begin(); it != end(); it++) {
+    const SmartPointer<Option> &option = it->second;
+    const string *file = option->getFilename();
+
+    if (option->isSet() && file && *file == filename &&
+        inFile.insert(option.get()).second) resets.push_back(option);
+  }
+
+  // Then apply and publish the new values together
+  SmartLock lock(&snapshotLock);
+  deferPublish = true;
+  pushFile(filename);
+
+  try {
+    for (unsigned i = 0; i < changes.size(); i++) {
+      changes[i].first->set(changes[i].second);
+      changes[i].first->setFilename(getCurrentFile());
+    }
+
+    for (unsigned i = 0; i < resets.size(); i++) resets[i]->reset();
+
+  } catch (...) {
+    popFile();
+    deferPublish = false;
+    publish();
+    throw;
+  }
+
+  popFile();
+  deferPublish = false;
+  publish();
+
+  return changes.size() + resets.size();
+}
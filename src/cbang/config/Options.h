@@ -36,10 +36,12 @@
 #include "OptionCategory.h"
 
 #include <cbang/json/Serializable.h>
+#include <cbang/os/Mutex.h>
 
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 
 namespace cb {
@@ -55,6 +57,21 @@ namespace cb {
     typedef std::vector<SmartPointer<OptionCategory> > category_stack_t;
     category_stack_t categoryStack;
 
+  public:
+    typedef std::map<std::string, std::shared_ptr<const OptionValue> >
+    values_t;
+
+  protected:
+    struct Snapshot {
+      uint64_t generation;
+      values_t values;
+    };
+
+    Mutex snapshotLock;
+    uint64_t generation;
+    bool deferPublish;
+    std::shared_ptr<const Snapshot> snapshot;
+
   public:
     static bool warnWhenInvalid;
 
@@ -95,6 +112,31 @@ namespace cb {
     pushCategory(const std::string &name);
     virtual void popCategory();
 
+    /**
+     * @return An immutable view of every option's value.  Values changed
+     * by reload() are published together so a reader of several options
+     * never sees a partially applied configuration.  Snapshots are built
+     * by writers so reading one never locks.
+     */
+    std::shared_ptr<const values_t> getSnapshot() const;
+    /// @return A counter which changes whenever one of these options changes
+    uint64_t getGeneration() const;
+
+    /// Called by an Option owned by this object when its value changes
+    void changed();
+
+    /**
+     * Re-read an XML configuration.  The new values are staged and checked
+     * against each option's type and constraints before any are applied, so
+     * an invalid configuration leaves the current one unchanged.  Options
+     * previously read from the same file but no longer in it are reset.
+     *
+     * @return The number of options which changed.
+     */
+    virtual unsigned reload(const std::string &filename);
+    virtual unsigned reload(std::istream &stream,
+                            const std::string &filename = "<stream>");
+
     // From OptionMap
     using OptionMap::add;
     virtual void add(const std::string &name, SmartPointer<Option> option);
@@ -109,6 +151,10 @@ namespace cb {
     using JSON::Serializable::write;
 
     static std::string cleanKey(const std::string &key);
+
+  protected:
+    void publish();
+    unsigned apply(const Options &staged, const std::string &filename);
   };
 
   inline std::ostream &operator<<(std::ostream &stream, const Options &opts) {
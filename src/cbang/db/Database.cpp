@@ -33,6 +33,7 @@
 #include "Database.h"
 
 #include "Statement.h"
+#include "StatementCache.h"
 
 #include <cbang/Exception.h>
 #include <cbang/String.h>
@@ -50,7 +51,8 @@ using namespace cb;
 using namespace cb::DB;
 
 
-Database::Database(double timeout) : timeout(timeout), db(0), transaction(0) {}
+Database::Database(double timeout) :
+  timeout(timeout), db(0), transaction(0), cache(new StatementCache(*this)) {}
 
 
 Database::~Database() {
@@ -78,6 +80,9 @@ void Database::open(const string &filename, unsigned flags) {
 
 
 void Database::close() {
+  // Statements must be finalized before the connection is closed
+  cache->clear();
+
   if (isOpen()) {
     if (sqlite3_close(db) != SQLITE_OK)
       LOG_WARNING("Failed to close DB connection: " << lastErrorMsg());
@@ -86,6 +91,20 @@ void Database::close() {
 }
 
 
+void Database::setCacheSize(unsigned size) {
+  cache->setCapacity(size);
+}
+
+
+void Database::enableWAL() {
+  string mode;
+  execute("PRAGMA journal_mode=WAL", mode);
+  if (String::toLower(mode) != "wal")
+    THROW("Failed to enable write-ahead log, journal mode is '" << mode
+           << "'");
+}
+
+
 void Database::executef(const char *sql, ...) {
   va_list ap;
 
@@ -99,37 +118,52 @@ void Database::execute(const string &sql) {
   // TODO handle SQLITE_LOCKED return code with sqlite3_unlock_notify() and a
   //   condition variable to support shared-cache mode.
 
-  LOG_DEBUG(5, "SQL: " << sql);
+  SmartPointer<Statement> stmt = prepare(sql);
+
+  if (stmt->hasTail()) {
+    LOG_DEBUG(5, "SQL: " << sql);
+
+    char *err = 0;
+    int ret = sqlite3_exec(db, sql.c_str(), 0, 0, &err);
+
+    if (ret || err) {
+      string errMsg;
 
-  char *err = 0;
-  int ret = sqlite3_exec(db, sql.c_str(), 0, 0, &err);
+      if (err) {
+        errMsg = err;
+        sqlite3_free(err);
 
-  if (ret || err) {
-    string errMsg;
+      } else errMsg = errorMsg(ret);
 
-    if (err) {
-      errMsg = err;
-      sqlite3_free(err);
+      THROW("Error executing: '" << sql << "': " << errMsg);
+    }
 
-    } else errMsg = errorMsg(ret);
+    return;
+  }
+
+  try {
+    stmt->execute();
 
+  } catch (const Exception &) {
+    string errMsg = lastErrorMsg();
+    stmt->reset();
     THROW("Error executing: '" << sql << "': " << errMsg);
   }
 }
 
 
 bool Database::execute(const string &sql, int64_t &result) {
-  return compile(sql)->execute(result);
+  return prepare(sql)->execute(result);
 }
 
 
 bool Database::execute(const string &sql, double &result) {
-  return compile(sql)->execute(result);
+  return prepare(sql)->execute(result);
 }
 
 
 bool Database::execute(const string &sql, string &result) {
-  return compile(sql)->execute(result);
+  return prepare(sql)->execute(result);
 }
 
 
@@ -149,6 +183,11 @@ SmartPointer<Statement> Database::compile(const string &sql) {
 }
 
 
+SmartPointer<Statement> Database::prepare(const string &sql) {
+  return cache->get(sql);
+}
+
+
 SmartPointer<Transaction> Database::begin(transaction_t type, double timeout) {
   if (transaction) THROW("Already in a transaction");
 
@@ -184,6 +223,19 @@ void Database::rollback() {
 }
 
 
+void Database::batch(function<void ()> cb, transaction_t type) {
+  if (!cb) THROW("Callback cannot be null");
+  if (transaction) {
+    cb();
+    return;
+  }
+
+  SmartPointer<Transaction> t = begin(type, timeout);
+  cb();
+  t->commit();
+}
+
+
 SmartPointer<Backup> Database::backup(Database &target) {
   sqlite3_backup *backup = sqlite3_backup_init(target.db, "main", db, "main");
   if (!backup) THROW("Failed to initialize backup");
@@ -38,18 +38,21 @@
 #include <cbang/SmartPointer.h>
 
 #include <string>
+#include <functional>
 
 struct sqlite3;
 
 namespace cb {
   namespace DB {
     class Statement;
+    class StatementCache;
     class Blob;
 
     class Database {
       double timeout;
       sqlite3 *db;
       Transaction *transaction;
+      SmartPointer<StatementCache> cache;
 
     public:
       typedef enum {
@@ -79,6 +82,14 @@ namespace cb {
       void open(const std::string &con, unsigned flags = READ_WRITE | CREATE);
       void close();
 
+      StatementCache &getCache() {return *cache;}
+      /// Set the number of compiled statements kept.  Zero disables caching.
+      void setCacheSize(unsigned size);
+
+      /// Put the database in write-ahead log mode so readers on other
+      /// connections do not block the writer.
+      void enableWAL();
+
       void executef(const char *sql, ...);
       void execute(const std::string &sql);
       bool execute(const std::string &sql, int64_t &result);
@@ -87,11 +98,21 @@ namespace cb {
 
       SmartPointer<Statement> compilef(const char *sql, ...);
       SmartPointer<Statement> compile(const std::string &sql);
+      /// Like compile() but the Statement comes from, and stays in, the cache
+      SmartPointer<Statement> prepare(const std::string &sql);
 
       SmartPointer<Transaction> begin(transaction_t type = DEFERRED,
                                       double timeout = 30);
       void commit();
       void rollback();
+      bool inTransaction() const {return transaction;}
+
+      /**
+       * Call @param cb inside one transaction so its writes are committed
+       * together.  The transaction is rolled back if @param cb throws.  If a
+       * transaction is already open @param cb joins it.
+       */
+      void batch(std::function<void ()> cb, transaction_t type = IMMEDIATE);
 
       SmartPointer<Backup> backup(Database &target);
 
@@ -0,0 +1,111 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "DatabasePool.h"
+
+#include <cbang/Exception.h>
+#include <cbang/util/SmartLock.h>
+
+using namespace std;
+using namespace cb;
+using namespace cb::DB;
+
+
+DatabasePool::DatabasePool(const string &filename, double timeout,
+                           unsigned cacheSize) :
+  filename(filename), timeout(timeout), cacheSize(cacheSize) {}
+
+
+DatabasePool::~DatabasePool() {
+  close();
+}
+
+
+void DatabasePool::open() {
+  SmartLock lock(this);
+
+  if (isOpen()) THROW("Database pool '" << filename << "' already open");
+
+  SmartPointer<Database> db = new Database(timeout);
+  db->setCacheSize(cacheSize);
+  db->open(filename);
+  db->enableWAL();
+
+  writer = db;
+}
+
+
+void DatabasePool::close() {
+  SmartLock lock(this);
+
+  for (unsigned i = 0; i < connections.size(); i++) connections[i]->close();
+  connections.clear();
+
+  if (writer.isSet()) writer->close();
+  writer.release();
+}
+
+
+Database &DatabasePool::getReader() {
+  SmartPointer<Database> &db = readers.get();
+
+  // Connections closed by close() are replaced
+  if (db.isNull() || !db->isOpen()) {
+    SmartLock lock(this);
+    if (!isOpen()) THROW("Database pool '" << filename << "' not open");
+
+    db = new Database(timeout);
+    db->setCacheSize(cacheSize);
+    db->open(filename, Database::READ_ONLY | Database::NO_MUTEX);
+
+    connections.push_back(db);
+  }
+
+  return *db;
+}
+
+
+void DatabasePool::write(function<void (Database &db)> cb,
+                         Database::transaction_t type) {
+  if (!cb) THROW("Callback cannot be null");
+
+  SmartLock lock(&writeLock);
+
+  SmartPointer<Database> db;
+  {
+    SmartLock lock(this);
+    if (!isOpen()) THROW("Database pool '" << filename << "' not open");
+    db = writer;
+  }
+
+  db->batch([&db, &cb] () {cb(*db);}, type);
+}
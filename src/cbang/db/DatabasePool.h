@@ -0,0 +1,87 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Database.h"
+
+#include <cbang/SmartPointer.h>
+#include <cbang/os/Mutex.h>
+#include <cbang/os/ThreadLocalStorage.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+
+namespace cb {
+  namespace DB {
+    /**
+     * Connections to one SQLite file in write-ahead log mode.  Each thread
+     * reads through its own read-only connection so readers never wait on
+     * each other or on the writer.  All writes go through a single writer
+     * connection, one batch at a time.
+     *
+     * Connections opened by threads are kept until close().  close() must
+     * not be called while other threads are still using the pool.
+     */
+    class DatabasePool : public Mutex {
+      const std::string filename;
+      double timeout;
+      unsigned cacheSize;
+
+      Mutex writeLock;
+      SmartPointer<Database> writer;
+
+      ThreadLocalStorage<SmartPointer<Database> > readers;
+      std::vector<SmartPointer<Database> > connections;
+
+    public:
+      DatabasePool(const std::string &filename, double timeout = 30,
+                   unsigned cacheSize = 64);
+      ~DatabasePool();
+
+      const std::string &getFilename() const {return filename;}
+
+      bool isOpen() const {return writer.isSet();}
+      void open();
+      void close();
+
+      /// @return The calling thread's read-only connection
+      Database &getReader();
+
+      /// Call @param cb with the writer inside one transaction.
+      void write(std::function<void (Database &db)> cb,
+                 Database::transaction_t type = Database::IMMEDIATE);
+    };
+  }
+}
@@ -0,0 +1,522 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "EventSQLite.h"
+#include "Statement.h"
+
+#include <cbang/Exception.h>
+#include <cbang/Catch.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/json/Builder.h>
+#include <cbang/json/Sink.h>
+#include <cbang/time/Timer.h>
+#include <cbang/util/SmartLock.h>
+#include <cbang/util/SmartUnlock.h>
+#include <cbang/log/Logger.h>
+
+#include <sqlite3.h>
+
+#include <cctype>
+
+using namespace std;
+using namespace cb;
+using namespace cb::DB;
+
+
+namespace {
+  int progress(void *data) {
+    const EventSQLite::Job *job = (const EventSQLite::Job *)data;
+    return job->canceled || job->expired();
+  }
+
+
+  // Lets SQLite interrupt a canceled or expired Job
+  class ProgressHandler {
+    sqlite3 *db;
+
+  public:
+    ProgressHandler(Database &db, const EventSQLite::Job &job) :
+      db(db.getDB()) {
+      sqlite3_progress_handler(this->db, 1000, progress, (void *)&job);
+    }
+
+    ~ProgressHandler() {sqlite3_progress_handler(db, 0, 0, 0);}
+  };
+}
+
+
+bool EventSQLite::Job::expired() const {
+  return deadline && deadline < Timer::now();
+}
+
+
+EventSQLite::EventSQLite(Event::Base &base, const string &filename,
+                         unsigned readers, double timeout) :
+  base(base), pool(filename, timeout), readers(readers), maxBatch(1000),
+  chunkSize(256), event(base.newEvent(this, &EventSQLite::complete)),
+  timer(base.newEvent(this, &EventSQLite::expire)), shutdown(false),
+  nextID(0), changes(0), lastInsertID(0) {
+
+  if (!Event::Base::threadsEnabled())
+    THROW("Cannot use DB::EventSQLite without threads enabled.  "
+          "Call Event::Base::enableThreads() before creating Event::Base.");
+  if (!readers) THROW("DB::EventSQLite needs at least one read thread");
+}
+
+
+EventSQLite::~EventSQLite() {
+  TRY_CATCH_ERROR(stop());
+}
+
+
+void EventSQLite::start() {
+  if (isRunning()) THROW("DB::EventSQLite already running");
+
+  pool.open();
+  shutdown = false;
+
+  for (unsigned i = 0; i < readers; i++)
+    threads.push_back
+      (new ThreadFunc<EventSQLite>(this, &EventSQLite::readLoop));
+  threads.push_back
+    (new ThreadFunc<EventSQLite>(this, &EventSQLite::writeLoop));
+
+  for (unsigned i = 0; i < threads.size(); i++) threads[i]->start();
+}
+
+
+void EventSQLite::stop() {
+  if (!isRunning()) return;
+
+  {
+    SmartLock lock(this);
+    shutdown = true;
+    Condition::broadcast();
+  }
+
+  for (unsigned i = 0; i < threads.size(); i++) threads[i]->join();
+  threads.clear();
+
+  SmartLock lock(this);
+  jobs.clear();
+  reads.clear();
+  writes.clear();
+  results.clear();
+  deadlines.clear();
+  timer->del();
+
+  pool.close();
+}
+
+
+uint64_t EventSQLite::query(callback_t cb, const string &sql,
+                            const SmartPointer<const JSON::Value> &params,
+                            double timeout) {
+  JobPtr job = new Job;
+  job->sql = sql;
+  job->params = params;
+  job->cb = cb;
+  if (timeout) job->deadline = Timer::now() + timeout;
+
+  return submit(job);
+}
+
+
+uint64_t EventSQLite::query(JSON::Sink &sink, callback_t cb,
+                            const string &sql,
+                            const SmartPointer<const JSON::Value> &params,
+                            double timeout) {
+  auto write = [this, &sink, cb] (state_t state) {
+    switch (state) {
+    case EVENTDB_BEGIN_RESULT:
+      sink.beginList();
+      sink.beginAppend();
+      getRow().write(sink);
+      break;
+
+    case EVENTDB_ROW:
+      sink.beginAppend();
+      getRow().write(sink);
+      break;
+
+    case EVENTDB_END_RESULT: sink.endList(); break;
+    default: break;
+    }
+
+    if (cb) cb(state);
+  };
+
+  return query(write, sql, params, timeout);
+}
+
+
+uint64_t EventSQLite::write(callback_t cb, const string &sql,
+                            const SmartPointer<const JSON::Value> &params,
+                            double timeout) {
+  JobPtr job = new Job;
+  job->write = true;
+  job->sql = sql;
+  job->params = params;
+  job->cb = cb;
+  if (timeout) job->deadline = Timer::now() + timeout;
+
+  return submit(job);
+}
+
+
+bool EventSQLite::cancel(uint64_t id) {
+  SmartLock lock(this);
+
+  auto it = jobs.find(id);
+  if (it == jobs.end()) return false;
+
+  // Skipped if still queued, interrupted by SQLite if running
+  it->second->canceled = true;
+  jobs.erase(it);
+
+  return true;
+}
+
+
+const JSON::Value &EventSQLite::getRow() const {
+  if (row.isNull()) THROW("No current row");
+  return *row;
+}
+
+
+void EventSQLite::bind(Statement &stmt, const JSON::Value &params) {
+  for (unsigned i = 0; i < params.size(); i++) {
+    Parameter param = stmt.parameter(i);
+
+    if (params.isDict()) {
+      string name = params.keyAt(i);
+
+      // Accept names without their prefix
+      if (!name.empty() && isalnum(name[0])) name = ":" + name;
+      param = stmt.parameter(name);
+    }
+
+    const JSON::Value &value = *params.get(i);
+
+    if (value.isNull()) param.bind();
+    else if (value.isBoolean()) param.bind(value.getBoolean());
+    else if (value.isString()) param.bind(value.getString());
+
+    else if (value.isNumber()) {
+      double x = value.getNumber();
+      if (x == (double)(int64_t)x) param.bind((int64_t)x);
+      else param.bind(x);
+
+    } else THROW("Cannot bind " << value.getType() << " to SQL parameter");
+  }
+}
+
+
+uint64_t EventSQLite::submit(const JobPtr &job) {
+  SmartLock lock(this);
+
+  if (!isRunning()) THROW("DB::EventSQLite not running");
+
+  job->id = ++nextID;
+  jobs[job->id] = job;
+
+  if (job->write) writes.push_back(job);
+  else reads.push_back(job);
+  Condition::broadcast();
+
+  if (job->deadline) {
+    bool first =
+      deadlines.empty() || job->deadline < deadlines.begin()->first;
+    deadlines.insert(make_pair(job->deadline, job->id));
+    if (first) timer->add(job->deadline - Timer::now());
+  }
+
+  return job->id;
+}
+
+
+void EventSQLite::expire() {
+  SmartLock lock(this);
+
+  double now = Timer::now();
+
+  while (!deadlines.empty() && deadlines.begin()->first <= now) {
+    uint64_t id = deadlines.begin()->second;
+    deadlines.erase(deadlines.begin());
+
+    // Jobs which already completed are ignored
+    auto it = jobs.find(id);
+    if (it == jobs.end()) continue;
+
+    JobPtr job = it->second;
+    job->canceled = true;
+    jobs.erase(it);
+
+    SmartUnlock unlock(this);
+
+    error = "Query timed out";
+    TRY_CATCH_ERROR(if (job->cb) job->cb(EVENTDB_ERROR));
+    error.clear();
+  }
+
+  if (!deadlines.empty()) timer->add(deadlines.begin()->first - now);
+}
+
+
+void EventSQLite::post(ResultPtr &result) {
+  SmartLock lock(this);
+  results.push_back(result);
+  result.release();
+  event->activate();
+}
+
+
+void EventSQLite::fail(const JobPtr &job, const string &error) {
+  ResultPtr result = new Result(job->id, EVENTDB_ERROR);
+  result->error = job->expired() ? "Query timed out" : error;
+  post(result);
+}
+
+
+EventSQLite::JobPtr EventSQLite::next(list<JobPtr> &queue) {
+  // Called with lock held
+  while (!shutdown) {
+    while (!queue.empty()) {
+      JobPtr job = queue.front();
+      queue.pop_front();
+      if (!job->canceled) return job;
+    }
+
+    Condition::wait();
+  }
+
+  return 0;
+}
+
+
+void EventSQLite::readLoop() {
+  while (true) {
+    JobPtr job;
+
+    {
+      SmartLock lock(this);
+      job = next(reads);
+      if (job.isNull()) return; // Shutdown
+    }
+
+    try {
+      read(job);
+    } catch (const Exception &e) {fail(job, e.getMessage());}
+  }
+}
+
+
+void EventSQLite::writeLoop() {
+  while (true) {
+    vector<JobPtr> batch;
+
+    {
+      SmartLock lock(this);
+
+      JobPtr job = next(writes);
+      if (job.isNull()) return; // Shutdown
+
+      // Group commit everything queued so far
+      batch.push_back(job);
+      while (batch.size() < maxBatch && !writes.empty()) {
+        job = writes.front();
+        writes.pop_front();
+        if (!job->canceled) batch.push_back(job);
+      }
+    }
+
+    writeBatch(batch);
+  }
+}
+
+
+void EventSQLite::read(const JobPtr &job) {
+  Database &db = pool.getReader();
+  ProgressHandler handler(db, *job);
+
+  SmartPointer<Statement> stmt = db.prepare(job->sql);
+  if (job->params.isSet()) bind(*stmt, *job->params);
+
+  // Builders are destroyed before their results are posted so JSON
+  // reference counts are never touched by two threads at once.
+  try {
+    JSON::ValuePtr rows;
+
+    {
+      JSON::Builder builder;
+      stmt->readHeader(builder);
+      rows = builder.getRoot();
+    }
+
+    ResultPtr result = new Result(job->id, EVENTDB_BEGIN_RESULT);
+    result->rows = rows;
+    rows.release();
+    post(result);
+
+    bool more = true;
+    while (more && !job->canceled) {
+      {
+        JSON::Builder builder;
+        builder.beginList();
+
+        for (unsigned i = 0; i < chunkSize && (more = stmt->next()); i++) {
+          builder.beginAppend();
+          stmt->readOne(builder);
+        }
+
+        builder.endList();
+        rows = builder.getRoot();
+      }
+
+      if (rows->size()) {
+        result = new Result(job->id, EVENTDB_ROW);
+        result->rows = rows;
+        rows.release();
+        post(result);
+      }
+    }
+
+  } catch (...) {
+    // Don't hold the read transaction open
+    stmt->reset();
+    throw;
+  }
+
+  stmt->reset();
+
+  ResultPtr result = new Result(job->id, EVENTDB_END_RESULT);
+  post(result);
+  result = new Result(job->id, EVENTDB_DONE);
+  post(result);
+}
+
+
+void EventSQLite::writeBatch(vector<JobPtr> &batch) {
+  vector<ResultPtr> done(batch.size());
+
+  try {
+    pool.write([&] (Database &db) {
+        for (unsigned i = 0; i < batch.size(); i++) {
+          const Job &job = *batch[i];
+          if (job.canceled) continue;
+
+          db.execute("SAVEPOINT job");
+          SmartPointer<Statement> stmt;
+
+          try {
+            ProgressHandler handler(db, job);
+
+            stmt = db.prepare(job.sql);
+            if (job.params.isSet()) bind(*stmt, *job.params);
+            stmt->execute();
+
+            done[i] = new Result(job.id, EVENTDB_DONE);
+            done[i]->changes = sqlite3_changes(db.getDB());
+            done[i]->lastInsertID = sqlite3_last_insert_rowid(db.getDB());
+
+            db.execute("RELEASE job");
+
+          } catch (const Exception &e) {
+            done[i] = new Result(job.id, EVENTDB_ERROR);
+            done[i]->error =
+              job.expired() ? "Query timed out" : e.getMessage();
+
+            // Undo only this write
+            if (stmt.isSet()) stmt->reset();
+            db.execute("ROLLBACK TO job");
+            db.execute("RELEASE job");
+          }
+        }
+      });
+
+  } catch (const Exception &e) {
+    LOG_WARNING("DB::EventSQLite commit failed: " << e.getMessage());
+
+    // Nothing was committed
+    for (unsigned i = 0; i < batch.size(); i++) {
+      done[i] = new Result(batch[i]->id, EVENTDB_ERROR);
+      done[i]->error = "Commit failed: " + e.getMessage();
+    }
+  }
+
+  for (unsigned i = 0; i < done.size(); i++)
+    if (done[i].isSet()) post(done[i]);
+}
+
+
+void EventSQLite::complete() {
+  SmartLock lock(this);
+
+  while (!results.empty()) {
+    ResultPtr result = results.front();
+    results.pop_front();
+
+    // Canceled or timed out
+    auto it = jobs.find(result->id);
+    if (it == jobs.end()) continue;
+
+    JobPtr job = it->second;
+    if (result->state == EVENTDB_DONE || result->state == EVENTDB_ERROR)
+      jobs.erase(it);
+
+    if (!job->cb) continue;
+
+    SmartUnlock unlock(this);
+
+    try {
+      if (result->state == EVENTDB_ROW)
+        for (unsigned i = 0; i < result->rows->size() && !job->canceled;
+             i++) {
+          row = result->rows->get(i);
+          job->cb(EVENTDB_ROW);
+        }
+
+      else {
+        row = result->rows;
+        error = result->error;
+        changes = result->changes;
+        lastInsertID = result->lastInsertID;
+
+        job->cb(result->state);
+      }
+    } CATCH_ERROR;
+
+    row.release();
+    error.clear();
+  }
+}
@@ -0,0 +1,231 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "DatabasePool.h"
+
+#include <cbang/SmartPointer.h>
+#include <cbang/StdTypes.h>
+#include <cbang/os/Condition.h>
+#include <cbang/os/Thread.h>
+#include <cbang/json/Value.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <functional>
+#include <atomic>
+
+
+namespace cb {
+  namespace JSON {class Sink;}
+  namespace Event {
+    class Base;
+    class Event;
+  }
+
+  namespace DB {
+    /**
+     * Runs SQLite statements on worker threads so the Event::Base thread
+     * never waits on a query or an fsync.  Reads are spread over a pool of
+     * threads, each with its own read-only connection.  Writes are queued
+     * to a single writer thread which commits everything queued so far in
+     * one transaction.  Each write runs in its own savepoint so a failed
+     * write does not undo the others.
+     *
+     * Callbacks are always called on the Base thread.  Like
+     * MariaDB::EventDB a query reports EVENTDB_BEGIN_RESULT, EVENTDB_ROW
+     * for each row, EVENTDB_END_RESULT and then EVENTDB_DONE, or
+     * EVENTDB_ERROR at any point.  Writes report only EVENTDB_DONE or
+     * EVENTDB_ERROR and only once their transaction has committed.
+     * getRow(), getError(), getChanges() and getLastInsertID() are valid
+     * during a callback.
+     *
+     * A canceled query gets no more callbacks.  A query which times out
+     * reports EVENTDB_ERROR.  Both are also interrupted inside SQLite if
+     * they are running.
+     */
+    class EventSQLite : protected Condition {
+    public:
+      typedef enum {
+        EVENTDB_ERROR,
+        EVENTDB_BEGIN_RESULT,
+        EVENTDB_ROW,
+        EVENTDB_END_RESULT,
+        EVENTDB_DONE,
+      } state_t;
+
+      template <class T> struct Callback {
+        typedef void (T::*member_t)(state_t);
+      };
+      typedef std::function<void (state_t)> callback_t;
+
+      struct Job {
+        uint64_t id;
+        bool write;
+        std::string sql;
+        SmartPointer<const JSON::Value> params;
+        callback_t cb;
+        double deadline;
+        std::atomic<bool> canceled;
+
+        Job() : id(0), write(false), deadline(0), canceled(false) {}
+        bool expired() const;
+      };
+      typedef SmartPointer<Job>::Protected JobPtr;
+
+      struct Result {
+        uint64_t id;
+        state_t state;
+        JSON::ValuePtr rows;
+        std::string error;
+        int64_t changes;
+        int64_t lastInsertID;
+
+        Result(uint64_t id, state_t state) :
+          id(id), state(state), changes(0), lastInsertID(0) {}
+      };
+      typedef SmartPointer<Result>::Protected ResultPtr;
+
+    protected:
+      Event::Base &base;
+      DatabasePool pool;
+      unsigned readers;
+      unsigned maxBatch;
+      unsigned chunkSize;
+
+      std::vector<SmartPointer<Thread> > threads;
+      SmartPointer<Event::Event> event;
+      SmartPointer<Event::Event> timer;
+      volatile bool shutdown;
+
+      uint64_t nextID;
+      std::map<uint64_t, JobPtr> jobs;
+      std::list<JobPtr> reads;
+      std::list<JobPtr> writes;
+      std::list<ResultPtr> results;
+      std::multimap<double, uint64_t> deadlines;
+
+      // Valid during callbacks
+      JSON::ValuePtr row;
+      std::string error;
+      int64_t changes;
+      int64_t lastInsertID;
+
+    public:
+      /**
+       * @param readers The number of read threads.
+       * @param timeout How long SQLite waits on a locked database.
+       */
+      EventSQLite(Event::Base &base, const std::string &filename,
+                  unsigned readers = 2, double timeout = 30);
+      ~EventSQLite();
+
+      const std::string &getFilename() const {return pool.getFilename();}
+
+      /// The most writes committed in one transaction
+      void setMaxBatch(unsigned maxBatch) {this->maxBatch = maxBatch;}
+      /// Rows are passed from the read threads in chunks of this size
+      void setChunkSize(unsigned chunkSize) {this->chunkSize = chunkSize;}
+
+      bool isRunning() const {return !threads.empty();}
+      void start();
+      /// Queued queries are dropped without callbacks
+      void stop();
+
+      /**
+       * Queue a read.  @param params is a list of positional parameters or
+       * a dict of named parameters.
+       * @param timeout Seconds before the query fails or zero for no limit.
+       * @return An id which can be passed to cancel().
+       */
+      uint64_t query(callback_t cb, const std::string &sql,
+                     const SmartPointer<const JSON::Value> &params = 0,
+                     double timeout = 0);
+
+      template <class T>
+      uint64_t query(T *obj, typename Callback<T>::member_t member,
+                     const std::string &sql,
+                     const SmartPointer<const JSON::Value> &params = 0,
+                     double timeout = 0) {
+        using namespace std::placeholders;
+        return query(std::bind(member, obj, _1), sql, params, timeout);
+      }
+
+      /// Queue a read whose rows are written to @param sink in the same
+      /// form as Statement::readAll().
+      uint64_t query(JSON::Sink &sink, callback_t cb, const std::string &sql,
+                     const SmartPointer<const JSON::Value> &params = 0,
+                     double timeout = 0);
+
+      /// Queue a write to be committed with the other pending writes.
+      uint64_t write(callback_t cb, const std::string &sql,
+                     const SmartPointer<const JSON::Value> &params = 0,
+                     double timeout = 0);
+
+      template <class T>
+      uint64_t write(T *obj, typename Callback<T>::member_t member,
+                     const std::string &sql,
+                     const SmartPointer<const JSON::Value> &params = 0,
+                     double timeout = 0) {
+        using namespace std::placeholders;
+        return write(std::bind(member, obj, _1), sql, params, timeout);
+      }
+
+      /// @return False if the query already completed.
+      bool cancel(uint64_t id);
+
+      const JSON::Value &getRow() const;
+      const std::string &getError() const {return error;}
+      int64_t getChanges() const {return changes;}
+      int64_t getLastInsertID() const {return lastInsertID;}
+
+      static void bind(Statement &stmt, const JSON::Value &params);
+
+    protected:
+      uint64_t submit(const JobPtr &job);
+      void expire();
+      void post(ResultPtr &result);
+      void fail(const JobPtr &job, const std::string &error);
+      JobPtr next(std::list<JobPtr> &queue);
+
+      void readLoop();
+      void writeLoop();
+      void read(const JobPtr &job);
+      void writeBatch(std::vector<JobPtr> &batch);
+
+      void complete();
+    };
+  }
+}
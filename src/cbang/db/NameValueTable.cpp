@@ -145,30 +145,41 @@ bool NameValueTable::getBoolean(const string &name) const {
 
 const string NameValueTable::getString(const string &name,
                                        const string &defaultValue) const {
-  return has(name) ? getString(name) : defaultValue;
+  if (!doFind(name)) return defaultValue;
+  string x = selectStmt->column(0).toString();
+  selectStmt->reset();
+  return x;
 }
 
 
 int64_t NameValueTable::getInteger(const string &name,
                                    int64_t defaultValue) const {
-  return has(name) ? getInteger(name) : defaultValue;
+  if (!doFind(name)) return defaultValue;
+  int64_t x = selectStmt->column(0).toInteger();
+  selectStmt->reset();
+  return x;
 }
 
 
 double NameValueTable::getDouble(const string &name,
                                  double defaultValue) const {
-  return has(name) ? getDouble(name) : defaultValue;
+  if (!doFind(name)) return defaultValue;
+  double x = selectStmt->column(0).toDouble();
+  selectStmt->reset();
+  return x;
 }
 
 
 bool NameValueTable::getBoolean(const string &name, bool defaultValue) const {
-  return has(name) ? getBoolean(name) : defaultValue;
+  if (!doFind(name)) return defaultValue;
+  bool x = selectStmt->column(0).toBoolean();
+  selectStmt->reset();
+  return x;
 }
 
 
 bool NameValueTable::has(const string &name) const {
-  selectStmt->parameter(0).bind(name);
-  bool hasValue = selectStmt->next();
+  bool hasValue = doFind(name);
   selectStmt->reset();
   return hasValue;
 }
@@ -185,13 +196,17 @@ void NameValueTable::foreach(function<void (const string &,
 }
 
 
-Column NameValueTable::doGet(const string &name) const {
+bool NameValueTable::doFind(const string &name) const {
   selectStmt->parameter(0).bind(name);
+  if (selectStmt->next()) return true;
+  selectStmt->reset();
+  return false;
+}
+
 
-  if (!selectStmt->next()) {
-    selectStmt->reset();
+Column NameValueTable::doGet(const string &name) const {
+  if (!doFind(name))
     THROW("'" << name << "' not found in NameValueTable '" << table << "'");
-  }
 
   return selectStmt->column(0);
 }
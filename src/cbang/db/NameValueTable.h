@@ -107,6 +107,8 @@ namespace cb {
                                        const std::string &value)> cb);
 
     protected:
+      /// Leaves selectStmt on the row if found, otherwise reset
+      bool doFind(const std::string &name) const;
       Column doGet(const std::string &name) const;
       void doSet(const std::string &name);
     };
@@ -42,19 +42,25 @@
 
 #include <sqlite3.h>
 
+#include <cctype>
+
 using namespace std;
 using namespace cb;
 using namespace cb::DB;
 
 
 Statement::Statement(Database &db, const string &sql) :
-  stmt(0), done(false), validRow(false) {
+  stmt(0), done(false), validRow(false), tail(false) {
 
   LOG_DEBUG(5, "SQL: " << sql);
 
-  if (sqlite3_prepare_v2(db.getDB(), sql.c_str(), sql.length(), &stmt, 0))
+  const char *end = 0;
+  if (sqlite3_prepare_v2(db.getDB(), sql.c_str(), sql.length(), &stmt, &end))
     THROW("Failed to prepare statement: " << sql << ": "
            << sqlite3_errmsg(db.getDB()));
+
+  while (end && *end && isspace(*end)) end++;
+  tail = end && *end;
 }
 
 
@@ -68,6 +74,11 @@ Statement::~Statement() {
 
 bool Statement::next() {
   if (done) return false;
+  if (!stmt) { // Empty SQL
+    done = true;
+    return false;
+  }
+
   int code = sqlite3_step(stmt);
   validRow = false;
 
@@ -81,7 +92,8 @@ bool Statement::next() {
     return false;
 
   default:
-    THROW("Failed to advance statement result: " << Database::errorMsg(code));
+    THROW("Failed to advance statement result: "
+          << sqlite3_errmsg(sqlite3_db_handle(stmt)));
   }
 }
 
@@ -50,12 +50,16 @@ namespace cb {
       sqlite3_stmt *stmt;
       bool done;
       bool validRow;
+      bool tail;
 
     public:
       Statement(Database &db, const std::string &sql);
       ~Statement();
 
       bool isDone() const {return done;}
+      /// True if the SQL held more than one statement.  Only the first is
+      /// compiled.
+      bool hasTail() const {return tail;}
       bool next();
       void reset();
       void clearBindings();
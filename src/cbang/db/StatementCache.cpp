@@ -0,0 +1,93 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "StatementCache.h"
+
+#include "Database.h"
+
+using namespace std;
+using namespace cb;
+using namespace cb::DB;
+
+
+StatementCache::StatementCache(Database &db, unsigned capacity) :
+  db(db), capacity(capacity), hits(0), misses(0) {}
+
+
+void StatementCache::setCapacity(unsigned capacity) {
+  this->capacity = capacity;
+  evict();
+}
+
+
+SmartPointer<Statement> StatementCache::get(const string &sql) {
+  index_t::iterator it = index.find(sql);
+
+  if (it != index.end()) {
+    hits++;
+
+    // Move to front
+    entries.splice(entries.begin(), entries, it->second);
+
+    SmartPointer<Statement> stmt = it->second->second;
+    stmt->reset();
+    stmt->clearBindings();
+
+    return stmt;
+  }
+
+  misses++;
+
+  SmartPointer<Statement> stmt = new Statement(db, sql);
+
+  if (capacity && !stmt->hasTail()) {
+    entries.push_front(entry_t(sql, stmt));
+    index[sql] = entries.begin();
+    evict();
+  }
+
+  return stmt;
+}
+
+
+void StatementCache::clear() {
+  index.clear();
+  entries.clear();
+}
+
+
+void StatementCache::evict() {
+  while (capacity < index.size()) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+}
@@ -0,0 +1,86 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Statement.h"
+
+#include <cbang/SmartPointer.h>
+#include <cbang/StdTypes.h>
+
+#include <string>
+#include <list>
+#include <map>
+
+
+namespace cb {
+  namespace DB {
+    class Database;
+
+    /**
+     * A least recently used cache of compiled Statements keyed by their SQL.
+     * Statements returned by get() are reset with their bindings cleared.
+     * A Statement is shared by every caller with the same SQL, so each use
+     * must finish before the next begins.
+     */
+    class StatementCache {
+      Database &db;
+      unsigned capacity;
+
+      typedef std::pair<std::string, SmartPointer<Statement> > entry_t;
+      typedef std::list<entry_t> entries_t;
+      entries_t entries;
+
+      typedef std::map<std::string, entries_t::iterator> index_t;
+      index_t index;
+
+      uint64_t hits;
+      uint64_t misses;
+
+    public:
+      StatementCache(Database &db, unsigned capacity = 64);
+
+      unsigned getCapacity() const {return capacity;}
+      void setCapacity(unsigned capacity);
+      unsigned size() const {return index.size();}
+      uint64_t getHits() const {return hits;}
+      uint64_t getMisses() const {return misses;}
+
+      /// SQL holding more than one statement is compiled but not cached.
+      SmartPointer<Statement> get(const std::string &sql);
+      void clear();
+
+    protected:
+      void evict();
+    };
+  }
+}
@@ -62,6 +62,7 @@ namespace cb {
       typedef std::function<void (state_t)> callback_t;
 
       EventDB(Event::Base &base, st_mysql *db = 0);
+      virtual ~EventDB() {}
 
       unsigned getEventFlags() const;
 
@@ -70,14 +71,14 @@ namespace cb {
       void addEvent(Event::Event &e) const;
 
       void callback(callback_t cb);
-      void connect(callback_t cb,
-                   const std::string &host = "localhost",
-                   const std::string &user = "root",
-                   const std::string &password = std::string(),
-                   const std::string &dbName = std::string(),
-                   unsigned port = 3306,
-                   const std::string &socketName = std::string(),
-                   flags_t flags = FLAG_NONE);
+      virtual void connect(callback_t cb,
+                           const std::string &host = "localhost",
+                           const std::string &user = "root",
+                           const std::string &password = std::string(),
+                           const std::string &dbName = std::string(),
+                           unsigned port = 3306,
+                           const std::string &socketName = std::string(),
+                           flags_t flags = FLAG_NONE);
 
       template <class T>
       void connect(T *obj, typename Callback<T>::member_t member,
@@ -94,8 +95,8 @@ namespace cb {
       }
 
 
-      void query(callback_t cb, const std::string &s,
-                 const SmartPointer<const JSON::Value> &dict = 0);
+      virtual void query(callback_t cb, const std::string &s,
+                         const SmartPointer<const JSON::Value> &dict = 0);
 
       template <class T>
       void query(T *obj, typename Callback<T>::member_t member,
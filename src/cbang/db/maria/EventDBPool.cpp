@@ -0,0 +1,449 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "EventDBPool.h"
+
+#include <cbang/Catch.h>
+#include <cbang/String.h>
+#include <cbang/log/Logger.h>
+#include <cbang/json/Value.h>
+#include <cbang/json/Sink.h>
+#include <cbang/time/Timer.h>
+
+#include <cctype>
+
+using namespace std;
+using namespace cb;
+using namespace cb::MariaDB;
+
+
+EventDBPool::EventDBPool(Event::Base &base, unsigned minConnections,
+                         unsigned maxConnections) :
+  base(base), host("localhost"), user("root"), port(3306),
+  flags(DB::FLAG_DEFAULTS), minConnections(minConnections),
+  maxConnections(maxConnections), checkInterval(30), idleTimeout(300),
+  maxBatch(16), maxBatchLength(16 * 1024), fairness(8), queued(0),
+  nextID(0), skipped(0), backoff(false), current(0), queryCount(0),
+  batchCount(0),
+  dispatchEvent(base.newEvent(this, &EventDBPool::dispatch)),
+  checkEvent(base.newEvent(this, &EventDBPool::healthCheck)) {}
+
+
+EventDBPool::~EventDBPool() {
+  dispatchEvent->del();
+  checkEvent->del();
+}
+
+
+void EventDBPool::setConnection(const string &host, const string &user,
+                                const string &password, const string &dbName,
+                                unsigned port, const string &socketName,
+                                DB::flags_t flags) {
+  this->host = host;
+  this->user = user;
+  this->password = password;
+  this->dbName = dbName;
+  this->port = port;
+  this->socketName = socketName;
+  this->flags = flags;
+}
+
+
+unsigned EventDBPool::getIdleCount() const {
+  unsigned count = 0;
+
+  for (auto it = connections.begin(); it != connections.end(); it++)
+    if ((*it)->state == CONN_IDLE) count++;
+
+  return count;
+}
+
+
+void EventDBPool::start() {
+  dispatch();
+  checkEvent->add(checkInterval);
+}
+
+
+EventDB &EventDBPool::getDB() const {
+  if (!current) THROW("No query callback in progress");
+  return *current;
+}
+
+
+void EventDBPool::query(callback_t cb, const string &s,
+                        const SmartPointer<const JSON::Value> &dict,
+                        int priority) {
+  QueryPtr query = new Query;
+  query->id = nextID++;
+  query->priority = priority;
+  query->sql = s;
+  query->dict = dict;
+  query->cb = cb;
+  query->batchable = s.length() <= maxBatchLength && isSelect(s);
+
+  queues[priority].push_back(query);
+  queued++;
+
+  dispatchEvent->activate();
+}
+
+
+void EventDBPool::query(JSON::Sink &sink, callback_t cb, const string &s,
+                        const SmartPointer<const JSON::Value> &dict,
+                        int priority) {
+  auto write = [this, &sink, cb] (EventDB::state_t state) {
+    switch (state) {
+    case EventDB::EVENTDB_BEGIN_RESULT: sink.beginList(); break;
+
+    case EventDB::EVENTDB_ROW:
+      sink.beginAppend();
+      getDB().writeRowDict(sink);
+      break;
+
+    case EventDB::EVENTDB_END_RESULT: sink.endList(); break;
+    default: break;
+    }
+
+    if (cb) cb(state);
+  };
+
+  query(write, s, dict, priority);
+}
+
+
+bool EventDBPool::isSelect(const string &s) {
+  // A lone SELECT returns exactly one result set.  Any ';', even one
+  // quoted, rules the query out rather than parsing SQL here.
+  if (s.find(';') != string::npos) return false;
+
+  string sql = String::trimLeft(s);
+  return 6 < sql.length() && String::toUpper(sql.substr(0, 6)) == "SELECT" &&
+    isspace(sql[6]);
+}
+
+
+EventDBPool::QueryPtr EventDBPool::peek() const {
+  if (!queued) return 0;
+
+  QueryPtr next = queues.begin()->second.front();
+
+  if (fairness && fairness <= skipped)
+    for (auto it = queues.begin(); it != queues.end(); it++)
+      if (it->second.front()->id < next->id) next = it->second.front();
+
+  return next;
+}
+
+
+void EventDBPool::pop(const QueryPtr &query) {
+  bool oldest = true;
+  for (auto it = queues.begin(); it != queues.end() && oldest; it++)
+    if (it->second.front()->id < query->id) oldest = false;
+
+  if (oldest) skipped = 0;
+  else skipped++;
+
+  auto it = queues.find(query->priority);
+  it->second.pop_front();
+  if (it->second.empty()) queues.erase(it);
+  queued--;
+}
+
+
+void EventDBPool::requeue(const QueryPtr &query) {
+  queues[query->priority].push_front(query);
+  queued++;
+}
+
+
+void EventDBPool::call(const QueryPtr &query, EventDB::state_t state) {
+  try {
+    query->cb(state);
+    return;
+  } CATCH_ERROR;
+
+  if (state != EventDB::EVENTDB_ERROR && state != EventDB::EVENTDB_DONE)
+    TRY_CATCH_ERROR(query->cb(EventDB::EVENTDB_ERROR));
+}
+
+
+SmartPointer<EventDB> EventDBPool::createDB() {return new EventDB(base);}
+
+
+void EventDBPool::open() {
+  ConnectionPtr conn = new Connection(createDB());
+  connections.push_back(conn);
+
+  LOG_DEBUG(4, "Opening DB connection " << connections.size());
+
+  auto cb = [this, conn] (EventDB::state_t state) {connected(conn, state);};
+
+  try {
+    conn->db->enableNonBlocking();
+    conn->db->connect(cb, host, user, password, dbName, port, socketName,
+                      flags);
+
+  } catch (const Exception &e) {
+    LOG_DEBUG(5, e);
+    connected(conn, EventDB::EVENTDB_ERROR);
+  }
+}
+
+
+void EventDBPool::connected(const ConnectionPtr &conn,
+                            EventDB::state_t state) {
+  if (state == EventDB::EVENTDB_DONE) {
+    backoff = false;
+    release(conn);
+    return;
+  }
+
+  LOG_WARNING("Failed to connect to DB: " << conn->db->getError());
+
+  // Wait for the next health check before connecting again
+  backoff = true;
+  failed = conn->db;
+  drop(conn);
+}
+
+
+void EventDBPool::check(const ConnectionPtr &conn) {
+  conn->state = CONN_BUSY;
+
+  auto cb = [this, conn] (EventDB::state_t state) {
+    if (state == EventDB::EVENTDB_DONE) release(conn);
+    else if (state == EventDB::EVENTDB_ERROR) {
+      LOG_WARNING("DB health check failed: " << conn->db->getError());
+      drop(conn);
+    }
+  };
+
+  try {
+    conn->db->query(cb, "DO 1");
+
+  } catch (const Exception &e) {
+    LOG_WARNING("DB health check failed: " << e.getMessage());
+    drop(conn);
+  }
+}
+
+
+void EventDBPool::release(const ConnectionPtr &conn) {
+  conn->state = CONN_IDLE;
+  conn->lastUsed = Timer::now();
+  if (queued) dispatchEvent->activate();
+}
+
+
+void EventDBPool::drop(const ConnectionPtr &conn) {
+  // Lambdas held by the connection's pending events keep it alive
+  connections.remove(conn);
+  dispatchEvent->activate();
+}
+
+
+void EventDBPool::dispatch() {
+  // Callbacks may drop connections so work from a copy
+  vector<ConnectionPtr> idle;
+  for (auto it = connections.begin(); it != connections.end(); it++)
+    if ((*it)->state == CONN_IDLE) idle.push_back(*it);
+
+  for (unsigned i = 0; queued && i < idle.size(); i++) {
+    const ConnectionPtr &conn = idle[i];
+
+    BatchPtr batch = new Batch;
+    QueryPtr query = peek();
+    pop(query);
+    batch->queries.push_back(query);
+
+    if (query->batchable && (flags & DB::FLAG_MULTI_STATEMENTS)) {
+      unsigned length = query->sql.length();
+
+      while (batch->queries.size() < maxBatch && queued) {
+        query = peek();
+        if (!query->batchable ||
+            maxBatchLength < length + query->sql.length()) break;
+
+        pop(query);
+        batch->queries.push_back(query);
+        length += query->sql.length();
+      }
+    }
+
+    run(conn, batch);
+  }
+
+  if (backoff) {
+    // Nothing can run until the DB is reachable again
+    if (connections.empty() && queued) {
+      LOG_WARNING("DB unavailable, failing " << queued << " queries");
+
+      current = failed.get();
+      while (queued) {
+        QueryPtr query = peek();
+        pop(query);
+        call(query, EventDB::EVENTDB_ERROR);
+      }
+      current = 0;
+    }
+
+    return;
+  }
+
+  // Grow to cover waiting queries, without exceeding the maximum
+  unsigned connecting = 0;
+  for (auto it = connections.begin(); it != connections.end(); it++)
+    if ((*it)->state == CONN_CONNECTING) connecting++;
+
+  while (connections.size() < maxConnections &&
+         (connections.size() < minConnections || connecting < queued)) {
+    connecting++;
+    open();
+    if (backoff) break;
+  }
+}
+
+
+void EventDBPool::run(const ConnectionPtr &conn, const BatchPtr &batch) {
+  conn->state = CONN_BUSY;
+  queryCount += batch->queries.size();
+  batchCount++;
+
+  auto cb = [this, conn, batch] (EventDB::state_t state) {
+    complete(conn, batch, state);
+  };
+
+  try {
+    string sql;
+    auto &queries = batch->queries;
+
+    for (unsigned i = 0; i < queries.size(); i++) {
+      if (i) sql += ";\n";
+      if (queries[i]->dict.isNull()) sql += queries[i]->sql;
+      else sql += conn->db->format(queries[i]->sql, queries[i]->dict->getDict());
+    }
+
+    conn->db->query(cb, sql);
+
+  } catch (const Exception &e) {
+    LOG_DEBUG(5, e);
+    complete(conn, batch, EventDB::EVENTDB_ERROR);
+  }
+}
+
+
+void EventDBPool::complete(const ConnectionPtr &conn, const BatchPtr &batch,
+                           EventDB::state_t state) {
+  auto &queries = batch->queries;
+  bool merged = 1 < queries.size();
+  unsigned index = merged ? batch->results : 0;
+  QueryPtr query;
+  if (index < queries.size()) query = queries[index];
+
+  current = conn->db.get();
+
+  switch (state) {
+  case EventDB::EVENTDB_RETRY:
+    // The whole statement is run again, skip what was already reported
+    batch->seen = 0;
+    break;
+
+  case EventDB::EVENTDB_BEGIN_RESULT:
+  case EventDB::EVENTDB_ROW:
+  case EventDB::EVENTDB_END_RESULT: {
+    bool replay = batch->seen < batch->results;
+
+    if (state == EventDB::EVENTDB_END_RESULT) {
+      batch->seen++;
+      if (!replay) batch->results++;
+    }
+
+    if (replay || query.isNull()) break;
+
+    call(query, state);
+    if (merged && state == EventDB::EVENTDB_END_RESULT)
+      call(query, EventDB::EVENTDB_DONE);
+    break;
+  }
+
+  case EventDB::EVENTDB_ERROR: {
+    unsigned next = index + 1;
+
+    // A retry which fails while replaying never reached this query
+    if (merged && batch->seen < batch->results) next = index;
+    else if (query.isSet()) call(query, EventDB::EVENTDB_ERROR);
+
+    // Queries after the failed one never ran
+    for (unsigned i = queries.size(); next < i; i--)
+      requeue(queries[i - 1]);
+
+    current = 0;
+    check(conn);
+    return;
+  }
+
+  case EventDB::EVENTDB_DONE:
+    for (unsigned i = index; i < queries.size(); i++)
+      call(queries[i], EventDB::EVENTDB_DONE);
+
+    current = 0;
+    release(conn);
+    return;
+  }
+
+  current = 0;
+}
+
+
+void EventDBPool::healthCheck() {
+  double now = Timer::now();
+  vector<ConnectionPtr> idle;
+
+  for (auto it = connections.begin(); it != connections.end(); it++)
+    if ((*it)->state == CONN_IDLE) idle.push_back(*it);
+
+  for (unsigned i = 0; i < idle.size(); i++) {
+    const ConnectionPtr &conn = idle[i];
+
+    if (minConnections < connections.size() &&
+        conn->lastUsed + idleTimeout <= now) {
+      LOG_DEBUG(4, "Closing idle DB connection");
+      drop(conn);
+
+    } else if (conn->lastUsed + checkInterval <= now) check(conn);
+  }
+
+  backoff = false;
+  dispatch();
+  checkEvent->add(checkInterval);
+}
@@ -0,0 +1,226 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "EventDB.h"
+
+#include <cbang/event/Event.h>
+
+#include <cbang/SmartPointer.h>
+#include <cbang/json/Value.h>
+#include <cbang/StdTypes.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <functional>
+
+
+namespace cb {
+  namespace JSON {class Sink;}
+
+  namespace MariaDB {
+    /**
+     * Shares a set of EventDB connections between many concurrent queries.
+     * Between the minimum and maximum number of connections are kept open.
+     * Idle connections are pinged every health check interval, broken ones
+     * are replaced and connections beyond the minimum are closed once they
+     * have been idle for the idle timeout.
+     *
+     * Queries wait in one FIFO per priority and higher priorities run
+     * first.  So that a busy high priority cannot starve the rest, after
+     * fairness queries have jumped ahead of the oldest waiting query it
+     * runs next.  When a connection becomes free, consecutive waiting
+     * SELECTs are sent to it as one multi-statement round trip and their
+     * result sets are handed back to each query in turn.
+     *
+     * Callbacks see the same states as EventDB::query() except
+     * EVENTDB_RETRY.  A retried deadlock does not repeat result sets which
+     * were already reported.  getDB() is the connection running the query
+     * and is only valid during a callback.  The pool must outlive its
+     * queries.
+     */
+    class EventDBPool {
+    public:
+      typedef EventDB::callback_t callback_t;
+
+    protected:
+      Event::Base &base;
+
+      std::string host;
+      std::string user;
+      std::string password;
+      std::string dbName;
+      unsigned port;
+      std::string socketName;
+      DB::flags_t flags;
+
+      unsigned minConnections;
+      unsigned maxConnections;
+      double checkInterval;
+      double idleTimeout;
+      unsigned maxBatch;
+      unsigned maxBatchLength;
+      unsigned fairness;
+
+      struct Query {
+        uint64_t id;
+        int priority;
+        std::string sql;
+        SmartPointer<const JSON::Value> dict;
+        callback_t cb;
+        bool batchable;
+      };
+      typedef SmartPointer<Query> QueryPtr;
+
+      struct Batch {
+        std::vector<QueryPtr> queries;
+        unsigned results; // Result sets reported
+        unsigned seen;    // Result sets seen since the last (re)try
+        Batch() : results(0), seen(0) {}
+      };
+      typedef SmartPointer<Batch> BatchPtr;
+
+      typedef enum {
+        CONN_CONNECTING,
+        CONN_IDLE,
+        CONN_BUSY,
+      } conn_state_t;
+
+      struct Connection {
+        SmartPointer<EventDB> db;
+        conn_state_t state;
+        double lastUsed;
+        Connection(const SmartPointer<EventDB> &db) :
+          db(db), state(CONN_CONNECTING), lastUsed(0) {}
+      };
+      typedef SmartPointer<Connection> ConnectionPtr;
+
+      std::list<ConnectionPtr> connections;
+      std::map<int, std::list<QueryPtr>, std::greater<int> > queues;
+      unsigned queued;
+      uint64_t nextID;
+      unsigned skipped;
+      bool backoff;
+      SmartPointer<EventDB> failed;
+      EventDB *current;
+
+      uint64_t queryCount;
+      uint64_t batchCount;
+
+      Event::EventPtr dispatchEvent;
+      Event::EventPtr checkEvent;
+
+    public:
+      EventDBPool(Event::Base &base, unsigned minConnections = 1,
+                  unsigned maxConnections = 8);
+      virtual ~EventDBPool();
+
+      void setConnection(const std::string &host = "localhost",
+                         const std::string &user = "root",
+                         const std::string &password = std::string(),
+                         const std::string &dbName = std::string(),
+                         unsigned port = 3306,
+                         const std::string &socketName = std::string(),
+                         DB::flags_t flags = DB::FLAG_DEFAULTS);
+
+      unsigned getMinConnections() const {return minConnections;}
+      void setMinConnections(unsigned x) {minConnections = x;}
+      unsigned getMaxConnections() const {return maxConnections;}
+      void setMaxConnections(unsigned x) {maxConnections = x;}
+      double getCheckInterval() const {return checkInterval;}
+      void setCheckInterval(double x) {checkInterval = x;}
+      double getIdleTimeout() const {return idleTimeout;}
+      void setIdleTimeout(double x) {idleTimeout = x;}
+      unsigned getMaxBatch() const {return maxBatch;}
+      void setMaxBatch(unsigned x) {maxBatch = x;}
+      unsigned getMaxBatchLength() const {return maxBatchLength;}
+      void setMaxBatchLength(unsigned x) {maxBatchLength = x;}
+      unsigned getFairness() const {return fairness;}
+      void setFairness(unsigned x) {fairness = x;}
+
+      unsigned getConnectionCount() const {return connections.size();}
+      unsigned getIdleCount() const;
+      unsigned getQueuedCount() const {return queued;}
+      uint64_t getQueryCount() const {return queryCount;}
+      uint64_t getBatchCount() const {return batchCount;}
+
+      /// Open the minimum connections and start health checks.
+      void start();
+
+      EventDB &getDB() const;
+
+      void query(callback_t cb, const std::string &s,
+                 const SmartPointer<const JSON::Value> &dict = 0,
+                 int priority = 0);
+
+      template <class T>
+      void query(T *obj, typename EventDB::Callback<T>::member_t member,
+                 const std::string &s,
+                 const SmartPointer<const JSON::Value> &dict = 0,
+                 int priority = 0) {
+        using namespace std::placeholders;
+        query(std::bind(member, obj, _1), s, dict, priority);
+      }
+
+      /// Write each result set to @param sink as a list of row dicts.
+      void query(JSON::Sink &sink, callback_t cb, const std::string &s,
+                 const SmartPointer<const JSON::Value> &dict = 0,
+                 int priority = 0);
+
+      static bool isSelect(const std::string &s);
+
+    protected:
+      /// Create an unconnected EventDB for a new connection
+      virtual SmartPointer<EventDB> createDB();
+
+      QueryPtr peek() const;
+      void pop(const QueryPtr &query);
+      void requeue(const QueryPtr &query);
+      void call(const QueryPtr &query, EventDB::state_t state);
+
+      void open();
+      void connected(const ConnectionPtr &conn, EventDB::state_t state);
+      void check(const ConnectionPtr &conn);
+      void release(const ConnectionPtr &conn);
+      void drop(const ConnectionPtr &conn);
+
+      void dispatch();
+      void run(const ConnectionPtr &conn, const BatchPtr &batch);
+      void complete(const ConnectionPtr &conn, const BatchPtr &batch,
+                    EventDB::state_t state);
+      void healthCheck();
+    };
+  }
+}
@@ -79,110 +79,125 @@ bool BacktraceDebugger::supported() {
 }
 
 
-bool BacktraceDebugger::getStackTrace(StackTrace &trace) {
-  init(); // Might set enabled false
+bool BacktraceDebugger::captureStackTrace(StackTrace &trace) {
   if (!enabled) return false;
 
-  void *stack[maxStack];
-  int n = backtrace(stack, maxStack);
-  SmartPointer<char *>::Malloc symbols = backtrace_symbols(stack, n);
+  vector<void *> &addrs = trace.getAddresses();
+  addrs.resize(maxStack);
+  int n = backtrace(&addrs[0], maxStack);
+  addrs.resize(0 < n ? n : 0);
 
 #ifdef VALGRIND_MAKE_MEM_DEFINED
-  (void)VALGRIND_MAKE_MEM_DEFINED(stack, n * sizeof(void *));
+  if (n) (void)VALGRIND_MAKE_MEM_DEFINED(&addrs[0], n * sizeof(void *));
 #endif // VALGRIND_MAKE_MEM_DEFINED
 
-  SmartLock lock(this);
+  return true;
+}
 
-  for (int i = 0; i < n; i++) {
-    bfd_vma pc = (bfd_vma)stack[i];
 
-    const char *filename = 0;
-    const char *function = 0;
-    unsigned line = 0;
+void BacktraceDebugger::resolveAddresses(const vector<void *> &addrs,
+                                         StackTrace &trace) {
+  init(); // Might set enabled false
+  if (!enabled) return;
 
-    // Find section
-    asection *section = 0;
-    for (asection *s = p->abfd->sections; s; s = s->next) {
-      if ((bfd_get_section_flags(p->abfd, s) & SEC_CODE) == 0)
-        continue;
+  for (unsigned i = 0; i < addrs.size(); i++)
+    trace.push_back(lookup(addrs[i]));
+}
 
-      bfd_vma vma = bfd_get_section_vma(p->abfd, s);
-      if (pc < vma) {
-        section = s->prev;
-        break;
-      }
+
+const StackFrame &BacktraceDebugger::lookup(void *addr) {
+  cache_t::iterator it = cache.find(addr);
+  if (it != cache.end()) return it->second;
+
+  bfd_vma pc = (bfd_vma)addr;
+
+  const char *filename = 0;
+  const char *function = 0;
+  unsigned line = 0;
+
+  // Find section
+  asection *section = 0;
+  for (asection *s = p->abfd->sections; s; s = s->next) {
+    if ((bfd_get_section_flags(p->abfd, s) & SEC_CODE) == 0)
+      continue;
+
+    bfd_vma vma = bfd_get_section_vma(p->abfd, s);
+    if (pc < vma) {
+      section = s->prev;
+      break;
     }
+  }
 
-    if (section) {
-      bfd_vma vma = bfd_get_section_vma(p->abfd, section);
-      bfd_find_nearest_line(p->abfd, section, p->syms, pc - vma,
-                            &filename, &function, &line);
+  if (section) {
+    bfd_vma vma = bfd_get_section_vma(p->abfd, section);
+    bfd_find_nearest_line(p->abfd, section, p->syms, pc - vma,
+                          &filename, &function, &line);
 
 #ifdef VALGRIND_MAKE_MEM_DEFINED
-      if (filename) (void)VALGRIND_MAKE_MEM_DEFINED(filename, strlen(filename));
-      if (function) (void)VALGRIND_MAKE_MEM_DEFINED(function, strlen(function));
-      (void)VALGRIND_MAKE_MEM_DEFINED(&line, sizeof(line));
+    if (filename) (void)VALGRIND_MAKE_MEM_DEFINED(filename, strlen(filename));
+    if (function) (void)VALGRIND_MAKE_MEM_DEFINED(function, strlen(function));
+    (void)VALGRIND_MAKE_MEM_DEFINED(&line, sizeof(line));
 #endif // VALGRIND_MAKE_MEM_DEFINED
-    }
+  }
 
-    // Fallback to backtrace symbols
-    if ((!function || !filename) && symbols.get()) {
-      char *sym = symbols[i];
-
-      // Parse symbol string
-      // Expected format: <module>(<function>+0x<offset>)
-      char *ptr = sym;
-      while (*ptr && *ptr != '(') ptr++;
-      if (*ptr == '(') {
-        *ptr++ = 0;
-        if (!filename) filename = sym; // Not really the source file
-
-        if (!function) {
-          function = ptr;
-          while (*ptr && *ptr != '+') ptr++;
-
-          if (*ptr) {
-            *ptr++ = 0;
-            char *offset = ptr;
-            while (*ptr && *ptr != ')') ptr++;
-            if (*ptr == ')') *ptr = 0;
-
-            int save_errno = errno;
-            errno = 0;
-            line = strtol(offset, 0, 0); // Byte offset not line number
-            if (errno) line = 0;
-            errno = save_errno;
-          }
+  // Fallback to backtrace symbols
+  SmartPointer<char *>::Malloc symbols;
+  if (!function || !filename) symbols = backtrace_symbols(&addr, 1);
+
+  if ((!function || !filename) && symbols.get()) {
+    char *sym = symbols[0];
+
+    // Parse symbol string
+    // Expected format: <module>(<function>+0x<offset>)
+    char *ptr = sym;
+    while (*ptr && *ptr != '(') ptr++;
+    if (*ptr == '(') {
+      *ptr++ = 0;
+      if (!filename) filename = sym; // Not really the source file
+
+      if (!function) {
+        function = ptr;
+        while (*ptr && *ptr != '+') ptr++;
+
+        if (*ptr) {
+          *ptr++ = 0;
+          char *offset = ptr;
+          while (*ptr && *ptr != ')') ptr++;
+          if (*ptr == ')') *ptr = 0;
+
+          int save_errno = errno;
+          errno = 0;
+          line = strtol(offset, 0, 0); // Byte offset not line number
+          if (errno) line = 0;
+          errno = save_errno;
         }
       }
     }
+  }
 
-    // Filename
-    if (!filename) filename = "";
-    else if (0 <= parents) {
-      const char *ptr = filename + strlen(filename);
-      for (int j = 0; j <= parents; j++)
-        while (filename < ptr && *--ptr != '/') continue;
-
-      if (*ptr == '/') filename = ptr + 1;
-    }
-
-    // Function name
-    char *demangled = 0;
-    if (!function) function = "";
-    else {
-      int status = 0;
-      demangled = abi::__cxa_demangle(function, 0, 0, &status);
-      if (!status && demangled) function = demangled;
-    }
+  // Filename
+  if (!filename) filename = "";
+  else if (0 <= parents) {
+    const char *ptr = filename + strlen(filename);
+    for (int j = 0; j <= parents; j++)
+      while (filename < ptr && *--ptr != '/') continue;
 
-    trace.push_back(StackFrame(stack[i], FileLocation(filename, line),
-                               function));
+    if (*ptr == '/') filename = ptr + 1;
+  }
 
-    if (demangled) free(demangled);
+  // Function name
+  char *demangled = 0;
+  if (!function) function = "";
+  else {
+    int status = 0;
+    demangled = abi::__cxa_demangle(function, 0, 0, &status);
+    if (!status && demangled) function = demangled;
   }
 
-  return true;
+  StackFrame frame(addr, FileLocation(filename, line), function);
+  if (demangled) free(demangled);
+
+  return cache.insert(cache_t::value_type(addr, frame)).first->second;
 }
 
 
@@ -35,6 +35,7 @@
 #include "Debugger.h"
 
 #include <string>
+#include <map>
 
 namespace cb {
   class BacktraceDebugger : public Debugger {
@@ -45,6 +46,9 @@ namespace cb {
     bool initialized;
     bool enabled;
 
+    typedef std::map<void *, StackFrame> cache_t;
+    cache_t cache; // Process wide PC -> symbol cache
+
   public:
     int parents;
 
@@ -52,9 +56,14 @@ namespace cb {
     ~BacktraceDebugger();
 
     static bool supported();
-    bool getStackTrace(StackTrace &trace);
+
+    // From Debugger
+    bool captureStackTrace(StackTrace &trace);
 
   protected:
+    void resolveAddresses(const std::vector<void *> &addrs, StackTrace &trace);
+    const StackFrame &lookup(void *addr);
+
     void init();
     void release();
   };
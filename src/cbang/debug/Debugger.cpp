@@ -50,24 +50,30 @@ using namespace std;
 using namespace cb;
 
 Mutex Debugger::lock;
-Debugger *Debugger::singleton = 0;
+atomic<Debugger *> Debugger::singleton(0);
 
 
 Debugger &Debugger::instance() {
+  // Acquire pairs with the release below so the object is fully built
+  Debugger *debugger = singleton.load(memory_order_acquire);
+  if (debugger) return *debugger;
+
   SmartLock l(&lock);
 
-  if (!singleton) {
-    if (getenv("DISABLE_DEBUGGER")) singleton = new Debugger(); // Null debugger
+  debugger = singleton.load(memory_order_relaxed);
+  if (!debugger) {
+    if (getenv("DISABLE_DEBUGGER")) debugger = new Debugger(); // Null debugger
 #ifdef HAVE_CBANG_BACKTRACE
     else if (BacktraceDebugger::supported())
-      singleton = new BacktraceDebugger();
+      debugger = new BacktraceDebugger();
 #endif // HAVE_CBANG_BACKTRACE
-    else singleton = new Debugger(); // Null debugger
+    else debugger = new Debugger(); // Null debugger
 
-    SingletonDealloc::instance().add(singleton);
+    SingletonDealloc::instance().add(debugger);
+    singleton.store(debugger, memory_order_release);
   }
 
-  return *singleton;
+  return *debugger;
 }
 
 
@@ -97,6 +103,24 @@ StackTrace Debugger::getStackTrace() {
 }
 
 
+bool Debugger::getStackTrace(StackTrace &trace) {
+  if (!captureStackTrace(trace)) return false;
+  resolve(trace);
+  return true;
+}
+
+
+void Debugger::resolve(StackTrace &trace) {
+  SmartLock l(this);
+
+  if (trace.isResolved()) return;
+
+  vector<void *> addrs;
+  addrs.swap(trace.getAddresses());
+  resolveAddresses(addrs, trace);
+}
+
+
 string Debugger::getExecutableName() {
 #ifndef _WIN32
   char path[4096];
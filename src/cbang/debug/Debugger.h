@@ -33,6 +33,7 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
 
 #include "StackTrace.h"
 
@@ -51,7 +52,7 @@ namespace cb {
 
   protected:
     static Mutex lock;
-    static Debugger *singleton;
+    static std::atomic<Debugger *> singleton;
 
     Debugger() : maxStack(256) {}
 
@@ -62,6 +63,21 @@ namespace cb {
 
     static std::string getExecutableName();
 
-    virtual bool getStackTrace(StackTrace &trace) {return 0;}
+    /// Capture and resolve a stack trace
+    virtual bool getStackTrace(StackTrace &trace);
+
+    /**
+     * Record only the raw program counters of the current stack.  This does
+     * not lock or touch symbol tables so it is cheap enough to call on every
+     * throw.  The frames are filled in later by resolve().
+     */
+    virtual bool captureStackTrace(StackTrace &trace) {return false;}
+
+    /// Symbolize any unresolved addresses in @param trace.  Thread safe.
+    void resolve(StackTrace &trace);
+
+  protected:
+    virtual void resolveAddresses(const std::vector<void *> &addrs,
+                                  StackTrace &trace) {}
   };
 }
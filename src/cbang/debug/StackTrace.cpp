@@ -39,7 +39,16 @@ using namespace cb;
 using namespace std;
 
 
+void StackTrace::resolve() {Debugger::instance().resolve(*this);}
+
+
 ostream &StackTrace::print(ostream &stream) const {
+  if (!isResolved()) {
+    StackTrace copy(*this);
+    copy.resolve();
+    return copy.print(stream);
+  }
+
   unsigned count = 0;
   const_iterator it;
   for (it = begin(); it != end(); it++)
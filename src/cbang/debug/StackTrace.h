@@ -39,8 +39,20 @@
 
 
 namespace cb {
+  /**
+   * A stack trace is captured as raw program counters and only symbolized
+   * when the frames are first needed.  Call resolve() before iterating over
+   * the frames of a trace filled by Debugger::captureStackTrace().
+   */
   class StackTrace : public std::vector<StackFrame> {
+    std::vector<void *> addresses; // Unresolved program counters
+
   public:
+    const std::vector<void *> &getAddresses() const {return addresses;}
+    std::vector<void *> &getAddresses() {return addresses;}
+    bool isResolved() const {return addresses.empty();}
+    void resolve();
+
     std::ostream &print(std::ostream &stream) const;
     static StackTrace get();
   };
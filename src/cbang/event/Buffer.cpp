@@ -35,8 +35,14 @@
 #include <cbang/Exception.h>
 #include <cbang/String.h>
 
+#ifdef HAVE_OPENSSL
+#include <cbang/openssl/Digest.h>
+#endif
+
 #include <event2/buffer.h>
 
+#include <vector>
+
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -44,6 +50,8 @@
 
 #ifdef _WIN32
 #include <io.h>
+#else
+#include <unistd.h>
 #endif
 
 using namespace std;
@@ -150,6 +158,31 @@ void Buffer::drain(unsigned length) {
 }
 
 
+#ifdef HAVE_OPENSSL
+void Buffer::digest(Digest &digest) const {
+  int n = evbuffer_peek(evb, -1, 0, 0, 0);
+  if (n <= 0) {
+    digest.update(0, 0); // Starts the digest, as for ""
+    return;
+  }
+
+  evbuffer_iovec small[16];
+  vector<evbuffer_iovec> large;
+  evbuffer_iovec *vecs = small;
+
+  if (16 < n) {
+    large.resize(n);
+    vecs = &large[0];
+  }
+
+  n = evbuffer_peek(evb, -1, 0, vecs, n);
+
+  for (int i = 0; i < n; i++)
+    digest.update((const uint8_t *)vecs[i].iov_base, vecs[i].iov_len);
+}
+#endif // HAVE_OPENSSL
+
+
 unsigned Buffer::remove(char *data, unsigned length) {
   ev_ssize_t ret = evbuffer_remove(evb, data, length);
   if (ret < 0) THROW("Failed to remove data from buffer");
@@ -207,6 +240,17 @@ void Buffer::addFile(const string &path) {
 }
 
 
+void Buffer::addFile(const string &path, uint64_t offset, uint64_t length) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) THROW("Failed to open file " << path);
+
+  if (evbuffer_add_file(evb, fd, offset, length)) {
+    ::close(fd);
+    THROW("Failed to add file to buffer: " << path);
+  }
+}
+
+
 void Buffer::prepend(const Buffer &buf) {
   if (evbuffer_prepend_buffer(evb, buf.getBuffer()))
     THROW("Prepend buffer failed");
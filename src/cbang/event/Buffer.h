@@ -35,10 +35,14 @@
 #include <string>
 #include <ostream>
 
+#include <stdint.h>
+
 struct evbuffer;
 
 
 namespace cb {
+  class Digest;
+
   namespace Event {
     class Buffer {
       evbuffer *evb;
@@ -70,6 +74,8 @@ namespace cb {
       unsigned copy(std::ostream &stream, unsigned length);
       unsigned copy(std::ostream &stream);
       void drain(unsigned length);
+      /// Hashes the chain in place, without copying or draining it
+      void digest(Digest &digest) const;
       unsigned remove(char *data, unsigned length);
       unsigned remove(std::ostream &stream, unsigned length);
       unsigned remove(std::ostream &stream);
@@ -80,6 +86,7 @@ namespace cb {
       void add(const char *s);
       void add(const std::string &s);
       void addFile(const std::string &path);
+      void addFile(const std::string &path, uint64_t offset, uint64_t length);
 
       void prepend(const Buffer &buf);
       void prepend(const char *data, unsigned length);
@@ -73,6 +73,8 @@ BufferEvent::BufferEvent(cb::Event::Base &base,
       SSL_set_tlsext_host_name(ssl, host.c_str());
 #endif
 
+    sslCtx->resumeSession(ssl, host);
+
     bev = bufferevent_openssl_socket_new
       (base.getBase(), -1, ssl, BUFFEREVENT_SSL_CONNECTING,
        BEV_OPT_CLOSE_ON_FREE | BEV_OPT_DEFER_CALLBACKS);
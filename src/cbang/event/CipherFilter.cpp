@@ -0,0 +1,137 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "CipherFilter.h"
+
+#include <cbang/Exception.h>
+#include <cbang/openssl/Cipher.h>
+
+#include <event2/buffer.h>
+
+#include <vector>
+
+using namespace std;
+using namespace cb;
+using namespace cb::Event;
+
+
+CipherFilter::CipherFilter(const SmartPointer<Cipher> &cipher) :
+  cipher(cipher), tagLength(cipher->getTagLength()) {}
+
+
+void CipherFilter::filter(Buffer &buf) {
+  if (tagLength && !cipher->isEncrypt()) {
+    // Hold back what may be the tag
+    buf.prepend(tail);
+
+    unsigned length = buf.getLength();
+    if (length <= tagLength) {
+      tail.add(buf);
+      return;
+    }
+
+    Buffer body;
+    evbuffer_remove_buffer(buf.getBuffer(), body.getBuffer(),
+                           length - tagLength);
+    tail.add(buf);
+    transform(body);
+    buf.add(body);
+
+  } else transform(buf);
+}
+
+
+void CipherFilter::finish(Buffer &buf) {
+  if (tagLength && !cipher->isEncrypt()) {
+    if (tail.getLength() != tagLength)
+      THROW("Cipher stream too short for authentication tag");
+
+    cipher->setTag(tail.pullup(), tagLength);
+    tail.clear();
+  }
+
+  char block[32]; // EVP_MAX_BLOCK_LENGTH
+  buf.add(block, cipher->final(block, sizeof(block)));
+
+  if (tagLength && cipher->isEncrypt()) {
+    char tag[16]; // The longest AEAD tag
+    if (sizeof(tag) < tagLength) THROW("Tag too long");
+    cipher->getTag(tag, tagLength);
+    buf.add(tag, tagLength);
+  }
+}
+
+
+void CipherFilter::transform(Buffer &buf) {
+  evbuffer *evb = buf.getBuffer();
+
+  int n = evbuffer_peek(evb, -1, 0, 0, 0);
+  if (n <= 0) return;
+
+  evbuffer_iovec small[16];
+  vector<evbuffer_iovec> large;
+  evbuffer_iovec *vecs = small;
+
+  if (16 < n) {
+    large.resize(n);
+    vecs = &large[0];
+  }
+
+  n = evbuffer_peek(evb, -1, 0, vecs, n);
+
+  if (cipher->getBlockSize() == 1) {
+    for (int i = 0; i < n; i++)
+      cipher->update(vecs[i].iov_base, vecs[i].iov_len, vecs[i].iov_base,
+                     vecs[i].iov_len);
+    return;
+  }
+
+  // Block modes buffer partial blocks so cannot work in place
+  Buffer out;
+  unsigned blockSize = cipher->getBlockSize();
+
+  for (int i = 0; i < n; i++) {
+    evbuffer_iovec space;
+    if (evbuffer_reserve_space(out.getBuffer(), vecs[i].iov_len + blockSize,
+                               &space, 1) != 1)
+      THROW("Failed to reserve buffer space");
+
+    space.iov_len = cipher->update(space.iov_base, space.iov_len,
+                                   vecs[i].iov_base, vecs[i].iov_len);
+
+    if (evbuffer_commit_space(out.getBuffer(), &space, 1))
+      THROW("Failed to commit buffer space");
+  }
+
+  buf.clear();
+  buf.add(out);
+}
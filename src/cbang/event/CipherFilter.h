@@ -0,0 +1,74 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Buffer.h"
+
+#include <cbang/SmartPointer.h>
+
+
+namespace cb {
+  class Cipher;
+
+  namespace Event {
+    /**
+     * Encrypts or decrypts a stream of Buffers segment by segment.  When
+     * the cipher's block size is one, e.g. CTR, GCM or ChaCha20, segments
+     * are transformed in place, otherwise into newly reserved buffer space.
+     * Since buffer memory is overwritten, filtered buffers must not hold
+     * references to other buffers' memory or file segments.
+     *
+     * With AEAD ciphers the tag follows the ciphertext.  When encrypting
+     * finish() appends it.  When decrypting the last tag length bytes seen
+     * are held back and finish() verifies them.
+     */
+    class CipherFilter {
+      SmartPointer<Cipher> cipher;
+      unsigned tagLength;
+      Buffer tail;
+
+    public:
+      CipherFilter(const SmartPointer<Cipher> &cipher);
+
+      const SmartPointer<Cipher> &getCipher() const {return cipher;}
+
+      /// Replace the contents of @param buf with its encryption/decryption
+      void filter(Buffer &buf);
+      /// Append the remaining output to @param buf
+      void finish(Buffer &buf);
+
+    protected:
+      void transform(Buffer &buf);
+    };
+  }
+}
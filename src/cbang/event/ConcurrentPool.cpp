@@ -44,8 +44,9 @@ bool ConcurrentPool::Task::shouldShutdown() {
 }
 
 
-ConcurrentPool::ConcurrentPool(Base &base, unsigned size) :
-  ThreadPool(size), base(base),
+ConcurrentPool::ConcurrentPool(Base &base, unsigned size,
+                               ThreadPlacement placement) :
+  ThreadPool(size, placement), base(base),
   event(base.newEvent(this, &ConcurrentPool::complete)) {
   if (!Base::threadsEnabled())
     THROW("Cannot use Event::ConcurrentPool without threads enabled.  "
@@ -161,7 +161,8 @@ namespace cb {
       queue_t completed;
 
     public:
-      ConcurrentPool(Base &base, unsigned size);
+      ConcurrentPool(Base &base, unsigned size, ThreadPlacement placement =
+                     ThreadPlacement::PLACEMENT_NONE);
       ~ConcurrentPool();
 
       void submit(const SmartPointer<Task> &task);
@@ -177,6 +178,8 @@ namespace cb {
 
       // From ThreadPool
       using ThreadPool::start;
+      using ThreadPool::setPlacement;
+      using ThreadPool::getPlacement;
       void stop();
       void join();
 
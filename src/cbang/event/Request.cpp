@@ -43,6 +43,7 @@
 #include <cbang/log/Logger.h>
 #include <cbang/http/Cookie.h>
 #include <cbang/json/JSON.h>
+#include <cbang/iostream/ParallelCompressor.h>
 #include <cbang/time/Time.h>
 
 #include <event2/http.h>
@@ -70,16 +71,33 @@ namespace {
 
 
   SmartPointer<ostream> compressBufferStream
-  (Event::Buffer buffer, Request::compression_t compression) {
+  (Event::Buffer buffer, Request::compression_t compression,
+   unsigned threads) {
     SmartPointer<ostream> target = new Event::BufferStream<>(buffer);
     SmartPointer<FilteringOStreamWithRef> out = new FilteringOStreamWithRef;
 
-    switch (compression) {
-    case Request::COMPRESS_ZLIB:  out->push(io::zlib_compressor()); break;
-    case Request::COMPRESS_GZIP:  out->push(io::gzip_compressor()); break;
-    case Request::COMPRESS_BZIP2: out->push(io::bzip2_compressor()); break;
-    default: return target;
-    }
+    if (threads != 1) {
+      ParallelCompressor::format_t format;
+
+      switch (compression) {
+      case Request::COMPRESS_ZLIB:
+        format = ParallelCompressor::PARALLEL_ZLIB; break;
+      case Request::COMPRESS_GZIP:
+        format = ParallelCompressor::PARALLEL_GZIP; break;
+      case Request::COMPRESS_BZIP2:
+        format = ParallelCompressor::PARALLEL_BZIP2; break;
+      default: return target;
+      }
+
+      out->push(ParallelCompressor(format, threads));
+
+    } else
+      switch (compression) {
+      case Request::COMPRESS_ZLIB:  out->push(io::zlib_compressor()); break;
+      case Request::COMPRESS_GZIP:  out->push(io::gzip_compressor()); break;
+      case Request::COMPRESS_BZIP2: out->push(io::bzip2_compressor()); break;
+      default: return target;
+      }
 
     out->ref = target;
     out->push(*target);
@@ -104,7 +122,9 @@ namespace {
 
     JSONWriter(Request &req, unsigned indent, bool compact,
                Request::compression_t compression) :
-      SmartPointer<ostream>(compressBufferStream(*this, compression)),
+      SmartPointer<ostream>(compressBufferStream
+                            (*this, compression,
+                             req.getCompressionThreads())),
       JSON::Writer(*SmartPointer<ostream>::get(), indent, compact), req(req) {
       req.outSetContentEncoding(compression);
     }
@@ -126,7 +146,7 @@ namespace {
 
 Request::Request(evhttp_request *req, bool deallocate) :
   req(req), deallocate(deallocate), id(0), user("anonymous"), incoming(false),
-  finalized(false) {
+  finalized(false), compressionThreads(1) {
   if (!req) THROW("Event request cannot be null");
   init();
 
@@ -150,7 +170,8 @@ Request::Request(evhttp_request *req, bool deallocate) :
 
 Request::Request(evhttp_request *req, const URI &uri, bool deallocate) :
   req(req), deallocate(deallocate), originalURI(uri), uri(uri),
-  clientIP(uri.getHost(), uri.getPort()), incoming(false), finalized(false) {
+  clientIP(uri.getHost(), uri.getPort()), incoming(false), finalized(false),
+  compressionThreads(1) {
   if (!req) THROW("Event request cannot be null");
   init();
 }
@@ -266,6 +287,12 @@ URI Request::getURI(evhttp_request *req) {
 }
 
 
+URIView Request::getURIView() const {
+  const char *uri = evhttp_request_get_uri(req.access());
+  return uri ? URIView(uri) : URIView();
+}
+
+
 RequestMethod Request::getMethod() const {return getMethod(req.access());}
 
 
@@ -614,7 +641,8 @@ Request::getOutputStream(compression_t compression) {
   // Auto select compression type based on Accept-Encoding
   if (compression == COMPRESS_AUTO) compression = getRequestedCompression();
   outSetContentEncoding(compression);
-  return compressBufferStream(getOutputBuffer(), compression);
+  return compressBufferStream(getOutputBuffer(), compression,
+                              compressionThreads);
 }
 
 
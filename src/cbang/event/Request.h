@@ -39,6 +39,7 @@
 #include <cbang/util/Version.h>
 #include <cbang/net/IPAddress.h>
 #include <cbang/net/URI.h>
+#include <cbang/net/URIView.h>
 #include <cbang/net/Session.h>
 #include <cbang/json/JSON.h>
 
@@ -76,6 +77,7 @@ namespace cb {
       std::string user;
       bool incoming;
       bool finalized;
+      unsigned compressionThreads;
 
       JSON::Dict args;
 
@@ -143,6 +145,9 @@ namespace cb {
       virtual const URI &getURI() const {return uri;}
       virtual URI &getURI() {return uri;}
       static URI getURI(evhttp_request *req);
+      /// A non-owning view of the request line URI, valid for the lifetime
+      /// of the request.  Reflects the original URI, not later changes.
+      virtual URIView getURIView() const;
       virtual const IPAddress &getClientIP() const {return clientIP;}
       virtual RequestMethod getMethod() const;
       static RequestMethod getMethod(evhttp_request *req);
@@ -179,6 +184,11 @@ namespace cb {
         COMPRESS_BZIP2
       } compression_t;
 
+      unsigned getCompressionThreads() const {return compressionThreads;}
+      /// Compress output on @param threads threads, zero for one per CPU
+      void setCompressionThreads(unsigned threads)
+      {compressionThreads = threads;}
+
       virtual void outSetContentEncoding(compression_t compression);
       virtual compression_t getRequestedCompression() const;
 
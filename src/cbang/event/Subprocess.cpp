@@ -0,0 +1,340 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Subprocess.h"
+#include "Event.h"
+
+#include <cbang/Exception.h>
+#include <cbang/log/Logger.h>
+#include <cbang/os/SysError.h>
+#include <cbang/os/Mutex.h>
+#include <cbang/util/SmartLock.h>
+
+#include <event2/buffer.h>
+#include <event2/util.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <map>
+#include <set>
+
+using namespace std;
+using namespace cb::Event;
+
+
+namespace {
+  // libevent delivers a signal to only one event per Base, so the SIGCHLD
+  // event is shared by all of a Base's Subprocesses without a pidfd.
+  struct ChildWatch {
+    cb::SmartPointer<cb::Event::Event> event;
+    set<cb::Event::Subprocess *> children;
+  };
+
+  cb::Mutex childWatchLock;
+  map<Base *, ChildWatch> childWatches;
+}
+
+
+Subprocess::Subprocess(Base &base) :
+  base(base), closingInput(false), pidFD(-1), signalWatch(false),
+  openOutputs(0), exited(false) {}
+
+
+Subprocess::~Subprocess() {release();}
+
+
+void Subprocess::exec(const vector<string> &args, unsigned flags,
+                      ProcessPriority priority) {
+#ifdef _WIN32
+  THROW("Event driven subprocesses are not supported on Windows");
+
+#else
+  if (isRunning() || openOutputs)
+    THROW("Subprocess already running");
+
+  release();
+  exited = false;
+  closingInput = false;
+  input.clear();
+  output[0].clear();
+  output[1].clear();
+
+  cb::Subprocess::exec(args, flags, priority);
+
+  try {
+    if (flags & REDIR_STDIN) {
+      int fd = getPipeHandle(0, false);
+      evutil_make_socket_nonblocking(fd);
+      unsigned events = EventFlag::EVENT_WRITE | EventFlag::EVENT_PERSIST;
+      inEvent = base.newEvent(fd, events, this, &Subprocess::writeReady);
+    }
+
+    for (unsigned i = 0; i < 2; i++)
+      if (flags & (i ? REDIR_STDERR : REDIR_STDOUT)) {
+        int fd = getPipeHandle(i + 1, false);
+        evutil_make_socket_nonblocking(fd);
+        unsigned events = EventFlag::EVENT_READ | EventFlag::EVENT_PERSIST;
+        outEvents[i] =
+          base.newEvent(fd, events, [this, i] () {readReady(i);});
+        outEvents[i]->add();
+        openOutputs++;
+      }
+
+    watchExit();
+
+  } catch (...) {
+    release();
+    throw;
+  }
+#endif // _WIN32
+}
+
+
+void Subprocess::exec(const string &command, unsigned flags,
+                      ProcessPriority priority) {
+  vector<string> args;
+  parse(command, args);
+  exec(args, flags, priority);
+}
+
+
+void Subprocess::write(const Buffer &buffer) {
+  if (inEvent.isNull()) THROW("Subprocess stdin not redirected");
+  if (closingInput) THROW("Subprocess stdin is closing");
+
+  input.add(buffer);
+  if (!inEvent->isPending()) inEvent->add();
+}
+
+
+void Subprocess::closeInput() {
+  if (inEvent.isNull()) return;
+
+  closingInput = true;
+  if (!input.getLength()) closeInputNow();
+}
+
+
+void Subprocess::watchExit() {
+#ifdef __NR_pidfd_open
+  // A pidfd becomes readable when the child exits
+  pidFD = syscall(__NR_pidfd_open, (pid_t)getPID(), 0);
+
+  if (pidFD != -1) {
+    exitEvent =
+      base.newEvent(pidFD, EventFlag::EVENT_READ, this, &Subprocess::exitReady);
+    exitEvent->add();
+    return;
+  }
+#endif
+
+#ifndef _WIN32
+  watchSignal();
+
+  // Catch exits which happened before the handler was installed
+  exitReady();
+#endif
+}
+
+
+void Subprocess::watchSignal() {
+  cb::SmartLock lock(&childWatchLock);
+
+  ChildWatch &watch = childWatches[&base];
+  if (watch.event.isNull()) {
+    Base *base = &this->base;
+    watch.event = this->base.newSignal
+      (SIGCHLD, [base] () {childSignaled(base);}, true);
+    watch.event->add();
+  }
+
+  watch.children.insert(this);
+  signalWatch = true;
+}
+
+
+void Subprocess::unwatchSignal() {
+  if (!signalWatch) return;
+  signalWatch = false;
+
+  cb::SmartLock lock(&childWatchLock);
+
+  auto it = childWatches.find(&base);
+  if (it == childWatches.end()) return;
+
+  it->second.children.erase(this);
+  if (it->second.children.empty()) {
+    it->second.event->del();
+    childWatches.erase(it);
+  }
+}
+
+
+void Subprocess::childSignaled(Base *base) {
+  std::set<Subprocess *> children;
+
+  {
+    cb::SmartLock lock(&childWatchLock);
+    auto it = childWatches.find(base);
+    if (it != childWatches.end()) children = it->second.children;
+  }
+
+  for (auto child: children) {
+    // Skip children released by an earlier callback
+    {
+      cb::SmartLock lock(&childWatchLock);
+      auto it = childWatches.find(base);
+      if (it == childWatches.end() || !it->second.children.count(child))
+        continue;
+    }
+
+    child->exitReady();
+  }
+}
+
+
+void Subprocess::readReady(unsigned i) {
+  int fd = outEvents[i]->getFD();
+  int ret = evbuffer_read(output[i].getBuffer(), fd, -1);
+
+  if (ret < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+    LOG_WARNING("Subprocess " << getPID() << " read failed: " << SysError());
+  }
+
+  if (0 < ret) {
+    read_cb_t &cb = i ? stderrCB : stdoutCB;
+    if (cb) cb(output[i]);
+    else output[i].clear();
+
+  } else closeOutput(i);
+}
+
+
+void Subprocess::writeReady() {
+  if (input.getLength()) {
+    int ret = evbuffer_write(input.getBuffer(), inEvent->getFD());
+
+    if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      // The child closed its end
+      LOG_DEBUG(3, "Subprocess " << getPID() << " write failed: "
+                << SysError());
+      input.clear();
+      closeInputNow();
+      return;
+    }
+  }
+
+  if (!input.getLength()) {
+    if (closingInput) closeInputNow();
+    else inEvent->del();
+  }
+}
+
+
+void Subprocess::exitReady() {
+  if (exited || isRunning()) return;
+
+  exited = true;
+  if (!exitEvent.isNull()) {
+    exitEvent->del();
+    exitEvent.release();
+  }
+  unwatchSignal();
+
+#ifndef _WIN32
+  if (pidFD != -1) {
+    ::close(pidFD);
+    pidFD = -1;
+  }
+#endif
+
+  checkDone();
+}
+
+
+void Subprocess::closeOutput(unsigned i) {
+  outEvents[i]->del();
+  outEvents[i].release();
+  closeStream(i + 1);
+  openOutputs--;
+
+  checkDone();
+}
+
+
+void Subprocess::closeInputNow() {
+  inEvent->del();
+  inEvent.release();
+  closeStdIn();
+}
+
+
+void Subprocess::checkDone() {
+  if (exited && !openOutputs && exitCB) {
+    exit_cb_t cb = exitCB;
+    cb();
+  }
+}
+
+
+void Subprocess::release() {
+  if (!inEvent.isNull()) closeInputNow();
+
+  for (unsigned i = 0; i < 2; i++)
+    if (!outEvents[i].isNull()) {
+      outEvents[i]->del();
+      outEvents[i].release();
+    }
+  openOutputs = 0;
+
+  if (!exitEvent.isNull()) {
+    exitEvent->del();
+    exitEvent.release();
+  }
+  unwatchSignal();
+
+#ifndef _WIN32
+  if (pidFD != -1) {
+    ::close(pidFD);
+    pidFD = -1;
+  }
+#endif
+}
@@ -0,0 +1,117 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "Base.h"
+#include "Buffer.h"
+
+#include <cbang/os/Subprocess.h>
+
+
+namespace cb {
+  namespace Event {
+    class Event;
+
+    /**
+     * A Subprocess driven by an Event::Base.  Redirected pipes are
+     * non-blocking and serviced by events, so many children can be run from
+     * one thread without blocking or deadlocking on full pipes.  Child exit
+     * is detected with a pidfd where available, otherwise with a SIGCHLD
+     * event shared by all the Subprocesses of a Base.
+     *
+     * Not supported on Windows.
+     */
+    class Subprocess : public cb::Subprocess {
+    public:
+      /// Called with the unread output.  Data not drained is kept.
+      typedef std::function<void (Buffer &buffer)> read_cb_t;
+      typedef Base::bare_callback_t exit_cb_t;
+
+    protected:
+      Base &base;
+
+      read_cb_t stdoutCB;
+      read_cb_t stderrCB;
+      exit_cb_t exitCB;
+
+      Buffer input;
+      Buffer output[2];
+      bool closingInput;
+
+      SmartPointer<Event> inEvent;
+      SmartPointer<Event> outEvents[2];
+      SmartPointer<Event> exitEvent;
+      int pidFD;
+      bool signalWatch;
+      unsigned openOutputs;
+      bool exited;
+
+    public:
+      Subprocess(Base &base);
+      ~Subprocess();
+
+      void setStdOutCallback(read_cb_t cb) {stdoutCB = cb;}
+      void setStdErrCallback(read_cb_t cb) {stderrCB = cb;}
+
+      /// Called once the child has exited and all its output was read
+      void setExitCallback(exit_cb_t cb) {exitCB = cb;}
+
+      Buffer &getStdOutBuffer() {return output[0];}
+      Buffer &getStdErrBuffer() {return output[1];}
+
+      void exec(const std::vector<std::string> &args, unsigned flags = 0,
+                ProcessPriority priority = ProcessPriority::PRIORITY_INHERIT);
+      void exec(const std::string &command, unsigned flags = 0,
+                ProcessPriority priority = ProcessPriority::PRIORITY_INHERIT);
+
+      /// Queue data for the child's stdin.  Requires REDIR_STDIN.
+      void write(const Buffer &buffer);
+      void write(const std::string &s) {write(Buffer(s));}
+      /// Close the child's stdin after all queued data is written.
+      void closeInput();
+
+    protected:
+      void watchExit();
+      void watchSignal();
+      void unwatchSignal();
+      static void childSignaled(Base *base);
+      void readReady(unsigned i);
+      void writeReady();
+      void exitReady();
+      void closeOutput(unsigned i);
+      void closeInputNow();
+      void checkDone();
+      void release();
+    };
+  }
+}
@@ -104,6 +104,8 @@ void WebServer::addOptions(Options &options) {
                 "format.")->setDefault("certificate.pem");
     options.add("private-key-file", "The servers private key file in PEM "
                 "format.")->setDefault("private.pem");
+    options.add("kernel-tls", "Let the kernel encrypt TLS records where "
+                "supported.")->setDefault(false);
     options.popCategory();
   }
 }
@@ -161,6 +163,9 @@ void WebServer::init() {
       if (SystemUtilities::exists(crlFile)) sslCtx->addCRL(crlFile);
       else LOG_WARNING("Certificate Relocation List not found " << crlFile);
     }
+
+    // Kernel TLS
+    if (options["kernel-tls"].toBoolean()) sslCtx->setKTLS();
   }
 #endif // HAVE_OPENSSL
 }
@@ -40,6 +40,7 @@
 #include <cbang/String.h>
 
 #include <cbang/buffer/BufferDevice.h>
+#include <cbang/buffer/BufferPool.h>
 
 #include <cbang/socket/SocketDevice.h>
 
@@ -189,11 +190,13 @@ void Connection::writeResponse(ostream &stream) {
   // Write data
   responseBuf_t::const_iterator it;
   for (it = responseBuf.begin(); it != responseBuf.end(); it++) {
-    // Ignore non-MemoryBuffers
-    if (!it->isInstance<MemoryBuffer>()) continue;
+    // Other Buffers cannot be read without consuming them
+    if (it->isInstance<MemoryBuffer>()) {
+      MemoryBuffer &buf = *it->cast<MemoryBuffer>();
+      stream.write(buf.begin(), buf.getFill());
 
-    MemoryBuffer &buf = *it->cast<MemoryBuffer>();
-    stream.write(buf.begin(), buf.getFill());
+    } else if (it->isInstance<FileBuffer>())
+      it->cast<FileBuffer>()->copy(stream);
   }
 }
 
@@ -228,12 +231,14 @@ void Connection::addResponseBuffer(Packet &packet) {
 }
 
 
-unsigned Connection::getResponseSize() const {
-  unsigned total = 0;
+uint64_t Connection::getResponseSize() const {
+  uint64_t total = 0;
   responseBuf_t::const_iterator it;
 
   for (it = responseBuf.begin(); it != responseBuf.end(); it++)
-    total += (*it)->getFill();
+    if (it->isInstance<FileBuffer>())
+      total += it->cast<FileBuffer>()->getLength();
+    else total += (*it)->getFill();
 
   return total;
 }
@@ -247,7 +252,7 @@ bool Connection::readHeader() {
     unsigned size = tryParsingHeader(readBuf);
 
     if (size) {
-      dataBuf.clear();
+      dataBuf.release(); // Return the last payload's memory to the pool
       contentLength = 0;
 
       LOG_DEBUG(5, *this << " HTTP Request (\n"
@@ -281,7 +286,7 @@ bool Connection::read() {
 
     case RequestMethod::HTTP_POST: {
       // Check Content-Length
-      if (!request.has("Content-Length")) {
+      if (!request.has(Header::HEADER_CONTENT_LENGTH)) {
         LOG_WARNING("Request missing Content-Length");
         error(StatusCode::HTTP_LENGTH_REQUIRED);
       }
@@ -294,6 +299,12 @@ bool Connection::read() {
         error(StatusCode::HTTP_REQUEST_ENTITY_TOO_LARGE);
       }
 
+      // Push back on clients while buffer memory is short
+      if (BufferPool::instance().isExhausted()) {
+        LOG_WARNING("Buffer memory exhausted, rejecting request");
+        error(StatusCode::HTTP_SERVICE_UNAVAILABLE);
+      }
+
       // Allocate buffer
       dataBuf.increase(contentLength);
 
@@ -361,42 +372,45 @@ bool Connection::writeHeader() {
     LOG_DEBUG(5, *this << " HTTP Response (\n" << response << ")");
   }
 
-  utilBuf.incPosition(writeSocket(utilBuf.begin(), utilBuf.getFill()));
+  // Send the header together with as much of the body as possible
+  writeMemoryBuffers(&utilBuf);
 
   return utilBuf.isEmpty();
 }
 
 
 bool Connection::write() {
-  while (!responseBuf.empty()) {
-    MemoryBuffer *buf;
-
-    if (utilBuf.isEmpty()) {
-      // Find the first non-empty buffer
-      SmartPointer<Buffer> &bufPtr = responseBuf.front();
-      if (bufPtr->isEmpty()) {
-        responseBuf.pop_front();
-        continue;
-      }
+  while (true) {
+    // Data read from a non-MemoryBuffer into utilBuf goes first
+    if (!utilBuf.isEmpty()) {
+      uint64_t count = writeSocket(utilBuf.begin(), utilBuf.getFill());
+      if (!count) break;
+      utilBuf.incPosition(count);
+      continue;
+    }
+
+    // Drop finished buffers
+    while (!responseBuf.empty() && responseBuf.front()->isEmpty())
+      responseBuf.pop_front();
+    if (responseBuf.empty()) break;
 
-      // If this is not a MemoryBuffer use utilBuf to read it
-      if (!bufPtr.isInstance<MemoryBuffer>()) {
-        buf = &utilBuf;
-        buf->clear();
-        buf->increase(4096);
-        buf->incFill(bufPtr->read(buf->begin(), buf->getSpace()));
+    SmartPointer<Buffer> &bufPtr = responseBuf.front();
 
-      } else buf = bufPtr.castPtr<MemoryBuffer>();
+    if (bufPtr.isInstance<MemoryBuffer>()) {
+      if (!writeMemoryBuffers()) break;
 
-    } else buf = &utilBuf;
+    } else if (bufPtr.isInstance<FileBuffer>() && socket->canSendFile()) {
+      if (!writeFileBuffer(*bufPtr.cast<FileBuffer>())) break;
 
-    // Write the data to the socket
-    uint64_t count = writeSocket(buf->begin(), buf->getFill());
-    if (!count) break;
-    buf->incPosition(count);
+    } else {
+      // Otherwise use utilBuf to read it
+      utilBuf.clear();
+      utilBuf.increase(4096);
+      utilBuf.incFill(bufPtr->read(utilBuf.begin(), utilBuf.getSpace()));
+    }
   }
 
-  return responseBuf.empty();
+  return responseBuf.empty() && utilBuf.isEmpty();
 }
 
 
@@ -425,9 +439,8 @@ unsigned Connection::tryParsingHeader(MemoryBuffer &buffer) {
   if (match == 4) {
     // Found end of header, parse it
     unsigned size = ptr - buffer.begin();
-    io::stream<io::array> stream(buffer.begin(), size);
     request.reset();
-    request.read(stream);
+    request.parse(buffer.begin(), size);
 
     return size;
   }
@@ -454,3 +467,82 @@ uint64_t Connection::writeSocket(const char *buffer, unsigned length) {
 
   return count;
 }
+
+
+uint64_t Connection::writeSocket(const Socket::Segment *segments,
+                                 unsigned count) {
+  if (!count) return 0;
+  if (count == 1) return writeSocket(segments[0].data, segments[0].length);
+
+  uint64_t bytes = socket->writev(segments, count, Socket::NONBLOCKING);
+  if (bytes) {
+    lastUpdate = Time::now();
+    LOG_DEBUG(5, *this << " wrote " << bytes << " from " << count
+              << " buffers");
+  }
+
+  return bytes;
+}
+
+
+uint64_t Connection::writeMemoryBuffers(MemoryBuffer *header) {
+  const unsigned maxSegments = 64;
+  Socket::Segment segments[maxSegments];
+  unsigned count = 0;
+
+  if (header && !header->isEmpty()) {
+    segments[count].data = header->begin();
+    segments[count++].length = header->getFill();
+  }
+
+  // Gather consecutive MemoryBuffers
+  responseBuf_t::iterator it;
+  for (it = responseBuf.begin(); it != responseBuf.end() &&
+         count < maxSegments && it->isInstance<MemoryBuffer>(); it++) {
+    MemoryBuffer &buf = *it->cast<MemoryBuffer>();
+
+    if (!buf.isEmpty()) {
+      segments[count].data = buf.begin();
+      segments[count++].length = buf.getFill();
+    }
+  }
+
+  if (!count) return 0;
+  uint64_t bytes = writeSocket(segments, count);
+
+  // Consume what was written, which may end in the middle of a buffer
+  uint64_t left = bytes;
+
+  if (header) {
+    unsigned n = left < header->getFill() ? left : header->getFill();
+    header->incPosition(n);
+    left -= n;
+  }
+
+  while (left) {
+    MemoryBuffer &buf = *responseBuf.front().cast<MemoryBuffer>();
+    unsigned n = left < buf.getFill() ? left : buf.getFill();
+    buf.incPosition(n);
+    left -= n;
+
+    if (buf.isEmpty()) responseBuf.pop_front();
+  }
+
+  return bytes;
+}
+
+
+uint64_t Connection::writeFileBuffer(FileBuffer &buf) {
+  uint64_t count =
+    socket->sendFile(buf.getFD(), buf.getOffset(), buf.getLength(),
+                     Socket::NONBLOCKING);
+
+  if (count) {
+    buf.incPosition(count);
+    lastUpdate = Time::now();
+    LOG_DEBUG(5, *this << " sent " << count << " from file");
+
+  } else buf.checkSize(); // Nothing is sent past the end of the file
+
+  return count;
+}
@@ -37,8 +37,10 @@
 #include "Response.h"
 
 #include <cbang/buffer/MemoryBuffer.h>
+#include <cbang/buffer/FileBuffer.h>
 #include <cbang/os/Mutex.h>
 #include <cbang/socket/SocketConnection.h>
+#include <cbang/socket/Socket.h>
 
 #include <ostream>
 #include <list>
@@ -140,7 +142,7 @@ namespace cb {
       void addResponseBuffer(const SmartPointer<Buffer> &buf);
       void addResponseBuffer(char *buffer, unsigned length);
       void addResponseBuffer(Packet &packet);
-      unsigned getResponseSize() const;
+      uint64_t getResponseSize() const;
 
       typedef responseBuf_t::const_iterator iterator;
       iterator responseBufferBegin() const {return responseBuf.begin();}
@@ -164,6 +166,9 @@ namespace cb {
 
       uint64_t readSocket(char *buffer, unsigned length);
       uint64_t writeSocket(const char *buffer, unsigned length);
+      uint64_t writeSocket(const Socket::Segment *segments, unsigned count);
+      uint64_t writeMemoryBuffers(MemoryBuffer *header = 0);
+      uint64_t writeFileBuffer(FileBuffer &buf);
     };
 
     inline static
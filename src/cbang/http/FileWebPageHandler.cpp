@@ -35,6 +35,7 @@
 #include "WebContext.h"
 
 #include <cbang/os/SystemUtilities.h>
+#include <cbang/buffer/FileBuffer.h>
 
 using namespace std;
 using namespace cb;
@@ -46,7 +47,16 @@ bool FileWebPageHandler::handlePage(WebContext &ctx, ostream &stream,
   string filename = root + uri.getPath();
 
   if (SystemUtilities::exists(filename)) {
-    SystemUtilities::cp(*SystemUtilities::open(filename, ios::in), stream);
+    Connection &con = ctx.getConnection();
+
+    if (&stream == &(ostream &)con) {
+      // Queue the file itself so it can be sent without copying
+      con.flush();
+      con.addResponseBuffer(new FileBuffer(filename));
+
+    } else
+      SystemUtilities::cp(*SystemUtilities::open(filename, ios::in), stream);
+
     return true;
   }
 
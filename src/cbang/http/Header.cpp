@@ -38,11 +38,10 @@
 #include <cbang/Exception.h>
 
 #include <cbang/log/Logger.h>
+#include <cbang/util/Numeric.h>
 
 #include <string.h>
 
-#include <vector>
-#include <sstream>
 #include <cctype>
 
 using namespace std;
@@ -50,11 +49,234 @@ using namespace cb;
 using namespace cb::HTTP;
 
 
+namespace {
+  const char *headerNames[Header::HEADER_COUNT] = {
+    "Accept",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Authorization",
+    "Cache-Control",
+    "Connection",
+    "Content-Encoding",
+    "Content-Length",
+    "Content-Type",
+    "Cookie",
+    "Date",
+    "ETag",
+    "Expires",
+    "Host",
+    "If-Modified-Since",
+    "If-None-Match",
+    "Keep-Alive",
+    "Last-Modified",
+    "Location",
+    "Origin",
+    "Pragma",
+    "Proxy-Authenticate",
+    "Proxy-Authentication-Info",
+    "Proxy-Authorization",
+    "Range",
+    "Referer",
+    "Server",
+    "Set-Cookie",
+    "Transfer-Encoding",
+    "Upgrade",
+    "User-Agent",
+    "WWW-Authenticate",
+    "X-Forwarded-For",
+  };
+
+
+  inline char lower(char c) {return 'A' <= c && c <= 'Z' ? c + 32 : c;}
+  inline bool isSpace(char c) {return c == ' ' || c == '\t' || c == '\r';}
+
+
+  bool equalsCI(const char *a, const char *b, unsigned length) {
+    for (unsigned i = 0; i < length; i++)
+      if (lower(a[i]) != lower(b[i])) return false;
+    return true;
+  }
+
+
+  // Open addressed hash of the interned names
+  class NameTable {
+    static const unsigned SIZE = 128;
+
+    int slots[SIZE];
+    unsigned lengths[Header::HEADER_COUNT];
+
+  public:
+    NameTable() {
+      for (unsigned i = 0; i < SIZE; i++) slots[i] = -1;
+
+      for (int id = 0; id < Header::HEADER_COUNT; id++) {
+        lengths[id] = strlen(headerNames[id]);
+
+        unsigned i = hash(headerNames[id], lengths[id]);
+        while (slots[i] != -1) i = (i + 1) % SIZE;
+        slots[i] = id;
+      }
+    }
+
+
+    static unsigned hash(const char *name, unsigned length) {
+      return (length * 31 + lower(name[0]) * 7 + lower(name[length - 1])) %
+        SIZE;
+    }
+
+
+    Header::id_t lookup(const char *name, unsigned length) const {
+      if (!length) return Header::HEADER_UNKNOWN;
+
+      for (unsigned i = hash(name, length);; i = (i + 1) % SIZE) {
+        int id = slots[i];
+        if (id == -1) return Header::HEADER_UNKNOWN;
+
+        if (lengths[id] == length && equalsCI(headerNames[id], name, length))
+          return (Header::id_t)id;
+      }
+    }
+  };
+
+
+  const NameTable nameTable;
+}
+
+
+bool Header::Slice::equals(const char *s, unsigned length) const {
+  return this->length == length && equalsCI(ptr, s, length);
+}
+
+
 Header::Header(const string &data) {
   read(data);
 }
 
 
+Header::id_t Header::lookup(const char *name, unsigned length) {
+  return nameTable.lookup(name, length);
+}
+
+
+const char *Header::getName(id_t id) {
+  if (id < 0 || HEADER_COUNT <= id) THROW("Invalid header id " << id);
+  return headerNames[id];
+}
+
+
+void Header::clear() {
+  buffer.clear();
+  fields.clear();
+  garbage = 0;
+  for (unsigned i = 0; i < HEADER_COUNT; i++) index[i] = -1;
+}
+
+
+Header::Slice Header::getFieldName(unsigned i) const {
+  const Field &field = fields.at(i);
+  return Slice(buffer.data() + field.name, field.nameLength);
+}
+
+
+Header::Slice Header::getFieldValue(unsigned i) const {
+  const Field &field = fields.at(i);
+  return Slice(buffer.data() + field.value, field.valueLength);
+}
+
+
+bool Header::find(id_t id, Slice &value) const {
+  if (!has(id)) return false;
+  value = getFieldValue(index[id]);
+  return true;
+}
+
+
+bool Header::find(const string &name, Slice &value) const {
+  int i = findPosition(lookup(name), name.data(), name.length());
+  if (i < 0) return false;
+  value = getFieldValue(i);
+  return true;
+}
+
+
+bool Header::has(const string &name) const {
+  return 0 <= findPosition(lookup(name), name.data(), name.length());
+}
+
+
+string Header::get(id_t id) const {
+  Slice value;
+  if (!find(id, value)) THROW("'" << getName(id) << "' not set");
+  return value.toString();
+}
+
+
+string Header::get(const string &name) const {
+  Slice value;
+  if (!find(name, value)) THROW("'" << name << "' not set");
+  return value.toString();
+}
+
+
+string Header::get(const string &name, const string &defaultValue) const {
+  Slice value;
+  return find(name, value) ? value.toString() : defaultValue;
+}
+
+
+void Header::add(const string &name, const string &value) {
+  addField(lookup(name), name.data(), name.length(), value.data(),
+           value.length());
+}
+
+
+void Header::append(const string &name, const string &value) {
+  int i = findPosition(lookup(name), name.data(), name.length());
+  if (i < 0) return set(name, value);
+
+  string s = getFieldValue(i).toString() + value;
+  setValue(fields[i], s.data(), s.length());
+}
+
+
+void Header::set(id_t id, const string &value) {
+  const char *name = getName(id);
+  set(name, strlen(name), value.data(), value.length());
+}
+
+
+void Header::unset(id_t id) {
+  unset(getName(id));
+}
+
+
+void Header::unset(const string &name) {
+  id_t id = lookup(name);
+  bool found = false;
+
+  for (unsigned i = fields.size(); i; i--) {
+    Field &field = fields[i - 1];
+
+    if (field.id == id && (id != HEADER_UNKNOWN ||
+                           getFieldName(i - 1).equals(name.data(),
+                                                      name.length()))) {
+      removeField(i - 1);
+      found = true;
+    }
+  }
+
+  if (found) reindex();
+}
+
+
+bool Header::isContentType(const string &contentType) const {
+  Slice value;
+  return find(HEADER_CONTENT_TYPE, value) &&
+    value.size() == contentType.size() &&
+    !memcmp(value.data(), contentType.data(), value.size());
+}
+
+
 string Header::setContentTypeFromExtension(const string &filename) {
   size_t ptr = filename.find_last_of('.');
   string ext;
@@ -70,72 +292,118 @@ string Header::setContentTypeFromExtension(const string &filename) {
 
 
 void Header::setContentLength(streamsize length) {
-  set("Content-Length", String((uint64_t)length));
+  char buf[Numeric::BUFFER_SIZE];
+  const char *name = headerNames[HEADER_CONTENT_LENGTH];
+  set(name, strlen(name), buf, Numeric::format(buf, (uint64_t)length));
 }
 
 
 streamsize Header::getContentLength() const {
-  if (!has("Content-Length")) return 0;
-  return (streamsize)String::parseU64(get("Content-Length"));
-}
+  Slice value;
+  if (!find(HEADER_CONTENT_LENGTH, value)) return 0;
 
+  const char *end = value.data() + value.size();
+  uint64_t length;
+  if (Numeric::parse(value.data(), end, length) != end)
+    THROW("Invalid Content-Length '" << value.toString() << "'");
 
-void Header::read(const string &data) {
-  istringstream stream(data);
-  read(stream);
+  return (streamsize)length;
 }
 
 
-istream &Header::read(istream &stream) {
-  string key;
+unsigned Header::parse(const char *data, unsigned length) {
+  const char *ptr = data;
+  const char *end = data + length;
+  int last = -1;
 
   clear();
+  buffer.reserve(length);
 
-  while (!stream.fail()) {
-    char line[1024];
-    memset(line, 0, sizeof(line));
-
-    stream.getline(line, sizeof(line));
-    if (stream.fail()) THROW("Failed to read stream");
-
-    LOG_DEBUG(6, "Read " << stream.gcount() << " bytes of HTTP header");
+  while (true) {
+    const char *eol = (const char *)memchr(ptr, '\n', end - ptr);
+    if (!eol) THROW("Reached end of data before end of HTTP header");
+    const char *next = eol + 1;
 
     // Remove trailing space
-    for (int i = strlen(line) - 1; 0 <= i && isspace(line[i]); i--)
-      line[i] = 0;
+    while (ptr < eol && isSpace(eol[-1])) eol--;
 
-    if (line[0] == 0) break; // End of header
+    if (ptr == eol) return next - data; // End of header
 
-    LOG_DEBUG(5, "HTTP::Header: " << line);
+    LOG_DEBUG(5, "HTTP::Header: " << string(ptr, eol - ptr));
 
-    if (stream.eof()) THROW("Reached end of stream before end of HTTP header");
+    if (0 <= last && isSpace(*ptr)) { // Continuation of last line
+      while (isSpace(*ptr)) ptr++;
 
-    char *ptr = line;
-    if (!key.empty() && isspace(*ptr)) { // Continuation of last line
-      while (*ptr && isspace(*ptr)) ptr++;
-      set(key, get(key) + " " + ptr);
+      Field &field = fields[last];
+      if (field.value + field.valueLength == buffer.size()) {
+        buffer.push_back(' ');
+        buffer.append(ptr, eol - ptr);
+        field.valueLength += eol - ptr + 1;
 
-    } else {
-      ptr = strchr(line, ':');
-      if (!ptr) THROW("Invalid  header '" << line << "'");
+      } else {
+        string value =
+          getFieldValue(last).toString() + " " + string(ptr, eol - ptr);
+        setValue(field, value.data(), value.length());
+      }
 
-      *ptr++ = 0;
-      key = line;
+    } else {
+      const char *colon = (const char *)memchr(ptr, ':', eol - ptr);
+      if (!colon) THROW("Invalid header '" << string(ptr, eol - ptr) << "'");
 
-      while (*ptr && isspace(*ptr)) ptr++;
+      const char *value = colon + 1;
+      while (value < eol && isSpace(*value)) value++;
 
-      // TODO handle repeated keys such as Set-Cookie
-      set(key, ptr);
+      addField(lookup(ptr, colon - ptr), ptr, colon - ptr, value, eol - value);
+      last = fields.size() - 1;
     }
+
+    ptr = next;
   }
+}
+
+
+void Header::read(const string &data) {
+  parse(data.data(), data.length());
+}
+
+
+istream &Header::read(istream &stream) {
+  string data;
+  string line;
+
+  while (true) {
+    getline(stream, line);
+    if (stream.fail()) THROW("Failed to read stream");
+
+    data.append(line);
+    data.push_back('\n');
+
+    // Remove trailing space
+    string::size_type len = line.length();
+    while (len && isspace(line[len - 1])) len--;
+
+    if (!len) break; // End of header
+
+    if (stream.eof()) THROW("Reached end of stream before end of HTTP header");
+  }
+
+  LOG_DEBUG(6, "Read " << data.length() << " bytes of HTTP header");
+
+  parse(data.data(), data.length());
 
   return stream;
 }
 
 
 ostream &Header::write(ostream &stream) const {
-  for (const_iterator it = begin(); it != end(); it++)
-    stream << it->first << ": " << it->second << "\r\n";
+  for (unsigned i = 0; i < fields.size(); i++) {
+    const Field &field = fields[i];
+
+    stream.write(buffer.data() + field.name, field.nameLength);
+    stream.write(": ", 2);
+    stream.write(buffer.data() + field.value, field.valueLength);
+    stream.write("\r\n", 2);
+  }
 
   return stream;
 }
@@ -213,3 +481,108 @@ string Header::quoted(const string &s) {
 
   return result + "\"";
 }
+
+
+void Header::set(const char *name, unsigned nameLength, const char *value,
+                 unsigned valueLength) {
+  id_t id = lookup(name, nameLength);
+  int i = findPosition(id, name, nameLength);
+  if (i < 0) {
+    addField(id, name, nameLength, value, valueLength);
+    return;
+  }
+
+  setValue(fields[i], value, valueLength);
+
+  // Remove any earlier fields with the same name
+  bool found = false;
+  while (i--)
+    if (fields[i].id == id && (id != HEADER_UNKNOWN ||
+                               getFieldName(i).equals(name, nameLength))) {
+      removeField(i);
+      found = true;
+    }
+
+  if (found) reindex();
+}
+
+
+int Header::findPosition(id_t id, const char *name, unsigned length) const {
+  if (id != HEADER_UNKNOWN) return index[id];
+
+  for (unsigned i = fields.size(); i; i--)
+    if (fields[i - 1].id == HEADER_UNKNOWN &&
+        getFieldName(i - 1).equals(name, length)) return i - 1;
+
+  return -1;
+}
+
+
+void Header::addField(id_t id, const char *name, unsigned nameLength,
+                      const char *value, unsigned valueLength) {
+  Field field;
+  field.id = id;
+  field.name = buffer.size();
+  field.nameLength = nameLength;
+  buffer.append(name, nameLength);
+  field.value = buffer.size();
+  field.valueLength = valueLength;
+  buffer.append(value, valueLength);
+
+  fields.push_back(field);
+  if (id != HEADER_UNKNOWN) index[id] = fields.size() - 1;
+}
+
+
+void Header::setValue(Field &field, const char *value, unsigned length) {
+  if (length <= field.valueLength) {
+    memmove(&buffer[field.value], value, length);
+    garbage += field.valueLength - length;
+
+  } else {
+    garbage += field.valueLength;
+    field.value = buffer.size();
+    buffer.append(value, length);
+  }
+
+  field.valueLength = length;
+
+  if (buffer.size() < 2 * garbage) compact();
+}
+
+
+void Header::removeField(unsigned i) {
+  garbage += fields[i].nameLength + fields[i].valueLength;
+  fields.erase(fields.begin() + i);
+}
+
+
+void Header::reindex() {
+  for (unsigned i = 0; i < HEADER_COUNT; i++) index[i] = -1;
+
+  for (unsigned i = 0; i < fields.size(); i++)
+    if (fields[i].id != HEADER_UNKNOWN) index[fields[i].id] = i;
+
+  if (buffer.size() < 2 * garbage) compact();
+}
+
+
+void Header::compact() {
+  string compacted;
+  compacted.reserve(buffer.size() - garbage);
+
+  for (unsigned i = 0; i < fields.size(); i++) {
+    Field &field = fields[i];
+
+    unsigned name = compacted.size();
+    compacted.append(buffer, field.name, field.nameLength);
+    unsigned value = compacted.size();
+    compacted.append(buffer, field.value, field.valueLength);
+
+    field.name = name;
+    field.value = value;
+  }
+
+  buffer.swap(compacted);
+  garbage = 0;
+}
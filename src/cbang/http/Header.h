@@ -35,32 +35,166 @@
 #include <cbang/util/StringMap.h>
 
 #include <string>
+#include <vector>
+#include <iostream>
 
 
 namespace cb {
   namespace HTTP {
-    class Header : public CIStringMap {
+    /**
+     * HTTP header fields stored as slices of one contiguous buffer.  Field
+     * order is preserved and names are matched case-insensitively.  Well
+     * known names are interned to an id_t so finding them is a table
+     * lookup rather than a string search.
+     *
+     * As with the map this class replaced, a name read more than once
+     * resolves to its last value and set() leaves a single field.
+     */
+    class Header {
     public:
-      Header() {}
+      typedef enum {
+        HEADER_UNKNOWN = -1,
+        HEADER_ACCEPT,
+        HEADER_ACCEPT_ENCODING,
+        HEADER_ACCEPT_LANGUAGE,
+        HEADER_AUTHORIZATION,
+        HEADER_CACHE_CONTROL,
+        HEADER_CONNECTION,
+        HEADER_CONTENT_ENCODING,
+        HEADER_CONTENT_LENGTH,
+        HEADER_CONTENT_TYPE,
+        HEADER_COOKIE,
+        HEADER_DATE,
+        HEADER_ETAG,
+        HEADER_EXPIRES,
+        HEADER_HOST,
+        HEADER_IF_MODIFIED_SINCE,
+        HEADER_IF_NONE_MATCH,
+        HEADER_KEEP_ALIVE,
+        HEADER_LAST_MODIFIED,
+        HEADER_LOCATION,
+        HEADER_ORIGIN,
+        HEADER_PRAGMA,
+        HEADER_PROXY_AUTHENTICATE,
+        HEADER_PROXY_AUTHENTICATION_INFO,
+        HEADER_PROXY_AUTHORIZATION,
+        HEADER_RANGE,
+        HEADER_REFERER,
+        HEADER_SERVER,
+        HEADER_SET_COOKIE,
+        HEADER_TRANSFER_ENCODING,
+        HEADER_UPGRADE,
+        HEADER_USER_AGENT,
+        HEADER_WWW_AUTHENTICATE,
+        HEADER_X_FORWARDED_FOR,
+        HEADER_COUNT,
+      } id_t;
+
+
+      class Slice {
+        const char *ptr;
+        unsigned length;
+
+      public:
+        Slice(const char *ptr = 0, unsigned length = 0) :
+          ptr(ptr), length(length) {}
+
+        const char *data() const {return ptr;}
+        unsigned size() const {return length;}
+        bool empty() const {return !length;}
+        std::string toString() const {return std::string(ptr, length);}
+
+        /// Case-insensitive compare
+        bool equals(const char *s, unsigned length) const;
+      };
+
+    protected:
+      struct Field {
+        id_t id;
+        unsigned name;
+        unsigned nameLength;
+        unsigned value;
+        unsigned valueLength;
+      };
+
+      std::string buffer;
+      std::vector<Field> fields;
+      unsigned garbage;
+
+      /// Position in fields of the last field with each interned name
+      int index[HEADER_COUNT];
+
+    public:
+      Header() {clear();}
       Header(const std::string &header);
 
-      bool hasContentType() const {return has("Content-Type");}
-      const std::string &getContentType() const {return get("Content-Type");}
+      static id_t lookup(const char *name, unsigned length);
+      static id_t lookup(const std::string &name)
+      {return lookup(name.data(), name.length());}
+      static const char *getName(id_t id);
+
+      unsigned size() const {return fields.size();}
+      bool empty() const {return fields.empty();}
+      void clear();
+
+      /// Fields in the order they were read or added
+      Slice getFieldName(unsigned i) const;
+      Slice getFieldValue(unsigned i) const;
+
+      bool find(id_t id, Slice &value) const;
+      bool find(const std::string &name, Slice &value) const;
+
+      bool has(id_t id) const {return 0 <= id && 0 <= index[id];}
+      bool has(const std::string &name) const;
+      std::string get(id_t id) const;
+      std::string get(const std::string &name) const;
+      std::string get(const std::string &name,
+                      const std::string &defaultValue) const;
+      std::string operator[](const std::string &name) const
+      {return get(name);}
+
+      /// Replace all fields named @param name with one
+      void set(const std::string &name, const std::string &value)
+      {set(name.data(), name.length(), value.data(), value.length());}
+      void set(id_t id, const std::string &value);
+      /// Add a field even if @param name is already set, e.g. Set-Cookie
+      void add(const std::string &name, const std::string &value);
+      void append(const std::string &name, const std::string &value);
+      void unset(id_t id);
+      void unset(const std::string &name);
+      void erase(const std::string &name) {unset(name);}
+
+      bool hasContentType() const {return has(HEADER_CONTENT_TYPE);}
+      std::string getContentType() const {return get(HEADER_CONTENT_TYPE);}
       void setContentType(const std::string &contentType)
-      {set("Content-Type", contentType);}
-      bool isContentType(const std::string &contentType) const
-      {return hasContentType() && getContentType() == contentType;}
+      {set(HEADER_CONTENT_TYPE, contentType);}
+      bool isContentType(const std::string &contentType) const;
       std::string setContentTypeFromExtension(const std::string &filename);
 
       void setContentLength(std::streamsize length);
       std::streamsize getContentLength() const;
 
+      /// Parse header fields up to and including the blank line which ends
+      /// them.  Lines may end in CRLF or LF.
+      /// @return The number of bytes consumed.
+      unsigned parse(const char *data, unsigned length);
       void read(const std::string &data);
       std::istream &read(std::istream &stream);
       std::ostream &write(std::ostream &stream) const;
 
       static void parseKeyValueList(const std::string &s, StringMap &map);
       static std::string quoted(const std::string &s);
+
+    protected:
+      void set(const char *name, unsigned nameLength, const char *value,
+               unsigned valueLength);
+      int findPosition(id_t id, const char *name, unsigned length) const;
+      void addField(id_t id, const char *name, unsigned nameLength,
+                    const char *value, unsigned valueLength);
+      void setValue(Field &field, const char *value, unsigned length);
+      void removeField(unsigned i);
+      void reindex();
+      void compact();
     };
 
 
@@ -47,7 +47,9 @@ const char *Message::TIME_FORMAT = "%a, %d %b %Y %H:%M:%S %Z";
 
 
 bool Message::isChunked() const {
-  string encoding = get("Transfer-Encoding", "");
+  Slice value;
+  if (!find(HEADER_TRANSFER_ENCODING, value)) return false;
+  string encoding = value.toString();
 
   vector<string> parts;
   String::tokenize(encoding, parts, ",");
@@ -60,7 +62,9 @@ bool Message::isChunked() const {
 
 void Message::setChunked(bool chunked) {
   if (chunked != isChunked()) {
-    string encoding = String::trim(get("Transfer-Encoding", ""));
+    string encoding;
+    if (has(HEADER_TRANSFER_ENCODING))
+      encoding = String::trim(get(HEADER_TRANSFER_ENCODING));
 
     if (chunked) { // Add it
       if (!encoding.empty()) encoding += ", ";
@@ -77,17 +81,17 @@ void Message::setChunked(bool chunked) {
         }
     }
 
-    if (encoding.empty()) unset("Transfer-Encoding");
-    else set("Transfer-Encoding", encoding);
+    if (encoding.empty()) unset(HEADER_TRANSFER_ENCODING);
+    else set(HEADER_TRANSFER_ENCODING, encoding);
   }
 }
 
 
 bool Message::hasCookie(const string &name) const {
-  if (!has("Cookie")) return false;
+  if (!has(HEADER_COOKIE)) return false;
 
   vector<string> cookies;
-  String::tokenize(get("Cookie"), cookies, "; \t\n\r");
+  String::tokenize(get(HEADER_COOKIE), cookies, "; \t\n\r");
 
   for (unsigned i = 0; i < cookies.size(); i++)
     if (name == cookies[i].substr(0, cookies[i].find('='))) return true;
@@ -97,10 +101,10 @@ bool Message::hasCookie(const string &name) const {
 
 
 string Message::getCookie(const string &name) const {
-  if (has("Cookie")) {
+  if (has(HEADER_COOKIE)) {
     // Return only the first matching cookie
     vector<string> cookies;
-    String::tokenize(get("Cookie"), cookies, "; \t\n\r");
+    String::tokenize(get(HEADER_COOKIE), cookies, "; \t\n\r");
 
     for (unsigned i = 0; i < cookies.size(); i++) {
       size_t pos = cookies[i].find('=');
@@ -125,18 +129,21 @@ string Message::findCookie(const string &name) const {
 
 void Message::setPersistent(bool x) {
   if (getVersion() < 1.1) {
-    if (x) set("Connection", "Keep-Alive");
-    else erase("Connection");
+    if (x) set(HEADER_CONNECTION, "Keep-Alive");
+    else unset(HEADER_CONNECTION);
 
-  } else if (x) erase("Connection");
-  else set("Connection", "close");
+  } else if (x) unset(HEADER_CONNECTION);
+  else set(HEADER_CONNECTION, "close");
 }
 
 
 bool Message::isPersistent() const {
-  string connection = String::toLower(get("Connection", ""));
-  if (getVersion() < 1.1) return connection == "keep-alive";
-  return connection != "close";
+  Slice connection;
+  bool found = find(HEADER_CONNECTION, connection);
+
+  if (getVersion() < 1.1)
+    return found && connection.equals("keep-alive", 10);
+  return !found || !connection.equals("close", 5);
 }
 
 
@@ -160,9 +167,23 @@ void Message::readVersionString(const string &s) {
 }
 
 
+unsigned Message::parse(const char *data, unsigned length) {
+  const char *eol = (const char *)memchr(data, '\n', length);
+  if (!eol) THROW("Reached end of data before end of HTTP header line");
+  unsigned size = eol + 1 - data;
+
+  // Remove trailing space
+  while (data < eol && isspace(eol[-1])) eol--;
+
+  LOG_DEBUG(5, "HTTP header line '" << string(data, eol - data) << "'");
+
+  readHeaderLine(string(data, eol - data));
+  return size + Header::parse(data + size, length - size);
+}
+
+
 void Message::read(const string &data) {
-  istringstream stream(data);
-  read(stream);
+  parse(data.data(), data.length());
 }
 
 
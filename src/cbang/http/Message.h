@@ -81,6 +81,10 @@ namespace cb {
       virtual std::string getHeaderLine() const = 0;
       virtual void readHeaderLine(const std::string &line) = 0;
 
+      /// Parse the header line and fields from a buffer holding at least
+      /// the complete header.
+      /// @return The number of bytes consumed.
+      unsigned parse(const char *data, unsigned length);
       void read(const std::string &data);
       virtual std::istream &read(std::istream &stream);
       virtual std::ostream &write(std::ostream &stream) const;
@@ -54,8 +54,8 @@ void Response::reset() {
 void Response::redirect(const URI &uri, StatusCode status) {
   LOG_DEBUG(5, "Redirect: " << status << ": " << uri);
   setStatus(status);
-  set("Location", uri);
-  set("Content-Length", "0");
+  set(HEADER_LOCATION, uri.toString());
+  setContentLength(0);
 }
 
 
@@ -77,23 +77,23 @@ void Response::readHeaderLine(const string &line) {
 }
 
 
-void Response::finalize(unsigned length) {
+void Response::finalize(uint64_t length) {
   if (finalized) return;
 
   if (status == StatusCode::HTTP_UNKNOWN) status = StatusCode::HTTP_OK;
 
-  set("Date", Time(TIME_FORMAT));
+  set(HEADER_DATE, Time(TIME_FORMAT).toString());
 
-  if (isChunked()) set("Transfer-Encoding", "chunked");
-  else if (length) set("Content-Length", String(length));
+  if (isChunked()) set(HEADER_TRANSFER_ENCODING, "chunked");
+  else if (length) setContentLength(length);
 
-  if (!has("Cache-Control")) set("Cache-Control", "no-cache");
+  if (!has(HEADER_CACHE_CONTROL)) set(HEADER_CACHE_CONTROL, "no-cache");
 
   finalized = true;
 }
 
 
 void Response::setCacheExpire(unsigned secs) {
-  set("Expires", Time(Time::now() + secs, TIME_FORMAT).toString());
-  set("Cache-Control", "max-age");
+  set(HEADER_EXPIRES, Time(Time::now() + secs, TIME_FORMAT).toString());
+  set(HEADER_CACHE_CONTROL, "max-age");
 }
@@ -62,7 +62,7 @@ namespace cb {
 
       void setCacheExpire(unsigned secs = 60 * 60 * 24 * 10);
 
-      void finalize(unsigned length);
+      void finalize(uint64_t length);
     };
   }
 }
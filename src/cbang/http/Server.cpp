@@ -43,6 +43,8 @@
 #include <cbang/socket/SocketSet.h>
 #include <cbang/socket/SocketDebugger.h>
 
+#include <cbang/buffer/BufferPool.h>
+
 #include <cbang/os/SystemUtilities.h>
 #include <cbang/os/ThreadPoolFunc.h>
 
@@ -114,6 +116,10 @@ void Server::init() {
   ipFilter.allow(options["allow"]);
   ipFilter.deny(options["deny"]);
 
+  // Buffer memory
+  if (options["max-buffer-memory"].isSet())
+    BufferPool::instance().setMaxBytes(options["max-buffer-memory"].toInteger());
+
   // Configure ports
   Option::strings_t addresses = options["http-addresses"].toStrings();
   for (unsigned i = 0; i < addresses.size(); i++)
@@ -150,6 +156,9 @@ void Server::init() {
       if (SystemUtilities::exists(crlFile)) sslCtx->addCRL(crlFile);
       else LOG_WARNING("Certificate Relocation List not found " << crlFile);
     }
+
+    // Kernel TLS
+    if (options["kernel-tls"].toBoolean()) sslCtx->setKTLS();
   }
 #endif // HAVE_OPENSSL
 
@@ -241,6 +250,11 @@ void Server::construct() {
                     "Sets the maximum number of simultaneous connections.");
   options.addTarget("max-request-length", maxRequestLength,
                     "Sets the maximum length of a client request packet.");
+  options.add("max-buffer-memory", "The maximum number of bytes of buffer "
+              "memory in use by all connections, not counting free buffers "
+              "kept for reuse.  New connections and request data are refused "
+              "when it runs short.  Zero for no limit."
+              )->setDefault((uint64_t)0);
   options.addTarget("connection-timeout", connectionTimeout, "The maximum "
                     "amount of time, in seconds, a connection can be idle "
                     "before being dropped.");
@@ -270,6 +284,9 @@ void Server::construct() {
                 "format.")->setDefault("certificate.pem");
     options.add("private-key-file", "The servers private key file in PEM "
                 "format.")->setDefault("private.pem");
+    options.add("kernel-tls", "Let the kernel encrypt TLS records where "
+                "supported, allowing files to be sent with sendfile() over "
+                "secure connections.")->setDefault(false);
     options.popCategory();
   }
 #endif // HAVE_OPENSSL
@@ -484,6 +501,7 @@ Server::createConnection(SmartPointer<Socket> socket,
                          const IPAddress &clientIP) {
   limitConnections();
   if (maxConnections <= connections.size()) return 0;
+  if (BufferPool::instance().isExhausted()) return 0;
   return new Connection(*this, socket, clientIP);
 }
 
@@ -33,6 +33,7 @@
 #include "InputSource.h"
 
 #include "File.h"
+#include "MMapFile.h"
 
 #include <cbang/os/SystemUtilities.h>
 #include <cbang/iostream/ArrayDevice.h>
@@ -46,33 +47,41 @@ using namespace cb;
 
 
 InputSource::InputSource(Buffer &buffer, const string &name) :
-  Named(name), stream(new BufferStream(buffer)), length(buffer.getFill()) {}
+  Named(name), stream(new BufferStream(buffer)), length(buffer.getFill()),
+  data(0) {}
 
 
 InputSource::InputSource(const char *array, streamsize length,
                          const string &name) :
   Named(name), stream(new ArrayStream<const char>(array, length)),
-  length(length) {}
+  length(length), data(array) {}
 
 
 InputSource::InputSource(const string &filename) :
-  Named(filename), stream(SystemUtilities::iopen(filename)), length(-1) {}
+  Named(filename), stream(SystemUtilities::iopen(filename)), length(-1),
+  data(0) {}
 
 
 InputSource::InputSource(istream &stream, const string &name,
                          streamsize length) :
-  Named(name), stream(SmartPointer<istream>::Phony(&stream)), length(length) {}
+  Named(name), stream(SmartPointer<istream>::Phony(&stream)), length(length),
+  data(0) {}
 
 
 InputSource::InputSource(const SmartPointer<istream> &stream,
                          const string &name, streamsize length) :
-  Named(name), stream(stream), length(length) {}
+  Named(name), stream(stream), length(length), data(0) {}
 
 
 InputSource::InputSource(const Resource &resource) :
   Named(resource.getName()),
-  stream(new ArrayStream<const char>(resource.getData(), resource.getLength()))
-{}
+  stream(new ArrayStream<const char>(resource.getData(), resource.getLength())),
+  length(resource.getLength()), data(resource.getData()) {}
+
+
+InputSource::InputSource(const SmartPointer<MMapFile> &file) :
+  Named(file->getPath()), stream(new MMapStream(file)),
+  length(file->getLength()), data(file->begin()) {}
 
 
 streamsize InputSource::getLength() const {
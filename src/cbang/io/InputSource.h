@@ -42,10 +42,12 @@
 namespace cb {
   class Buffer;
   class Resource;
+  class MMapFile;
 
   class InputSource : public Named {
     cb::SmartPointer<std::istream> stream;
     std::streamsize length;
+    const char *data;
 
   public:
     InputSource(Buffer &buffer, const std::string &name = "<buffer>");
@@ -58,8 +60,11 @@ namespace cb {
                 const std::string &name = std::string(),
                 std::streamsize length = -1);
     InputSource(const Resource &resource);
+    InputSource(const SmartPointer<MMapFile> &file);
 
     std::istream &getStream() const {return *stream;}
+    /// @return the source's contiguous memory or null if it only has a stream
+    const char *getData() const {return data;}
     std::streamsize getLength() const;
     std::string toString() const;
     std::string getLine(unsigned maxLength = 4096) const;
@@ -0,0 +1,205 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "MMapFile.h"
+
+#include <cbang/Exception.h>
+#include <cbang/Catch.h>
+#include <cbang/os/SysError.h>
+#include <cbang/log/Logger.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN // Avoid including winsock.h
+#include <windows.h>
+
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace cb;
+
+
+MMapFile::MMapFile(const string &path, unsigned flags, uint64_t length) :
+  path(path), flags(flags), data(0), length(length) {
+  open();
+  advise(flags);
+}
+
+
+MMapFile::~MMapFile() {
+  try {
+    close();
+  } CATCH_ERROR;
+}
+
+
+char *MMapFile::getData() {
+  if (!isWritable()) THROW("Mapping of '" << path << "' is read-only");
+  return data;
+}
+
+
+void MMapFile::advise(unsigned flags) {
+#ifndef _WIN32
+  if (!length) return;
+
+  if (flags & MMAP_SEQUENTIAL) madvise(data, length, MADV_SEQUENTIAL);
+  if (flags & MMAP_RANDOM) madvise(data, length, MADV_RANDOM);
+  if (flags & MMAP_WILL_NEED) madvise(data, length, MADV_WILLNEED);
+
+#ifdef MADV_HUGEPAGE
+  if ((flags & MMAP_HUGE_PAGES) && madvise(data, length, MADV_HUGEPAGE))
+    LOG_DEBUG(3, "Huge pages not available for '" << path << "': "
+              << SysError());
+#endif
+#endif // _WIN32
+}
+
+
+void MMapFile::sync(bool async) {
+  if (!length || !isWritable()) return;
+
+  SysError::clear();
+
+#ifdef _WIN32
+  if (!FlushViewOfFile(data, 0))
+    THROW("Failed to sync '" << path << "': " << SysError());
+
+#else
+  if (msync(data, length, async ? MS_ASYNC : MS_SYNC))
+    THROW("Failed to sync '" << path << "': " << SysError());
+#endif
+}
+
+
+void MMapFile::open() {
+  bool writable = isWritable();
+
+  SysError::clear();
+
+#ifdef _WIN32
+  HANDLE file =
+    CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0),
+                FILE_SHARE_READ | FILE_SHARE_WRITE, 0,
+                writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL, 0);
+  if (file == INVALID_HANDLE_VALUE)
+    THROW("Failed to open '" << path << "': " << SysError());
+
+  LARGE_INTEGER size;
+  if (writable && length) {
+    size.QuadPart = length;
+    if (!SetFilePointerEx(file, size, 0, FILE_BEGIN) || !SetEndOfFile(file)) {
+      CloseHandle(file);
+      THROW("Failed to resize '" << path << "': " << SysError());
+    }
+
+  } else if (GetFileSizeEx(file, &size)) length = size.QuadPart;
+  else {
+    CloseHandle(file);
+    THROW("Failed to get size of '" << path << "': " << SysError());
+  }
+
+  if (length) {
+    // The view keeps the file and mapping objects alive
+    HANDLE mapping =
+      CreateFileMappingA(file, 0, writable ? PAGE_READWRITE : PAGE_READONLY,
+                         0, 0, 0);
+    if (mapping) {
+      data = (char *)MapViewOfFile
+        (mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+    }
+  }
+
+  CloseHandle(file);
+
+#else // _WIN32
+  int fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  if (fd == -1) THROW("Failed to open '" << path << "': " << SysError());
+
+  struct stat st;
+  if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    THROW("Cannot map '" << path << "', not a regular file");
+  }
+
+  if (writable && length) {
+    if ((uint64_t)st.st_size != length && ftruncate(fd, length)) {
+      ::close(fd);
+      THROW("Failed to resize '" << path << "': " << SysError());
+    }
+
+  } else length = st.st_size;
+
+  if (length) {
+    int mapFlags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (flags & MMAP_POPULATE) mapFlags |= MAP_POPULATE;
+#endif
+
+    void *addr = mmap(0, length, PROT_READ | (writable ? PROT_WRITE : 0),
+                      mapFlags, fd, 0);
+    if (addr != MAP_FAILED) data = (char *)addr;
+  }
+
+  // The mapping remains valid after the descriptor is closed
+  ::close(fd);
+#endif // _WIN32
+
+  if (length && !data) {
+    length = 0;
+    THROW("Failed to map '" << path << "': " << SysError());
+  }
+}
+
+
+void MMapFile::close() {
+  if (!data) return;
+
+  SysError::clear();
+
+#ifdef _WIN32
+  if (!UnmapViewOfFile(data))
+#else
+  if (munmap(data, length))
+#endif
+    THROW("Failed to unmap '" << path << "': " << SysError());
+
+  data = 0;
+  length = 0;
+}
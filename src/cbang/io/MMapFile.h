@@ -0,0 +1,119 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/SmartPointer.h>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <string>
+#include <cstdint>
+
+
+namespace cb {
+  /**
+   * A memory mapped file.  The whole file is mapped as one contiguous span
+   * which stays valid for the lifetime of the object.  Reading from the
+   * mapping avoids copying file data through kernel and stream buffers.
+   *
+   * The file must not be truncated by another process while it is mapped.
+   */
+  class MMapFile {
+  public:
+    typedef enum {
+      MMAP_READ_ONLY   = 0,
+      MMAP_READ_WRITE  = 1 << 0,
+      MMAP_SEQUENTIAL  = 1 << 1, // Expect sequential access
+      MMAP_RANDOM      = 1 << 2, // Expect random access
+      MMAP_WILL_NEED   = 1 << 3, // Start read ahead of the whole file
+      MMAP_POPULATE    = 1 << 4, // Fault in all pages before returning
+      MMAP_HUGE_PAGES  = 1 << 5, // Request transparent huge pages
+    } flags_t;
+
+  protected:
+    std::string path;
+    unsigned flags;
+    char *data;
+    uint64_t length;
+
+  public:
+    /// If @param length is non-zero a read-write file is resized to it
+    MMapFile(const std::string &path, unsigned flags = MMAP_READ_ONLY,
+             uint64_t length = 0);
+    ~MMapFile();
+
+    const std::string &getPath() const {return path;}
+    unsigned getFlags() const {return flags;}
+    bool isWritable() const {return flags & MMAP_READ_WRITE;}
+
+    const char *getData() const {return data;}
+    char *getData();
+    uint64_t getLength() const {return length;}
+    bool isEmpty() const {return !length;}
+
+    /// An empty file has no mapping but still gives a valid, empty span
+    const char *begin() const {return data ? data : "";}
+    const char *end() const {return begin() + length;}
+
+    /// Apply access hints to the mapping.  Only the hint flags are used.
+    void advise(unsigned flags);
+    /// Write modified pages back to the file
+    void sync(bool async = false);
+
+  protected:
+    void open();
+    void close();
+  };
+
+
+  /// Holds the mapping so it outlives the stream buffer
+  struct MMapFileHolder {
+    SmartPointer<MMapFile> file;
+    MMapFileHolder(const SmartPointer<MMapFile> &file) : file(file) {}
+  };
+
+
+  /// An istream which reads directly from the mapped memory
+  class MMapStream :
+    protected MMapFileHolder,
+    public boost::iostreams::stream<boost::iostreams::array_source> {
+  public:
+    MMapStream(const SmartPointer<MMapFile> &file) :
+      MMapFileHolder(file),
+      boost::iostreams::stream<boost::iostreams::array_source>
+      (file->begin(), file->end()) {}
+
+    const SmartPointer<MMapFile> &getFile() const {return file;}
+  };
+}
@@ -43,6 +43,8 @@ namespace cb {
     UnixFile(const std::string &path, std::ios::openmode mode, int perm);
     ~UnixFile() {close();}
 
+    int getFD() const {return fd;}
+
     // From FileInterface
     void open(const std::string &path, std::ios::openmode mode, int perm);
     std::streamsize read(char *s, std::streamsize n);
@@ -48,6 +48,7 @@ namespace io = boost::iostreams;
 namespace cb {
   class BZip2Decompressor {
     static const unsigned BUFFER_SIZE = 4096;
+    static const unsigned MAGIC_SIZE = 3;
 
     class BZip2DecompressorImpl {
       bz_stream bz;
@@ -88,14 +89,21 @@ namespace cb {
         while (bz.avail_out) {
 
           if (!bz.avail_in) {
-            bz.avail_in = io::read(src, buffer, BUFFER_SIZE);
-            bz.next_in = buffer;
+            std::streamsize count = io::read(src, buffer, BUFFER_SIZE);
+            if (count <= 0) break;
 
-            if (!bz.avail_in) break;
+            bz.avail_in = count;
+            bz.next_in = buffer;
           }
 
           int ret;
           if ((ret = BZ2_bzDecompress(&bz)) != BZ_OK) {
+            // Continue with the next of several concatenated streams
+            if (ret == BZ_STREAM_END && fill(src) && isNextStream()) {
+              restart();
+              continue;
+            }
+
             if (ret > 0) {
               remain = bz.avail_in;
               remain_ptr = bz.next_in;
@@ -125,6 +133,11 @@ namespace cb {
           int result = BZ2_bzDecompress(&bz);
           io::write(dest, buffer, BUFFER_SIZE - bz.avail_out);
 
+          if (result == BZ_STREAM_END && isNextStream()) {
+            restart();
+            continue;
+          }
+
           if (result != BZ_OK) {
             release();
 
@@ -159,6 +172,47 @@ namespace cb {
       }
 
 
+      /// Buffer enough input to check for another stream
+      template<typename Source> bool fill(Source &src) {
+        if (MAGIC_SIZE <= bz.avail_in) return true;
+
+        memmove(buffer, bz.next_in, bz.avail_in);
+        bz.next_in = buffer;
+
+        while (bz.avail_in < MAGIC_SIZE) {
+          std::streamsize count =
+            io::read(src, buffer + bz.avail_in, BUFFER_SIZE - bz.avail_in);
+          if (count <= 0) break;
+          bz.avail_in += count;
+        }
+
+        return MAGIC_SIZE <= bz.avail_in;
+      }
+
+
+      /// Check whether the remaining input starts another bzip2 stream.  In
+      /// write mode a stream ending exactly at a write boundary is assumed
+      /// to be followed by another.
+      bool isNextStream() const {
+        unsigned size = bz.avail_in < MAGIC_SIZE ? bz.avail_in : MAGIC_SIZE;
+        return !strncmp(bz.next_in, "BZh", size);
+      }
+
+
+      void restart() {
+        bz_stream last = bz;
+
+        BZ2_bzDecompressEnd(&bz);
+        memset(&bz, 0, sizeof(bz_stream));
+        BZ2_bzDecompressInit(&bz, 0, 0);
+
+        bz.next_in = last.next_in;
+        bz.avail_in = last.avail_in;
+        bz.next_out = last.next_out;
+        bz.avail_out = last.avail_out;
+      }
+
+
       void release() {
         if (done) return;
 
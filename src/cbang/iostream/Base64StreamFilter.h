@@ -0,0 +1,270 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <iosfwd> // streamsize
+#include <boost/iostreams/concepts.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <boost/iostreams/close.hpp>
+#include <boost/iostreams/detail/ios.hpp>
+namespace io = boost::iostreams;
+
+#include <cbang/SmartPointer.h>
+#include <cbang/net/Base64.h>
+
+#include <string>
+#include <string.h>
+
+
+namespace cb {
+  /// Incremental Base64 encoder.  Produces the same output as
+  /// Base64::encode() over the concatenated input.
+  class Base64StreamEncoder {
+    Base64 base64;
+    unsigned lineChars;
+    unsigned col;
+    char carry[3];
+    unsigned carried;
+
+  public:
+    Base64StreamEncoder(const Base64 &base64 = Base64()) :
+      base64(base64), lineChars(base64.getWidth() % 4 ? 0 : base64.getWidth()),
+      col(0), carried(0) {}
+
+
+    void update(const char *s, std::streamsize n, std::string &out) {
+      if (!n) return;
+
+      std::string::size_type start = out.size();
+      std::streamsize size = (carried + n) / 3 * 4 + 4;
+      if (lineChars) size += (size / lineChars + 1) * 2;
+      out.resize(start + size);
+      char *ptr = &out[start];
+
+      // Complete a group carried over from the last call
+      while (carried && n) {
+        carry[carried++] = *s++;
+        n--;
+
+        if (carried == 3) {
+          ptr = put(carry, 3, ptr);
+          carried = 0;
+        }
+      }
+
+      std::streamsize whole = n / 3 * 3;
+      ptr = put(s, whole, ptr);
+
+      for (s += whole, n -= whole; n; n--) carry[carried++] = *s++;
+
+      out.resize(ptr - out.data());
+    }
+
+
+    void finish(std::string &out) {
+      if (carried) {
+        char buf[6];
+        char *ptr = buf;
+
+        if (lineChars && col == lineChars) {
+          *ptr++ = '\r';
+          *ptr++ = '\n';
+        }
+
+        ptr = base64.encodeFinal(carry, carried, ptr);
+        out.append(buf, ptr - buf);
+      }
+
+      reset();
+    }
+
+
+    void reset() {col = carried = 0;}
+
+  protected:
+    char *put(const char *s, std::streamsize n, char *out) {
+      if (!lineChars) return base64.encodeBlock(s, n, out);
+
+      while (n) {
+        if (col == lineChars) {
+          *out++ = '\r';
+          *out++ = '\n';
+          col = 0;
+        }
+
+        std::streamsize bytes = (lineChars - col) / 4 * 3;
+        if (n < bytes) bytes = n;
+
+        out = base64.encodeBlock(s, bytes, out);
+        col += bytes / 3 * 4;
+        s += bytes;
+        n -= bytes;
+      }
+
+      return out;
+    }
+  };
+
+
+  /// Incremental Base64 decoder.  Produces the same output as
+  /// Base64::decode() over the concatenated input.
+  class Base64StreamDecoder {
+    Base64 base64;
+    char quad[4];
+    unsigned count;
+
+  public:
+    Base64StreamDecoder(const Base64 &base64 = Base64()) :
+      base64(base64), count(0) {}
+
+
+    void update(const char *s, std::streamsize n, std::string &out) {
+      std::string::size_type start = out.size();
+      out.resize(start + (count + n) / 4 * 3);
+      char *end = base64.decodeBlock(s, s + n, &out[start], quad, count);
+      out.resize(end - out.data());
+    }
+
+
+    void finish(std::string &out) {
+      char buf[3];
+      unsigned n = count;
+      count = 0;
+      out.append(buf, base64.decodeFinal(quad, n, buf) - buf);
+    }
+
+
+    void reset() {count = 0;}
+  };
+
+
+  /// A multichar dual-use filter which runs data through a
+  /// Base64StreamEncoder or Base64StreamDecoder in large blocks.
+  template <typename Codec>
+  class Base64StreamFilter {
+    static const unsigned BUFFER_SIZE = 3 * 4096;
+
+    class Impl {
+      Codec codec;
+      char buffer[BUFFER_SIZE];
+      std::string pending;
+      std::string::size_type offset;
+      bool eof;
+
+    public:
+      Impl(const Base64 &base64) : codec(base64), offset(0), eof(false) {}
+
+
+      template<typename Source>
+      std::streamsize read(Source &src, char *s, std::streamsize n) {
+        while (offset == pending.size()) {
+          if (eof) return -1;
+
+          pending.clear();
+          offset = 0;
+
+          std::streamsize count = io::read(src, buffer, BUFFER_SIZE);
+          if (count == -1) {
+            codec.finish(pending);
+            eof = true;
+
+          } else if (!count) return 0;
+          else codec.update(buffer, count, pending);
+        }
+
+        std::streamsize size = pending.size() - offset;
+        if (n < size) size = n;
+        memcpy(s, pending.data() + offset, size);
+        offset += size;
+
+        return size;
+      }
+
+
+      template<typename Sink>
+      std::streamsize write(Sink &dest, const char *s, std::streamsize n) {
+        pending.clear();
+        codec.update(s, n, pending);
+        io::write(dest, pending.data(), pending.size());
+
+        return n;
+      }
+
+
+      template<typename Sink> void close(Sink &dest, BOOST_IOS::openmode m) {
+        if (m & BOOST_IOS::out) {
+          pending.clear();
+          codec.finish(pending);
+          io::write(dest, pending.data(), pending.size());
+        }
+
+        codec.reset();
+        pending.clear();
+        offset = 0;
+        eof = false;
+      }
+    };
+
+    SmartPointer<Impl> impl;
+
+  public:
+    typedef char char_type;
+    struct category :
+      io::dual_use, io::filter_tag, io::multichar_tag, io::closable_tag {};
+
+
+    Base64StreamFilter(const Base64 &base64 = Base64()) :
+      impl(new Impl(base64)) {}
+
+
+    template<typename Source>
+    std::streamsize read(Source &src, char *s, std::streamsize n) {
+      return impl->read(src, s, n);
+    }
+
+
+    template<typename Sink>
+    std::streamsize write(Sink &dest, const char *s, std::streamsize n) {
+      return impl->write(dest, s, n);
+    }
+
+
+    template<typename Sink> void close(Sink &dest, BOOST_IOS::openmode m) {
+      impl->close(dest, m);
+    }
+  };
+
+
+  typedef Base64StreamFilter<Base64StreamEncoder> Base64EncodeFilter;
+  typedef Base64StreamFilter<Base64StreamDecoder> Base64DecodeFilter;
+}
@@ -33,6 +33,7 @@
 #pragma once
 
 #include <cbang/SmartPointer.h>
+#include <cbang/openssl/Cipher.h>
 
 #include <boost/iostreams/concepts.hpp>
 #include <boost/iostreams/operations.hpp>
@@ -0,0 +1,494 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "ParallelCompressor.h"
+
+#include <cbang/Exception.h>
+#include <cbang/os/ThreadPool.h>
+#include <cbang/os/Condition.h>
+#include <cbang/os/SystemInfo.h>
+#include <cbang/util/SmartLock.h>
+#include <cbang/util/SmartUnlock.h>
+#include <cbang/util/Singleton.h>
+
+#include <deque>
+
+#include <string.h>
+
+#include <zlib.h>
+#include <bzlib.h>
+
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  const unsigned WINDOW_SIZE = 32768;
+
+
+  struct Block {
+    ParallelCompressor::format_t format;
+    int level;
+
+    string input;
+    string dictionary;
+    string output;
+    bool last;
+    bool done;
+    bool failed;
+    Exception e;
+    uint32_t check;
+
+    Block(ParallelCompressor::format_t format, int level) :
+      format(format), level(level), last(false), done(false), failed(false),
+      check(0) {}
+  };
+
+  typedef SmartPointer<Block>::Protected BlockPtr;
+
+
+  void append32LE(string &s, uint32_t x) {
+    for (unsigned i = 0; i < 4; i++) s.push_back((char)(x >> (8 * i)));
+  }
+
+
+  void append32BE(string &s, uint32_t x) {
+    for (unsigned i = 0; i < 4; i++) s.push_back((char)(x >> (24 - 8 * i)));
+  }
+
+
+  void deflateBlock(Block &block) {
+    const string &input = block.input;
+
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (deflateInit2(&z, block.level, Z_DEFLATED, -15, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+      THROW("Failed to initialize deflate: " << z.msg);
+
+    int ret = Z_OK;
+    if (!block.dictionary.empty())
+      ret = deflateSetDictionary(&z, (const Bytef *)block.dictionary.data(),
+                                 block.dictionary.size());
+
+    z.next_in = (Bytef *)input.data();
+    z.avail_in = input.size();
+
+    // A sync flush byte aligns the end of the block so the next block's
+    // output can be appended directly.  Only the last block is final.
+    string &output = block.output;
+    unsigned bound = deflateBound(&z, input.size()) + 16;
+    size_t used = 0;
+
+    while (ret == Z_OK) {
+      output.resize(used + bound);
+      z.next_out = (Bytef *)&output[used];
+      z.avail_out = bound;
+
+      ret = deflate(&z, block.last ? Z_FINISH : Z_SYNC_FLUSH);
+      used = output.size() - z.avail_out;
+
+      if (ret == Z_STREAM_END || (ret == Z_OK && z.avail_out)) break;
+      if (ret == Z_BUF_ERROR) ret = Z_OK;
+    }
+
+    deflateEnd(&z);
+    if (ret != Z_OK && ret != Z_STREAM_END)
+      THROW("Deflate failed: " << ret);
+
+    output.resize(used);
+
+    if (block.format == ParallelCompressor::PARALLEL_GZIP)
+      block.check = crc32(0, (const Bytef *)input.data(), input.size());
+    else block.check = adler32(1, (const Bytef *)input.data(), input.size());
+  }
+
+
+  void bzip2Block(Block &block) {
+    const string &input = block.input;
+
+    bz_stream bz;
+    memset(&bz, 0, sizeof(bz));
+    int ret =
+      BZ2_bzCompressInit(&bz, block.level == -1 ? 9 : block.level, 0, 0);
+    if (ret != BZ_OK) THROW("Failed to initialize bzip2: " << ret);
+
+    bz.next_in = (char *)input.data();
+    bz.avail_in = input.size();
+
+    string &output = block.output;
+    unsigned bound = input.size() + input.size() / 100 + 600;
+    size_t used = 0;
+
+    do {
+      output.resize(used + bound);
+      bz.next_out = &output[used];
+      bz.avail_out = bound;
+
+      ret = BZ2_bzCompress(&bz, BZ_FINISH);
+      used = output.size() - bz.avail_out;
+    } while (ret == BZ_FINISH_OK);
+
+    BZ2_bzCompressEnd(&bz);
+    if (ret != BZ_STREAM_END) THROW("bzip2 compression failed: " << ret);
+
+    output.resize(used);
+  }
+
+
+  void compressBlock(Block &block) {
+    try {
+      if (block.format == ParallelCompressor::PARALLEL_BZIP2)
+        bzip2Block(block);
+      else deflateBlock(block);
+
+    } catch (const Exception &e) {
+      block.e = e;
+      block.failed = true;
+    }
+  }
+}
+
+
+/// One set of threads, one per CPU, shared by all ParallelCompressors
+class ParallelCompressor::Pool :
+  public Singleton<Pool>, protected ThreadPool, protected Condition {
+  typedef pair<Impl *, BlockPtr> job_t;
+  deque<job_t> jobs;
+
+public:
+  Pool(Inaccessible) :
+    ThreadPool(max(1U, SystemInfo::instance().getCPUCount())) {
+    ThreadPool::start();
+  }
+
+
+  ~Pool() {
+    {
+      SmartLock lock(this);
+      ThreadPool::stop();
+      Condition::broadcast();
+    }
+
+    ThreadPool::join();
+  }
+
+
+  void submit(Impl *owner, const BlockPtr &block) {
+    SmartLock lock(this);
+    jobs.push_back(job_t(owner, block));
+    Condition::signal();
+  }
+
+
+  /// @return The number of queued blocks removed
+  unsigned remove(Impl *owner) {
+    SmartLock lock(this);
+
+    unsigned count = 0;
+    for (auto it = jobs.begin(); it != jobs.end();)
+      if (it->first == owner) {
+        it = jobs.erase(it);
+        count++;
+
+      } else it++;
+
+    return count;
+  }
+
+protected:
+  // From ThreadPool
+  void run();
+};
+
+
+class ParallelCompressor::Impl : protected Condition {
+  const format_t format;
+  const unsigned threads;
+  const unsigned blockSize;
+  const int level;
+
+  Pool &pool;
+  deque<BlockPtr> blocks; // In stream order, awaiting output
+  deque<BlockPtr> ready;  // Awaiting a turn in the pool
+  unsigned running;       // Submitted to the pool and not yet done
+
+  BlockPtr current;
+  string window;
+  bool started;
+  uint32_t check;
+  uint64_t length;
+
+public:
+  Impl(format_t format, unsigned threads, unsigned blockSize, int level) :
+    format(format), threads(threads), blockSize(blockSize), level(level),
+    pool(Pool::instance()), running(0) {
+    reset();
+  }
+
+
+  ~Impl() {
+    SmartLock lock(this);
+
+    // Drop queued blocks and wait for those being compressed
+    ready.clear();
+    running -= pool.remove(this);
+    while (running) Condition::wait();
+  }
+
+
+  unsigned getThreads() const {return threads;}
+  unsigned getBlockSize() const {return blockSize;}
+
+
+  streamsize add(const char *s, streamsize n) {
+    if (current.isNull()) current = new Block(format, level);
+
+    streamsize size = blockSize - current->input.size();
+    if (n < size) size = n;
+    current->input.append(s, size);
+
+    if (current->input.size() == blockSize) submit(false);
+
+    return size;
+  }
+
+
+  bool isFull() const {
+    SmartLock lock(this);
+    return 2 * threads <= blocks.size();
+  }
+
+
+  bool next(string &data, bool wait) {
+    SmartLock lock(this);
+
+    if (blocks.empty()) return false;
+
+    while (!blocks.front()->done) {
+      if (!wait) return false;
+      Condition::wait();
+    }
+
+    BlockPtr block = blocks.front();
+    blocks.pop_front();
+
+    if (block->failed) throw block->e;
+
+    data.clear();
+    if (!started) writeHeader(data);
+    started = true;
+
+    if (data.empty()) data.swap(block->output);
+    else data.append(block->output);
+
+    uint64_t size = block->input.size();
+    switch (format) {
+    case PARALLEL_GZIP: check = crc32_combine(check, block->check, size); break;
+    case PARALLEL_ZLIB: check = adler32_combine(check, block->check, size);
+      break;
+    case PARALLEL_BZIP2: break;
+    }
+    length += size;
+
+    if (block->last) writeTrailer(data);
+
+    return true;
+  }
+
+
+  void finish() {submit(true);}
+
+
+  /// Called by the pool once a block is compressed
+  void compressed(Block &block) {
+    SmartLock lock(this);
+
+    block.done = true;
+    running--;
+    dispatch();
+    Condition::broadcast();
+  }
+
+
+  void reset() {
+    SmartLock lock(this);
+
+    // Wait for blocks still in the pool
+    ready.clear();
+    while (running) Condition::wait();
+
+    blocks.clear();
+    current.release();
+    window.clear();
+    started = false;
+    check = format == PARALLEL_ZLIB ? adler32(0, 0, 0) : crc32(0, 0, 0);
+    length = 0;
+  }
+
+protected:
+  void submit(bool last) {
+    if (current.isNull()) current = new Block(format, level);
+    current->last = last;
+
+    // Prime each deflate block with the tail of the previous one
+    if (format != PARALLEL_BZIP2) {
+      const string &input = current->input;
+      current->dictionary = window;
+
+      if (WINDOW_SIZE <= input.size())
+        window = input.substr(input.size() - WINDOW_SIZE);
+
+      else {
+        window.append(input);
+        if (WINDOW_SIZE < window.size())
+          window = window.substr(window.size() - WINDOW_SIZE);
+      }
+    }
+
+    SmartLock lock(this);
+    blocks.push_back(current);
+    ready.push_back(current);
+    current.release();
+    dispatch();
+  }
+
+
+  // Compress at most threads blocks of this stream at once
+  void dispatch() {
+    while (running < threads && !ready.empty()) {
+      pool.submit(this, ready.front());
+      ready.pop_front();
+      running++;
+    }
+  }
+
+
+  void writeHeader(string &data) const {
+    switch (format) {
+    case PARALLEL_GZIP: {
+      const char header[] = {
+        '\x1f', '\x8b', 8, 0, 0, 0, 0, 0,
+        (char)(level == 9 ? 2 : (level == 1 ? 4 : 0)), 3};
+      data.append(header, sizeof(header));
+      break;
+    }
+
+    case PARALLEL_ZLIB: {
+      unsigned flevel = level == -1 ? 2 : (level < 2 ? 0 : (level < 6 ? 1 :
+                                                      (level == 6 ? 2 : 3)));
+      unsigned header = (0x78 << 8) | (flevel << 6);
+      if (header % 31) header += 31 - header % 31;
+      data.push_back((char)(header >> 8));
+      data.push_back((char)header);
+      break;
+    }
+
+    case PARALLEL_BZIP2: break;
+    }
+  }
+
+
+  void writeTrailer(string &data) const {
+    switch (format) {
+    case PARALLEL_GZIP:
+      append32LE(data, check);
+      append32LE(data, (uint32_t)length);
+      break;
+
+    case PARALLEL_ZLIB: append32BE(data, check); break;
+    case PARALLEL_BZIP2: break;
+    }
+  }
+};
+
+
+void ParallelCompressor::Pool::run() {
+  SmartLock lock(this);
+
+  while (!Thread::current().shouldShutdown()) {
+    if (jobs.empty()) {
+      Condition::wait();
+      continue;
+    }
+
+    job_t job = jobs.front();
+    jobs.pop_front();
+
+    SmartUnlock unlock(this);
+    compressBlock(*job.second);
+    job.first->compressed(*job.second);
+  }
+}
+
+
+ParallelCompressor::ParallelCompressor(format_t format, unsigned threads,
+                                       unsigned blockSize, int level) {
+  if (!threads) threads = SystemInfo::instance().getCPUCount();
+  if (!threads) threads = 1;
+
+  if (!blockSize)
+    blockSize = format == PARALLEL_BZIP2 ? 900000 : 128 * 1024;
+
+  if (level < -1 || 9 < level || (format == PARALLEL_BZIP2 && !level))
+    THROW("Invalid compression level " << level);
+
+  impl = new Impl(format, threads, blockSize, level);
+}
+
+
+ParallelCompressor::~ParallelCompressor() {}
+
+
+unsigned ParallelCompressor::getThreads() const {return impl->getThreads();}
+
+
+unsigned ParallelCompressor::getBlockSize() const {
+  return impl->getBlockSize();
+}
+
+
+streamsize ParallelCompressor::add(const char *s, streamsize n) {
+  return impl->add(s, n);
+}
+
+
+bool ParallelCompressor::isFull() const {return impl->isFull();}
+
+
+bool ParallelCompressor::next(string &data, bool wait) {
+  return impl->next(data, wait);
+}
+
+
+void ParallelCompressor::finish() {impl->finish();}
+void ParallelCompressor::reset() {impl->reset();}
@@ -0,0 +1,121 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <iosfwd> // streamsize
+#include <boost/iostreams/concepts.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <boost/iostreams/close.hpp>
+namespace io = boost::iostreams;
+
+#include <cbang/SmartPointer.h>
+
+#include <string>
+
+
+namespace cb {
+  /**
+   * An output filter which splits the stream into fixed size blocks and
+   * compresses them concurrently, in the manner of pigz and pbzip2.  All
+   * compressors share one pool of threads, one per CPU, so many small
+   * streams do not each start their own.  Blocks are written in order and
+   * at most two blocks per thread are held in memory at once.
+   *
+   * gzip and zlib output is a single standard stream.  Each block is
+   * primed with the last 32KiB of its predecessor so the compression
+   * ratio is close to that of a serial compressor.  bzip2 output is a
+   * concatenation of independent streams, one per block, which bzip2
+   * and BZip2Decompressor decode as one.
+   */
+  class ParallelCompressor {
+  public:
+    typedef enum {
+      PARALLEL_GZIP,
+      PARALLEL_ZLIB,
+      PARALLEL_BZIP2,
+    } format_t;
+
+    class Impl;
+    class Pool;
+
+  protected:
+    SmartPointer<Impl> impl;
+    std::string data;
+
+  public:
+    typedef char char_type;
+    struct category :
+      io::output, io::filter_tag, io::multichar_tag, io::closable_tag {};
+
+    /**
+     * @param threads Blocks of this stream compressed at once or zero for
+     *   one per CPU.
+     * @param blockSize Uncompressed bytes per block or zero for the format
+     *   default, 128KiB for gzip and zlib or 900KB for bzip2.
+     * @param level Compression level or -1 for the format default.
+     */
+    ParallelCompressor(format_t format, unsigned threads = 0,
+                       unsigned blockSize = 0, int level = -1);
+    ~ParallelCompressor();
+
+    unsigned getThreads() const;
+    unsigned getBlockSize() const;
+
+
+    template<typename Sink>
+    std::streamsize write(Sink &dest, const char *s, std::streamsize n) {
+      std::streamsize count = 0;
+
+      while (count < n) {
+        count += add(s + count, n - count);
+        while (next(data, isFull())) io::write(dest, data.data(), data.size());
+      }
+
+      return n;
+    }
+
+
+    template<typename Sink> void close(Sink &dest) {
+      finish();
+      while (next(data, true)) io::write(dest, data.data(), data.size());
+      reset();
+    }
+
+  protected:
+    std::streamsize add(const char *s, std::streamsize n);
+    bool isFull() const;
+    bool next(std::string &data, bool wait);
+    void finish();
+    void reset();
+  };
+}
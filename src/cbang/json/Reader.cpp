@@ -41,13 +41,13 @@
 #include "Builder.h"
 
 #include <cbang/String.h>
+#include <cbang/util/Numeric.h>
 #include <cbang/io/StringInputSource.h>
 
 #include <vector>
 #include <cctype>
 #include <sstream>
 
-#include <errno.h>
 
 using namespace std;
 using namespace cb;
@@ -222,29 +222,28 @@ void Reader::parseNumber(Sink &sink) {
     while (isdigit(stream.peek())) value += stream.get();
   }
 
-  const char *start = value.c_str();
-  char *end;
-  errno = 0;
+  const char *start = value.data();
+  const char *end = start + value.length();
 
   if (!decimal && negative) {
-    long long int v = strtoll(start, &end, 0);
+    int64_t v;
 
-    if (!errno && (size_t)(end - start) == value.length()) {
-      sink.write((int64_t)v);
+    if (Numeric::parse(start, end, v) == end) {
+      sink.write(v);
       return;
     }
 
   } else if (!decimal) {
-    long long unsigned v = strtoull(start, &end, 0);
+    uint64_t v;
 
-    if (!errno && (size_t)(end - start) == value.length()) {
-      sink.write((uint64_t)v);
+    if (Numeric::parse(start, end, v) == end) {
+      sink.write(v);
       return;
     }
   }
 
-  double v = strtod(start, &end);
-  if (errno || (size_t)(end - start) != value.length())
+  double v;
+  if (Numeric::parse(start, end, v) != end)
     error(SSTR("Invalid JSON number '" << value << "'"));
   sink.write(v);
 }
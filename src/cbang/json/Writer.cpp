@@ -37,6 +37,7 @@
 #include <cbang/String.h>
 #include <cbang/SStream.h>
 #include <cbang/Math.h>
+#include <cbang/util/Numeric.h>
 
 #include <cctype>
 #include <iomanip>
@@ -82,19 +83,25 @@ void Writer::write(double value) {
   if (isnan(value)) stream << "\"NaN\"";
   else if (isinf(value) && 0 < value) stream << "\"Infinity\"";
   else if (isinf(value) && value < 0) stream << "\"-Infinity\"";
-  else stream << cb::String(value);
+  else {
+    // Shortest decimal which reads back as the same double
+    char buf[Numeric::BUFFER_SIZE];
+    stream.write(buf, Numeric::format(buf, value));
+  }
 }
 
 
 void Writer::write(uint64_t value) {
   NullSink::write(value);
-  stream << cb::String(value);
+  char buf[Numeric::BUFFER_SIZE];
+  stream.write(buf, Numeric::format(buf, value));
 }
 
 
 void Writer::write(int64_t value) {
   NullSink::write(value);
-  stream << cb::String(value);
+  char buf[Numeric::BUFFER_SIZE];
+  stream.write(buf, Numeric::format(buf, value));
 }
 
 
@@ -31,76 +31,131 @@
 \******************************************************************************/
 
 #include "TailFileToLog.h"
+#include "TailFileWatcher.h"
 
 #include <cbang/String.h>
-#include <cbang/time/Timer.h>
+#include <cbang/io/UnixFile.h>
 #include <cbang/os/SystemUtilities.h>
 
 #include <string.h>
 
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
 using namespace std;
 using namespace cb;
 
 
+TailFileToLog::TailFileToLog(const string &filename, const string &prefix,
+                             const char *logDomain, unsigned logLevel) :
+  filename(filename), prefix(prefix), logDomain(logDomain),
+  logLevel(logLevel), offset(0), inode(0), fill(0) {}
+
+
+TailFileToLog::~TailFileToLog() {}
+
+
+void TailFileToLog::update() {
+  if (file.isNull()) {
+    if (!SystemUtilities::exists(filename)) return;
+    open();
+  }
+
+  read();
+
+  if (reopenNeeded()) {
+    LOG_DEBUG(4, "Reopening truncated or rotated '" << filename << "'");
+    open();
+    read();
+  }
+}
+
+
 void TailFileToLog::run() {
-  Timer timer;
-
-  while (!shouldShutdown()) {
-    if (stream.isNull()) {
-      if (SystemUtilities::exists(filename))
-        stream = SystemUtilities::open(filename, ios::in);
-
-    } else {
-      while (!stream->fail() && !shouldShutdown()) {
-        // Try to read some data
-        stream->read(buffer + fill, bufferSize - fill);
-        fill += stream->gcount();
-
-        while (fill) {
-          // Find end of line
-          buffer[fill] = 0; // Terminate buffer
-          char *eol = strchr(buffer, '\n');
-
-          if (eol) {
-            // Terminate line
-            char *ptr = eol;
-            *ptr-- = 0;
-            if (*ptr == '\r') *ptr = 0;
-
-            // Log the line
-            log();
-
-            // Update buffer
-            fill -= (eol - buffer) + 1;
-            if (fill) {
-              memmove(buffer, eol + 1, fill);
-              continue;
-            }
-
-          } else { // EOL not found
-            if (fill == bufferSize) {
-              // Buffer is full so just log it as is
-              log();
-              fill = 0;
-            }
-
-            break;
-          }
-        }
-
-        // Ignore end of stream but not bad/closed stream
-        if (stream->eof() && !stream->bad()) {
-          stream->clear();
-          break;
-        }
-      }
+  TailFileWatcher watcher;
+  watcher.add(SmartPointer<TailFileToLog>::Phony(this));
+
+  while (!shouldShutdown()) watcher.waitForChanges(0.25);
+}
+
+
+void TailFileToLog::open() {
+  // A partial line left in the old file will not be completed
+  if (fill) {
+    buffer[fill] = 0;
+    log(buffer);
+    fill = 0;
+  }
+
+  file = new UnixFile(filename, ios::in, 0644);
+  offset = 0;
+
+#ifndef _WIN32
+  // The name may already refer to a newer file
+  struct stat st;
+  inode = fstat(file->getFD(), &st) ? 0 : st.st_ino;
+#endif
+}
+
+
+bool TailFileToLog::reopenNeeded() const {
+#ifdef _WIN32
+  return SystemUtilities::exists(filename) &&
+    (uint64_t)SystemUtilities::getFileSize(filename) < offset;
+
+#else
+  // Keep reading the old file until a new one appears
+  struct stat st;
+  if (stat(filename.c_str(), &st)) return false;
+
+  return (uint64_t)st.st_ino != inode || (uint64_t)st.st_size < offset;
+#endif
+}
+
+
+void TailFileToLog::read() {
+  while (true) {
+    // Read as much as fits in the buffer
+    streamsize space = bufferSize - fill;
+    streamsize count = file->read(buffer + fill, space);
+    if (count <= 0) break;
+
+    fill += count;
+    offset += count;
+
+    // Log complete lines
+    char *start = buffer;
+    char *end = buffer + fill;
+
+    while (start < end) {
+      char *eol = (char *)memchr(start, '\n', end - start);
+      if (!eol) break;
+
+      // Terminate line
+      *eol = 0;
+      if (start < eol && eol[-1] == '\r') eol[-1] = 0;
+
+      log(start);
+      start = eol + 1;
     }
 
-    timer.throttle(0.25);
+    fill = end - start;
+
+    if (fill == bufferSize) {
+      // Buffer is full so just log it as is
+      buffer[fill] = 0;
+      log(buffer);
+      fill = 0;
+
+    } else if (fill && start != buffer) memmove(buffer, start, fill);
+
+    if (count < space) break; // Avoid a read() which would only see EOF
   }
 }
 
 
-void TailFileToLog::log() {
-  LOG(logDomain, logLevel, prefix + buffer);
+void TailFileToLog::log(const char *line) {
+  LOG(logDomain, logLevel, prefix + line);
 }
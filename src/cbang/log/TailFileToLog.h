@@ -37,17 +37,28 @@
 #include <cbang/log/Logger.h>
 
 #include <string>
-#include <iostream>
 
 namespace cb {
+  class UnixFile;
+
+  /**
+   * Log lines appended to a file.  Truncation and, on POSIX systems,
+   * rotation of the file are followed.
+   *
+   * Either start() the TailFileToLog as its own thread or add it to a
+   * TailFileWatcher which services many files from one thread or to an
+   * EventTailFileWatcher which services them from an Event::Base.
+   */
   class TailFileToLog : public Thread {
     const std::string filename;
     const std::string prefix;
     const char *logDomain;
     unsigned logLevel;
-    SmartPointer<std::iostream> stream;
+    SmartPointer<UnixFile> file;
+    uint64_t offset;
+    uint64_t inode;
 
-    static const unsigned bufferSize = 4096;
+    static const unsigned bufferSize = 64 * 1024;
     char buffer[bufferSize + 1]; // Room for null terminator
     unsigned fill;
 
@@ -55,14 +66,21 @@ namespace cb {
     TailFileToLog(const std::string &filename,
                   const std::string &prefix = std::string(),
                   const char *logDomain = CBANG_LOG_DOMAIN,
-                  unsigned logLevel = CBANG_LOG_INFO_LEVEL(1)) :
-      filename(filename), prefix(prefix), logDomain(logDomain),
-      logLevel(logLevel), fill(0) {}
+                  unsigned logLevel = CBANG_LOG_INFO_LEVEL(1));
+    ~TailFileToLog();
+
+    const std::string &getFilename() const {return filename;}
+
+    /// Read and log any new data.  Called by TailFileWatcher.
+    void update();
 
   protected:
     // From Thread
     void run();
 
-    void log();
+    void open();
+    bool reopenNeeded() const;
+    void read();
+    virtual void log(const char *line);
   };
 }
@@ -0,0 +1,240 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "TailFileWatcher.h"
+
+#include <cbang/Exception.h>
+#include <cbang/log/Logger.h>
+#include <cbang/os/SysError.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/util/SmartLock.h>
+#include <cbang/time/Timer.h>
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace cb;
+
+
+#define DIR_EVENTS (IN_CREATE | IN_MOVED_TO | IN_ONLYDIR)
+#define FILE_EVENTS (IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)
+
+
+TailFileWatcher::TailFileWatcher(double pollInterval) :
+  pollInterval(pollInterval), lastPoll(0), fd(-1) {
+#ifdef __linux__
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd == -1) LOG_WARNING("inotify unavailable, polling files: "
+                            << SysError());
+#endif
+}
+
+
+TailFileWatcher::~TailFileWatcher() {
+#ifdef __linux__
+  if (fd != -1) close(fd);
+#endif
+}
+
+
+void TailFileWatcher::add(const SmartPointer<TailFileToLog> &tail) {
+  SmartLock lock(this);
+
+  tails.push_back(tail);
+  watch(*tail);
+  tail->update();
+}
+
+
+void TailFileWatcher::remove(const SmartPointer<TailFileToLog> &tail) {
+  SmartLock lock(this);
+
+  unwatch(*tail);
+  tails.erase(std::remove(tails.begin(), tails.end(), tail), tails.end());
+}
+
+
+void TailFileWatcher::waitForChanges(double timeout) {
+#ifdef __linux__
+  if (fd != -1) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (0 < ::poll(&pfd, 1, timeout * 1000) && (pfd.revents & POLLIN))
+      process();
+
+  } else
+#endif
+    Timer::sleep(timeout);
+
+  if (pollInterval <= Timer::now() - lastPoll) poll();
+}
+
+
+void TailFileWatcher::process() {
+#ifdef __linux__
+  SmartLock lock(this);
+
+  set<TailFileToLog *> changed;
+  set<TailFileToLog *> created;
+  bool overflow = false;
+
+  char buf[16 * 1024]
+    __attribute__((aligned(__alignof__(struct inotify_event))));
+
+  while (true) {
+    ssize_t len = ::read(fd, buf, sizeof(buf));
+    if (len <= 0) break;
+
+    for (char *ptr = buf; ptr < buf + len;) {
+      const struct inotify_event *event = (const struct inotify_event *)ptr;
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) overflow = true;
+
+      watches_t::iterator it = fileWatches.find(event->wd);
+      if (it != fileWatches.end()) {
+        changed.insert(it->second.begin(), it->second.end());
+
+        // The file was deleted or its file system unmounted
+        if (event->mask & IN_IGNORED) {
+          polled.insert(it->second.begin(), it->second.end());
+          fileWatches.erase(it);
+        }
+      }
+
+      it = dirWatches.find(event->wd);
+      if (it != dirWatches.end() && event->len)
+        for (unsigned i = 0; i < it->second.size(); i++) {
+          TailFileToLog *tail = it->second[i];
+          if (SystemUtilities::basename(tail->getFilename()) == event->name)
+            created.insert(tail);
+        }
+    }
+  }
+
+  // Watch files which were created or replaced
+  for (set<TailFileToLog *>::iterator it = created.begin();
+       it != created.end(); it++) {
+    watch(**it);
+    changed.insert(*it);
+  }
+
+  for (set<TailFileToLog *>::iterator it = changed.begin();
+       it != changed.end(); it++)
+    (*it)->update();
+
+  if (overflow) poll(true);
+#endif
+}
+
+
+void TailFileWatcher::poll(bool all) {
+  SmartLock lock(this);
+
+  lastPoll = Timer::now();
+
+  for (unsigned i = 0; i < tails.size(); i++) {
+    TailFileToLog *tail = tails[i].get();
+    if (!all && !polled.count(tail)) continue;
+
+    // Files may have appeared since they were last watched
+    if (fd != -1 && polled.count(tail)) watch(*tail);
+    tail->update();
+  }
+}
+
+
+void TailFileWatcher::watch(TailFileToLog &tail) {
+  polled.insert(&tail);
+
+#ifdef __linux__
+  if (fd == -1) return;
+
+  const string &path = tail.getFilename();
+  string dir = SystemUtilities::dirname(path);
+  if (dir.empty()) dir = ".";
+
+  // The directory reports creation and rotation of the file
+  int wd = inotify_add_watch(fd, dir.c_str(), DIR_EVENTS);
+  if (wd == -1) return;
+
+  vector<TailFileToLog *> &dirTails = dirWatches[wd];
+  if (find(dirTails.begin(), dirTails.end(), &tail) == dirTails.end())
+    dirTails.push_back(&tail);
+
+  // The file itself reports writes, even through other links to it
+  wd = inotify_add_watch(fd, path.c_str(), FILE_EVENTS);
+  if (wd == -1) return;
+
+  vector<TailFileToLog *> &fileTails = fileWatches[wd];
+  if (find(fileTails.begin(), fileTails.end(), &tail) == fileTails.end())
+    fileTails.push_back(&tail);
+
+  polled.erase(&tail);
+#endif
+}
+
+
+void TailFileWatcher::unwatch(TailFileToLog &tail) {
+  polled.erase(&tail);
+
+  watches_t *watches[] = {&fileWatches, &dirWatches};
+
+  for (unsigned i = 0; i < 2; i++)
+    for (watches_t::iterator it = watches[i]->begin();
+         it != watches[i]->end();) {
+      vector<TailFileToLog *> &v = it->second;
+      v.erase(std::remove(v.begin(), v.end(), &tail), v.end());
+
+      if (v.empty()) {
+#ifdef __linux__
+        inotify_rm_watch(fd, it->first);
+#endif
+        watches[i]->erase(it++);
+
+      } else it++;
+    }
+}
+
+
+void TailFileWatcher::run() {
+  while (!shouldShutdown()) waitForChanges(pollInterval);
+}
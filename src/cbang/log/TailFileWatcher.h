@@ -0,0 +1,93 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "TailFileToLog.h"
+
+#include <cbang/SmartPointer.h>
+#include <cbang/os/Thread.h>
+#include <cbang/os/Mutex.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+
+namespace cb {
+  /**
+   * Services many TailFileToLog instances from one thread.  See
+   * EventTailFileWatcher to service them from an Event::Base instead.
+   * On Linux files are watched with inotify and only read after they
+   * change.  Elsewhere, or for files whose directory cannot be watched yet,
+   * files are polled.
+   */
+  class TailFileWatcher : public Thread, public Mutex {
+    typedef std::vector<SmartPointer<TailFileToLog> > tails_t;
+    tails_t tails;
+
+    double pollInterval;
+    double lastPoll;
+
+    int fd;
+    typedef std::map<int, std::vector<TailFileToLog *> > watches_t;
+    watches_t fileWatches;
+    watches_t dirWatches;
+    std::set<TailFileToLog *> polled;
+
+  public:
+    TailFileWatcher(double pollInterval = 0.25);
+    virtual ~TailFileWatcher();
+
+    double getPollInterval() const {return pollInterval;}
+    /// @return The inotify descriptor or -1 if files are only polled
+    int getFD() const {return fd;}
+
+    void add(const SmartPointer<TailFileToLog> &tail);
+    void remove(const SmartPointer<TailFileToLog> &tail);
+
+    /// Wait up to @param timeout seconds for changes and process them
+    void waitForChanges(double timeout);
+    /// Process pending change notifications without blocking
+    void process();
+    /// Update files which are not watched
+    void poll(bool all = false);
+
+  protected:
+    void watch(TailFileToLog &tail);
+    void unwatch(TailFileToLog &tail);
+
+    // From Thread
+    void run();
+  };
+}
@@ -33,14 +33,279 @@
 #include "Base64.h"
 
 #include <cbang/Exception.h>
+#include <cbang/os/CPUID.h>
 
-#include <locale>
+#include <cctype>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BASE64_SIMD
+#define TARGET(x) __attribute__((target(x)))
+#include <immintrin.h>
+
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define BASE64_SIMD
+#define TARGET(x)
+#include <immintrin.h>
+#endif
 
 
 using namespace std;
 using namespace cb;
 
 
+namespace {
+  // Kernels return the number of input bytes consumed.  Encoders consume
+  // whole multiples of 12 bytes and decoders whole multiples of 16 chars
+  // and stop at the first block containing anything other than the 64
+  // symbols, leaving whitespace, padding and errors to the scalar code.
+  typedef unsigned (*encode_kernel_t)(const uint8_t *s, unsigned length,
+                                      char *out, char a, char b);
+  typedef unsigned (*decode_kernel_t)(const char *s, unsigned length,
+                                      char *out, char a, char b);
+
+#ifdef BASE64_SIMD
+  TARGET("ssse3") inline __m128i encodeIndices(__m128i in) {
+    // Spread 12 bytes to 16 lanes of 6 bits
+    in = _mm_shuffle_epi8
+      (in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+    __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+    return _mm_or_si128(t1, t3);
+  }
+
+
+  TARGET("ssse3") inline __m128i encodeLUT(char a, char b) {
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, (char)(a - 62), (char)(b - 63), 'A', 0, 0);
+  }
+
+
+  TARGET("ssse3") inline __m128i encodeChars(__m128i indices, __m128i lut) {
+    // Map 0-25 -> 13, 26-51 -> 0, 52-61 -> 1-10, 62 -> 11, 63 -> 12
+    __m128i x = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    x = _mm_or_si128(x, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+    return _mm_add_epi8(_mm_shuffle_epi8(lut, x), indices);
+  }
+
+
+  TARGET("ssse3")
+  unsigned encodeSSSE3(const uint8_t *s, unsigned length, char *out, char a,
+                       char b) {
+    const uint8_t *start = s;
+    __m128i lut = encodeLUT(a, b);
+
+    for (; 16 <= length; length -= 12, s += 12, out += 16) {
+      __m128i in = _mm_loadu_si128((const __m128i *)s);
+      __m128i chars = encodeChars(encodeIndices(in), lut);
+      _mm_storeu_si128((__m128i *)out, chars);
+    }
+
+    return s - start;
+  }
+
+
+  TARGET("avx2") inline __m256i broadcast(__m128i x) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(x), x, 1);
+  }
+
+
+  TARGET("avx2")
+  unsigned encodeAVX2(const uint8_t *s, unsigned length, char *out, char a,
+                      char b) {
+    const uint8_t *start = s;
+    const __m256i lut = broadcast(encodeLUT(a, b));
+    const __m256i shuf = broadcast
+      (_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+    for (; 28 <= length; length -= 24, s += 24, out += 32) {
+      __m256i in = _mm256_inserti128_si256
+        (_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)s)),
+         _mm_loadu_si128((const __m128i *)(s + 12)), 1);
+
+      in = _mm256_shuffle_epi8(in, shuf);
+
+      __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+      __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+      __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+      __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+      __m256i indices = _mm256_or_si256(t1, t3);
+
+      __m256i x = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+      __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+      x = _mm256_or_si256(x, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+      x = _mm256_add_epi8(_mm256_shuffle_epi8(lut, x), indices);
+
+      _mm256_storeu_si256((__m256i *)out, x);
+    }
+
+    // Finish any remaining whole blocks with SSSE3
+    return (s - start) + encodeSSSE3(s, length, out, a, b);
+  }
+
+
+  TARGET("ssse3") inline __m128i inRange(__m128i x, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), x));
+  }
+
+
+  TARGET("ssse3")
+  unsigned decodeSSSE3(const char *s, unsigned length, char *out, char a,
+                       char b) {
+    const char *start = s;
+
+    for (; 16 <= length; length -= 16, s += 16, out += 12) {
+      __m128i in = _mm_loadu_si128((const __m128i *)s);
+
+      __m128i upper = inRange(in, 'A', 'Z');
+      __m128i lower = inRange(in, 'a', 'z');
+      __m128i digit = inRange(in, '0', '9');
+      __m128i is62 = _mm_cmpeq_epi8(in, _mm_set1_epi8(a));
+      __m128i is63 = _mm_cmpeq_epi8(in, _mm_set1_epi8(b));
+
+      __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                   _mm_or_si128(digit, _mm_or_si128
+                                                (is62, is63)));
+      if (_mm_movemask_epi8(valid) != 0xffff) break;
+
+      __m128i offset =
+        _mm_or_si128(_mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)),
+                                  _mm_and_si128(lower, _mm_set1_epi8(-71))),
+                     _mm_and_si128(digit, _mm_set1_epi8(4)));
+      __m128i special =
+        _mm_or_si128(_mm_and_si128(is62, _mm_set1_epi8(62)),
+                     _mm_and_si128(is63, _mm_set1_epi8(63)));
+      __m128i values =
+        _mm_or_si128(_mm_andnot_si128(_mm_or_si128(is62, is63),
+                                      _mm_add_epi8(in, offset)), special);
+
+      // Pack 4 x 6 bits to 3 bytes
+      __m128i merged =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+      merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+      merged = _mm_shuffle_epi8
+        (merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                               -1, -1, -1, -1));
+
+      _mm_storel_epi64((__m128i *)out, merged);
+      uint32_t last = _mm_cvtsi128_si32(_mm_srli_si128(merged, 8));
+      memcpy(out + 8, &last, 4);
+    }
+
+    return s - start;
+  }
+
+
+  TARGET("avx2") inline __m256i inRange(__m256i x, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(lo - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), x));
+  }
+
+
+  TARGET("avx2")
+  unsigned decodeAVX2(const char *s, unsigned length, char *out, char a,
+                      char b) {
+    const char *start = s;
+    const __m256i shuf = broadcast
+      (_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    for (; 32 <= length; length -= 32, s += 32, out += 24) {
+      __m256i in = _mm256_loadu_si256((const __m256i *)s);
+
+      __m256i upper = inRange(in, 'A', 'Z');
+      __m256i lower = inRange(in, 'a', 'z');
+      __m256i digit = inRange(in, '0', '9');
+      __m256i is62 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(a));
+      __m256i is63 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(b));
+      __m256i special = _mm256_or_si256(is62, is63);
+
+      __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                      _mm256_or_si256(digit, special));
+      if (_mm256_movemask_epi8(valid) != -1) break;
+
+      __m256i offset = _mm256_or_si256
+        (_mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)),
+                         _mm256_and_si256(lower, _mm256_set1_epi8(-71))),
+         _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+      __m256i values = _mm256_or_si256
+        (_mm256_andnot_si256(special, _mm256_add_epi8(in, offset)),
+         _mm256_or_si256(_mm256_and_si256(is62, _mm256_set1_epi8(62)),
+                         _mm256_and_si256(is63, _mm256_set1_epi8(63))));
+
+      __m256i merged =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+      merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+      merged = _mm256_shuffle_epi8(merged, shuf);
+      merged = _mm256_permutevar8x32_epi32(merged, perm);
+
+      _mm_storeu_si128((__m128i *)out, _mm256_castsi256_si128(merged));
+      _mm_storel_epi64((__m128i *)(out + 16),
+                       _mm256_extracti128_si256(merged, 1));
+    }
+
+    return (s - start) + decodeSSSE3(s, length, out, a, b);
+  }
+
+
+  bool osHasAVX() {
+    CPUID cpuid;
+    if (!cpuid.cpuHasFeature(CPUFeature::FEATURE_OSXSAVE) ||
+        !cpuid.cpuHasFeature(CPUFeature::FEATURE_AVX)) return false;
+
+    // Check that the OS saves the YMM registers
+#ifdef _MSC_VER
+    return (_xgetbv(0) & 6) == 6;
+#else
+    uint32_t eax, edx;
+    asm volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return (eax & 6) == 6;
+#endif
+  }
+#endif // BASE64_SIMD
+
+
+  struct Kernels {
+    const char *name;
+    encode_kernel_t encode;
+    decode_kernel_t decode;
+
+    Kernels() : name("scalar"), encode(0), decode(0) {
+#ifdef BASE64_SIMD
+      CPUID cpuid;
+
+      if (cpuid.cpuHasFeature(CPUFeature::FEATURE_SSSE3)) {
+        name = "ssse3";
+        encode = encodeSSSE3;
+        decode = decodeSSSE3;
+      }
+
+      if (cpuid.cpuHasExtendedFeature(CPUExtendedFeature::FEATURE_AVX2) &&
+          osHasAVX()) {
+        name = "avx2";
+        encode = encodeAVX2;
+        decode = decodeAVX2;
+      }
+#endif // BASE64_SIMD
+    }
+  };
+
+
+  const Kernels &kernels() {
+    static Kernels kernels;
+    return kernels;
+  }
+}
+
+
 const char *Base64::encodeTable =
   "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
 
@@ -69,78 +334,167 @@ string Base64::encode(const string &s) const {
 }
 
 
-string Base64::encode(const char *_s, unsigned length) const {
-  const uint8_t *s = (uint8_t *)_s;
-  const uint8_t *end = s + length;
-  string result;
-  unsigned size = length / 3 * 4 + 4; // Not exact
-  if (width) size += (size / width) * 2;
-  result.reserve(size);
+string Base64::encode(const char *s, unsigned length) const {
+  const char *end = s + length;
+  unsigned size = (length + 2) / 3 * 4;
+  unsigned line = width % 4 ? 0 : width;
+  if (line && size) size += (size - 1) / line * 2;
 
-  unsigned col = 0;
-  int padding = 0;
-  uint8_t a, b, c;
-  while (s != end) {
-    a = *s++;
-    if (s == end) {c = b = 0; padding = 2;}
-    else {
-      b = *s++;
-      if (s == end) {c = 0; padding = 1;}
-      else c = *s++;
-    }
+  string result(size, 0);
+  char *out = &result[0];
 
-    result += encode(63 & (a >> 2));
-    result += encode(63 & (a << 4 | b >> 4));
-    if (pad && padding == 2) result += pad;
-    else result += encode(63 & (b << 2 | c >> 6));
-    if (pad && padding) result += pad;
-    else result += encode(63 & c);
-
-    if (s != end && width) {
-      col += 4;
-      if (col == width) {
-        col = 0;
-        result += "\r\n";
-      }
+  if (line) {
+    unsigned lineBytes = line / 4 * 3;
+
+    while (lineBytes < (unsigned)(end - s)) {
+      out = encodeBlock(s, lineBytes, out);
+      s += lineBytes;
+      *out++ = '\r';
+      *out++ = '\n';
     }
   }
 
+  out = encodeBlock(s, end - s, out);
+  s += (end - s) / 3 * 3;
+  encodeFinal(s, end - s, out);
+
   return result;
 }
 
 
 string Base64::decode(const string &s) const {
-  string result;
-  result.reserve(s.length() / 4 * 3 + 1);
+  return decode(s.data(), s.length());
+}
+
+
+string Base64::decode(const char *s, unsigned length) const {
+  string result((length + 3) / 4 * 3, 0);
+
+  char quad[4];
+  unsigned count = 0;
+  char *out = decodeBlock(s, s + length, &result[0], quad, count);
+  out = decodeFinal(quad, count, out);
+
+  result.resize(out - result.data());
+
+  return result;
+}
+
+
+char *Base64::encodeBlock(const char *_s, unsigned length, char *out) const {
+  const uint8_t *s = (const uint8_t *)_s;
+  const uint8_t *end = s + length / 3 * 3;
+
+  encode_kernel_t kernel = kernels().encode;
+  if (kernel) {
+    unsigned n = kernel(s, end - s, out, a, b);
+    s += n;
+    out += n / 3 * 4;
+  }
+
+  char table[64];
+  for (unsigned i = 0; i < 62; i++) table[i] = encodeTable[i];
+  table[62] = a;
+  table[63] = b;
+
+  for (; s != end; s += 3) {
+    uint32_t x = (uint32_t)s[0] << 16 | (uint32_t)s[1] << 8 | s[2];
+    *out++ = table[x >> 18];
+    *out++ = table[63 & x >> 12];
+    *out++ = table[63 & x >> 6];
+    *out++ = table[63 & x];
+  }
+
+  return out;
+}
+
+
+char *Base64::encodeFinal(const char *s, unsigned length, char *out) const {
+  if (!length) return out;
+
+  uint8_t x = s[0];
+  uint8_t y = 1 < length ? s[1] : 0;
+
+  *out++ = encode(63 & (x >> 2));
+  *out++ = encode(63 & (x << 4 | y >> 4));
+  *out++ = pad && length == 1 ? pad : encode(63 & (y << 2));
+  *out++ = pad ? pad : encode(0);
+
+  return out;
+}
 
-  string::const_iterator it = s.begin();
-  while (it != s.end() && isspace(*it)) it++;
 
-  while (it != s.end()) {
-    char w = decode(next(it, s.end()));
-    char x = it == s.end() ? -2 : decode(next(it, s.end()));
-    char y = it == s.end() ? -2 : decode(next(it, s.end()));
-    char z = it == s.end() ? -2 : decode(next(it, s.end()));
+char *Base64::decodeBlock(const char *s, const char *end, char *out,
+                          char quad[4], unsigned &count) const {
+  decode_kernel_t kernel = kernels().decode;
 
-    if (w == -2 || x == -2 || w == -1 || x == -1 || y == -1 || z == -1)
-      THROW("Invalid Base64 data at " << (it - s.begin()));
+  // The kernels only know the 64 symbols, the rest is handled below
+  if (isalnum(a) || isalnum(b) || a == b || (pad && (pad == a || pad == b)))
+    kernel = 0;
+
+  while (s != end) {
+    if (!count) {
+      if (kernel) {
+        unsigned n = kernel(s, end - s, out, a, b);
+        s += n;
+        out += n / 4 * 3;
+      }
+
+      while (4 <= end - s) {
+        int w = decode(s[0]);
+        int x = decode(s[1]);
+        int y = decode(s[2]);
+        int z = decode(s[3]);
+        if ((w | x | y | z) < 0) break;
+
+        *out++ = (char)(w << 2 | x >> 4);
+        *out++ = (char)(x << 4 | y >> 2);
+        *out++ = (char)(y << 6 | z);
+        s += 4;
+      }
 
-    result += (char)(w << 2 | x >> 4);
-    if (y != -2) {
-      result += (char)(x << 4 | y >> 2);
-      if (z != -2) result += (char)(y << 6 | z);
+      if (s == end) break;
+    }
+
+    char c = *s++;
+    if (isspace((unsigned char)c)) continue;
+
+    quad[count++] = c;
+    if (count == 4) {
+      out = decodeQuad(quad, 4, out);
+      count = 0;
     }
   }
 
-  return result;
+  return out;
+}
+
+
+char *Base64::decodeFinal(const char quad[4], unsigned count,
+                          char *out) const {
+  return count ? decodeQuad(quad, count, out) : out;
 }
 
 
-char Base64::next(string::const_iterator &it,
-                  string::const_iterator end) {
-  char c = *it++;
-  while (it != end && isspace(*it)) it++;
-  return c;
+const char *Base64::getAcceleration() {return kernels().name;}
+
+
+char *Base64::decodeQuad(const char *quad, unsigned count, char *out) const {
+  int w = decode(quad[0]);
+  int x = 1 < count ? decode(quad[1]) : -2;
+  int y = 2 < count ? decode(quad[2]) : -2;
+  int z = 3 < count ? decode(quad[3]) : -2;
+
+  if (w < 0 || x < 0 || y == -1 || z == -1)
+    THROW("Invalid Base64 data '" << string(quad, count) << "'");
+
+  *out++ = (char)(w << 2 | x >> 4);
+  if (y != -2) {
+    *out++ = (char)(x << 4 | y >> 2);
+    if (z != -2) *out++ = (char)(y << 6 | z);
+  }
+
+  return out;
 }
 
 
@@ -155,5 +509,5 @@ int Base64::decode(char x) const {
   if (x == a) return 62;
   if (x == b) return 63;
   if (x == pad) return -2;
-  return decodeTable[(int)x];
+  return decodeTable[(uint8_t)x];
 }
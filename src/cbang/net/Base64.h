@@ -48,16 +48,40 @@ namespace cb {
     static const signed char decodeTable[256];
 
   public:
+    /// Output is wrapped in lines of @param width chars.  Lines hold whole
+    /// 4 char groups so a width which is not a multiple of 4 disables
+    /// wrapping.
     Base64(char pad = '=', char a = '+', char b = '/', unsigned width = 0) :
       pad(pad), a(a), b(b), width(width) {}
 
+    char getPad() const {return pad;}
+    unsigned getWidth() const {return width;}
+
     std::string encode(const std::string &s) const;
     std::string encode(const char *s, unsigned length) const;
     std::string decode(const std::string &s) const;
+    std::string decode(const char *s, unsigned length) const;
+
+    /// Encode the leading whole 3 byte groups of @param s without line
+    /// wrapping.  Writes length / 3 * 4 chars and returns the output end.
+    char *encodeBlock(const char *s, unsigned length, char *out) const;
+    /// Encode the last 1 or 2 bytes of a stream.  Always writes 4 chars.
+    char *encodeFinal(const char *s, unsigned length, char *out) const;
+
+    /// Decode as much of [s, end) as possible.  Whitespace is skipped and
+    /// an incomplete group of up to 3 chars is held in @param quad and
+    /// @param count for the next call.  Output must have room for
+    /// (count + (end - s)) / 4 * 3 bytes.  Returns the output end.
+    char *decodeBlock(const char *s, const char *end, char *out, char quad[4],
+                      unsigned &count) const;
+    /// Decode a final incomplete group left by decodeBlock().
+    char *decodeFinal(const char quad[4], unsigned count, char *out) const;
+
+    /// Returns the name of the encode/decode kernel selected for this CPU
+    static const char *getAcceleration();
 
   protected:
-    static char next(std::string::const_iterator &it,
-                     std::string::const_iterator end);
+    char *decodeQuad(const char *quad, unsigned count, char *out) const;
     char encode(int x) const;
     int decode(char x) const;
   };
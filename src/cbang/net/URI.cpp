@@ -31,6 +31,7 @@
 \******************************************************************************/
 
 #include "URI.h"
+#include "URIView.h"
 
 #include <cbang/String.h>
 #include <cbang/Exception.h>
@@ -108,6 +109,11 @@ URI::URI(const char *uri) : port(0) {
 }
 
 
+URI::URI(const URIView &uri) : port(0) {
+  read(uri);
+}
+
+
 unsigned URI::getPort() const {
   if (port || scheme.empty()) return port;
 
@@ -206,29 +212,25 @@ void URI::read(const string &uri) {
 
 
 void URI::read(const char *uri) {
-  // See RFC2396
-  // Does not support:
-  //   opaque URI data (Section 3)
-  //   registry-based naming (Section 3.2.1)
-  //   path parameters (Section 3.3)
+  read(URIView(uri));
+}
+
 
+void URI::read(const URIView &uri) {
   clear(); // Reset all
 
-  const char *s = uri;
-  try {
-    if (!*s) THROW("Cannot be empty");
+  scheme = uri.getScheme().raw();
+  host = uri.getHost().raw();
+  port = uri.getPort();
+  user = uri.getUser().toString();
+  pass = uri.getPass().toString();
 
-    if (*s == '/') parseAbsPath(s);
-    else {
-      parseScheme(s);
-      parseNetPath(s);
-    }
-    if (consume(s, '?')) parseQuery(s);
+  for (URIView::SegmentIterator it(uri.getPath()); it.next();)
+    pathSegs.push_back(it.get().toString());
+  if (!uri.getPath().empty()) path = "/" + String::join(pathSegs, "/");
 
-  } catch (const Exception &e) {
-    THROW("Failed to parse URI '" << String::escapeC(uri) << "' at char "
-           << (s - uri) << ": " << e.getMessage());
-  }
+  for (URIView::QueryIterator it(uri.getQuery()); it.next();)
+    set(it.getName().toString(), it.getValue().toString());
 }
 
 
@@ -309,102 +311,6 @@ char URI::parseEscape(const char *&s) {
 }
 
 
-void URI::parseAbsPath(const char *&s) {
-  match(s, '/');
-
-  do {
-    parsePathSegment(s);
-  } while (consume(s, '/'));
-
-  // TODO This fails for encoded / i.e. %2f
-  path = "/" + String::join(pathSegs, "/");
-}
-
-
-void URI::parsePathSegment(const char *&s) {
-  string seg;
-
-  while (true)
-    if (contains(PATH_SEGMENT_CHARS, *s)) seg.append(1, *s++);
-    else if (*s == '%') seg.append(1, parseEscape(s));
-    else break;
-
-  pathSegs.push_back(seg);
-}
-
-
-void URI::parseScheme(const char *&s) {
-  if (!isalpha(*s)) THROW("Expected alpha at start of scheme");
-
-  while (true)
-    if (contains(SCHEME_CHARS, *s)) scheme.append(1, *s++);
-    else break;
-
-  match(s, ':');
-}
-
-
-void URI::parseNetPath(const char *&s) {
-  match(s, '/');
-  consume(s, '/');
-  parseAuthority(s);
-  if (*s == '/') parseAbsPath(s);
-}
-
-
-void URI::parseAuthority(const char *&s) {
-  // Try parsing user info
-  const char *save = s;
-  parseUserInfo(s);
-  if (!consume(s, '@')) {
-    // Backtrack, wasn't user info
-    s = save;
-    user.clear();
-    pass.clear();
-  }
-
-  parseHost(s);
-  if (consume(s, ':')) parsePort(s);
-}
-
-
-string URI::parseUserPass(const char *&s) {
-  string result;
-
-  while (true)
-    if (contains(USER_PASS_CHARS, *s)) result.append(1, *s++);
-    else if (*s == '%') result.append(1, parseEscape(s));
-    else break;
-
-  return result;
-}
-
-
-void URI::parseUserInfo(const char *&s) {
-  user = parseUserPass(s);
-  if (consume(s, ':')) pass = parseUserPass(s);
-}
-
-
-void URI::parseHost(const char *&s) {
-  while (true)
-    if (contains(HOST_CHARS, *s)) host.append(1, *s++);
-    else break;
-
-  if (host.empty()) THROW("Expected host character");
-}
-
-
-void URI::parsePort(const char *&s) {
-  string result;
-
-  while (isdigit(*s)) result.append(1, *s++);
-
-  if (result.empty()) return;
-  port = String::parseU32(result);
-}
-
-
 void URI::parseQuery(const char *&s) {
   if (!*s) return; // Empty query
   parsePair(s);
@@ -39,6 +39,8 @@
 
 
 namespace cb {
+  class URIView;
+
   class URI : public StringMap {
   protected:
     std::string scheme;
@@ -55,6 +57,7 @@ namespace cb {
     URI();
     URI(const std::string &uri);
     URI(const char *uri);
+    URI(const URIView &uri);
 
     const std::string &getScheme() const {return scheme;}
     const std::string &getHost() const {return host;}
@@ -81,6 +84,7 @@ namespace cb {
 
     void read(const std::string &s);
     void read(const char *s);
+    void read(const URIView &uri);
     std::ostream &write(std::ostream &stream) const;
     std::ostream &writeQuery(std::ostream &stream) const;
 
@@ -93,15 +97,6 @@ namespace cb {
 
   protected:
     char parseEscape(const char *&s);
-    void parseAbsPath(const char *&s);
-    void parsePathSegment(const char *&s);
-    void parseScheme(const char *&s);
-    void parseNetPath(const char *&s);
-    void parseAuthority(const char *&s);
-    std::string parseUserPass(const char *&s);
-    void parseUserInfo(const char *&s);
-    void parseHost(const char *&s);
-    void parsePort(const char *&s);
     void parseQuery(const char *&s);
     void parsePair(const char *&s);
     std::string parseName(const char *&s);
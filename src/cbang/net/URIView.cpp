@@ -0,0 +1,443 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "URIView.h"
+
+#include <cbang/String.h>
+#include <cbang/Exception.h>
+
+#include <ctype.h>
+#include <string.h>
+
+using namespace cb;
+using namespace std;
+
+
+#define DIGIT_CHARS        "1234567890"
+#define LOWER_CHARS        "abcdefghijklmnopqrstuvwxyz"
+#define UPPER_CHARS        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+#define ALPHA_CHARS        LOWER_CHARS UPPER_CHARS
+#define ALPHANUMERIC_CHARS ALPHA_CHARS DIGIT_CHARS
+#define UNRESERVED_CHARS   ALPHANUMERIC_CHARS "-_.!~*'()"
+#define USER_PASS_CHARS    UNRESERVED_CHARS ";&=+$,"
+#define NAME_CHARS         UNRESERVED_CHARS ";/?:@+$,"
+#define VALUE_CHARS        NAME_CHARS "="
+#define PATH_SEGMENT_CHARS UNRESERVED_CHARS ":@&=+$,"
+#define HOST_CHARS         ALPHANUMERIC_CHARS "-."
+#define SCHEME_CHARS       ALPHANUMERIC_CHARS "+-."
+
+
+namespace {
+  enum {
+    SCHEME       = 1 << 0,
+    HOST         = 1 << 1,
+    PATH_SEGMENT = 1 << 2,
+    USER_PASS    = 1 << 3,
+    NAME         = 1 << 4,
+    VALUE        = 1 << 5,
+  };
+
+
+  struct CharClasses {
+    uint8_t table[256];
+
+    CharClasses() {
+      memset(table, 0, sizeof(table));
+      add(SCHEME_CHARS, SCHEME);
+      add(HOST_CHARS, HOST);
+      add(PATH_SEGMENT_CHARS, PATH_SEGMENT);
+      add(USER_PASS_CHARS, USER_PASS);
+      add(NAME_CHARS, NAME);
+      add(VALUE_CHARS, VALUE);
+    }
+
+
+    void add(const char *s, unsigned charClass) {
+      while (*s) table[(uint8_t)*s++] |= charClass;
+    }
+  };
+
+
+  const CharClasses charClasses;
+
+
+  bool is(const char *s, const char *end, unsigned charClass) {
+    return s != end && (charClasses.table[(uint8_t)*s] & charClass);
+  }
+
+
+  bool consume(const char *&s, const char *end, char c) {
+    if (s == end || *s != c) return false;
+    s++;
+    return true;
+  }
+
+
+  void match(const char *&s, const char *end, char c) {
+    if (!consume(s, end, c)) THROW("Expected '" << c << "'");
+  }
+
+
+  int hexToInt(char x) {
+    return isdigit(x) ? x - '0' : ((islower(x) ? x - 'a' : x - 'A') + 10);
+  }
+
+
+  bool isEscape(const char *s, const char *end) {
+    return s + 2 < end && s[0] == '%' && isxdigit(s[1]) && isxdigit(s[2]);
+  }
+
+
+  char nextChar(const char *&s, const char *end) {
+    if (isEscape(s, end)) {
+      char c = (char)((hexToInt(s[1]) << 4) + hexToInt(s[2]));
+      s += 3;
+      return c;
+    }
+
+    return *s++;
+  }
+
+
+  bool hasEscape(const char *s, unsigned length) {
+    return memchr(s, '%', length);
+  }
+}
+
+
+string URIView::Slice::toString() const {
+  if (!escaped) return raw();
+
+  string s;
+  decode(s);
+  return s;
+}
+
+
+void URIView::Slice::decode(string &s) const {
+  if (!escaped) {
+    s.append(ptr, length);
+    return;
+  }
+
+  const char *end = ptr + length;
+  for (const char *p = ptr; p != end;) s.append(1, nextChar(p, end));
+}
+
+
+bool URIView::Slice::equals(const char *s, unsigned length) const {
+  if (!escaped)
+    return length == this->length && !memcmp(s, ptr, length);
+
+  const char *end = ptr + this->length;
+  const char *p = ptr;
+  unsigned i = 0;
+
+  for (; p != end && i < length; i++)
+    if (nextChar(p, end) != s[i]) return false;
+
+  return p == end && i == length;
+}
+
+
+bool URIView::Slice::operator==(const char *s) const {
+  return equals(s, strlen(s));
+}
+
+
+URIView::SegmentIterator::SegmentIterator(const Slice &path) :
+  ptr(path.data()), end(path.data() + path.size()) {
+  if (ptr != end && *ptr == '/') ptr++;
+  else ptr = 0;
+}
+
+
+bool URIView::SegmentIterator::next() {
+  if (!ptr) return false;
+
+  const char *start = ptr;
+  while (ptr != end && *ptr != '/') ptr++;
+
+  unsigned length = ptr - start;
+  segment = Slice(start, length, hasEscape(start, length));
+
+  if (ptr == end) ptr = 0;
+  else ptr++;
+
+  return true;
+}
+
+
+URIView::QueryIterator::QueryIterator(const Slice &query) :
+  ptr(query.data()), end(query.data() + query.size()) {}
+
+
+bool URIView::QueryIterator::next() {
+  if (ptr == end) return false;
+
+  const char *start = ptr;
+  const char *equal = 0;
+
+  for (; ptr != end && *ptr != '&'; ptr++)
+    if (*ptr == '=' && !equal) equal = ptr;
+
+  if (equal) {
+    unsigned length = ptr - (equal + 1);
+    name = Slice(start, equal - start, hasEscape(start, equal - start));
+    value = Slice(equal + 1, length, hasEscape(equal + 1, length));
+
+  } else {
+    name = Slice(start, ptr - start, hasEscape(start, ptr - start));
+    value = Slice(ptr, 0);
+  }
+
+  if (ptr != end) ptr++; // Skip '&'
+
+  return true;
+}
+
+
+URIView::URIView(const char *uri) : port(0) {read(uri, strlen(uri));}
+
+
+URIView::URIView(const char *uri, unsigned length) : port(0) {
+  read(uri, length);
+}
+
+
+URIView::URIView(const string &uri) : port(0) {
+  read(uri.data(), uri.length());
+}
+
+
+URIView::Slice URIView::getExtension() const {
+  const char *start = path.data();
+  const char *end = start + path.size();
+  const char *ptr = end;
+
+  while (ptr != start && ptr[-1] != '/') {
+    if (ptr[-1] == '.') {
+      unsigned length = end - ptr;
+      return Slice(ptr, length, hasEscape(ptr, length));
+    }
+
+    ptr--;
+  }
+
+  return Slice();
+}
+
+
+bool URIView::hasArg(const char *name) const {
+  for (QueryIterator it(query); it.next();)
+    if (it.getName() == name) return true;
+
+  return false;
+}
+
+
+bool URIView::getArg(const char *name, Slice &value) const {
+  // Like URI, the last occurrence wins
+  bool found = false;
+
+  for (QueryIterator it(query); it.next();)
+    if (it.getName() == name) {
+      value = it.getValue();
+      found = true;
+    }
+
+  return found;
+}
+
+
+string URIView::getArg(const char *name, const string &defaultValue) const {
+  Slice value;
+  return getArg(name, value) ? value.toString() : defaultValue;
+}
+
+
+void URIView::clear() {
+  uri = scheme = host = path = user = pass = query = Slice();
+  port = 0;
+}
+
+
+void URIView::read(const char *uri, unsigned length) {
+  // See RFC2396
+  // Does not support:
+  //   opaque URI data (Section 3)
+  //   registry-based naming (Section 3.2.1)
+  //   path parameters (Section 3.3)
+
+  clear();
+  this->uri = Slice(uri, length);
+
+  const char *s = uri;
+  const char *end = uri + length;
+
+  try {
+    if (s == end || !*s) THROW("Cannot be empty");
+
+    if (*s == '/') parseAbsPath(s, end);
+    else {
+      parseScheme(s, end);
+      parseNetPath(s, end);
+    }
+    if (consume(s, end, '?')) parseQuery(s, end);
+
+  } catch (const Exception &e) {
+    THROW("Failed to parse URI '" << String::escapeC(string(uri, length))
+           << "' at char " << (s - uri) << ": " << e.getMessage());
+  }
+}
+
+
+bool URIView::parseEscape(const char *&s, const char *end) {
+  if (!consume(s, end, '%')) return false;
+
+  for (unsigned i = 0; i < 2; i++)
+    if (s == end || !isxdigit(*s++))
+      THROW("Expected hexadecimal digit in escape sequence");
+
+  return true;
+}
+
+
+bool URIView::parseChars(const char *&s, const char *end,
+                         unsigned charClass) {
+  bool escaped = false;
+
+  while (true)
+    if (is(s, end, charClass)) s++;
+    else if (parseEscape(s, end)) escaped = true;
+    else break;
+
+  return escaped;
+}
+
+
+void URIView::parseAbsPath(const char *&s, const char *end) {
+  const char *start = s;
+  bool escaped = false;
+
+  match(s, end, '/');
+
+  do {
+    if (parseChars(s, end, PATH_SEGMENT)) escaped = true;
+  } while (consume(s, end, '/'));
+
+  path = Slice(start, s - start, escaped);
+}
+
+
+void URIView::parseScheme(const char *&s, const char *end) {
+  if (s == end || !isalpha(*s)) THROW("Expected alpha at start of scheme");
+
+  const char *start = s;
+  while (is(s, end, SCHEME)) s++;
+  scheme = Slice(start, s - start);
+
+  match(s, end, ':');
+}
+
+
+void URIView::parseNetPath(const char *&s, const char *end) {
+  match(s, end, '/');
+  consume(s, end, '/');
+  parseAuthority(s, end);
+  if (s != end && *s == '/') parseAbsPath(s, end);
+}
+
+
+void URIView::parseAuthority(const char *&s, const char *end) {
+  // Try parsing user info
+  const char *save = s;
+
+  bool escaped = parseChars(s, end, USER_PASS);
+  user = Slice(save, s - save, escaped);
+
+  if (consume(s, end, ':')) {
+    const char *start = s;
+    escaped = parseChars(s, end, USER_PASS);
+    pass = Slice(start, s - start, escaped);
+  }
+
+  if (!consume(s, end, '@')) {
+    // Backtrack, wasn't user info
+    s = save;
+    user = pass = Slice();
+  }
+
+  parseHost(s, end);
+  if (consume(s, end, ':')) parsePort(s, end);
+}
+
+
+void URIView::parseHost(const char *&s, const char *end) {
+  const char *start = s;
+  while (is(s, end, HOST)) s++;
+
+  if (s == start) THROW("Expected host character");
+  host = Slice(start, s - start);
+}
+
+
+void URIView::parsePort(const char *&s, const char *end) {
+  const char *start = s;
+  uint64_t value = 0;
+
+  for (; s != end && isdigit(*s); s++) {
+    value = value * 10 + (*s - '0');
+    if (0xffffffff < value)
+      THROW("Port '" << string(start, s - start + 1) << "' out of range");
+  }
+
+  if (s != start) port = (unsigned)value;
+}
+
+
+void URIView::parseQuery(const char *&s, const char *end) {
+  if (s == end || !*s) return; // Empty query
+
+  const char *start = s;
+  bool escaped = false;
+
+  do {
+    const char *name = s;
+    if (parseChars(s, end, NAME)) escaped = true;
+    if (s == name) THROW("Expected query name character");
+
+    if (consume(s, end, '=') && parseChars(s, end, VALUE)) escaped = true;
+  } while (consume(s, end, '&'));
+
+  query = Slice(start, s - start, escaped);
+}
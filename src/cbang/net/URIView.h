@@ -0,0 +1,160 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <ostream>
+
+
+namespace cb {
+  /**
+   * A non-owning URI parser.  Accepts the same grammar as URI but only
+   * records slices of the original buffer, which must outlive the view.
+   * Percent escapes are validated while parsing but only decoded on
+   * request.  Use URI(const URIView &) when an owned copy is needed.
+   */
+  class URIView {
+  public:
+    class Slice {
+      const char *ptr;
+      unsigned length;
+      bool escaped;
+
+    public:
+      Slice(const char *ptr = 0, unsigned length = 0, bool escaped = false) :
+        ptr(ptr), length(length), escaped(escaped) {}
+
+      const char *data() const {return ptr;}
+      unsigned size() const {return length;}
+      bool empty() const {return !length;}
+      bool isEscaped() const {return escaped;}
+
+      /// @return The slice with percent escapes left intact
+      std::string raw() const {return std::string(ptr, length);}
+      /// @return The slice with percent escapes decoded
+      std::string toString() const;
+      /// Append the decoded slice to @param s
+      void decode(std::string &s) const;
+
+      /// Compare the decoded slice to @param s without allocating
+      bool equals(const char *s, unsigned length) const;
+      bool operator==(const char *s) const;
+      bool operator==(const std::string &s) const
+      {return equals(s.data(), s.length());}
+      bool operator!=(const char *s) const {return !(*this == s);}
+      bool operator!=(const std::string &s) const {return !(*this == s);}
+    };
+
+
+    /// Iterates over the '/' separated segments of a path
+    class SegmentIterator {
+      const char *ptr;
+      const char *end;
+      Slice segment;
+
+    public:
+      SegmentIterator(const Slice &path);
+
+      bool next();
+      const Slice &get() const {return segment;}
+    };
+
+
+    /// Iterates over the name/value pairs of a query string
+    class QueryIterator {
+      const char *ptr;
+      const char *end;
+      Slice name;
+      Slice value;
+
+    public:
+      QueryIterator(const Slice &query);
+
+      bool next();
+      const Slice &getName() const {return name;}
+      const Slice &getValue() const {return value;}
+    };
+
+  protected:
+    Slice uri;
+    Slice scheme;
+    Slice host;
+    unsigned port;
+    Slice path;
+    Slice user;
+    Slice pass;
+    Slice query;
+
+  public:
+    URIView() : port(0) {}
+    URIView(const char *uri);
+    URIView(const char *uri, unsigned length);
+    URIView(const std::string &uri);
+
+    const Slice &getURI() const {return uri;}
+    const Slice &getScheme() const {return scheme;}
+    const Slice &getHost() const {return host;}
+    /// @return The explicit port or zero.  See URI::getPort() for defaults.
+    unsigned getPort() const {return port;}
+    const Slice &getPath() const {return path;}
+    Slice getExtension() const;
+    const Slice &getUser() const {return user;}
+    const Slice &getPass() const {return pass;}
+    const Slice &getQuery() const {return query;}
+
+    bool hasArg(const char *name) const;
+    bool getArg(const char *name, Slice &value) const;
+    std::string getArg(const char *name,
+                       const std::string &defaultValue = "") const;
+
+    void clear();
+    void read(const char *uri, unsigned length);
+
+  protected:
+    bool parseEscape(const char *&s, const char *end);
+    bool parseChars(const char *&s, const char *end, unsigned charClass);
+    void parseAbsPath(const char *&s, const char *end);
+    void parseScheme(const char *&s, const char *end);
+    void parseNetPath(const char *&s, const char *end);
+    void parseAuthority(const char *&s, const char *end);
+    void parseHost(const char *&s, const char *end);
+    void parsePort(const char *&s, const char *end);
+    void parseQuery(const char *&s, const char *end);
+  };
+
+
+  inline std::ostream &operator<<(std::ostream &stream,
+                                  const URIView::Slice &slice) {
+    return stream.write(slice.data(), slice.size());
+  }
+}
@@ -218,7 +218,11 @@ long BStream::ctrl(int cmd, long sub, void *arg) {
   case BIO_CTRL_DGRAM_SET_NEXT_TIMEOUT:
     cmdStr = "DGRAM_SET_NEXT_TIMEOUT"; break;
 #endif
-  default: cmdStr = "UNKNOWN"; break;
+  default:
+    // Unsupported.  Claiming success for queries such as
+    // BIO_CTRL_GET_KTLS_SEND would change how OpenSSL writes records.
+    LOG_DEBUG(5, "BStream::ctrl(UNKNOWN=" << cmd << ", " << sub << ")");
+    return 0;
   }
 
   LOG_DEBUG(5, "BStream::ctrl(" << cmdStr << '=' << cmd << ", " << sub << ")");
@@ -44,6 +44,13 @@ using namespace std;
 using namespace cb;
 
 
+#ifndef EVP_CTRL_AEAD_SET_IVLEN
+#define EVP_CTRL_AEAD_SET_IVLEN EVP_CTRL_GCM_SET_IVLEN
+#define EVP_CTRL_AEAD_GET_TAG EVP_CTRL_GCM_GET_TAG
+#define EVP_CTRL_AEAD_SET_TAG EVP_CTRL_GCM_SET_TAG
+#endif
+
+
 Cipher::Cipher(const string &cipher, bool encrypt, const void *key,
                const void *iv, ENGINE *e) :
   ctx(EVP_CIPHER_CTX_new()), encrypt(encrypt) {
@@ -97,10 +104,56 @@ unsigned Cipher::getBlockSize() const {
 }
 
 
+bool Cipher::isAEAD() const {
+  return EVP_CIPHER_CTX_flags(ctx) & EVP_CIPH_FLAG_AEAD_CIPHER;
+}
+
+
+unsigned Cipher::getTagLength() const {
+  if (!isAEAD()) return 0;
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+  return 16; // The default for GCM, CCM, OCB and ChaCha20-Poly1305
+#else
+  // ChaCha20-Poly1305 reports no length before a tag is set
+  int length = EVP_CIPHER_CTX_get_tag_length(ctx);
+  return 0 < length ? length : 16;
+#endif
+}
+
+
+void Cipher::setIVLength(unsigned length) {
+  if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, length, 0))
+    THROW("Failed to set cipher IV length: " << SSL::getErrorStr());
+}
+
+
+void Cipher::addAAD(const void *data, unsigned length) {
+  int outLen;
+
+  if (!(encrypt ? EVP_EncryptUpdate : EVP_DecryptUpdate)
+      (ctx, 0, &outLen, (const unsigned char *)data, length))
+    THROW("Failed to add cipher AAD: " << SSL::getErrorStr());
+}
+
+
+void Cipher::getTag(void *tag, unsigned length) const {
+  if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, length, tag))
+    THROW("Failed to get cipher tag: " << SSL::getErrorStr());
+}
+
+
+void Cipher::setTag(const void *tag, unsigned length) {
+  if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, length, (void *)tag))
+    THROW("Failed to set cipher tag: " << SSL::getErrorStr());
+}
+
+
 unsigned Cipher::update(void *out, unsigned length, const void *in,
                         unsigned inLen) {
+  // OpenSSL works in place when the buffers are identical and the block size
+  // is one.  Block modes hold back partial blocks, so copy the input.
   SmartPointer<char>::Array buf;
-  if (out == in) {
+  if (out == in && getBlockSize() != 1) {
     if (inLen < length)
       THROW("If using cipher in place then the intput buffer length must be "
             "at least as large as the output buffer");
@@ -54,8 +54,27 @@ namespace cb {
     void setIV(const void *iv);
 
     unsigned getBlockSize() const;
-
+    bool isEncrypt() const {return encrypt;}
+
+    // AEAD modes, e.g. AES-GCM or ChaCha20-Poly1305
+    bool isAEAD() const;
+    /// @return The length of the authentication tag or zero
+    unsigned getTagLength() const;
+    /// Must be called before the IV is set
+    void setIVLength(unsigned length);
+    /// Add authenticated data.  Must be called before any update().
+    void addAAD(const void *data, unsigned length);
+    /// Get the authentication tag after final() when encrypting
+    void getTag(void *tag, unsigned length) const;
+    /// Set the expected authentication tag before final() when decrypting
+    void setTag(const void *tag, unsigned length);
+
+    /// @param out may equal @param in.  Stream and AEAD modes, which have a
+    /// block size of one, then work in place and the output is always the
+    /// same length as the input.  Block modes copy the input first.
+    /// Otherwise the buffers must not overlap.
     unsigned update(void *out, unsigned length, const void *in, unsigned inLen);
+    /// Fails when decrypting if AEAD authentication fails
     unsigned final(void *out, unsigned length);
   };
 }
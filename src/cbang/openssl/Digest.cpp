@@ -39,9 +39,13 @@
 #include <cbang/Exception.h>
 #include <cbang/String.h>
 #include <cbang/net/Base64.h>
+#include <cbang/os/Mutex.h>
+#include <cbang/util/SmartLock.h>
 
 #include <openssl/evp.h>
 
+#include <map>
+
 using namespace cb;
 using namespace std;
 
@@ -52,7 +56,7 @@ Digest::Digest(const string &digest) : md(0), ctx(0), initialized(false) {
   ctx = EVP_MD_CTX_create();
   if (!ctx) THROW("Failed to created digest context: " << SSL::getErrorStr());
 
-  md = EVP_get_digestbyname(digest.c_str());
+  md = getAlgorithm(digest);
   if (!md) THROW("Unrecognized digest '" << digest);
 }
 
@@ -60,7 +64,7 @@ Digest::Digest(const string &digest) : md(0), ctx(0), initialized(false) {
 Digest::~Digest() {if (ctx) EVP_MD_CTX_destroy(ctx);}
 
 
-unsigned Digest::size() const {return EVP_MD_CTX_size(ctx);}
+unsigned Digest::size() const {return EVP_MD_size(md);}
 
 
 void Digest::init(ENGINE *e) {
@@ -186,11 +190,7 @@ string Digest::toString() {
 string Digest::toHexString() const {
   if (digest.empty()) THROW("Digest not finalized");
 
-  string result;
-  unsigned s = size();
-  for (unsigned i = 0; i < s; i++)
-    result += String::printf("%02x", digest.at(i));
-  return result;
+  return String::hexEncode(toString());
 }
 
 
@@ -243,6 +243,45 @@ void Digest::reset() {
 }
 
 
+unsigned Digest::compute(const uint8_t *data, unsigned length, uint8_t *out,
+                         ENGINE *e) {
+  reset();
+
+  // Reinitializing an existing context does not allocate
+  unsigned len = 0;
+  if (!EVP_DigestInit_ex(ctx, md, e) || !EVP_DigestUpdate(ctx, data, length) ||
+      !EVP_DigestFinal_ex(ctx, out, &len))
+    THROW("Error computing digest: " << SSL::getErrorStr());
+
+  return len;
+}
+
+
+string Digest::compute(const string &data, ENGINE *e) {
+  uint8_t out[EVP_MAX_MD_SIZE];
+  unsigned len = compute((const uint8_t *)data.data(), data.length(), out, e);
+  return string((const char *)out, len);
+}
+
+
+void Digest::computeBatch(const uint8_t *const *data, const unsigned *lengths,
+                          unsigned count, uint8_t *out, ENGINE *e) {
+  unsigned s = size();
+
+  for (unsigned i = 0; i < count; i++)
+    compute(data[i], lengths[i], out + i * s, e);
+}
+
+
+void Digest::computeBatch(const vector<string> &data, vector<string> &results,
+                          ENGINE *e) {
+  results.resize(data.size());
+
+  for (unsigned i = 0; i < data.size(); i++)
+    results[i] = compute(data[i], e);
+}
+
+
 string Digest::hash(const string &s, const string &digest, ENGINE *e) {
   Digest d(digest);
   d.init(e);
@@ -290,7 +329,30 @@ bool Digest::verify(const KeyPair &key, const std::string &s, const string &sig,
 
 bool Digest::hasAlgorithm(const string &digest) {
   SSL::init();
+  return getAlgorithm(digest);
+}
+
+
+const EVP_MD *Digest::getAlgorithm(const string &digest) {
+#if 0x30000000L <= OPENSSL_VERSION_NUMBER
+  // Explicitly fetched algorithms avoid a provider lookup on every init.
+  // They are immutable and shared by all threads.
+  static Mutex mutex;
+  static map<string, EVP_MD *> algorithms;
+  SmartLock lock(&mutex);
+
+  map<string, EVP_MD *>::iterator it = algorithms.find(digest);
+  if (it != algorithms.end()) return it->second;
+
+  EVP_MD *md = EVP_MD_fetch(0, digest.c_str(), 0);
+  if (md) algorithms[digest] = md;
+  else return EVP_get_digestbyname(digest.c_str());
+
+  return md;
+
+#else
   return EVP_get_digestbyname(digest.c_str());
+#endif
 }
 
 
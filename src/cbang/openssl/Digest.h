@@ -111,6 +111,21 @@ namespace cb {
     // Reset
     virtual void reset();
 
+    // Reusable context
+    /// Hashes @param data into @param out, which must hold size() bytes,
+    /// reusing this context.  Any hash in progress is reset.
+    /// @return The number of bytes written.
+    unsigned compute(const uint8_t *data, unsigned length, uint8_t *out,
+                     ENGINE *e = 0);
+    std::string compute(const std::string &data, ENGINE *e = 0);
+
+    /// Hashes @param count independent messages.  @param out must hold
+    /// count * size() bytes.
+    void computeBatch(const uint8_t *const *data, const unsigned *lengths,
+                      unsigned count, uint8_t *out, ENGINE *e = 0);
+    void computeBatch(const std::vector<std::string> &data,
+                      std::vector<std::string> &results, ENGINE *e = 0);
+
     // Static
     static std::string hash(const std::string &s, const std::string &digest,
                             ENGINE *e = 0);
@@ -126,6 +141,7 @@ namespace cb {
                        const std::string &sig, const std::string &digest,
                        ENGINE *e = 0);
     static bool hasAlgorithm(const std::string &digest);
+    static const EVP_MD *getAlgorithm(const std::string &digest);
 
     static std::string signHMAC(const std::string &key, const std::string &s,
                                 const std::string &digest, ENGINE *e = 0);
@@ -248,6 +248,38 @@ unsigned cb::SSL::write(const char *data, unsigned size) {
 }
 
 
+bool cb::SSL::isKTLSSend() const {
+#ifdef BIO_get_ktls_send
+  BIO *bio = SSL_get_wbio(ssl);
+  return bio && BIO_get_ktls_send(bio);
+#else
+  return false;
+#endif
+}
+
+
+int64_t cb::SSL::sendFile(int fd, uint64_t offset, uint64_t length) {
+  LOG_DEBUG(5, "cb::SSL::sendFile(" << offset << ", " << length << ')');
+
+#ifdef BIO_get_ktls_send
+  checkHandshakes();
+  if (!checkWants() || !length) return 0;
+
+  ossl_ssize_t ret = SSL_sendfile(ssl, fd, offset, length, 0);
+  if (ret < 0) {
+    int err = SSL_get_error(ssl, ret);
+    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) return 0;
+    THROW("SSL sendfile failed: " << getFullSSLErrorStr(ret));
+  }
+
+  LOG_DEBUG(5, "cb::SSL::sendFile()=" << ret);
+  return ret;
+
+#else
+  THROW("SSL sendfile requires kernel TLS");
+#endif
+}
+
 unsigned long cb::SSL::idCallback() {
   return (unsigned long)cb::Thread::self();
 }
@@ -37,6 +37,8 @@
 #include <string>
 #include <vector>
 
+#include <stdint.h>
+
 typedef struct ssl_st _SSL;
 typedef struct ssl_ctx_st SSL_CTX;
 typedef struct bio_st BIO;
@@ -84,6 +86,11 @@ namespace cb {
     int read(char *data, unsigned size);
     unsigned write(const char *data, unsigned size);
 
+    /// @return True if the kernel encrypts records sent on this connection
+    bool isKTLSSend() const;
+    /// Send directly from file @param fd.  Requires isKTLSSend().
+    int64_t sendFile(int fd, uint64_t offset, uint64_t length);
+
     static unsigned long idCallback();
     static void lockingCallback(int mode, int n, const char *file, int line);
     static int passwordCallback(char *buf, int num, int rwglags, void *data);
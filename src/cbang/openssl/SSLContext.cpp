@@ -39,6 +39,10 @@
 #include "CRL.h"
 
 #include <cbang/Exception.h>
+#include <cbang/os/Mutex.h>
+#include <cbang/util/SmartLock.h>
+#include <cbang/time/Time.h>
+#include <cbang/log/Logger.h>
 
 // This avoids a conflict with OCSP_RESPONSE in wincrypt.h
 #ifdef OCSP_RESPONSE
@@ -51,6 +55,18 @@
 #include <openssl/x509.h>
 #include <openssl/x509_vfy.h>
 #include <openssl/opensslv.h>
+#include <openssl/rand.h>
+#include <openssl/hmac.h>
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
+
+#include <map>
+#include <list>
+#include <deque>
+
+#include <string.h>
 
 using namespace std;
 using namespace cb;
@@ -60,8 +76,235 @@ using namespace cb;
 #define TLS_method TLSv1_method
 #endif // OPENSSL_VERSION_NUMBER < 0x1010000fL
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+typedef EVP_MAC_CTX ticket_mac_ctx_t;
+#else
+typedef HMAC_CTX ticket_mac_ctx_t;
+#endif
+
+
+namespace {
+  int contextIndex() {
+    static int index = SSL_CTX_get_ex_new_index(0, 0, 0, 0, 0);
+    return index;
+  }
+
+
+  void freeHost(void *parent, void *ptr, CRYPTO_EX_DATA *ad, int idx,
+                long argl, void *argp) {
+    delete (string *)ptr;
+  }
+
+
+  int hostIndex() {
+    static int index = SSL_get_ex_new_index(0, 0, 0, 0, freeHost);
+    return index;
+  }
+
+
+  SSLContext *getContext(::SSL *ssl) {
+    return (SSLContext *)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl),
+                                             contextIndex());
+  }
+}
+
+
+struct SSLContext::TicketKeys : public Mutex {
+  struct Key {
+    unsigned char name[16];
+    unsigned char aesKey[32];
+    unsigned char hmacKey[32];
+    uint64_t created;
+  };
+
+  unsigned lifetime;
+  deque<Key> keys; // Newest first
+
+
+  TicketKeys(unsigned lifetime) : lifetime(lifetime) {}
+
+
+  bool rotate() {
+    uint64_t now = Time::now();
+
+    if (keys.empty() || keys.front().created + lifetime <= now) {
+      Key key;
+      if (RAND_bytes(key.name, sizeof(key.name)) != 1 ||
+          RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1 ||
+          RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1)
+        return !keys.empty();
+
+      key.created = now;
+      keys.push_front(key);
+    }
+
+    // Accept tickets from a retired key for one more lifetime
+    while (1 < keys.size() && keys.back().created + 2 * lifetime <= now)
+      keys.pop_back();
+
+    return true;
+  }
+
+
+  static bool initMAC(ticket_mac_ctx_t *macCtx, const Key &key) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    OSSL_PARAM params[] = {
+      OSSL_PARAM_construct_octet_string
+      (OSSL_MAC_PARAM_KEY, (void *)key.hmacKey, sizeof(key.hmacKey)),
+      OSSL_PARAM_construct_utf8_string
+      (OSSL_MAC_PARAM_DIGEST, (char *)"sha256", 0),
+      OSSL_PARAM_construct_end()
+    };
+
+    return EVP_MAC_CTX_set_params(macCtx, params);
+
+#else
+    return HMAC_Init_ex(macCtx, key.hmacKey, sizeof(key.hmacKey),
+                        EVP_sha256(), 0);
+#endif
+  }
+
+
+  int process(unsigned char *name, unsigned char *iv,
+              EVP_CIPHER_CTX *cipherCtx, ticket_mac_ctx_t *macCtx,
+              int encrypt) {
+    SmartLock lock(this);
+
+    if (!rotate()) return -1;
+
+    const Key *key = 0;
+
+    if (encrypt) {
+      key = &keys.front();
+      memcpy(name, key->name, sizeof(key->name));
+      if (RAND_bytes(iv, 16) != 1) return -1;
+
+    } else {
+      for (unsigned i = 0; i < keys.size() && !key; i++)
+        if (!memcmp(name, keys[i].name, sizeof(keys[i].name)))
+          key = &keys[i];
+
+      if (!key) return 0; // Unknown or expired key, do a full handshake
+    }
+
+    if (!EVP_CipherInit_ex(cipherCtx, EVP_aes_256_cbc(), 0, key->aesKey, iv,
+                           encrypt) || !initMAC(macCtx, *key))
+      return -1;
+
+    // Ask for a new ticket if the key has been retired
+    return encrypt || key == &keys.front() ? 1 : 2;
+  }
+
+
+  static int callback(::SSL *ssl, unsigned char *name, unsigned char *iv,
+                      EVP_CIPHER_CTX *cipherCtx, ticket_mac_ctx_t *macCtx,
+                      int encrypt) {
+    SSLContext *ctx = getContext(ssl);
+    if (!ctx || ctx->ticketKeys.isNull()) return -1;
+    return ctx->ticketKeys->process(name, iv, cipherCtx, macCtx, encrypt);
+  }
+};
+
+
+struct SSLContext::ClientSessions : public Mutex {
+  typedef list<string> order_t;
+  typedef map<string, pair<SSL_SESSION *, order_t::iterator> > sessions_t;
+
+  unsigned size;
+  sessions_t sessions;
+  order_t order; // Oldest first
+
+
+  ClientSessions(unsigned size) : size(size) {}
+
+
+  ~ClientSessions() {
+    for (sessions_t::iterator it = sessions.begin(); it != sessions.end();
+         it++)
+      SSL_SESSION_free(it->second.first);
+  }
+
+
+  void erase(sessions_t::iterator it) {
+    SSL_SESSION_free(it->second.first);
+    order.erase(it->second.second);
+    sessions.erase(it);
+  }
+
+
+  void resize(unsigned size) {
+    SmartLock lock(this);
+
+    this->size = size;
+    while (size < order.size()) erase(sessions.find(order.front()));
+  }
+
+
+  bool add(const string &host, SSL_SESSION *session) {
+    SmartLock lock(this);
 
-SSLContext::SSLContext() : ctx(0) {
+    if (!size) return false;
+
+#if 0x1010100fL <= OPENSSL_VERSION_NUMBER
+    // Connections closed without a TLS shutdown mark their session
+    // unresumable, so keep a private copy
+    session = SSL_SESSION_dup(session);
+    if (!session) return false;
+#endif
+
+    sessions_t::iterator it = sessions.find(host);
+    if (it != sessions.end()) erase(it);
+    else if (order.size() == size) erase(sessions.find(order.front()));
+
+    order.push_back(host);
+    sessions[host] = make_pair(session, --order.end());
+
+#if 0x1010100fL <= OPENSSL_VERSION_NUMBER
+    return false; // Did not keep the original
+#else
+    return true;
+#endif
+  }
+
+
+  void apply(::SSL *ssl, const string &host) {
+    SmartLock lock(this);
+
+    sessions_t::iterator it = sessions.find(host);
+    if (it == sessions.end()) return;
+
+    SSL_SESSION *session = it->second.first;
+
+#if 0x1010100fL <= OPENSSL_VERSION_NUMBER
+    if (!SSL_SESSION_is_resumable(session)) {
+      erase(it);
+      return;
+    }
+
+    session = SSL_SESSION_dup(session);
+    if (!session) return;
+    SSL_set_session(ssl, session);
+    SSL_SESSION_free(session);
+
+#else
+    SSL_set_session(ssl, session);
+#endif
+  }
+
+
+  static int callback(::SSL *ssl, SSL_SESSION *session) {
+    const string *host = (const string *)SSL_get_ex_data(ssl, hostIndex());
+    SSLContext *ctx = getContext(ssl);
+    if (!host || !ctx) return 0;
+
+    // Returning 1 keeps the reference to the session
+    return ctx->clientSessions->add(*host, session) ? 1 : 0;
+  }
+};
+
+
+SSLContext::SSLContext() :
+  ctx(0), clientSessions(new ClientSessions(1024)) {
   cb::SSL::init();
 
   ctx = SSL_CTX_new(TLS_method());
@@ -71,11 +314,18 @@ SSLContext::SSLContext() : ctx(0) {
 
   // A session ID is required for session caching to work
   SSL_CTX_set_session_id_context(ctx, (unsigned char *)"cbang", 5);
+
+  // Remember client sessions so connections to the same host can resume
+  SSL_CTX_set_ex_data(ctx, contextIndex(), this);
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_BOTH);
+  SSL_CTX_sess_set_new_cb(ctx, ClientSessions::callback);
 }
 
 
 SSLContext::~SSLContext() {
   if (ctx) {
+    // Connections may outlive the context
+    SSL_CTX_set_ex_data(ctx, contextIndex(), 0);
     SSL_CTX_free(ctx);
     ctx = 0;
   }
@@ -247,3 +497,98 @@ void SSLContext::setCheckCRL(bool x) {
   X509_STORE_set1_param(store, param);
   X509_VERIFY_PARAM_free(param);
 }
+
+
+void SSLContext::setKTLS(bool enable) {
+#ifdef SSL_OP_ENABLE_KTLS
+  if (enable) SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+  else SSL_CTX_clear_options(ctx, SSL_OP_ENABLE_KTLS);
+
+#else
+  if (enable) LOG_WARNING("Kernel TLS not supported by this OpenSSL");
+#endif
+}
+
+
+bool SSLContext::getKTLS() const {
+#ifdef SSL_OP_ENABLE_KTLS
+  return SSL_CTX_get_options(ctx) & SSL_OP_ENABLE_KTLS;
+#else
+  return false;
+#endif
+}
+
+void SSLContext::setSessionCacheSize(unsigned size) {
+  long mode = SSL_CTX_get_session_cache_mode(ctx);
+
+  if (size) {
+    SSL_CTX_sess_set_cache_size(ctx, size);
+    mode |= SSL_SESS_CACHE_SERVER;
+
+  } else mode &= ~SSL_SESS_CACHE_SERVER;
+
+  SSL_CTX_set_session_cache_mode(ctx, mode);
+}
+
+
+void SSLContext::setSessionTimeout(unsigned secs) {
+  SSL_CTX_set_timeout(ctx, secs);
+}
+
+
+void SSLContext::setSessionTickets(bool enable) {
+  if (enable) SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+  else SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+}
+
+
+void SSLContext::setSessionTicketLifetime(unsigned secs) {
+  if (!secs) THROW("Session ticket lifetime cannot be zero");
+
+  if (ticketKeys.isNull()) {
+    ticketKeys = new TicketKeys(secs);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (!SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, TicketKeys::callback))
+#else
+    if (!SSL_CTX_set_tlsext_ticket_key_cb(ctx, TicketKeys::callback))
+#endif
+      THROW("Failed to set session ticket key callback: "
+            << cb::SSL::getErrorStr());
+
+  } else {
+    SmartLock lock(ticketKeys.get());
+    ticketKeys->lifetime = secs;
+  }
+}
+
+
+void SSLContext::setClientSessionCacheSize(unsigned size) {
+  clientSessions->resize(size);
+
+  long mode = SSL_CTX_get_session_cache_mode(ctx);
+  if (size) mode |= SSL_SESS_CACHE_CLIENT;
+  else mode &= ~SSL_SESS_CACHE_CLIENT;
+  SSL_CTX_set_session_cache_mode(ctx, mode);
+}
+
+
+void SSLContext::resumeSession(::SSL *ssl, const string &host) {
+  if (host.empty() || !(SSL_CTX_get_session_cache_mode(ctx) &
+                        SSL_SESS_CACHE_CLIENT)) return;
+
+  delete (string *)SSL_get_ex_data(ssl, hostIndex());
+  SSL_set_ex_data(ssl, hostIndex(), new string(host));
+
+  clientSessions->apply(ssl, host);
+}
+
+
+uint64_t SSLContext::getHandshakes() const {
+  return SSL_CTX_sess_accept_good(ctx) + SSL_CTX_sess_connect_good(ctx);
+}
+
+
+uint64_t SSLContext::getResumedHandshakes() const {
+  return SSL_CTX_sess_hits(ctx);
+}
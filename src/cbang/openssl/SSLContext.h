@@ -32,11 +32,15 @@
 
 #pragma once
 
+#include <cbang/SmartPointer.h>
 #include <cbang/io/InputSource.h>
 
 #include <string>
 
+#include <stdint.h>
+
 typedef struct ssl_ctx_st SSL_CTX;
+struct ssl_st;
 typedef struct x509_store_st X509_STORE;
 typedef struct bio_st BIO;
 
@@ -49,6 +53,12 @@ namespace cb {
   class SSLContext {
     SSL_CTX *ctx;
 
+    struct TicketKeys;
+    SmartPointer<TicketKeys> ticketKeys;
+
+    struct ClientSessions;
+    SmartPointer<ClientSessions> clientSessions;
+
   public:
     SSLContext();
     ~SSLContext();
@@ -87,5 +97,40 @@ namespace cb {
 
     void setVerifyDepth(unsigned depth);
     void setCheckCRL(bool x = true);
+
+    /**
+     * Let the kernel encrypt records after the handshake.  Connections fall
+     * back to user space encryption when the kernel or negotiated cipher
+     * does not support it.
+     */
+    void setKTLS(bool enable = true);
+    bool getKTLS() const;
+
+    // Session resumption
+    /// Limit the server side session cache.  Zero disables the cache.
+    void setSessionCacheSize(unsigned size);
+    void setSessionTimeout(unsigned secs);
+    void setSessionTickets(bool enable);
+    /**
+     * Encrypt session tickets with keys which are replaced every
+     * @param secs.  Tickets made with the previous key are still accepted
+     * but are renewed.  By default OpenSSL uses one random key for the life
+     * of the context.
+     */
+    void setSessionTicketLifetime(unsigned secs);
+
+    /// Limit the client side session cache.  Zero disables the cache.
+    void setClientSessionCacheSize(unsigned size);
+    /**
+     * Offer the session last negotiated with @param host, if any, and
+     * remember the one negotiated on this connection.  Must be called
+     * before the client handshake starts.
+     */
+    void resumeSession(struct ssl_st *ssl, const std::string &host);
+
+    /// @return The number of completed client and server handshakes
+    uint64_t getHandshakes() const;
+    /// @return The number of handshakes which resumed a session
+    uint64_t getResumedHandshakes() const;
   };
 }
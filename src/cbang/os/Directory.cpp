@@ -32,22 +32,35 @@
 
 #include "Directory.h"
 
+#include <cbang/Exception.h>
+#include <cbang/os/SysError.h>
+
+#ifdef _WIN32
 #define BOOST_SYSTEM_NO_DEPRECATED
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 namespace fs = boost::filesystem;
 
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 using namespace cb;
 
 
+#ifdef _WIN32
 struct Directory::private_t {
   fs::path path;
   fs::directory_iterator it;
 
-  private_t(const string &_path) :
-    path(fs::system_complete(fs::path(_path))), it(path) {}
+  private_t(const fs::path &_path) :
+    path(fs::system_complete(_path)), it(path) {}
 };
 
 
@@ -56,6 +69,12 @@ Directory::Directory(const string &path) : p(new private_t(path)) {
 }
 
 
+Directory::Directory(const Directory &parent, const string &name) :
+  p(new private_t(parent.p->path / name)) {
+  if (!fs::is_directory(p->path)) THROW("Not a directory '" << p->path << "'");
+}
+
+
 void Directory::rewind() {p->it = fs::directory_iterator(p->path);}
 Directory::operator bool() const {return p->it != fs::directory_iterator();}
 void Directory::next() {p->it++;}
@@ -73,3 +92,77 @@ const string Directory::getFilename() const {
 bool Directory::isSubdirectory() const {
   return fs::is_directory(p->it->status());
 }
+
+
+#else // _WIN32
+struct Directory::private_t {
+  DIR *dir;
+  struct dirent *entry;
+
+  private_t(int fd, const string &path) : dir(0), entry(0) {
+    if (fd != -1) dir = fdopendir(fd);
+
+    if (!dir) {
+      if (fd != -1) close(fd);
+      THROW("Not a directory '" << path << "': " << SysError());
+    }
+
+    next();
+  }
+
+
+  ~private_t() {closedir(dir);}
+
+
+  void next() {
+    // Skip "." and ".." like boost::filesystem::directory_iterator
+    do {
+      entry = readdir(dir);
+    } while (entry && entry->d_name[0] == '.' &&
+             (!entry->d_name[1] ||
+              (entry->d_name[1] == '.' && !entry->d_name[2])));
+  }
+};
+
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+#define DIR_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+
+
+Directory::Directory(const string &path) :
+  p(new private_t(open(path.c_str(), DIR_FLAGS), path)) {}
+
+
+Directory::Directory(const Directory &parent, const string &name) :
+  p(new private_t(openat(dirfd(parent.p->dir), name.c_str(), DIR_FLAGS),
+                  name)) {}
+
+
+void Directory::rewind() {
+  rewinddir(p->dir);
+  p->next();
+}
+
+
+Directory::operator bool() const {return p->entry;}
+void Directory::next() {p->next();}
+const string Directory::getFilename() const {return p->entry->d_name;}
+
+
+bool Directory::isSubdirectory() const {
+  // Only stat() when the file system does not report the type or when a
+  // symlink must be followed
+  switch (p->entry->d_type) {
+  case DT_DIR: return true;
+  case DT_UNKNOWN: case DT_LNK: break;
+  default: return false;
+  }
+
+  struct stat st;
+  return !fstatat(dirfd(p->dir), p->entry->d_name, &st, 0) &&
+    S_ISDIR(st.st_mode);
+}
+#endif // _WIN32
@@ -44,6 +44,8 @@ namespace cb {
 
   public:
     Directory(const std::string &path);
+    /// Open @param name relative to an already open @param parent.
+    Directory(const Directory &parent, const std::string &name);
 
     void rewind();
     operator bool () const;
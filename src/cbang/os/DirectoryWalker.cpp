@@ -34,15 +34,145 @@
 
 #include <cbang/log/Logger.h>
 #include <cbang/os/SystemUtilities.h>
+#include <cbang/os/Condition.h>
+#include <cbang/os/ThreadPoolFunc.h>
+#include <cbang/util/SmartLock.h>
 
 #include <cbang/Exception.h>
 
+#include <list>
+
 #include <string.h>
 
 using namespace std;
 using namespace cb;
 
 
+namespace {
+  struct Task {
+    SmartPointer<Directory> dir;
+    string path;
+    unsigned depth;
+
+    Task() : depth(0) {}
+    Task(const SmartPointer<Directory> &dir, const string &path,
+         unsigned depth) : dir(dir), path(path), depth(depth) {}
+  };
+
+
+  class ParallelWalk : public Condition {
+    const Regex &re;
+    unsigned maxDepth;
+    const DirectoryWalker::callback_t &cb;
+
+    // Shared directories are already open so the queue is kept short
+    unsigned maxQueued;
+    list<Task> queue;
+    unsigned active;
+    SmartPointer<Exception> error;
+
+  public:
+    ParallelWalk(const Regex &re, unsigned maxDepth,
+                 const DirectoryWalker::callback_t &cb, unsigned threads) :
+      re(re), maxDepth(maxDepth), cb(cb),
+      maxQueued(1 < threads ? threads : 0), active(0) {}
+
+
+    void start(const Task &task) {queue.push_back(task);}
+
+
+    void check() {if (!error.isNull()) throw *error;}
+
+
+    void run() {
+      while (true) {
+        Task task;
+
+        {
+          SmartLock lock(this);
+
+          while (queue.empty() && active) wait();
+
+          if (queue.empty()) {
+            broadcast();
+            return;
+          }
+
+          task = queue.front();
+          queue.pop_front();
+          active++;
+        }
+
+        try {
+          walk(task);
+
+        } catch (const Exception &e) {
+          fail(e);
+        } catch (const std::exception &e) {
+          fail(Exception(e.what()));
+        }
+
+        SmartLock lock(this);
+        if (!--active && queue.empty()) broadcast();
+      }
+    }
+
+
+    /// Walk depth first, handing subdirectories to idle threads
+    void walk(const Task &task) {
+      vector<Task> stack(1, task);
+
+      while (!stack.empty()) {
+        Directory &dir = *stack.back().dir;
+
+        if (!dir) {
+          stack.pop_back();
+          continue;
+        }
+
+        string name = dir.getFilename();
+        bool isDir = dir.isSubdirectory();
+        dir.next();
+
+        const Task &parent = stack.back();
+
+        if (isDir) {
+          if (parent.depth < maxDepth) {
+            Task child(new Directory(dir, name), parent.path + name + "/",
+                       parent.depth + 1);
+            if (!share(child)) stack.push_back(child);
+          }
+
+        } else if (re.match(name)) cb(parent.path + name);
+      }
+    }
+
+
+    bool share(Task &task) {
+      SmartLock lock(this);
+
+      if (!error.isNull()) THROW("Walk aborted");
+      if (maxQueued <= queue.size()) return false;
+
+      // SmartPointer counts are not atomic so give up our reference while
+      // holding the lock
+      queue.push_back(task);
+      task = Task();
+      signal();
+
+      return true;
+    }
+
+
+    void fail(const Exception &e) {
+      SmartLock lock(this);
+      if (error.isNull()) error = new Exception(e);
+      queue.clear();
+    }
+  };
+}
+
+
 DirectoryWalker::DirectoryWalker(const string &root, const string &pattern,
                                  unsigned maxDepth) :
   re(pattern), maxDepth(maxDepth) {
@@ -52,9 +182,10 @@ DirectoryWalker::DirectoryWalker(const string &root, const string &pattern,
 
 
 void DirectoryWalker::init(const string &root) {
+  this->root = root;
   nextFile = "";
   dirStack.clear();
-  path[0] = 0;
+  path = "";
   push(root);
 }
 
@@ -96,12 +227,35 @@ const string DirectoryWalker::next() {
 }
 
 
+void DirectoryWalker::walk(const callback_t &cb, unsigned threads) {
+  if (root.empty()) THROW("DirectoryWalker root not set");
+
+  string rootPath = root;
+  if (rootPath[rootPath.length() - 1] != '/') rootPath += '/';
+
+  if (!threads) threads = 1;
+  ParallelWalk pw(re, maxDepth, cb, threads);
+  Task task(new Directory(rootPath), rootPath, 1);
+
+  if (threads == 1) pw.walk(task);
+  else {
+    pw.start(task);
+    ThreadPoolFunc<ParallelWalk> pool(threads, &pw, &ParallelWalk::run);
+    pool.start();
+    pool.wait();
+    pw.check();
+  }
+}
+
+
 void DirectoryWalker::push(const string &name) {
   string tmp = path + name;
 
   if (tmp[tmp.length() - 1] != '/') tmp += '/';
 
-  dirStack.push_back(new Directory(tmp));
+  // Open subdirectories relative to their parent
+  if (dirStack.empty()) dirStack.push_back(new Directory(tmp));
+  else dirStack.push_back(new Directory(*dirStack.back(), name));
   path = tmp;
 
   LOG_DEBUG(6, "Pushed " << path);
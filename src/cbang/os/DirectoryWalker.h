@@ -34,6 +34,7 @@
 
 #include <vector>
 #include <string>
+#include <functional>
 
 #include <cbang/SmartPointer.h>
 #include <cbang/util/Regex.h>
@@ -44,6 +45,7 @@ namespace cb {
   /// Walk a directory tree and return files that match pattern.
   class DirectoryWalker {
     Regex re;
+    std::string root;
     std::string path;
     std::vector<SmartPointer<Directory> > dirStack;
     std::string nextFile;
@@ -76,6 +78,19 @@ namespace cb {
     /// @return The full path name of the next matching file.
     const std::string next();
 
+    typedef std::function<void (const std::string &path)> callback_t;
+
+    /**
+     * Walk the whole tree calling @param cb with the full path of each
+     * matching file.  With more than one thread, subdirectories are handed
+     * out to a pool of @param threads threads and @param cb is called
+     * concurrently from those threads, in no particular order.  The walk
+     * is independent of hasNext()/next().
+     *
+     * The first error encountered is rethrown after all threads stop.
+     */
+    void walk(const callback_t &cb, unsigned threads = 1);
+
   protected:
     void push(const std::string &dir);
     void pop();
@@ -38,6 +38,7 @@
 #include "SystemInfo.h"
 
 #include <cbang/Exception.h>
+#include <cbang/Catch.h>
 #include <cbang/String.h>
 #include <cbang/Zap.h>
 
@@ -58,6 +59,19 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <spawn.h>
+
+#if defined(__GLIBC__) && \
+  (2 < __GLIBC__ || (__GLIBC__ == 2 && 29 <= __GLIBC_MINOR__))
+#define HAVE_SPAWN_CHDIR
+#endif
+
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+  defined(__OpenBSD__)
+#define HAVE_PIPE2
+#endif
+
+extern char **environ;
 #endif // _WIN32
 
 #include <boost/version.hpp>
@@ -141,8 +155,11 @@ namespace {
       ::close(handles[toChild ? 1 : 0]);
 
       // Move to target
-      if (target != -1 && dup2(handles[toChild ? 0 : 1], target) != target)
-        perror("Moving file descriptor");
+      int fd = handles[toChild ? 0 : 1];
+      if (target != -1 && fd != target) {
+        if (dup2(fd, target) != target) perror("Moving file descriptor");
+        ::close(fd);
+      }
     }
 #endif
 
@@ -175,7 +192,92 @@ namespace {
 
 
     void closeStream() {stream.release();}
+
+
+#ifndef _WIN32
+    void inSpawn(posix_spawn_file_actions_t &actions, int target = -1) {
+      // Close parent end
+      posix_spawn_file_actions_addclose(&actions, handles[toChild ? 1 : 0]);
+
+      // Move to target and close the original
+      int fd = handles[toChild ? 0 : 1];
+      if (target != -1 && fd != target) {
+        posix_spawn_file_actions_adddup2(&actions, fd, target);
+        posix_spawn_file_actions_addclose(&actions, fd);
+      }
+    }
+#endif
   };
+
+
+#ifndef _WIN32
+  pid_t spawn(vector<Pipe> &pipes, const vector<char *> &args,
+              unsigned flags, const string &wd, const StringMap &vars) {
+    // Environment
+    vector<string> env;
+
+    if (!(flags & Subprocess::CLEAR_ENVIRONMENT))
+      for (char **e = environ; *e; e++) {
+        const char *equal = strchr(*e, '=');
+        if (!equal || !vars.has(string(*e, equal - *e))) env.push_back(*e);
+      }
+
+    StringMap::const_iterator it;
+    for (it = vars.begin(); it != vars.end(); it++)
+      env.push_back(it->first + "=" + it->second);
+
+    vector<char *> envp;
+    for (unsigned i = 0; i < env.size(); i++)
+      envp.push_back((char *)env[i].c_str());
+    envp.push_back(0); // Sentinal
+
+    // Attributes
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+
+    if (flags & Subprocess::CREATE_PROCESS_GROUP) {
+      posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+      posix_spawnattr_setpgroup(&attr, 0);
+    }
+
+    // File actions, in the same order as the fork() path
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+
+    if (flags & Subprocess::REDIR_STDIN) pipes[0].inSpawn(actions, 0);
+    if (flags & Subprocess::REDIR_STDOUT) pipes[1].inSpawn(actions, 1);
+
+    if (flags & Subprocess::MERGE_STDOUT_AND_STDERR)
+      posix_spawn_file_actions_adddup2(&actions, 1, 2);
+
+    if (flags & Subprocess::REDIR_STDERR) pipes[2].inSpawn(actions, 2);
+
+    if (flags & Subprocess::NULL_STDOUT)
+      posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    if (flags & Subprocess::NULL_STDERR)
+      posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+
+    for (unsigned i = 3; i < pipes.size(); i++) pipes[i].inSpawn(actions);
+
+#ifdef HAVE_SPAWN_CHDIR
+    if (!wd.empty())
+      posix_spawn_file_actions_addchdir_np(&actions, wd.c_str());
+#endif
+
+    pid_t pid = 0;
+    int err = (flags & Subprocess::SHELL ? posix_spawnp : posix_spawn)
+      (&pid, args[0], &actions, &attr, &args[0], &envp[0]);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    if (err) THROW("Failed to execute: " << Subprocess::assemble
+                   (vector<string>(args.begin(), args.end() - 1)) << ": "
+                   << SysError(err));
+
+    return pid;
+  }
+#endif // _WIN32
 }
 
 
@@ -395,9 +497,41 @@ void Subprocess::exec(const vector<string> &_args, unsigned flags,
       args.push_back((char *)_args[i].c_str());
     args.push_back(0); // Sentinal
 
-    p->pid = fork();
+    // posix_spawn() does not copy the parent's page tables.  Use fork()
+    // only for setup that posix_spawn() cannot express.
+    bool useSpawn = priority == ProcessPriority::PRIORITY_INHERIT;
+#ifndef HAVE_SPAWN_CHDIR
+    if (!wd.empty()) useSpawn = false;
+#endif
+
+    // With fork() exec errors are reported back on a close-on-exec pipe so
+    // that both paths throw in the parent
+    int errPipe[2] = {-1, -1};
+    if (!useSpawn) {
+#ifdef HAVE_PIPE2
+      // Set close-on-exec atomically so other threads cannot leak the pipe
+      if (pipe2(errPipe, O_CLOEXEC))
+        THROW("Failed to create pipe: " << SysError());
+#else
+      if (pipe(errPipe)) THROW("Failed to create pipe: " << SysError());
+      fcntl(errPipe[0], F_SETFD, FD_CLOEXEC);
+      fcntl(errPipe[1], F_SETFD, FD_CLOEXEC);
+#endif
+    }
+
+    if (useSpawn) p->pid = spawn(p->pipes, args, flags, wd, *this);
+    else p->pid = fork();
+
+    if (p->pid == -1) {
+      SysError err;
+      ::close(errPipe[0]);
+      ::close(errPipe[1]);
+      THROW("Failed to spawn subprocess: " << err);
+    }
 
     if (!p->pid) { // Child
+      ::close(errPipe[0]);
+
       // Process group
       if (flags & CREATE_PROCESS_GROUP) setpgid(0, 0);
 
@@ -426,30 +560,55 @@ void Subprocess::exec(const vector<string> &_args, unsigned flags,
       for (unsigned i = 3; i < p->pipes.size(); i++)
         p->pipes[i].inChildProc();
 
+      int err = 0;
+
       // Priority
-      SystemUtilities::setPriority(priority);
+      try {
+        SystemUtilities::setPriority(priority);
+      } catch (...) {err = SysError::get();}
 
       // Working directory
-      if (wd != "") SystemUtilities::chdir(wd);
+      if (!err && wd != "" && ::chdir(wd.c_str())) err = errno;
 
-      // Setup environment
-      if (flags & CLEAR_ENVIRONMENT) SystemUtilities::clearenv();
+      if (!err) {
+        // Setup environment
+        if (flags & CLEAR_ENVIRONMENT) SystemUtilities::clearenv();
 
-      for (iterator it = begin(); it != end(); it++)
-        SystemUtilities::setenv(it->first, it->second);
+        for (iterator it = begin(); it != end(); it++)
+          SystemUtilities::setenv(it->first, it->second);
 
-      SysError::clear();
+        if (flags & SHELL) execvp(args[0], &args[0]);
+        else execv(args[0], &args[0]);
 
-      if (flags & SHELL) execvp(args[0], &args[0]);
-      else execv(args[0], &args[0]);
+        err = errno;
+      }
 
-      // Execution failed
-      string errorStr = "Failed to execute: " + String::join(_args);
-      perror(errorStr.c_str());
-      exit(-1);
+      // Execution failed, report to the parent.  Don't run atexit() handlers
+      // or flush stdio buffers copied from the parent.
+      if (write(errPipe[1], &err, sizeof(err))) {}
+      _exit(127);
+    }
+
+    if (!useSpawn) {
+      ::close(errPipe[1]);
+
+      int err = 0;
+      ssize_t ret;
+      do ret = read(errPipe[0], &err, sizeof(err));
+      while (ret == -1 && errno == EINTR);
+      ::close(errPipe[0]);
 
-    } else if (p->pid == -1)
-      THROW("Failed to spawn subprocess: " << SysError());
+      if (ret == sizeof(err)) {
+        // Reap the child
+        try {
+          SystemUtilities::waitPID(p->pid);
+        } CATCH_DEBUG(3);
+        p->pid = 0;
+
+        THROW("Failed to execute: " << assemble(_args) << ": "
+              << SysError(err));
+      }
+    }
 #endif // _WIN32
 
   } catch (...) {
@@ -36,6 +36,7 @@
 #include <cbang/Info.h>
 #include <cbang/SStream.h>
 #include <cbang/String.h>
+#include <cbang/Catch.h>
 
 #include <cbang/os/Thread.h>
 #include <cbang/os/SystemUtilities.h>
@@ -45,6 +46,10 @@
 
 #include <boost/filesystem/operations.hpp>
 
+#include <map>
+#include <set>
+#include <algorithm>
+
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN // Avoid including winsock.h
 #include <windows.h>
@@ -77,8 +82,71 @@ using namespace std;
 namespace fs = boost::filesystem;
 
 
-SystemInfo::SystemInfo(Inaccessible) {
+namespace {
+  string readSysFS(const string &path) {
+    return String::trim(SystemUtilities::read(path));
+  }
+
+
+  unsigned readSysFSID(const string &path) {
+    if (!SystemUtilities::exists(path)) return 0;
+    int32_t id = String::parseS32(readSysFS(path));
+    return id < 0 ? 0 : id; // Some VMs report -1
+  }
+
+
+  uint64_t parseCacheSize(const string &size) {
+    if (size.empty()) return 0;
+
+    uint64_t scale = 1;
+    switch (size[size.length() - 1]) {
+    case 'K': scale = 1 << 10; break;
+    case 'M': scale = 1 << 20; break;
+    case 'G': scale = 1 << 30; break;
+    }
+
+    return String::parseU64(scale == 1 ? size :
+                            size.substr(0, size.length() - 1)) * scale;
+  }
+
+
+  bool compactLess(const SystemInfo::cpu_t &a, const SystemInfo::cpu_t &b) {
+    if (a.node != b.node) return a.node < b.node;
+    if (a.socket != b.socket) return a.socket < b.socket;
+    if (a.core != b.core) return a.core < b.core;
+    if (a.thread != b.thread) return a.thread < b.thread;
+    return a.id < b.id;
+  }
+}
+
+
+SystemInfo::SystemInfo(Inaccessible) : sockets(1), cores(1), nodes(1) {
   detectThreads();
+  detectTopology();
+}
+
+
+SystemInfo::cpus_t SystemInfo::parseCPUList(const string &list) {
+  cpus_t result;
+  vector<string> ranges;
+  String::tokenize(String::trim(list), ranges, ",");
+
+  for (unsigned i = 0; i < ranges.size(); i++) {
+    if (ranges[i].find_first_not_of("0123456789-") != string::npos)
+      THROW("Invalid CPU list '" << list << "'");
+
+    string::size_type dash = ranges[i].find('-');
+
+    if (dash == string::npos) result.push_back(String::parseU32(ranges[i]));
+    else {
+      unsigned first = String::parseU32(ranges[i].substr(0, dash));
+      unsigned last = String::parseU32(ranges[i].substr(dash + 1));
+      if (last < first) THROW("Invalid CPU range '" << ranges[i] << "'");
+      for (unsigned j = first; j <= last; j++) result.push_back(j);
+    }
+  }
+
+  return result;
 }
 
 
@@ -110,6 +178,106 @@ uint32_t SystemInfo::getCPUCount() const {
 }
 
 
+unsigned SystemInfo::getThreadsPerCore() const {
+  unsigned threads = 1;
+
+  for (unsigned i = 0; i < cpus.size(); i++)
+    if (threads <= cpus[i].thread) threads = cpus[i].thread + 1;
+
+  return threads;
+}
+
+
+unsigned SystemInfo::getNUMANode(unsigned cpu) const {
+  for (unsigned i = 0; i < cpus.size(); i++)
+    if (cpus[i].id == cpu) return cpus[i].node;
+
+  return 0;
+}
+
+
+SystemInfo::cpus_t SystemInfo::getNUMANodeCPUs(unsigned node) const {
+  cpus_t result;
+
+  for (unsigned i = 0; i < cpus.size(); i++)
+    if (cpus[i].node == node) result.push_back(cpus[i].id);
+
+  return result;
+}
+
+
+uint64_t SystemInfo::getCacheSize(unsigned level) const {
+  for (unsigned i = 0; i < caches.size(); i++)
+    if (caches[i].level == level && caches[i].type != "Instruction")
+      return caches[i].size;
+
+  return 0;
+}
+
+
+vector<SystemInfo::cpus_t>
+SystemInfo::getPlacement(ThreadPlacement placement, unsigned count) const {
+  vector<cpus_t> result(count);
+  if (placement == ThreadPlacement::PLACEMENT_NONE || cpus.empty())
+    return result;
+
+  vector<cpu_t> order = cpus;
+  sort(order.begin(), order.end(), compactLess);
+
+  switch (placement) {
+  case ThreadPlacement::PLACEMENT_COMPACT:
+    for (unsigned i = 0; i < count; i++)
+      result[i].push_back(order[i % order.size()].id);
+    break;
+
+  case ThreadPlacement::PLACEMENT_SCATTER: {
+    // Rank each core within its socket then order by SMT thread, rank, socket
+    typedef pair<unsigned, pair<unsigned, unsigned> > key_t;
+    map<key_t, unsigned> scatter;
+    map<unsigned, unsigned> socketCores;
+    map<unsigned, unsigned> coreRank;
+
+    for (unsigned i = 0; i < order.size(); i++)
+      if (coreRank.find(order[i].core) == coreRank.end())
+        coreRank[order[i].core] = socketCores[order[i].socket]++;
+
+    for (unsigned i = 0; i < order.size(); i++) {
+      const cpu_t &cpu = order[i];
+      key_t key(cpu.thread, make_pair(coreRank[cpu.core], cpu.socket));
+      scatter[key] = cpu.id;
+    }
+
+    vector<unsigned> ids;
+    for (map<key_t, unsigned>::iterator it = scatter.begin();
+         it != scatter.end(); it++)
+      ids.push_back(it->second);
+
+    for (unsigned i = 0; i < count; i++)
+      result[i].push_back(ids[i % ids.size()]);
+    break;
+  }
+
+  case ThreadPlacement::PLACEMENT_ONE_PER_CORE: {
+    vector<cpus_t> coreCPUs;
+
+    for (unsigned i = 0; i < order.size(); i++) {
+      if (!i || order[i].core != order[i - 1].core)
+        coreCPUs.push_back(cpus_t());
+      coreCPUs.back().push_back(order[i].id);
+    }
+
+    for (unsigned i = 0; i < count; i++)
+      result[i] = coreCPUs[i % coreCPUs.size()];
+    break;
+  }
+
+  default: break;
+  }
+
+  return result;
+}
+
+
 uint64_t SystemInfo::getMemoryInfo(memory_info_t type) const {
 #if defined(_WIN32)
   MEMORYSTATUSEX info;
@@ -227,6 +395,16 @@ void SystemInfo::add(Info &info) {
            SSTR(getCPUVendor() << " Family " << getCPUFamily() << " Model "
                 << getCPUModel() << " Stepping " << getCPUStepping()));
   info.add(category, "CPUs", String(getCPUCount()));
+  info.add(category, "CPU Sockets", String(getSocketCount()));
+  info.add(category, "CPU Cores", String(getCoreCount()));
+  info.add(category, "Threads per Core", String(getThreadsPerCore()));
+  info.add(category, "NUMA Nodes", String(getNUMANodeCount()));
+
+  for (unsigned level = 1; level <= 3; level++) {
+    uint64_t size = getCacheSize(level);
+    if (size) info.add(category, SSTR("L" << level << " Cache"),
+                       HumanSize(size).toString() + "B");
+  }
 
   info.add(category, "Memory", HumanSize(getTotalMemory()).toString() + "B");
   info.add(category, "Free Memory",
@@ -273,3 +451,143 @@ void SystemInfo::detectThreads() {
   threadsType = ThreadsType::POSIX_THREADS;
 #endif
 }
+
+
+void SystemInfo::detectTopology() {
+#ifdef __linux__
+  try {
+    if (readSysFSTopology()) return;
+  } CATCH_WARNING;
+#endif
+
+  cpus.clear();
+  caches.clear();
+  readCPUIDTopology();
+}
+
+
+bool SystemInfo::readSysFSTopology(const string &root) {
+  const string cpuDir = root + "/cpu/";
+  const string nodeDir = root + "/node/";
+
+  if (!SystemUtilities::exists(cpuDir + "online")) return false;
+
+  cpus.clear();
+  caches.clear();
+
+  // NUMA nodes
+  map<unsigned, unsigned> cpuNodes;
+  set<unsigned> nodeIDs;
+
+  if (SystemUtilities::exists(nodeDir + "online")) {
+    cpus_t online = parseCPUList(readSysFS(nodeDir + "online"));
+
+    for (unsigned i = 0; i < online.size(); i++) {
+      string path = nodeDir + "node" + String(online[i]) + "/cpulist";
+      if (!SystemUtilities::exists(path)) continue;
+
+      cpus_t nodeCPUs = parseCPUList(readSysFS(path));
+      for (unsigned j = 0; j < nodeCPUs.size(); j++)
+        cpuNodes[nodeCPUs[j]] = online[i];
+    }
+  }
+
+  // CPUs
+  map<pair<unsigned, unsigned>, unsigned> coreIDs;
+  map<unsigned, unsigned> coreThreads;
+  set<unsigned> socketIDs;
+
+  cpus_t online = parseCPUList(readSysFS(cpuDir + "online"));
+  for (unsigned i = 0; i < online.size(); i++) {
+    string topo = cpuDir + "cpu" + String(online[i]) + "/topology/";
+
+    cpu_t cpu;
+    cpu.id = online[i];
+    cpu.socket = readSysFSID(topo + "physical_package_id");
+    cpu.node = cpuNodes.count(cpu.id) ? cpuNodes[cpu.id] : 0;
+
+    // Core IDs are only unique within a socket
+    pair<unsigned, unsigned> key(cpu.socket, readSysFSID(topo + "core_id"));
+    if (coreIDs.find(key) == coreIDs.end()) {
+      unsigned index = coreIDs.size();
+      coreIDs[key] = index;
+    }
+
+    cpu.core = coreIDs[key];
+    cpu.thread = coreThreads[cpu.core]++;
+
+    socketIDs.insert(cpu.socket);
+    nodeIDs.insert(cpu.node);
+    cpus.push_back(cpu);
+  }
+
+  if (cpus.empty()) return false;
+
+  // Caches, as seen by the first CPU
+  string cacheDir = cpuDir + "cpu" + String(cpus[0].id) + "/cache/";
+  for (unsigned i = 0; SystemUtilities::exists(cacheDir + "index" + String(i));
+       i++) {
+    string dir = cacheDir + "index" + String(i) + "/";
+
+    cache_t cache;
+    cache.level = String::parseU32(readSysFS(dir + "level"));
+    cache.type = readSysFS(dir + "type");
+    cache.size = parseCacheSize(readSysFS(dir + "size"));
+    cache.shared = SystemUtilities::exists(dir + "shared_cpu_list") ?
+      parseCPUList(readSysFS(dir + "shared_cpu_list")).size() : 1;
+
+    caches.push_back(cache);
+  }
+
+  sockets = socketIDs.size();
+  cores = coreIDs.size();
+  nodes = nodeIDs.size();
+
+  return true;
+}
+
+
+void SystemInfo::readCPUIDTopology() {
+  uint32_t logical, coresPerSocket, threads;
+  getCPUCounts(logical, coresPerSocket, threads);
+
+  unsigned count = getCPUCount();
+  if (!threads || count % threads) threads = 1;
+
+  for (unsigned i = 0; i < count; i++) {
+    cpu_t cpu;
+    cpu.id = i;
+    cpu.core = i / threads;
+    cpu.thread = i % threads;
+    cpu.socket = 0;
+    cpu.node = 0;
+    cpus.push_back(cpu);
+  }
+
+  sockets = nodes = 1;
+  cores = count / threads;
+
+  // Deterministic cache parameters, Intel leaf 4 or AMD leaf 0x8000001d
+  uint32_t leaf = 0;
+  string vendor = getCPUVendor();
+  if (vendor == "GenuineIntel") leaf = 4;
+  else if ((vendor == "AuthenticAMD" || vendor == "HygonGenuine") &&
+           0x8000001d <= cpuID(0x80000000).EAX()) leaf = 0x8000001d;
+  if (!leaf) return;
+
+  for (uint32_t i = 0; i < 16; i++) {
+    cpuID(leaf, 0, i);
+
+    unsigned type = EAX(4, 0);
+    if (!type) break;
+
+    cache_t cache;
+    cache.level = EAX(7, 5);
+    cache.type = type == 1 ? "Data" : (type == 2 ? "Instruction" : "Unified");
+    cache.size = (uint64_t)(EBX(31, 22) + 1) * (EBX(21, 12) + 1) *
+      (EBX(11, 0) + 1) * ((uint64_t)ECX() + 1);
+    cache.shared = EAX(25, 14) + 1;
+
+    caches.push_back(cache);
+  }
+}
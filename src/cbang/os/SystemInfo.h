@@ -41,16 +41,44 @@
 #include <cbang/util/Version.h>
 
 #include <cbang/enum/ThreadsType.h>
+#include <cbang/enum/ThreadPlacement.h>
 
 #include <vector>
+#include <string>
 #include <utility>
 
 namespace cb {
   class Info;
 
   class SystemInfo : public Singleton<SystemInfo>, public CPUID {
+  public:
+    /// A logical CPU and its place in the system topology
+    struct cpu_t {
+      unsigned id;     ///< Logical CPU number, as used for affinity
+      unsigned core;   ///< System wide physical core index
+      unsigned thread; ///< SMT thread index within the core
+      unsigned socket; ///< Physical package index
+      unsigned node;   ///< NUMA node
+    };
+
+    struct cache_t {
+      unsigned level;
+      std::string type; ///< Data, Instruction or Unified
+      uint64_t size;    ///< In bytes
+      unsigned shared;  ///< Number of logical CPUs sharing each instance
+    };
+
+    typedef std::vector<unsigned> cpus_t;
+
+  protected:
     ThreadsType threadsType;
 
+    std::vector<cpu_t> cpus;
+    std::vector<cache_t> caches;
+    unsigned sockets;
+    unsigned cores;
+    unsigned nodes;
+
   public:
     typedef enum {
       MEM_INFO_TOTAL,
@@ -62,8 +90,42 @@ namespace cb {
     SystemInfo(Inaccessible);
 
     uint32_t getCPUCount() const;
+    /// Parse a Linux CPU list such as "0-3,8,10-11".
+    static cpus_t parseCPUList(const std::string &list);
     ThreadsType getThreadsType() {return threadsType;}
 
+    const std::vector<cpu_t> &getCPUs() const {return cpus;}
+    const std::vector<cache_t> &getCaches() const {return caches;}
+    unsigned getSocketCount() const {return sockets;}
+    unsigned getCoreCount() const {return cores;}
+    unsigned getThreadsPerCore() const;
+    unsigned getNUMANodeCount() const {return nodes;}
+    /// @return The NUMA node of logical CPU @param cpu.
+    unsigned getNUMANode(unsigned cpu) const;
+    cpus_t getNUMANodeCPUs(unsigned node) const;
+    /// @return The size of the data or unified cache at @param level or 0.
+    uint64_t getCacheSize(unsigned level) const;
+
+    /**
+     * Choose CPUs for @param count threads.
+     *   PLACEMENT_NONE         No restriction, all lists are empty.
+     *   PLACEMENT_COMPACT      One logical CPU each, filling the SMT threads
+     *                          and cores of one socket before the next.
+     *   PLACEMENT_SCATTER      One logical CPU each, spread round-robin over
+     *                          sockets and using SMT siblings last.
+     *   PLACEMENT_ONE_PER_CORE All of one core's logical CPUs each.
+     * Threads wrap around when there are more threads than CPUs or cores.
+     */
+    std::vector<cpus_t> getPlacement(ThreadPlacement placement,
+                                     unsigned count) const;
+
+    /**
+     * Replace the topology with the one described by a Linux sysfs tree.
+     * @param root may point at a copy of the tree, e.g. for testing.
+     * @return False if no CPUs were found.
+     */
+    bool readSysFSTopology(const std::string &root = "/sys/devices/system");
+
     uint64_t getMemoryInfo(memory_info_t type) const;
     uint64_t getTotalMemory() const {return getMemoryInfo(MEM_INFO_TOTAL);}
     uint64_t getFreeMemory() const {return getMemoryInfo(MEM_INFO_FREE);}
@@ -78,5 +140,7 @@ namespace cb {
 
   protected:
     void detectThreads();
+    void detectTopology();
+    void readCPUIDTopology();
   };
 }
@@ -81,6 +81,13 @@
 #include <mach-o/dyld.h>
 #endif // __APPLE__
 
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/fs.h> // For FICLONE
+#endif // __linux__
+
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -582,11 +589,184 @@ namespace cb {
     }
 
 
-    uint64_t cp(const string &src, const string &dst, uint64_t length) {
+#ifndef _WIN32
+    static const uint64_t copyChunk = 16 * 1024 * 1024;
+
+
+    /// Other errors are real failures and must not be hidden by a fallback
+    static bool isUnsupported(int err) {
+      return err == ENOSYS || err == EXDEV || err == EOPNOTSUPP ||
+        err == ENOTTY || err == EINVAL;
+    }
+
+
+    static bool copyRange(int in, int out, uint64_t offset, uint64_t end,
+                          const SmartPointer<TransferCallback> &callback,
+                          bool &useCopyRange, bool &useSendFile,
+                          uint64_t &bytes, bool &stopped) {
+      while (offset < end) {
+        size_t size = end - offset < copyChunk ? end - offset : copyChunk;
+        ssize_t ret = -1;
+
+#ifdef __NR_copy_file_range
+        if (useCopyRange) {
+          loff_t inOff = offset;
+          loff_t outOff = offset;
+          ret = syscall(__NR_copy_file_range, in, &inOff, out, &outOff, size,
+                        0);
+          if (ret < 0 && !bytes && isUnsupported(errno)) useCopyRange = false;
+        }
+#else
+        useCopyRange = false;
+#endif
+
+#ifdef __linux__
+        if (!useCopyRange && useSendFile) {
+          off_t inOff = offset;
+          if (lseek(out, offset, SEEK_SET) == (off_t)-1) return false;
+          ret = sendfile(out, in, &inOff, size);
+          if (ret < 0 && !bytes && isUnsupported(errno)) useSendFile = false;
+        }
+#else
+        useSendFile = false;
+#endif
+
+        if (!useCopyRange && !useSendFile) return false;
+        if (ret < 0) {
+          if (errno == EINTR) continue;
+          THROW("Copy failed: " << SysError());
+        }
+        // Pseudo-files, such as those in /proc and /sys, report a size but
+        // end early.  Let the stream copy read them to the end instead.
+        if (!ret) return false;
+
+        offset += ret;
+        bytes += ret;
+
+        if (!callback.isNull() && !callback->transferCallback(ret)) {
+          stopped = true;
+          return true;
+        }
+      }
+
+      return true;
+    }
+
+
+    /// @return False if no in kernel copy method is available
+    static bool fastCopy(int in, int out, uint64_t end, bool whole,
+                         const SmartPointer<TransferCallback> &callback,
+                         uint64_t &bytes) {
+#ifdef FICLONE
+      // Share extents on copy-on-write file systems
+      if (whole && !ioctl(out, FICLONE, in)) {
+        if (callback.isNull()) {
+          bytes = end;
+          return true;
+        }
+
+        // Report progress as copyRange() would, the callback may stop it
+        while (bytes < end) {
+          uint64_t size = end - bytes < copyChunk ? end - bytes : copyChunk;
+          bytes += size;
+
+          if (!callback->transferCallback(size)) {
+            if (ftruncate(out, bytes))
+              THROW("Failed to set file size: " << SysError());
+            break;
+          }
+        }
+
+        return true;
+      }
+#endif
+
+      bool useCopyRange = true;
+      bool useSendFile = true;
+      uint64_t offset = 0;
+
+      while (offset < end) {
+        uint64_t dataEnd = end;
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+        // Skip holes so sparse files stay sparse
+        off_t data = lseek(in, offset, SEEK_DATA);
+        if (data == (off_t)-1) {
+          if (errno == ENXIO) break; // Only a hole remains
+          // Otherwise SEEK_DATA is unsupported, copy everything
+
+        } else {
+          if (end <= (uint64_t)data) break;
+          offset = data;
+
+          off_t hole = lseek(in, offset, SEEK_HOLE);
+          if (hole != (off_t)-1 && (uint64_t)hole < end) dataEnd = hole;
+        }
+#endif
+
+        bool stopped = false;
+        if (!copyRange(in, out, offset, dataEnd, callback, useCopyRange,
+                       useSendFile, bytes, stopped)) return false;
+        if (stopped) return true;
+
+        offset = dataEnd;
+      }
+
+      // Extend the file over any trailing hole
+      if (ftruncate(out, end)) THROW("Failed to set file size: " << SysError());
+      bytes = end;
+
+      return true;
+    }
+#endif // _WIN32
+
+
+    uint64_t cp(const string &src, const string &dst, uint64_t length,
+                SmartPointer<TransferCallback> callback) {
+#ifndef _WIN32
+      ensureDirectory(dirname(dst));
+
+      int inFD = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+      if (inFD == -1)
+        THROW("Failed to open '" << src << "': " << SysError());
+
+      // Files in /proc report a zero size, leave them to the stream copy
+      struct stat st;
+      if (!fstat(inFD, &st) && S_ISREG(st.st_mode) && st.st_size) {
+        int outFD = ::open(dst.c_str(),
+                           O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (outFD == -1) {
+          ::close(inFD);
+          THROW("Failed to open '" << dst << "': " << SysError());
+        }
+
+        uint64_t end = (uint64_t)st.st_size < length ? st.st_size : length;
+        uint64_t bytes = 0;
+        bool done;
+
+        try {
+          bool whole = end == (uint64_t)st.st_size;
+          done = fastCopy(inFD, outFD, end, whole, callback, bytes);
+        } catch (const Exception &e) {
+          ::close(inFD);
+          ::close(outFD);
+          THROWC("Failed to copy '" << src << "' to '" << dst << "'", e);
+        }
+
+        ::close(inFD);
+        if (::close(outFD))
+          THROW("Failed to copy '" << src << "' to '" << dst << "': "
+                << SysError());
+
+        if (done) return bytes;
+
+      } else ::close(inFD);
+#endif // _WIN32
+
       SmartPointer<iostream> in = open(src, ios::in);
       SmartPointer<iostream> out = open(dst, ios::out | ios::trunc);
 
-      uint64_t bytes = cp(*in, *out, length);
+      uint64_t bytes = cp(*in, *out, length, callback);
 
       if (out->fail())
         THROW("Failed to copy '" << src << "' to '" << dst << "'");
@@ -595,7 +775,8 @@ namespace cb {
     }
 
 
-    uint64_t cp(istream &in, ostream &out, uint64_t length) {
+    uint64_t cp(istream &in, ostream &out, uint64_t length,
+                SmartPointer<TransferCallback> callback) {
       char buffer[4096];
       uint64_t bytes = 0;
 
@@ -609,6 +790,8 @@ namespace cb {
           bytes += size;
           out.write(buffer, size);
           length -= size;
+
+          if (!callback.isNull() && !callback->transferCallback(size)) break;
         }
       }
 
@@ -40,6 +40,7 @@
 #include <cbang/util/StringMap.h>
 
 #include <cbang/enum/ProcessPriority.h>
+#include <cbang/iostream/Transfer.h>
 
 #include <limits>
 
@@ -105,9 +106,21 @@ namespace cb {
     bool unlink(const std::string &filename);
     void symlink(const std::string &oldname, const std::string &newname);
     void link(const std::string &oldname, const std::string &newname);
+    /**
+     * Copy a file.  Regular files are copied in the kernel when possible,
+     * trying a copy-on-write reflink, then copy_file_range() and sendfile(),
+     * before falling back to copying through streams.  Holes in sparse
+     * files are preserved.
+     *
+     * @param callback Called with the size of each copied chunk.  Returning
+     *   false stops the copy early.
+     * @return The number of bytes copied.
+     */
     uint64_t cp(const std::string &src, const std::string &dst,
-                uint64_t length = ~0);
-    uint64_t cp(std::istream &in, std::ostream &out, uint64_t length = ~0);
+                uint64_t length = ~0,
+                SmartPointer<TransferCallback> callback = 0);
+    uint64_t cp(std::istream &in, std::ostream &out, uint64_t length = ~0,
+                SmartPointer<TransferCallback> callback = 0);
     void rename(const std::string &src, const std::string &dst);
     SmartPointer<std::iostream>
     open(const std::string &filename,
@@ -54,6 +54,12 @@
 #include <errno.h>
 #endif
 
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
 #ifdef __APPLE__
 #include <sched.h>
 #endif // __APPLE__
@@ -92,12 +98,49 @@ static void *start_func(void *t) {
 }
 #endif
 
+
+namespace {
+#ifdef _WIN32
+  void setThreadAffinity(HANDLE h, const Thread::cpus_t &cpus) {
+    DWORD_PTR mask = 0;
+    DWORD_PTR systemMask;
+
+    if (cpus.empty()) GetProcessAffinityMask(GetCurrentProcess(), &mask,
+                                             &systemMask);
+
+    for (unsigned i = 0; i < cpus.size(); i++)
+      if (cpus[i] < 8 * sizeof(mask)) mask |= (DWORD_PTR)1 << cpus[i];
+      else THROW("CPU " << cpus[i] << " out of range");
+
+    if (!SetThreadAffinityMask(h, mask))
+      THROW("Failed to set thread affinity: " << SysError());
+  }
+
+#elif defined(__linux__)
+  void setThreadAffinity(pthread_t thread, const Thread::cpus_t &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    if (cpus.empty())
+      for (unsigned i = 0; i < CPU_SETSIZE; i++) CPU_SET(i, &set);
+
+    for (unsigned i = 0; i < cpus.size(); i++)
+      if (cpus[i] < CPU_SETSIZE) CPU_SET(cpus[i], &set);
+      else THROW("CPU " << cpus[i] << " out of range");
+
+    int err = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (err) THROW("Failed to set thread affinity: " << SysError(err));
+  }
+#endif
+}
+
+
 ThreadLocalStorage<Thread *> Thread::threads;
 
 
 Thread::Thread(bool destroy) :
   p(new Thread::private_t), state(THREAD_STOPPED), shutdown(false),
-  destroy(destroy), id(getNextID()), exitStatus(0) {
+  destroy(destroy), id(getNextID()), exitStatus(0), numaNode(-1) {
 
 #ifdef HAVE_VALGRIND
   VALGRIND_HG_DISABLE_CHECKING(state, sizeof(state));
@@ -189,6 +232,19 @@ void Thread::wait() {
 }
 
 
+void Thread::setAffinity(const cpus_t &cpus) {
+  affinity = cpus;
+
+  if (state != THREAD_RUNNING) return;
+
+#ifdef _WIN32
+  setThreadAffinity(p->h, cpus);
+#elif defined(__linux__)
+  setThreadAffinity(p->thread, cpus);
+#endif
+}
+
+
 void Thread::cancel() {
   stop();
 
@@ -233,10 +289,45 @@ uint64_t Thread::self() {
 Thread &Thread::current() {return *threads.get();}
 
 
+void Thread::setCurrentAffinity(const cpus_t &cpus) {
+#ifdef _WIN32
+  setThreadAffinity(GetCurrentThread(), cpus);
+#elif defined(__linux__)
+  setThreadAffinity(pthread_self(), cpus);
+#endif
+}
+
+
+void Thread::setCurrentNUMANode(int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  const int MPOL_DEFAULT = 0;
+  const int MPOL_PREFERRED = 1;
+  const unsigned bits = 8 * sizeof(unsigned long);
+
+  long ret;
+  if (node < 0) ret = syscall(SYS_set_mempolicy, MPOL_DEFAULT, 0, 0);
+  else {
+    vector<unsigned long> mask(node / bits + 1);
+    mask[node / bits] = 1UL << (node % bits);
+
+    ret = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask[0],
+                  mask.size() * bits + 1);
+  }
+
+  if (ret) THROW("Failed to set NUMA memory policy: " << SysError());
+#endif
+}
+
+
 void Thread::starter() {
   state = THREAD_RUNNING;
   threads.set(this);
 
+  try {
+    if (!affinity.empty()) setCurrentAffinity(affinity);
+    if (numaNode != -1) setCurrentNUMANode(numaNode);
+  } CATCH_WARNING;
+
   try {
     Logger::instance().setThreadID(getID());
     LOG_INFO(5, "Started thread " << getID() << " on PID "
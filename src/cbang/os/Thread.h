@@ -35,6 +35,8 @@
 #include <cbang/StdTypes.h>
 #include <cbang/util/UniqueID.h>
 
+#include <vector>
+
 namespace cb {
   template <typename T> class ThreadLocalStorage;
 
@@ -48,6 +50,8 @@ namespace cb {
       THREAD_DONE,
     };
 
+    typedef std::vector<unsigned> cpus_t;
+
   protected:
     struct private_t;
     private_t *p;
@@ -57,6 +61,8 @@ namespace cb {
     bool destroy;
     unsigned id;
     int exitStatus;
+    cpus_t affinity;
+    int numaNode;
 
     static ThreadLocalStorage<Thread *> threads;
 
@@ -109,6 +115,23 @@ namespace cb {
      */
     bool shouldShutdown() const {return shutdown;}
 
+    /**
+     * Restrict the thread to the listed logical CPUs, as numbered by
+     * SystemInfo::getCPUs().  An empty list removes the restriction.  The
+     * change takes effect immediately if the thread is running, otherwise
+     * when it starts.  Not supported on OS-X where this is ignored.
+     */
+    void setAffinity(const cpus_t &cpus);
+    const cpus_t &getAffinity() const {return affinity;}
+
+    /**
+     * Prefer memory from NUMA node @param node, or the system default
+     * if -1.  Memory policy is per thread so this takes effect when the
+     * thread next starts.  Only supported on Linux.
+     */
+    void setNUMANode(int node) {numaNode = node;}
+    int getNUMANode() const {return numaNode;}
+
     void cancel();
 
     /// Deliver a signal to the thread
@@ -122,6 +145,11 @@ namespace cb {
 
     static Thread &current();
 
+    /// Set the CPU affinity of the calling thread.  See setAffinity().
+    static void setCurrentAffinity(const cpus_t &cpus);
+    /// Set the preferred NUMA node of the calling thread.  See setNUMANode().
+    static void setCurrentNUMANode(int node);
+
     /// This function is used internally to start the thread.
     virtual void starter();
 
@@ -31,18 +31,31 @@
 \******************************************************************************/
 
 #include "ThreadPool.h"
+#include "SystemInfo.h"
 
 using namespace cb;
 using namespace std;
 
 
-ThreadPool::ThreadPool(unsigned size) {
+ThreadPool::ThreadPool(unsigned size, ThreadPlacement placement) :
+  placement(placement) {
   for (unsigned i = 0; i < size; i++)
     pool.push_back(new ThreadFunc<ThreadPool>(this, &ThreadPool::run));
 }
 
 
 void ThreadPool::start() {
+  if (placement != ThreadPlacement::PLACEMENT_NONE) {
+    SystemInfo &info = SystemInfo::instance();
+    vector<Thread::cpus_t> cpus = info.getPlacement(placement, pool.size());
+
+    for (unsigned i = 0; i < pool.size(); i++) {
+      pool[i]->setAffinity(cpus[i]);
+      if (1 < info.getNUMANodeCount() && !cpus[i].empty())
+        pool[i]->setNUMANode(info.getNUMANode(cpus[i][0]));
+    }
+  }
+
   for (iterator it = begin(); it != end(); it++)
     (*it)->start();
 }
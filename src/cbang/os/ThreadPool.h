@@ -35,6 +35,7 @@
 #include "Thread.h"
 
 #include <cbang/SmartPointer.h>
+#include <cbang/enum/ThreadPlacement.h>
 
 #include <vector>
 
@@ -44,11 +45,21 @@ namespace cb {
   class ThreadPool {
     typedef std::vector<SmartPointer<Thread> > pool_t;
     pool_t pool;
+    ThreadPlacement placement;
 
   public:
-    ThreadPool(unsigned size);
+    ThreadPool(unsigned size,
+               ThreadPlacement placement = ThreadPlacement::PLACEMENT_NONE);
     virtual ~ThreadPool() {}
 
+    /**
+     * Pin pool threads to CPUs, and their memory to the matching NUMA node,
+     * according to SystemInfo::getPlacement().  Applied by start().
+     */
+    void setPlacement(ThreadPlacement placement)
+    {this->placement = placement;}
+    ThreadPlacement getPlacement() const {return placement;}
+
     virtual void start();
     virtual void stop();
     virtual void join();
@@ -134,6 +134,30 @@ streamsize Socket::write(const char *data, streamsize length, unsigned flags) {
 }
 
 
+streamsize Socket::writev(const Segment *segments, unsigned count,
+                          unsigned flags) {
+  if (!isOpen()) THROW("Socket not open");
+
+  streamsize bytes = impl->writev(segments, count, flags);
+
+  LOG_DEBUG(5, "Socket writev " << bytes << " from " << count << " segments");
+
+  return bytes;
+}
+
+
+streamsize Socket::sendFile(int fd, uint64_t offset, streamsize length,
+                            unsigned flags) {
+  if (!isOpen()) THROW("Socket not open");
+
+  streamsize bytes = impl->sendFile(fd, offset, length, flags);
+
+  LOG_DEBUG(5, "Socket sendFile " << bytes);
+
+  return bytes;
+}
+
+
 streamsize Socket::read(char *data, streamsize length, unsigned flags) {
   if (!isOpen()) THROW("Socket not open");
   bool blocking = !(flags & NONBLOCKING) && getBlocking();
@@ -67,6 +67,8 @@ namespace cb {
       PEEK        = 1 << 1,
     };
 
+    typedef SocketImpl::Segment Segment;
+
 
     Socket();
     Socket(const SmartPointer<SSLContext> &sslCtx);
@@ -108,6 +110,20 @@ namespace cb {
     virtual std::streamsize write(const char *data, std::streamsize length,
                                   unsigned flags = 0);
 
+    /// Write several blocks of data with a single system call if possible.
+    /// @return The total bytes written, which may end mid segment.
+    virtual std::streamsize writev(const Segment *segments, unsigned count,
+                                   unsigned flags = 0);
+
+    /// @return True if sendFile() can send directly from a file.
+    virtual bool canSendFile() const {return impl->canSendFile();}
+
+    /// Send data directly from file descriptor @param fd starting at
+    /// @param offset.
+    virtual std::streamsize sendFile(int fd, uint64_t offset,
+                                     std::streamsize length,
+                                     unsigned flags = 0);
+
     /// Read data from an open connection.
     virtual std::streamsize read(char *data, std::streamsize length,
                                  unsigned flags = 0);
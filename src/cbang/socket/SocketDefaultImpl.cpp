@@ -62,6 +62,11 @@ typedef int socklen_t;  // Unix socket length
 #include <unistd.h>
 #include <fcntl.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 #define INVALID_SOCKET -1        // WinSock invalid socket
 #define SOCKET_ERROR   -1        // Basic WinSock error
@@ -75,6 +80,8 @@ typedef int socklen_t;  // Unix socket length
 #include <time.h>
 #include <string.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace cb;
 
@@ -323,6 +330,95 @@ streamsize SocketDefaultImpl::write(const char *data, streamsize length,
 }
 
 
+streamsize SocketDefaultImpl::writev(const Segment *segments, unsigned count,
+                                     unsigned flags) {
+#ifdef _WIN32
+  return SocketImpl::writev(segments, count, flags);
+
+#else
+  if (!isOpen()) THROW("Socket not open");
+
+  const unsigned maxSegments = 64;
+  if (maxSegments < count) count = maxSegments;
+
+  struct iovec iov[maxSegments];
+  streamsize length = 0;
+
+  for (unsigned i = 0; i < count; i++) {
+    iov[i].iov_base = (void *)segments[i].data;
+    iov[i].iov_len = segments[i].length;
+    length += segments[i].length;
+  }
+
+  if (!length) return 0;
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = count;
+
+  int f = MSG_NOSIGNAL;
+  if (flags & Socket::NONBLOCKING) f |= MSG_DONTWAIT;
+
+  SysError::clear();
+  streamsize ret = sendmsg((socket_t)socket, &msg, f);
+  int err = SysError::get();
+
+  LOG_DEBUG(5, "sendmsg() = " << ret << " of " << length);
+
+  if (ret < 0) {
+    if (err == EAGAIN) return 0;
+    THROW("Send error: " << err << ": " << SysError(err));
+  }
+
+  if (!out.isNull()) // Capture
+    for (unsigned i = 0, left = ret; left; i++) {
+      unsigned bytes = std::min(left, segments[i].length);
+      out->write(segments[i].data, bytes);
+      left -= bytes;
+    }
+
+  return ret;
+#endif
+}
+
+
+bool SocketDefaultImpl::canSendFile() const {
+#ifdef __linux__
+  return out.isNull(); // Captured data must pass through user space
+#else
+  return false;
+#endif
+}
+
+
+streamsize SocketDefaultImpl::sendFile(int fd, uint64_t offset,
+                                       streamsize length, unsigned flags) {
+#ifdef __linux__
+  if (!isOpen()) THROW("Socket not open");
+  if (!length) return 0;
+
+  // NOTE, sendfile() honors only the socket's blocking mode
+  off_t off = offset;
+  SysError::clear();
+  streamsize ret = ::sendfile((socket_t)socket, fd, &off, length);
+  int err = SysError::get();
+
+  LOG_DEBUG(5, "sendfile() = " << ret << " of " << length);
+
+  if (ret < 0) {
+    if (err == EAGAIN) return 0;
+    THROW("Sendfile error: " << err << ": " << SysError(err));
+  }
+
+  return ret;
+
+#else
+  return SocketImpl::sendFile(fd, offset, length, flags);
+#endif
+}
+
+
 streamsize SocketDefaultImpl::read(char *data, streamsize length,
                                    unsigned flags) {
   if (!isOpen()) THROW("Socket not open");
@@ -40,3 +40,17 @@ using namespace cb;
 Socket *SocketImpl::createSocket() {
   return new Socket;
 }
+
+
+std::streamsize SocketImpl::writev(const Segment *segments, unsigned count,
+                                   unsigned flags) {
+  std::streamsize total = 0;
+
+  for (unsigned i = 0; i < count; i++) {
+    std::streamsize bytes = write(segments[i].data, segments[i].length, flags);
+    total += bytes;
+    if (bytes < (std::streamsize)segments[i].length) break;
+  }
+
+  return total;
+}
@@ -50,6 +50,12 @@ namespace cb {
     Socket *parent;
 
   public:
+    /// A contiguous block of data for vectored writes
+    struct Segment {
+      const char *data;
+      unsigned length;
+    };
+
     SocketImpl(Socket *parent) : parent(parent) {}
     virtual ~SocketImpl() {}
 
@@ -77,6 +83,12 @@ namespace cb {
                                   unsigned flags) = 0;
     virtual std::streamsize read(char *data, std::streamsize length,
                                  unsigned flags) = 0;
+    virtual std::streamsize writev(const Segment *segments, unsigned count,
+                                   unsigned flags);
+    virtual bool canSendFile() const {return false;}
+    virtual std::streamsize sendFile(int fd, uint64_t offset,
+                                     std::streamsize length, unsigned flags)
+    {THROW("sendFile() not supported");}
     virtual void close() = 0;
     virtual socket_t get() const = 0;
   };
@@ -43,6 +43,8 @@
 
 #include <cbang/util/SmartToggle.h>
 
+#include <openssl/bio.h>
+
 using namespace cb;
 using namespace std;
 
@@ -66,6 +68,7 @@ SmartPointer<Socket> SocketSSLImpl::accept(IPAddress *ip) {
   SocketSSLImpl *impl = dynamic_cast<SocketSSLImpl *>(socket->getImpl());
   if (!impl) THROW("Expected SSL socket implementation");
 
+  impl->enableKTLS();
   SmartToggle toggle(impl->inSSL);
   impl->ssl->accept();
 
@@ -75,6 +78,7 @@ SmartPointer<Socket> SocketSSLImpl::accept(IPAddress *ip) {
 
 void SocketSSLImpl::connect(const IPAddress &ip) {
   SocketDefaultImpl::connect(ip);
+  enableKTLS();
   SmartToggle toggle(inSSL);
   if (ip.hasHost()) ssl->setTLSExtHostname(ip.getHost());
   ssl->connect();
@@ -114,6 +118,25 @@ streamsize SocketSSLImpl::read(char *data, streamsize length, unsigned flags) {
 }
 
 
+streamsize SocketSSLImpl::writev(const Segment *segments, unsigned count,
+                                 unsigned flags) {
+  // Each segment must be encrypted
+  return SocketImpl::writev(segments, count, flags);
+}
+
+
+bool SocketSSLImpl::canSendFile() const {
+  return !inSSL && ssl->isKTLSSend();
+}
+
+
+streamsize SocketSSLImpl::sendFile(int fd, uint64_t offset, streamsize length,
+                                   unsigned flags) {
+  SmartToggle toggle(inSSL);
+  return ssl->sendFile(fd, offset, length);
+}
+
+
 void SocketSSLImpl::close() {
   if (isOpen()) {
     SmartToggle toggle(inSSL);
@@ -122,4 +145,12 @@ void SocketSSLImpl::close() {
   SocketDefaultImpl::close();
 }
 
+
+void SocketSSLImpl::enableKTLS() {
+  // Kernel TLS requires that OpenSSL use the socket directly.  Captured
+  // data must pass through user space.
+  if (sslCtx->getKTLS() && SocketDefaultImpl::canSendFile())
+    ssl->setBIO(BIO_new_socket((int)get(), BIO_NOCLOSE));
+}
+
 #endif // HAVE_OPENSSL
@@ -64,6 +64,14 @@ namespace cb {
     std::streamsize write(const char *data, std::streamsize length,
                           unsigned flags);
     std::streamsize read(char *data, std::streamsize length, unsigned flags);
+    std::streamsize writev(const Segment *segments, unsigned count,
+                           unsigned flags);
+    bool canSendFile() const;
+    std::streamsize sendFile(int fd, uint64_t offset, std::streamsize length,
+                             unsigned flags);
     void close();
+
+  protected:
+    void enableKTLS();
   };
 }
@@ -123,7 +123,6 @@ void SocketServer::service() {
           }
 
           SocketConnectionPtr con = createConnection(client, clientIP);
-          con->setIncomingIP(ports[i]->ip);
           client = 0; // Release socket pointer
 
           if (con.isNull())
@@ -131,6 +130,7 @@ void SocketServer::service() {
                      << ports[i]->ip << " from " << clientIP);
 
           else {
+            con->setIncomingIP(ports[i]->ip);
             connections.push_back(con);
 
             LOG_INFO(3, "Server connection id=" << con->getID() << " on "
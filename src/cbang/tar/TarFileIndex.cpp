@@ -0,0 +1,450 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "TarFileIndex.h"
+
+#include <cbang/Exception.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/iostream/BZip2Decompressor.h>
+
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+namespace io = boost::iostreams;
+
+#include <zlib.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  const unsigned WINDOW_SIZE = 32768;
+  const unsigned CHUNK_SIZE = 65536;
+
+
+  uint64_t padded(uint64_t size) {return (size + 511) & ~(uint64_t)511;}
+}
+
+
+class TarFileIndex::Reader {
+  const TarFileIndex &index;
+  SmartPointer<istream> stream;
+  io::filtering_istream filter;
+
+  z_stream strm;
+  bool inflating;
+  bool raw;
+  unsigned trailer;
+  char in[CHUNK_SIZE];
+
+  uint64_t skip;
+  uint64_t left;
+
+public:
+  Reader(const TarFileIndex &index, const Entry &entry) :
+    index(index), stream(SystemUtilities::iopen(index.path)),
+    inflating(false), raw(false), trailer(0), skip(entry.offset),
+    left(entry.size) {
+
+    switch (index.compression) {
+    case TARFILE_NONE:
+      stream->seekg(entry.offset);
+      skip = 0;
+      break;
+
+    case TARFILE_BZIP2:
+      filter.push(BZip2Decompressor());
+      filter.push(*stream);
+      break;
+
+    case TARFILE_GZIP: startInflate(); break;
+    default: THROW("Invalid compression type " << index.compression);
+    }
+  }
+
+
+  ~Reader() {if (inflating) inflateEnd(&strm);}
+
+
+  streamsize read(char *s, streamsize n) {
+    if (!left) return -1;
+    if (left < (uint64_t)n) n = left;
+
+    switch (index.compression) {
+    case TARFILE_NONE:
+      stream->read(s, n);
+      n = stream->gcount();
+      break;
+
+    case TARFILE_BZIP2:
+      if (skip) filter.ignore(skip);
+      skip = 0;
+      filter.read(s, n);
+      n = filter.gcount();
+      break;
+
+    default:
+      while (skip) {
+        char buf[CHUNK_SIZE];
+        unsigned bytes = min(skip, (uint64_t)CHUNK_SIZE);
+        inflate(buf, bytes);
+        skip -= bytes;
+      }
+
+      inflate(s, n);
+      break;
+    }
+
+    if (!n) THROW("Unexpected end of tar file " << index.path);
+    left -= n;
+
+    return n;
+  }
+
+
+protected:
+  void startInflate() {
+    memset(&strm, 0, sizeof(strm));
+
+    // Find the last checkpoint before the data
+    const vector<Checkpoint> &checkpoints = index.checkpoints;
+    unsigned i = checkpoints.size();
+    while (i && skip < checkpoints[i - 1].out) i--;
+
+    if (!i) {
+      if (inflateInit2(&strm, 47) != Z_OK) THROW("inflateInit2() failed");
+      inflating = true;
+      return;
+    }
+
+    // The trailer follows a raw deflate stream, 8 bytes for gzip or 4 for
+    // zlib
+    trailer = stream->peek() == 0x1f ? 8 : 4;
+
+    const Checkpoint &cp = checkpoints[i - 1];
+    if (inflateInit2(&strm, -15) != Z_OK) THROW("inflateInit2() failed");
+    inflating = raw = true;
+
+    stream->seekg(cp.in - (cp.bits ? 1 : 0));
+
+    if (cp.bits) {
+      int c = stream->get();
+      if (c == EOF) THROW("Failed to read tar file " << index.path);
+      inflatePrime(&strm, cp.bits, c >> (8 - cp.bits));
+    }
+
+    inflateSetDictionary
+      (&strm, (const Bytef *)cp.window.data(), cp.window.length());
+
+    skip -= cp.out;
+  }
+
+
+  void fill() {
+    stream->read(in, CHUNK_SIZE);
+    strm.next_in = (Bytef *)in;
+    strm.avail_in = stream->gcount();
+
+    if (!strm.avail_in)
+      THROW("Unexpected end of compressed tar file " << index.path);
+  }
+
+
+  void inflate(char *out, unsigned length) {
+    strm.next_out = (Bytef *)out;
+    strm.avail_out = length;
+
+    while (strm.avail_out) {
+      if (!strm.avail_in) fill();
+
+      int ret = ::inflate(&strm, Z_NO_FLUSH);
+
+      if (ret == Z_STREAM_END) {
+        // Continue with the next gzip member
+        if (raw) {
+          // Skip the trailer
+          for (unsigned left = trailer; left;) {
+            if (!strm.avail_in) fill();
+            unsigned bytes = min(left, strm.avail_in);
+            strm.next_in += bytes;
+            strm.avail_in -= bytes;
+            left -= bytes;
+          }
+
+          inflateReset2(&strm, 47);
+          raw = false;
+
+        } else inflateReset(&strm);
+
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        THROW("Failed to decompress tar file " << index.path << ": "
+              << (strm.msg ? strm.msg : "inflate() failed"));
+    }
+  }
+};
+
+
+namespace {
+  class ReaderSource {
+    SmartPointer<TarFileIndex::Reader> reader;
+
+  public:
+    typedef char char_type;
+    typedef io::source_tag category;
+
+    ReaderSource(const SmartPointer<TarFileIndex::Reader> &reader) :
+      reader(reader) {}
+
+    streamsize read(char *s, streamsize n) {return reader->read(s, n);}
+  };
+}
+
+
+TarFileIndex::TarFileIndex(const string &path, compression_t compression,
+                           uint64_t span) :
+  path(path), compression(compression == TARFILE_AUTO ? infer(path) :
+                          compression), nextHeader(0), headerFill(0),
+  done(false) {
+
+  switch (this->compression) {
+  case TARFILE_NONE: indexNone(); break;
+  case TARFILE_GZIP: indexGZip(span); break;
+  case TARFILE_BZIP2: indexStream(); break;
+  default: THROW("Invalid compression type " << compression);
+  }
+}
+
+
+TarFileIndex::~TarFileIndex() {}
+
+
+const TarFileIndex::Entry &TarFileIndex::get(unsigned i) const {
+  if (entries.size() <= i) THROW("Invalid tar index entry " << i);
+  return entries[i];
+}
+
+
+const TarFileIndex::Entry *TarFileIndex::find(const string &filename) const {
+  map<string, unsigned>::const_iterator it = names.find(filename);
+  return it == names.end() ? 0 : &entries[it->second];
+}
+
+
+const TarFileIndex::Entry &TarFileIndex::lookup(const string &filename) const {
+  const Entry *entry = find(filename);
+  if (!entry) THROW("'" << filename << "' not found in " << path);
+  return *entry;
+}
+
+
+SmartPointer<istream> TarFileIndex::open(const Entry &entry) const {
+  return new io::stream<ReaderSource>(openReader(entry));
+}
+
+
+SmartPointer<TarFileIndex::Reader>
+TarFileIndex::openReader(const Entry &entry) const {
+  return new Reader(*this, entry);
+}
+
+
+void TarFileIndex::indexNone() {
+  SmartPointer<istream> stream = SystemUtilities::iopen(path);
+  uint64_t size = SystemUtilities::getFileSize(path);
+
+  // Jump from header to header
+  while (nextHeader < size) {
+    stream->seekg(nextHeader);
+    if (!readHeader(*stream)) THROW("Failed to read tar header in " << path);
+    if (isEOF()) break;
+
+    add(nextHeader + 512);
+  }
+}
+
+
+void TarFileIndex::indexGZip(uint64_t span) {
+  SmartPointer<istream> stream = SystemUtilities::iopen(path);
+
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, 47) != Z_OK) THROW("inflateInit2() failed");
+
+  try {
+    inflateGZip(strm, *stream, span);
+  } catch (...) {
+    inflateEnd(&strm);
+    throw;
+  }
+
+  inflateEnd(&strm);
+}
+
+
+void TarFileIndex::inflateGZip(z_stream &strm, istream &stream,
+                               uint64_t span) {
+  vector<char> in(CHUNK_SIZE);
+  vector<char> window(WINDOW_SIZE);
+  uint64_t totalIn = 0;
+  uint64_t totalOut = 0;
+  uint64_t last = 0;
+
+  while (!done) {
+    stream.read(&in[0], CHUNK_SIZE);
+    strm.next_in = (Bytef *)&in[0];
+    strm.avail_in = stream.gcount();
+    if (!strm.avail_in) {
+      if (atHeader(totalOut)) break; // Archive without an end block
+      THROW("Unexpected end of compressed tar file " << path);
+    }
+
+    while (strm.avail_in && !done) {
+      if (!strm.avail_out) {
+        strm.next_out = (Bytef *)&window[0];
+        strm.avail_out = WINDOW_SIZE;
+      }
+
+      const char *start = (const char *)strm.next_out;
+      totalIn += strm.avail_in;
+      totalOut += strm.avail_out;
+
+      // Stop at deflate block boundaries so checkpoints can be made
+      int ret = inflate(&strm, Z_BLOCK);
+
+      totalIn -= strm.avail_in;
+      totalOut -= strm.avail_out;
+
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+        THROW("Failed to decompress tar file " << path << ": "
+              << (strm.msg ? strm.msg : "inflate() failed"));
+
+      unsigned length = (const char *)strm.next_out - start;
+      scan(start, length, totalOut - length);
+
+      if (ret == Z_STREAM_END) inflateReset(&strm); // Next gzip member
+
+      else if ((strm.data_type & 128) && !(strm.data_type & 64) &&
+               (!totalOut || span < totalOut - last)) {
+        Checkpoint cp;
+        cp.in = totalIn;
+        cp.out = totalOut;
+        cp.bits = strm.data_type & 7;
+
+        // Save the last 32KiB of output in order
+        unsigned left = strm.avail_out;
+        unsigned size = min(totalOut, (uint64_t)WINDOW_SIZE);
+        cp.window.append(&window[WINDOW_SIZE - left], left);
+        cp.window.append(&window[0], WINDOW_SIZE - left);
+        cp.window.erase(0, WINDOW_SIZE - size);
+
+        checkpoints.push_back(cp);
+        last = totalOut;
+      }
+    }
+  }
+}
+
+
+void TarFileIndex::indexStream() {
+  SmartPointer<istream> stream = SystemUtilities::iopen(path);
+  io::filtering_istream filter;
+  filter.push(BZip2Decompressor());
+  filter.push(*stream);
+
+  char buf[CHUNK_SIZE];
+
+  for (uint64_t offset = 0; !done;) {
+    filter.read(buf, CHUNK_SIZE);
+    unsigned length = filter.gcount();
+    if (!length) {
+      if (atHeader(offset)) break; // Archive without an end block
+      THROW("Unexpected end of compressed tar file " << path);
+    }
+
+    scan(buf, length, offset);
+    offset += length;
+  }
+}
+
+
+void TarFileIndex::scan(const char *data, unsigned length, uint64_t offset) {
+  const char *end = data + length;
+
+  while (data < end && !done) {
+    // Skip file data
+    if (offset < nextHeader) {
+      uint64_t bytes = min(nextHeader - offset, (uint64_t)(end - data));
+      data += bytes;
+      offset += bytes;
+      continue;
+    }
+
+    unsigned bytes = min(512 - headerFill, (unsigned)(end - data));
+    memcpy(headerBlock + headerFill, data, bytes);
+    headerFill += bytes;
+    data += bytes;
+    offset += bytes;
+
+    if (headerFill == 512) {
+      headerFill = 0;
+      TarHeader::read(headerBlock);
+
+      if (isEOF()) done = true;
+      else add(offset);
+    }
+  }
+}
+
+
+bool TarFileIndex::atHeader(uint64_t offset) const {
+  return !headerFill && offset == nextHeader;
+}
+
+
+void TarFileIndex::add(uint64_t offset) {
+  Entry entry;
+  entry.filename = getFilename();
+  entry.type = getType();
+  entry.mode = getMode();
+  entry.modTime = getModTime();
+  entry.offset = offset;
+  entry.size = getSize();
+
+  names[entry.filename] = entries.size();
+  entries.push_back(entry);
+
+  nextHeader = offset + padded(entry.size);
+}
@@ -0,0 +1,128 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "TarFile.h"
+
+#include <cbang/SmartPointer.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <istream>
+
+typedef struct z_stream_s z_stream;
+
+
+namespace cb {
+  namespace Event {class Buffer;}
+
+  /**
+   * Records where each member of a tar file lies so that single members
+   * can be read without decompressing everything before them.  Uncompressed
+   * archives are read with direct seeks.  For gzip archives the inflate
+   * state is saved every @em span bytes of output, as in zlib's zran
+   * example, and reads start from the nearest checkpoint.  Each checkpoint
+   * holds up to 32KiB.  bzip2 archives are indexed but reading a member
+   * still decompresses everything before it.
+   */
+  class TarFileIndex : public TarFile {
+  public:
+    struct Entry {
+      std::string filename;
+      type_t type;
+      uint32_t mode;
+      uint64_t modTime;
+      uint64_t offset; // Of the data in the uncompressed archive
+      uint64_t size;
+    };
+
+    class Reader;
+
+  protected:
+    struct Checkpoint {
+      uint64_t in;  // Offset in the compressed file
+      uint64_t out; // Offset in the uncompressed archive
+      int bits;     // Unused bits of the byte before in
+      std::string window;
+    };
+
+    std::string path;
+    compression_t compression;
+    std::vector<Entry> entries;
+    std::map<std::string, unsigned> names;
+    std::vector<Checkpoint> checkpoints;
+
+    // Header scanning state
+    uint64_t nextHeader;
+    unsigned headerFill;
+    char headerBlock[512];
+    bool done;
+
+  public:
+    TarFileIndex(const std::string &path,
+                 compression_t compression = TARFILE_AUTO,
+                 uint64_t span = 4 << 20);
+    ~TarFileIndex();
+
+    const std::string &getPath() const {return path;}
+    compression_t getCompression() const {return compression;}
+    unsigned getCheckpointCount() const {return checkpoints.size();}
+
+    unsigned size() const {return entries.size();}
+    const Entry &get(unsigned i) const;
+    const Entry *find(const std::string &filename) const;
+    const Entry &lookup(const std::string &filename) const;
+
+    /// @return A stream of the member's data
+    SmartPointer<std::istream> open(const Entry &entry) const;
+    SmartPointer<std::istream> open(const std::string &filename) const
+    {return open(lookup(filename));}
+
+    /// Append the member's data to @param buf.  Defined with the event
+    /// code in TarFileIndexEvent.cpp.
+    void read(const Entry &entry, Event::Buffer &buf) const;
+    void read(const std::string &filename, Event::Buffer &buf) const
+    {read(lookup(filename), buf);}
+
+  protected:
+    SmartPointer<Reader> openReader(const Entry &entry) const;
+    void indexNone();
+    void indexGZip(uint64_t span);
+    void inflateGZip(z_stream &strm, std::istream &stream, uint64_t span);
+    void indexStream();
+    void scan(const char *data, unsigned length, uint64_t offset);
+    bool atHeader(uint64_t offset) const;
+    void add(uint64_t offset);
+  };
+}
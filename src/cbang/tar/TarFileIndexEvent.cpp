@@ -0,0 +1,70 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "TarFileIndex.h"
+
+#include <cbang/Exception.h>
+#include <cbang/event/Buffer.h>
+
+#include <event2/buffer.h>
+
+#include <algorithm>
+
+using namespace cb;
+using namespace std;
+
+
+void TarFileIndex::read(const Entry &entry, Event::Buffer &buf) const {
+  if (compression == TARFILE_NONE) {
+    if (entry.size) buf.addFile(path, entry.offset, entry.size);
+    return;
+  }
+
+  SmartPointer<istream> stream = open(entry);
+
+  for (uint64_t left = entry.size; left;) {
+    unsigned length = min(left, (uint64_t)65536);
+
+    evbuffer_iovec space;
+    if (evbuffer_reserve_space(buf.getBuffer(), length, &space, 1) != 1)
+      THROW("Failed to reserve buffer space");
+
+    stream->read((char *)space.iov_base, length);
+    space.iov_len = stream->gcount();
+    if (!space.iov_len) THROW("Failed to read '" << entry.filename << "'");
+
+    if (evbuffer_commit_space(buf.getBuffer(), &space, 1))
+      THROW("Failed to commit buffer space");
+
+    left -= space.iov_len;
+  }
+}
@@ -32,6 +32,7 @@
 
 #include "TarFileReader.h"
 
+#include <cbang/io/MMapFile.h>
 #include <cbang/os/SystemUtilities.h>
 #include <cbang/os/SysError.h>
 #include <cbang/log/Logger.h>
@@ -69,6 +70,16 @@ TarFileReader::TarFileReader(istream &stream, compression_t compression) :
 }
 
 
+TarFileReader::TarFileReader(const SmartPointer<MMapFile> &file,
+                             compression_t compression) :
+  pri(new private_t), stream(new MMapStream(file)), didReadHeader(false) {
+
+  addCompression(compression == TARFILE_AUTO ?
+                 infer(file->getPath()) : compression);
+  pri->filter.push(*this->stream);
+}
+
+
 TarFileReader::~TarFileReader() {
   delete pri;
 }
@@ -41,6 +41,8 @@
 
 
 namespace cb {
+  class MMapFile;
+
   class TarFileReader : public TarFile {
     struct private_t;
     private_t *pri;
@@ -51,6 +53,8 @@ namespace cb {
     TarFileReader(const std::string &path,
                   compression_t compression = TARFILE_AUTO);
     TarFileReader(std::istream &stream, compression_t compression);
+    TarFileReader(const SmartPointer<MMapFile> &file,
+                  compression_t compression = TARFILE_AUTO);
     ~TarFileReader();
 
     bool hasMore();
@@ -35,6 +35,7 @@
 #include <cbang/os/SystemUtilities.h>
 
 #include <cbang/iostream/BZip2Compressor.h>
+#include <cbang/iostream/ParallelCompressor.h>
 
 #include <boost/ref.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
@@ -51,19 +52,21 @@ struct TarFileWriter::private_t {
 
 
 TarFileWriter::TarFileWriter(const string &path, ios::openmode mode, int perm,
-                 compression_t compression) :
+                 compression_t compression, unsigned threads) :
   pri(new private_t),
   stream(SystemUtilities::open(path, mode | ios::out, perm)) {
 
-  addCompression(compression == TARFILE_AUTO ? infer(path) : compression);
+  addCompression(compression == TARFILE_AUTO ? infer(path) : compression,
+                 threads);
   pri->filter.push(*this->stream);
 }
 
 
-TarFileWriter::TarFileWriter(ostream &stream, compression_t compression) :
+TarFileWriter::TarFileWriter(ostream &stream, compression_t compression,
+                             unsigned threads) :
   pri(new private_t), stream(SmartPointer<ostream>::Phony(&stream)) {
 
-  addCompression(compression);
+  addCompression(compression, threads);
   pri->filter.push(*this->stream);
 }
 
@@ -108,11 +111,27 @@ void TarFileWriter::writeHeader(type_t type, const string &filename,
 }
 
 
-void TarFileWriter::addCompression(compression_t compression) {
+void TarFileWriter::addCompression(compression_t compression,
+                                   unsigned threads) {
+  const bool parallel = threads != 1;
+
   switch (compression) {
   case TARFILE_NONE: break; // none
-  case TARFILE_BZIP2: pri->filter.push(BZip2Compressor()); break;
-  case TARFILE_GZIP: pri->filter.push(io::zlib_compressor()); break;
+
+  case TARFILE_BZIP2:
+    if (parallel)
+      pri->filter.push(ParallelCompressor
+                       (ParallelCompressor::PARALLEL_BZIP2, threads));
+    else pri->filter.push(BZip2Compressor());
+    break;
+
+  case TARFILE_GZIP:
+    if (parallel)
+      pri->filter.push(ParallelCompressor
+                       (ParallelCompressor::PARALLEL_ZLIB, threads));
+    else pri->filter.push(io::zlib_compressor());
+    break;
+
   default: THROW("Invalid compression type " << compression);
   }
 }
@@ -48,9 +48,13 @@ namespace cb {
     SmartPointer<std::ostream> stream;
 
   public:
+    /// @param threads Compression threads.  Zero selects one per CPU and
+    /// more than one uses ParallelCompressor.
     TarFileWriter(const std::string &path, std::ios::openmode mode,
-                  int perm = 0644, compression_t compression = TARFILE_AUTO);
-    TarFileWriter(std::ostream &stream, compression_t compression);
+                  int perm = 0644, compression_t compression = TARFILE_AUTO,
+                  unsigned threads = 1);
+    TarFileWriter(std::ostream &stream, compression_t compression,
+                  unsigned threads = 1);
     ~TarFileWriter();
 
     void add(const std::string &path,
@@ -65,6 +69,6 @@ namespace cb {
   protected:
     void writeHeader(type_t type, const std::string &filename, uint64_t size,
                      uint32_t mode);
-    void addCompression(compression_t compression);
+    void addCompression(compression_t compression, unsigned threads);
   };
 }
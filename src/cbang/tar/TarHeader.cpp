@@ -199,18 +199,18 @@ bool TarHeader::read(istream &stream) {
   stream.read(filename, 512);
   if (stream.gcount() != 512) return false;
 
-  unsigned sum = readNumber(checksum, 6);
-  if (sum != 0) {
-    unsigned calculated = computeChecksum();
-    if (sum != calculated)
-      THROW("Invalid checksum in tar header calculated=" << calculated
-             << " expected=" << sum);
-  }
+  validate();
 
   return true;
 }
 
 
+void TarHeader::read(const char *block) {
+  memcpy(filename, block, 512);
+  validate();
+}
+
+
 void TarHeader::write(ostream &stream) {
   if (!checksum_valid) updateChecksum();
 
@@ -228,6 +228,17 @@ void TarHeader::writeNumber(uint64_t n, char *buf, unsigned length) {
 }
 
 
+void TarHeader::validate() {
+  unsigned sum = readNumber(checksum, 6);
+  if (sum != 0) {
+    unsigned calculated = computeChecksum();
+    if (sum != calculated)
+      THROW("Invalid checksum in tar header calculated=" << calculated
+             << " expected=" << sum);
+  }
+}
+
+
 bool TarHeader::isEOF() const {
   return readNumber(checksum, 6) == 0;
 }
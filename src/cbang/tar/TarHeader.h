@@ -67,6 +67,8 @@ namespace cb {
     unsigned updateChecksum();
 
     bool read(std::istream &stream);
+    /// Read a header from a 512 byte @param block
+    void read(const char *block);
     void write(std::ostream &stream);
 
     void setFilename(const std::string &filename);
@@ -96,5 +98,6 @@ namespace cb {
 
   protected:
     unsigned computeChecksum();
+    void validate();
   };
 }
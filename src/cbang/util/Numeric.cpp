@@ -0,0 +1,601 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Numeric.h"
+
+#include <limits>
+
+#include <cfloat>
+#include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+using namespace std;
+using namespace cb;
+
+// Floating point arithmetic must not use extended precision for the exact
+// fast path in parse()
+#if (defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0) || defined(_M_X64)
+#define EXACT_DOUBLE_ARITHMETIC
+#endif
+
+
+namespace {
+  const char digitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+
+  const double powersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+  };
+
+
+  const uint64_t powersOf10U64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+  };
+
+
+  bool isDigit(char c) {return '0' <= c && c <= '9';}
+
+
+  // The Grisu3 algorithm, see "Printing Floating-Point Numbers Quickly and
+  // Accurately with Integers" by Florian Loitsch, PLDI 2010.  It rejects
+  // the few values for which it cannot prove its result shortest and
+  // closest, which then take a slower exact path.
+
+  // Normalized significands and binary exponents of 10^-348 to 10^340 in
+  // steps of 10^8
+  const uint64_t cachedPowersF[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+  };
+
+  const int16_t cachedPowersE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+  };
+
+
+  const uint64_t hiddenBit = (uint64_t)1 << 52;
+  const uint64_t significandMask = hiddenBit - 1;
+
+
+  struct DiyFp {
+    uint64_t f;
+    int e;
+
+    DiyFp(uint64_t f = 0, int e = 0) : f(f), e(e) {}
+
+
+    explicit DiyFp(double d) {
+      uint64_t u;
+      memcpy(&u, &d, sizeof(u));
+
+      int biased = (int)((u >> 52) & 0x7ff);
+      f = u & significandMask;
+
+      if (biased) {
+        f += hiddenBit;
+        e = biased - 1075;
+
+      } else e = -1074;
+    }
+
+
+    DiyFp operator-(const DiyFp &o) const {return DiyFp(f - o.f, e);}
+
+
+    DiyFp operator*(const DiyFp &o) const {
+      const uint64_t M32 = 0xffffffff;
+      uint64_t a = f >> 32, b = f & M32, c = o.f >> 32, d = o.f & M32;
+      uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+      uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+      tmp += (uint64_t)1 << 31; // Round
+
+      return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + o.e + 64);
+    }
+
+
+    DiyFp normalize() const {
+      DiyFp r = *this;
+      while (!(r.f & ((uint64_t)1 << 63))) {r.f <<= 1; r.e--;}
+      return r;
+    }
+
+
+    void boundaries(DiyFp &minus, DiyFp &plus) const {
+      plus = DiyFp((f << 1) + 1, e - 1).normalize();
+
+      // The lower neighbor is closer at powers of two, except below the
+      // smallest normal where the spacing does not change
+      if (f == hiddenBit && e != -1074) minus = DiyFp((f << 2) - 1, e - 2);
+      else minus = DiyFp((f << 1) - 1, e - 1);
+
+      minus.f <<= minus.e - plus.e;
+      minus.e = plus.e;
+    }
+  };
+
+
+  DiyFp cachedPower(int e, int &k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive
+    int ik = (int)dk;
+    if (ik < dk) ik++;
+
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    k = -(-348 + (int)(index << 3)); // Decimal exponent of the cached power
+
+    return DiyFp(cachedPowersF[index], cachedPowersE[index]);
+  }
+
+
+  /**
+   * Moves the last digit towards the exact value, @param distance below
+   * the high boundary, while staying inside @param interval.  All values
+   * are scaled and off by at most @param unit.
+   * @return False if the digits may not be the closest in the interval.
+   */
+  bool roundWeed(char *buf, unsigned len, uint64_t distance,
+                 uint64_t interval, uint64_t rest, uint64_t tenKappa,
+                 uint64_t unit) {
+    const uint64_t small = distance - unit;
+    const uint64_t big = distance + unit;
+
+    while (rest < small && tenKappa <= interval - rest &&
+           (rest + tenKappa < small ||
+            small - rest >= rest + tenKappa - small)) {
+      buf[len - 1]--;
+      rest += tenKappa;
+    }
+
+    // Another digit may be closer to the exact value
+    if (rest < big && tenKappa <= interval - rest &&
+        (rest + tenKappa < big || big - rest > rest + tenKappa - big))
+      return false;
+
+    // The result may be outside the interval
+    return 2 * unit <= rest && rest <= interval - 4 * unit;
+  }
+
+
+  unsigned countDigits(uint32_t n) {
+    unsigned count = 1;
+    while (10 <= n) {n /= 10; count++;}
+    return count;
+  }
+
+
+  /// Generates the digits of the scaled value @param W, between @param Mm
+  /// and @param Mp.  @return False if they may not be the shortest.
+  bool digitGen(const DiyFp &Mm, const DiyFp &W, const DiyFp &Mp,
+                char *buf, unsigned &len, int &K) {
+    // The scaled boundaries are off by at most one unit either way.  unit
+    // is scaled along with the fractional digits so the distance to W is
+    // never multiplied by more than the interval already was.
+    uint64_t unit = 1;
+    const DiyFp tooHigh(Mp.f + unit, Mp.e);
+    uint64_t interval = tooHigh.f - (Mm.f - unit);
+    const uint64_t distance = (tooHigh - W).f;
+
+    const DiyFp one((uint64_t)1 << -W.e, W.e);
+    uint32_t p1 = (uint32_t)(tooHigh.f >> -one.e);
+    uint64_t p2 = tooHigh.f & (one.f - 1);
+    int kappa = (int)countDigits(p1);
+    len = 0;
+
+    while (0 < kappa) {
+      uint64_t divisor = powersOf10U64[kappa - 1];
+      uint32_t d = (uint32_t)(p1 / divisor);
+      p1 %= divisor;
+
+      if (d || len) buf[len++] = (char)('0' + d);
+      kappa--;
+
+      uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+      if (rest < interval) {
+        K += kappa;
+        return roundWeed(buf, len, distance, interval, rest,
+                         divisor << -one.e, unit);
+      }
+    }
+
+    while (true) {
+      p2 *= 10;
+      unit *= 10;
+      interval *= 10;
+
+      char d = (char)(p2 >> -one.e);
+      if (d || len) buf[len++] = (char)('0' + d);
+
+      p2 &= one.f - 1;
+      kappa--;
+
+      if (p2 < interval) {
+        K += kappa;
+        return roundWeed(buf, len, distance * unit, interval, p2, one.f,
+                         unit);
+      }
+    }
+  }
+
+
+#ifdef _WIN32
+  _locale_t cLocale() {
+    static _locale_t locale = _create_locale(LC_NUMERIC, "C");
+    return locale;
+  }
+
+#define strtod_l _strtod_l
+
+#else
+  locale_t cLocale() {
+    static locale_t locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    return locale;
+  }
+#endif
+
+
+  bool parseSlow(const char *s, unsigned length, double &x) {
+    char buf[64];
+    string big;
+    char *str = buf;
+
+    if (sizeof(buf) <= length) {
+      big.assign(s, length);
+      str = &big[0];
+
+    } else {
+      memcpy(buf, s, length);
+      buf[length] = 0;
+    }
+
+    char *end;
+    errno = 0;
+    double v = strtod_l(str, &end, cLocale());
+    if (end != str + length) return false;
+
+    // ERANGE is also reported for subnormals, which are fine
+    if (errno == ERANGE && (!v || std::isinf(v))) return false;
+
+    x = v;
+    return true;
+  }
+
+
+  /// Writes the closest decimal of @param precision digits.
+  /// @return True if it parses back to @param x.
+  bool roundTrips(char *digits, double x, int precision, int &exp) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*e", precision - 1, x);
+
+    // Digits and exponent, whatever the locale's decimal point
+    int len = 0;
+    const char *s = buf;
+    for (; *s != 'e'; s++) if (isDigit(*s)) digits[len++] = *s;
+    exp = atoi(s + 1) - (len - 1);
+
+    snprintf(buf, sizeof(buf), "%.*se%d", len, digits, exp);
+    return strtod_l(buf, 0, cLocale()) == x;
+  }
+
+
+  unsigned shortestSlow(char *digits, double x, int &exp) {
+    // If a precision round trips so do all longer ones.  17 always does.
+    int low = 1;
+    int high = 17;
+    int mid = 16; // Most values need 16 or 17 digits
+
+    while (low < high) {
+      if (roundTrips(digits, x, mid, exp)) high = mid;
+      else low = mid + 1;
+
+      mid = high == 16 ? 15 : (low + high) / 2;
+    }
+
+    roundTrips(digits, x, high, exp);
+    return high;
+  }
+}
+
+
+unsigned Numeric::format(char *buf, uint64_t x) {
+  char tmp[20];
+  char *p = tmp + 20;
+
+  while (100 <= x) {
+    unsigned i = (unsigned)(x % 100) * 2;
+    x /= 100;
+    *--p = digitPairs[i + 1];
+    *--p = digitPairs[i];
+  }
+
+  if (x < 10) *--p = (char)('0' + x);
+  else {
+    *--p = digitPairs[x * 2 + 1];
+    *--p = digitPairs[x * 2];
+  }
+
+  unsigned length = tmp + 20 - p;
+  memcpy(buf, p, length);
+
+  return length;
+}
+
+
+unsigned Numeric::format(char *buf, int64_t x) {
+  if (x < 0) {
+    *buf = '-';
+    return 1 + format(buf + 1, (uint64_t)0 - (uint64_t)x);
+  }
+
+  return format(buf, (uint64_t)x);
+}
+
+
+unsigned Numeric::format(char *buf, double x) {
+  if (std::isnan(x)) {memcpy(buf, "NaN", 3); return 3;}
+  if (std::isinf(x)) {
+    if (x < 0) {memcpy(buf, "-Infinity", 9); return 9;}
+    memcpy(buf, "Infinity", 8);
+    return 8;
+  }
+
+  if (!x) {*buf = '0'; return 1;}
+
+  char *p = buf;
+  if (x < 0) {
+    *p++ = '-';
+    x = -x;
+  }
+
+  char digits[18];
+  int k;
+  int len = (int)shortest(digits, x, k);
+  int kk = len + k; // 10^(kk - 1) <= x < 10^kk
+
+  if (len <= kk && kk <= 21) {
+    // 1234e7 -> 12340000000
+    memcpy(p, digits, len);
+    memset(p + len, '0', kk - len);
+    p += kk;
+
+  } else if (0 < kk && kk <= 21) {
+    // 1234e-2 -> 12.34
+    memcpy(p, digits, kk);
+    p[kk] = '.';
+    memcpy(p + kk + 1, digits + kk, len - kk);
+    p += len + 1;
+
+  } else if (-6 < kk && kk <= 0) {
+    // 1234e-6 -> 0.001234
+    *p++ = '0';
+    *p++ = '.';
+    memset(p, '0', -kk);
+    memcpy(p - kk, digits, len);
+    p += len - kk;
+
+  } else {
+    // 1234e30 -> 1.234e+33
+    *p++ = digits[0];
+
+    if (1 < len) {
+      *p++ = '.';
+      memcpy(p, digits + 1, len - 1);
+      p += len - 1;
+    }
+
+    *p++ = 'e';
+    *p++ = kk < 1 ? '-' : '+';
+    p += format(p, (uint64_t)(kk < 1 ? 1 - kk : kk - 1));
+  }
+
+  return p - buf;
+}
+
+
+unsigned Numeric::shortest(char *digits, double x, int &exp) {
+  const DiyFp v(x);
+  DiyFp minus, plus;
+  v.boundaries(minus, plus);
+
+  const DiyFp c = cachedPower(plus.e, exp);
+  unsigned len;
+
+  if (digitGen(minus * c, v.normalize() * c, plus * c, digits, len, exp))
+    return len;
+
+  return shortestSlow(digits, x, exp);
+}
+
+
+const char *Numeric::parse(const char *s, const char *end, uint64_t &x) {
+  const uint64_t max = numeric_limits<uint64_t>::max();
+  const char *start = s;
+  uint64_t v = 0;
+
+  for (; s != end && isDigit(*s); s++) {
+    unsigned d = *s - '0';
+    if ((max - d) / 10 < v) return 0; // Overflow
+    v = v * 10 + d;
+  }
+
+  if (s == start) return 0;
+
+  x = v;
+  return s;
+}
+
+
+const char *Numeric::parse(const char *s, const char *end, int64_t &x) {
+  const uint64_t max = numeric_limits<int64_t>::max();
+  bool negative = s != end && *s == '-';
+  if (negative) s++;
+
+  uint64_t v;
+  s = parse(s, end, v);
+  if (!s || v > max + negative) return 0;
+
+  x = negative ? (v ? -(int64_t)(v - 1) - 1 : 0) : (int64_t)v;
+  return s;
+}
+
+
+const char *Numeric::parse(const char *s, const char *end, double &x) {
+  const char *start = s;
+  bool negative = false;
+
+  if (s != end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+
+  // Collect up to 19 significant digits
+  uint64_t mantissa = 0;
+  unsigned digits = 0;
+  int exp = 0;
+  bool any = false;
+  bool truncated = false;
+
+  for (; s != end && isDigit(*s); s++) {
+    any = true;
+
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*s - '0');
+      if (mantissa) digits++;
+
+    } else {
+      exp++;
+      if (*s != '0') truncated = true;
+    }
+  }
+
+  if (s != end && *s == '.')
+    for (s++; s != end && isDigit(*s); s++) {
+      any = true;
+
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*s - '0');
+        if (mantissa) digits++;
+        exp--;
+
+      } else if (*s != '0') truncated = true;
+    }
+
+  if (!any) return 0;
+
+  if (s != end && (*s == 'e' || *s == 'E')) {
+    const char *e = s + 1;
+    bool negExp = false;
+    if (e != end && (*e == '-' || *e == '+')) negExp = *e++ == '-';
+
+    // Otherwise the 'e' is not part of the number
+    if (e != end && isDigit(*e)) {
+      int value = 0;
+      for (; e != end && isDigit(*e); e++)
+        if (value < 100000) value = value * 10 + (*e - '0');
+
+      exp += negExp ? -value : value;
+      s = e;
+    }
+  }
+
+#ifdef EXACT_DOUBLE_ARITHMETIC
+  // Exact when both the mantissa and the power of ten are exact doubles
+  const uint64_t maxExact = (uint64_t)1 << 53;
+
+  if (!truncated && mantissa <= maxExact) {
+    if (!mantissa) exp = 0;
+
+    // Shift excess powers of ten into the mantissa
+    while (22 < exp && mantissa <= maxExact / 10) {
+      mantissa *= 10;
+      exp--;
+    }
+
+    if (-22 <= exp && exp <= 22) {
+      double v = (double)mantissa;
+      v = exp < 0 ? v / powersOf10[-exp] : v * powersOf10[exp];
+      x = negative ? -v : v;
+      return s;
+    }
+  }
+#endif // EXACT_DOUBLE_ARITHMETIC
+
+  return parseSlow(start, s - start, x) ? s : 0;
+}
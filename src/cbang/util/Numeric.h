@@ -0,0 +1,84 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/StdTypes.h>
+
+
+namespace cb {
+  /**
+   * Locale independent, allocation free number formatting and parsing.
+   *
+   * Doubles are formatted as the shortest decimal that parses back to the
+   * same value, in the style of JavaScript's Number.toString().  Parsing
+   * is correctly rounded, with an exact fast path for common inputs.
+   */
+  class Numeric {
+  public:
+    /// Large enough for any formatted number
+    static const unsigned BUFFER_SIZE = 32;
+
+    /// Writes @param x to @param buf, which must have room for BUFFER_SIZE
+    /// chars.  The output is not NUL terminated.
+    /// @return The number of chars written.
+    static unsigned format(char *buf, uint64_t x);
+    static unsigned format(char *buf, int64_t x);
+    static unsigned format(char *buf, uint32_t x) {
+      return format(buf, (uint64_t)x);
+    }
+    static unsigned format(char *buf, int32_t x) {
+      return format(buf, (int64_t)x);
+    }
+    /// Zero is always written as "0", non-finite values as "NaN",
+    /// "Infinity" or "-Infinity".
+    static unsigned format(char *buf, double x);
+
+    /// Writes the shortest round trip decimal digits of positive, finite
+    /// @param x to @param digits, such that x = digits * 10^exp.
+    /// @return The number of digits written, at most 17.
+    static unsigned shortest(char *digits, double x, int &exp);
+
+    /// Parse a decimal integer from the start of [s, end).  Accepts an
+    /// optional '-' for signed values.
+    /// @return A pointer past the last char used or 0 if no digits were
+    /// found or the value is out of range.
+    static const char *parse(const char *s, const char *end, uint64_t &x);
+    static const char *parse(const char *s, const char *end, int64_t &x);
+
+    /// Parse a decimal floating point number, e.g. -1.25e-3, from the start
+    /// of [s, end).
+    /// @return A pointer past the last char used or 0 if there was no valid
+    /// number or it is out of range.
+    static const char *parse(const char *s, const char *end, double &x);
+  };
+}
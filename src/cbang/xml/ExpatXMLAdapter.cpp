@@ -37,12 +37,28 @@
 
 #include <cbang/String.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace cb;
 
 static const int BUFFER_SIZE = 4096;
 
 
+namespace {
+  uint64_t getChunkSize() {
+    // When built with context bytes, the default, Expat copies everything
+    // passed to XML_Parse() into its own buffer.  Feed it moderate chunks
+    // so that buffer stays small.  Otherwise it parses in place.
+    const XML_Feature *feature = XML_GetFeatureList();
+    for (; feature->feature != XML_FEATURE_END; feature++)
+      if (feature->feature == XML_FEATURE_CONTEXT_BYTES) return 64 * 1024;
+
+    return 1 << 30;
+  }
+}
+
+
 ExpatXMLAdapter::ExpatXMLAdapter() : parser(XML_ParserCreate("UTF-8")) {
   XML_SetElementHandler
     ((XML_Parser)parser, (XML_StartElementHandler)&ExpatXMLAdapter::start,
@@ -67,21 +83,49 @@ void ExpatXMLAdapter::read(istream &stream) {
     stream.read((char *)buf, BUFFER_SIZE);
     count = stream.gcount();
 
-    if (!XML_ParseBuffer((XML_Parser)parser, count, count == 0) && !error) {
-      XML_Error code = XML_GetErrorCode((XML_Parser)parser);
-      int line = XML_GetCurrentLineNumber((XML_Parser)parser);
-      int column = XML_GetCurrentColumnNumber((XML_Parser)parser);
-
-      error = new Exception(string("Parse failed: ") + String(code) +
-                            ": " + XML_ErrorString(code),
-                            FileLocation(getFilename(), line, column));
-    }
+    if (!XML_ParseBuffer((XML_Parser)parser, count, count == 0))
+      parseFailed();
 
     if (!error.isNull()) break;
   } while (count);
 
-  names.clear();
+  finish();
+}
+
+
+void ExpatXMLAdapter::read(const char *data, uint64_t length) {
+  static const uint64_t chunkSize = getChunkSize();
+
+  do {
+    int count = (int)min(length, chunkSize);
+
+    if (!XML_Parse((XML_Parser)parser, data, count, (uint64_t)count == length))
+      parseFailed();
+
+    if (!error.isNull()) break;
+
+    data += count;
+    length -= count;
+  } while (length);
+
+  finish();
+}
+
 
+void ExpatXMLAdapter::parseFailed() {
+  if (!error.isNull()) return;
+
+  XML_Error code = XML_GetErrorCode((XML_Parser)parser);
+  int line = XML_GetCurrentLineNumber((XML_Parser)parser);
+  int column = XML_GetCurrentColumnNumber((XML_Parser)parser);
+
+  error = new Exception(string("Parse failed: ") + String(code) +
+                        ": " + XML_ErrorString(code),
+                        FileLocation(getFilename(), line, column));
+}
+
+
+void ExpatXMLAdapter::finish() {
   if (!error.isNull()) {
     Exception e(*error.get());
     error = 0;
@@ -106,27 +150,17 @@ void ExpatXMLAdapter::start(ExpatXMLAdapter *adapter, const char *name,
                             const char **_attrs) {
   if (adapter->hasError()) return;
   try {
-    adapter->names.push_back(name);
-
-    XMLAttributes attrs;
-    for (unsigned i = 0; _attrs[i]; i += 2)
-      attrs[_attrs[i]] = _attrs[i + 1];
-
-    adapter->getHandler().startElement(name, attrs);
+    adapter->getHandler().startElementView(name, _attrs);
   } catch (const Exception &e) {
     adapter->setError(e);
   }
 }
 
 
-void ExpatXMLAdapter::end(ExpatXMLAdapter *adapter, void *data,
-                          const char *_name) {
+void ExpatXMLAdapter::end(ExpatXMLAdapter *adapter, const char *name) {
   if (adapter->hasError()) return;
   try {
-    string name = adapter->names.back();
-    adapter->names.pop_back();
-
-    adapter->getHandler().endElement(name);
+    adapter->getHandler().endElementView(name);
   } catch (const Exception &e) {
     adapter->setError(e);
   }
@@ -137,7 +171,7 @@ void ExpatXMLAdapter::text(ExpatXMLAdapter *adapter,
                            const char *text, int len) {
   if (adapter->hasError()) return;
   try {
-    adapter->getHandler().text(string(text, len));
+    adapter->getHandler().textView(XMLStringView(text, len));
   } catch (const Exception &e) {
     adapter->setError(e);
   }
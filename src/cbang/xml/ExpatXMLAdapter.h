@@ -37,13 +37,14 @@
 #include <cbang/SmartPointer.h>
 #include <cbang/Exception.h>
 
-#include <string>
-#include <vector>
-
 namespace cb {
+  /**
+   * Parses with Expat and passes names, attributes and text to handlers
+   * as views of Expat's buffer.  Contiguous input is handed to Expat
+   * without going through a stream.
+   */
   class ExpatXMLAdapter : public XMLAdapter {
     SmartPointer<Exception> error;
-    std::vector<std::string> names;
 
     void *parser;
 
@@ -51,15 +52,19 @@ namespace cb {
     ExpatXMLAdapter();
     ~ExpatXMLAdapter();
 
+    using XMLAdapter::read;
     virtual void read(std::istream &stream);
+    virtual void read(const char *data, uint64_t length);
 
   private:
+    void parseFailed();
+    void finish();
     void setError(const Exception &e);
     bool hasError() const {return error.get();}
 
     static void start(ExpatXMLAdapter *adapter,
                       const char *name, const char **attrs);
-    static void end(ExpatXMLAdapter *adapter, void *data, const char *name);
+    static void end(ExpatXMLAdapter *adapter, const char *name);
     static void text(ExpatXMLAdapter *adapter, const char *text, int len);
   };
 }
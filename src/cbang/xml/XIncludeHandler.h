@@ -46,5 +46,9 @@ namespace cb {
     void endElement(const std::string &name) {}
     void text(const std::string &text) {}
     void cdata(const std::string &data) {}
+    void startElementView(const XMLStringView &name,
+                          const XMLAttributesView &attrs) {}
+    void endElementView(const XMLStringView &name) {}
+    void textView(const XMLStringView &text) {}
   };
 }
@@ -34,6 +34,9 @@
 
 #include <cbang/Exception.h>
 
+#include <cbang/io/InputSource.h>
+#include <cbang/io/MMapFile.h>
+#include <cbang/iostream/ArrayDevice.h>
 #include <cbang/os/SystemUtilities.h>
 
 #include "ExpatXMLAdapter.h"
@@ -63,12 +66,37 @@ XMLHandler &XMLAdapter::getHandler() {
 void XMLAdapter::read(const string &filename) {
   setFilename(filename);
   if (!handlers.empty()) getHandler().pushFile(filename);
-  read(*SystemUtilities::open(filename, ios::in));
+
+  if (!SystemUtilities::isFile(filename))
+    read(*SystemUtilities::open(filename, ios::in));
+
+  else if (SystemUtilities::getFileSize(filename) <= MAX_COPY_SIZE) {
+    // A copy cannot fault if the file is rewritten while it is parsed
+    string data = SystemUtilities::read(filename);
+    read(data.data(), data.length());
+
+  } else {
+    MMapFile file(filename, MMapFile::MMAP_POPULATE);
+    read(file.begin(), file.getLength());
+  }
+
   if (!handlers.empty()) getHandler().popFile();
   setFilename(string());
 }
 
 
+void XMLAdapter::read(const InputSource &src) {
+  if (src.getData()) read(src.getData(), src.getLength());
+  else read(src.getStream());
+}
+
+
+void XMLAdapter::read(const char *data, uint64_t length) {
+  ArrayStream<const char> stream(data, length);
+  read(stream);
+}
+
+
 XMLAdapter *XMLAdapter::create() {
 #ifdef HAVE_EXPAT
   return new ExpatXMLAdapter();
@@ -34,10 +34,14 @@
 
 #include "XMLHandler.h"
 
+#include <cbang/StdTypes.h>
+
 #include <string>
 #include <vector>
 
 namespace cb {
+  class InputSource;
+
   class XMLAdapter {
     std::vector<XMLHandler *> handlers;
     std::string filename;
@@ -52,8 +56,17 @@ namespace cb {
     void setFilename(const std::string &x) {filename = x;}
     const std::string &getFilename() {return filename;}
 
+    static const uint64_t MAX_COPY_SIZE = 1 << 20;
+
+    /**
+     * Regular files are parsed in place from memory.  Files larger than
+     * MAX_COPY_SIZE are mapped and must not be truncated while being read.
+     */
     void read(const std::string &filename);
+    void read(const InputSource &src);
     virtual void read(std::istream &stream) = 0;
+    /// Parse @param length bytes of contiguous memory at @param data
+    virtual void read(const char *data, uint64_t length);
 
     static XMLAdapter *create();
   };
@@ -0,0 +1,73 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "XMLAttributesView.h"
+
+using namespace cb;
+using namespace std;
+
+
+unsigned XMLAttributesView::size() const {
+  unsigned count = 0;
+  if (attrs) while (attrs[2 * count]) count++;
+  return count;
+}
+
+
+const char *XMLAttributesView::find(const XMLStringView &name) const {
+  const char *value = 0;
+
+  // Like toAttributes(), the last of duplicate names wins
+  if (attrs)
+    for (unsigned i = 0; attrs[i]; i += 2)
+      if (name == attrs[i]) value = attrs[i + 1];
+
+  return value;
+}
+
+
+XMLStringView XMLAttributesView::get(const XMLStringView &name,
+                                     const XMLStringView &defaultValue) const {
+  const char *value = find(name);
+  return value ? XMLStringView(value) : defaultValue;
+}
+
+
+XMLAttributes XMLAttributesView::toAttributes() const {
+  XMLAttributes result;
+
+  if (attrs)
+    for (unsigned i = 0; attrs[i]; i += 2)
+      result[attrs[i]] = attrs[i + 1];
+
+  return result;
+}
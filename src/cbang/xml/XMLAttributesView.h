@@ -0,0 +1,61 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "XMLStringView.h"
+#include "XMLAttributes.h"
+
+
+namespace cb {
+  /// A non-owning view of an element's attributes as a null terminated
+  /// array of name, value pairs, the form XML parsers provide them in.
+  class XMLAttributesView {
+    const char **attrs;
+
+  public:
+    XMLAttributesView(const char **attrs = 0) : attrs(attrs) {}
+
+    unsigned size() const;
+    XMLStringView getName(unsigned i) const {return attrs[2 * i];}
+    XMLStringView getValue(unsigned i) const {return attrs[2 * i + 1];}
+
+    /// @return the value of the last attribute @param name or null
+    const char *find(const XMLStringView &name) const;
+    bool has(const XMLStringView &name) const {return find(name);}
+    XMLStringView get(const XMLStringView &name,
+                      const XMLStringView &defaultValue =
+                      XMLStringView()) const;
+
+    XMLAttributes toAttributes() const;
+  };
+}
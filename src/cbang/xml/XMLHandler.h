@@ -33,6 +33,7 @@
 #pragma once
 
 #include "XMLAttributes.h"
+#include "XMLAttributesView.h"
 
 namespace cb {
   /// A base class for XML processors.  Used in configuration.
@@ -49,5 +50,16 @@ namespace cb {
     virtual void text(const std::string &text) = 0;
     virtual void cdata(const std::string &data) {}
     virtual void comment(const std::string &text) {}
+
+    /// Zero-copy callbacks used by the XML parsers.  The views are only
+    /// valid during the call.  By default they copy into strings and call
+    /// the functions above.
+    virtual void startElementView(const XMLStringView &name,
+                                  const XMLAttributesView &attrs)
+    {startElement(name.toString(), attrs.toAttributes());}
+    virtual void endElementView(const XMLStringView &name)
+    {endElement(name.toString());}
+    virtual void textView(const XMLStringView &text)
+    {this->text(text.toString());}
   };
 }
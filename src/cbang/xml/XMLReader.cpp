@@ -43,6 +43,8 @@
 
 #include <cbang/log/Logger.h>
 
+#include <cbang/io/InputSource.h>
+#include <cbang/io/MMapFile.h>
 #include <cbang/os/SystemUtilities.h>
 
 using namespace cb;
@@ -72,27 +74,32 @@ XMLReader::~XMLReader() {
 
 
 void XMLReader::read(const string &filename, XMLHandler *handler) {
-  pushFile(filename);
-  if (handler) push(handler, 0);
-  read(*SystemUtilities::open(filename, ios::in), 0);
-  if (handler) pop();
-  popFile();
+  if (!SystemUtilities::isFile(filename))
+    read(InputSource(SystemUtilities::open(filename, ios::in), filename),
+         handler);
+
+  else if (SystemUtilities::getFileSize(filename) <=
+           XMLAdapter::MAX_COPY_SIZE) {
+    string data = SystemUtilities::read(filename);
+    read(InputSource(data.data(), data.length(), filename), handler);
+
+  } else {
+    SmartPointer<MMapFile> file =
+      new MMapFile(filename, MMapFile::MMAP_POPULATE);
+    read(InputSource(file), handler);
+  }
 }
 
 
 void XMLReader::read(istream &stream, XMLHandler *handler) {
-  if (handler) push(handler, 0);
-
-  SmartPointer<XMLAdapter> adapter = XMLAdapter::create();
-  adapter->setFilename(getCurrentFile());
-  adapter->pushHandler(this);
-
-  XMLSkipHandler skipper(*this);
-  if (skipRoot) adapter->pushHandler(&skipper);
+  parse(InputSource(stream), handler);
+}
 
-  adapter->read(stream);
 
-  if (handler) pop();
+void XMLReader::read(const InputSource &src, XMLHandler *handler) {
+  pushFile(src.getName());
+  parse(src, handler);
+  popFile();
 }
 
 
@@ -147,6 +154,51 @@ void XMLReader::cdata(const string &data) {
 }
 
 
+void XMLReader::startElementView(const XMLStringView &name,
+                                 const XMLAttributesView &attrs) {
+  LOG_DEBUG(5, __FUNCTION__ << "(" << name << ")");
+
+  depth++;
+
+  XMLHandlerFactory *factory = getFactory(name.toString());
+  if (factory) {
+    push(factory->getHandler(*this, attrs.toAttributes()), factory);
+    LOG_DEBUG(5, "XMLReader pushed " << name << " handler");
+  } else get().startElementView(name, attrs);
+}
+
+
+void XMLReader::endElementView(const XMLStringView &name) {
+  LOG_DEBUG(5, __FUNCTION__ << "(" << name << ")");
+
+  depth--;
+
+  if (!pop()) get().endElementView(name);
+  else LOG_DEBUG(5, "XMLReader popped " << name << " handler");
+}
+
+
+void XMLReader::textView(const XMLStringView &text) {
+  if (depth) get().textView(text);
+}
+
+
+void XMLReader::parse(const InputSource &src, XMLHandler *handler) {
+  if (handler) push(handler, 0);
+
+  SmartPointer<XMLAdapter> adapter = XMLAdapter::create();
+  adapter->setFilename(getCurrentFile());
+  adapter->pushHandler(this);
+
+  XMLSkipHandler skipper(*this);
+  if (skipRoot) adapter->pushHandler(&skipper);
+
+  adapter->read(src);
+
+  if (handler) pop();
+}
+
+
 void XMLReader::push(XMLHandler *handler, XMLHandlerFactory *factory) {
   handlers.push_back(HandlerRecord(handler, depth, factory));
   get().pushFile(getCurrentFile());
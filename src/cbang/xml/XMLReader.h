@@ -43,6 +43,7 @@
 namespace cb {
   class XMLHandlerFactory;
   class XIncludeHandler;
+  class InputSource;
 
   /// Used to read the XML files.  Also handles <include> tags.
   class XMLReader : public XMLProcessor {
@@ -58,8 +59,13 @@ namespace cb {
     XMLReader(bool skipRoot = true);
     virtual ~XMLReader();
 
+    /**
+     * Regular files are parsed in place from memory.  Files larger than
+     * XMLAdapter::MAX_COPY_SIZE are mapped, smaller ones are read.
+     */
     void read(const std::string &filename, XMLHandler *handler);
     void read(std::istream &stream, XMLHandler *handler);
+    void read(const InputSource &src, XMLHandler *handler);
 
     // From XMLProcessor
     void pushContext();
@@ -71,8 +77,13 @@ namespace cb {
     void endElement(const std::string &name);
     void text(const std::string &text);
     void cdata(const std::string &data);
+    void startElementView(const XMLStringView &name,
+                          const XMLAttributesView &attrs);
+    void endElementView(const XMLStringView &name);
+    void textView(const XMLStringView &text);
 
   protected:
+    void parse(const InputSource &src, XMLHandler *handler);
     void push(XMLHandler *handler, XMLHandlerFactory *factory);
     bool pop();
     XMLHandler &get();
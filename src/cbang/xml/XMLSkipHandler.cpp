@@ -55,3 +55,19 @@ void XMLSkipHandler::text(const string &text) {
 void XMLSkipHandler::cdata(const string &data) {
   if (depth) parent.cdata(data);
 }
+
+
+void XMLSkipHandler::startElementView(const XMLStringView &name,
+                                      const XMLAttributesView &attrs) {
+  if (++depth != 1) parent.startElementView(name, attrs);
+}
+
+
+void XMLSkipHandler::endElementView(const XMLStringView &name) {
+  if (--depth != 0) parent.endElementView(name);
+}
+
+
+void XMLSkipHandler::textView(const XMLStringView &text) {
+  if (depth) parent.textView(text);
+}
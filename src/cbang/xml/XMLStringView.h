@@ -0,0 +1,73 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstring>
+
+
+namespace cb {
+  /// A non-owning reference to characters in the XML parser's buffer.
+  /// Only valid for the duration of the handler call which received it.
+  class XMLStringView {
+    const char *data;
+    unsigned length;
+
+  public:
+    XMLStringView() : data(""), length(0) {}
+    XMLStringView(const char *data, unsigned length) :
+      data(data), length(length) {}
+    XMLStringView(const char *s) : data(s), length(strlen(s)) {}
+    XMLStringView(const std::string &s) : data(s.data()), length(s.length()) {}
+
+    const char *getData() const {return data;}
+    unsigned getLength() const {return length;}
+    bool empty() const {return !length;}
+
+    const char *begin() const {return data;}
+    const char *end() const {return data + length;}
+
+    std::string toString() const {return std::string(data, length);}
+
+    bool operator==(const XMLStringView &o) const
+    {return length == o.length && !memcmp(data, o.data, length);}
+    bool operator!=(const XMLStringView &o) const {return !(*this == o);}
+  };
+
+
+  inline
+  std::ostream &operator<<(std::ostream &stream, const XMLStringView &s) {
+    return stream.write(s.getData(), s.getLength());
+  }
+}
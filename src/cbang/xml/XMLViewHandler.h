@@ -0,0 +1,53 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include "XMLHandler.h"
+
+
+namespace cb {
+  /// A base class for XML handlers which only implement the zero-copy
+  /// callbacks.  Calls to the string callbacks are passed on as views.
+  class XMLViewHandler : public XMLHandler {
+  public:
+    // From XMLHandler
+    void startElement(const std::string &name, const XMLAttributes &attrs);
+    void endElement(const std::string &name) {endElementView(name);}
+    void text(const std::string &text) {textView(text);}
+
+    void startElementView(const XMLStringView &name,
+                          const XMLAttributesView &attrs) = 0;
+    void endElementView(const XMLStringView &name) = 0;
+    void textView(const XMLStringView &text) = 0;
+  };
+}
@@ -31,27 +31,162 @@
 \******************************************************************************/
 
 #include <cbang/net/Base64.h>
+#include <cbang/iostream/Base64StreamFilter.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
 
 #include <cbang/Catch.h>
 
 #include <iostream>
+#include <sstream>
+
+#include <boost/iostreams/filtering_stream.hpp>
 
 using namespace std;
 using namespace cb;
 
 
 int usage(const char *name) {
-  cerr << "Usage: " << name << " <-d | -e> <string>" << endl;
+  cerr << "Usage: " << name << " <-d | -e> <string> | -r <bytes> | -t <MiB>"
+       << endl;
   return 1;
 }
 
 
+string randomData(unsigned length) {
+  string data(length, 0);
+  uint32_t x = 0x12345678;
+
+  for (unsigned i = 0; i < length; i++) {
+    x = x * 1103515245 + 12345;
+    data[i] = (char)(x >> 16);
+  }
+
+  return data;
+}
+
+
+string referenceEncode(const string &s, char pad, char a, char b,
+                       unsigned width) {
+  const char *table =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+  string result;
+  unsigned col = 0;
+
+  for (unsigned i = 0; i < s.length(); i += 3) {
+    if (width && col == width) {
+      result += "\r\n";
+      col = 0;
+    }
+
+    uint32_t x = (uint8_t)s[i] << 16;
+    if (i + 1 < s.length()) x |= (uint8_t)s[i + 1] << 8;
+    if (i + 2 < s.length()) x |= (uint8_t)s[i + 2];
+
+    for (unsigned j = 0; j < 4; j++) {
+      unsigned v = 63 & x >> (18 - 6 * j);
+      if (pad && s.length() < i + j) result += pad;
+      else result += v == 62 ? a : (v == 63 ? b : table[v]);
+    }
+
+    col += 4;
+  }
+
+  return result;
+}
+
+
+string streamEncode(const string &s, const Base64 &base64, unsigned chunk) {
+  ostringstream str;
+  io::filtering_ostream out;
+  out.push(Base64EncodeFilter(base64));
+  out.push(str);
+
+  for (unsigned i = 0; i < s.length(); i += chunk)
+    out.write(s.data() + i, min<size_t>(chunk, s.length() - i));
+
+  out.reset();
+  return str.str();
+}
+
+
+string streamDecode(const string &s, const Base64 &base64) {
+  istringstream str(s);
+  io::filtering_istream in;
+  in.push(Base64DecodeFilter(base64));
+  in.push(str);
+
+  ostringstream result;
+  result << in.rdbuf();
+  return result.str();
+}
+
+
+bool roundTrip(const string &data, const Base64 &base64, char a, char b) {
+  string expected =
+    referenceEncode(data, base64.getPad(), a, b, base64.getWidth());
+  string encoded = base64.encode(data);
+
+  if (encoded != expected) return false;
+  if (streamEncode(data, base64, 1) != expected) return false;
+  if (streamEncode(data, base64, 4093) != expected) return false;
+
+  // Unpadded encodings fill the last group so only whole groups round trip
+  if (!base64.getPad() && data.length() % 3) return true;
+
+  if (base64.decode(encoded) != data) return false;
+  if (streamDecode(encoded, base64) != data) return false;
+
+  return true;
+}
+
+
+void roundTrips(unsigned length) {
+  string data = randomData(length);
+
+  for (unsigned offset = 0; offset < 3 && offset < length; offset++) {
+    string s = data.substr(offset);
+
+    if (!roundTrip(s, Base64(), '+', '/') ||
+        !roundTrip(s, Base64('=', '+', '/', 76), '+', '/') ||
+        !roundTrip(s, Base64('=', '+', '/', 74), '+', '/') ||
+        !roundTrip(s, URLBase64(), '-', '_'))
+      THROW("Round trip failed for " << s.length() << " bytes");
+  }
+
+  cout << length << " bytes OK" << endl;
+}
+
+
+void throughput(unsigned mib) {
+  string data = randomData(mib << 20);
+  Base64 base64;
+
+  double start = Timer::now();
+  string encoded = base64.encode(data);
+  double encodeTime = Timer::now() - start;
+
+  start = Timer::now();
+  string decoded = base64.decode(encoded);
+  double decodeTime = Timer::now() - start;
+
+  if (decoded != data) THROW("Round trip failed");
+
+  cout << "encode " << String::printf("%.1f", mib / encodeTime) << " MiB/s"
+       << endl;
+  cout << "decode " << String::printf("%.1f", mib / decodeTime) << " MiB/s"
+       << endl;
+}
+
+
 int main(int argc, char *argv[]) {
   try {
     if (argc != 3) return usage(argv[0]);
 
     if (string("-d") == argv[1]) cout << Base64().decode(argv[2]) << endl;
     else if (string("-e") == argv[1]) cout << Base64().encode(argv[2]) << endl;
+    else if (string("-r") == argv[1]) roundTrips(String::parseU32(argv[2]));
+    else if (string("-t") == argv[1]) throughput(String::parseU32(argv[2]));
     else return usage(argv[0]);
 
     return 0;
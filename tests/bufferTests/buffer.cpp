@@ -0,0 +1,236 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/buffer/BufferPool.h>
+#include <cbang/buffer/MemoryBuffer.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+using namespace cb;
+
+
+BufferPool &pool = BufferPool::instance();
+
+
+#define CHECK(cond)                                                     \
+  do {if (!(cond)) THROW("Check failed line " << __LINE__ << ": " #cond);} \
+  while (0)
+
+
+void sizeClasses() {
+  unsigned sizes[] = {1, 4096, 4097, 8192, 65536, 1 << 20, (1 << 20) + 1, 0};
+
+  for (unsigned i = 0; sizes[i]; i++)
+    cout << sizes[i] << " -> class " << BufferPool::getSizeClass(sizes[i])
+         << endl;
+}
+
+
+void reuse() {
+  BufferPool::Stats before = pool.getStats();
+
+  unsigned size = 5000;
+  char *a = pool.allocate(size);
+  cout << "5000 rounded to " << size << endl;
+  CHECK(pool.getStats().inUse == before.inUse + size);
+
+  // Released buffers are kept by this thread and handed out again
+  pool.release(a, size);
+  BufferPool::Stats stats = pool.getStats();
+  CHECK(stats.inUse == before.inUse);
+  CHECK(stats.threadCached == before.threadCached + size);
+
+  char *b = pool.allocate(size);
+  stats = pool.getStats();
+  CHECK(a == b);
+  CHECK(stats.hits == before.hits + 1);
+  CHECK(stats.threadCached == before.threadCached);
+  pool.release(b, size);
+
+  // Larger than any class
+  unsigned large = 3 << 20;
+  char *c = pool.allocate(large);
+  cout << "large allocation " << large << endl;
+  CHECK(pool.getStats().held == stats.held + large);
+  pool.release(c, large);
+  CHECK(pool.getStats().held == stats.held);
+
+  cout << "reuse OK" << endl;
+}
+
+
+void cap() {
+  uint64_t base = pool.getStats().inUse;
+  pool.setMaxBytes(base + 8 * 65536);
+
+  vector<char *> buffers;
+  try {
+    while (true) {
+      unsigned size = 65536;
+      buffers.push_back(pool.allocate(size));
+      if (pool.isExhausted()) cout << buffers.size() << " exhausted" << endl;
+    }
+
+  } catch (const Exception &e) {
+    cout << buffers.size() << " " << e.getMessage() << endl;
+  }
+
+  // Cached free buffers do not count against the cap
+  for (unsigned i = 0; i < buffers.size(); i++)
+    pool.release(buffers[i], 65536);
+  buffers.clear();
+  CHECK(!pool.isExhausted());
+
+  unsigned size = 65536;
+  pool.release(pool.allocate(size), size);
+
+  pool.setMaxBytes(0);
+  cout << "cap OK" << endl;
+}
+
+
+void concurrent() {
+  const unsigned threads = 8;
+  const unsigned each = 64;
+  const unsigned limit = 100;
+  uint64_t base = pool.getStats().inUse;
+  pool.setMaxBytes(base + limit * 4096);
+
+  atomic<unsigned> total(0);
+  vector<vector<char *> > buffers(threads);
+  vector<thread> workers;
+
+  for (unsigned i = 0; i < threads; i++)
+    workers.push_back(thread([&, i] () {
+          for (unsigned j = 0; j < each; j++)
+            try {
+              unsigned size = 4096;
+              buffers[i].push_back(pool.allocate(size));
+              total++;
+            } catch (const Exception &e) {}
+        }));
+
+  for (unsigned i = 0; i < threads; i++) workers[i].join();
+
+  // Exactly up to the cap, never past it
+  cout << total << " of " << threads * each << " allocated" << endl;
+  CHECK(pool.getStats().inUse == base + total * 4096);
+
+  for (unsigned i = 0; i < threads; i++)
+    for (unsigned j = 0; j < buffers[i].size(); j++)
+      pool.release(buffers[i][j], 4096);
+
+  CHECK(pool.getStats().inUse == base);
+  pool.setMaxBytes(0);
+}
+
+
+void growth() {
+  uint64_t base = pool.getStats().inUse;
+
+  {
+    MemoryBuffer buf(100);
+    cout << "capacity " << buf.getCapacity() << " allocated "
+         << buf.getAllocated() << (buf.isPooled() ? " pooled" : "") << endl;
+    buf.write("hello", 5);
+
+    // Grows within the pooled allocation first
+    const char *start = buf.begin();
+    buf.increase(3000);
+    CHECK(buf.begin() == start);
+    cout << "capacity " << buf.getCapacity() << " allocated "
+         << buf.getAllocated() << endl;
+
+    buf.increase(5000);
+    CHECK(string(buf.begin(), buf.getFill()) == "hello");
+    cout << "capacity " << buf.getCapacity() << " allocated "
+         << buf.getAllocated() << endl;
+    CHECK(pool.getStats().inUse == base + buf.getAllocated());
+
+    buf.release();
+    CHECK(!buf.getCapacity() && !buf.isPooled());
+    CHECK(pool.getStats().inUse == base);
+
+    // A released buffer can grow again
+    buf.increase(10);
+    cout << "after release capacity " << buf.getCapacity() << " allocated "
+         << buf.getAllocated() << (buf.isPooled() ? " pooled" : "") << endl;
+  }
+
+  CHECK(pool.getStats().inUse == base);
+
+  // Caller supplied memory is never returned to the pool
+  char data[16];
+  memcpy(data, "0123456789abcdef", 16);
+  MemoryBuffer fixed(16, data);
+  CHECK(!fixed.isPooled() && fixed.getFill() == 16);
+
+  try {
+    fixed.increase(32);
+    THROW("Fixed buffer grew");
+  } catch (const Exception &e) {
+    cout << "fixed: " << e.getMessage() << endl;
+  }
+
+  char *owned = (char *)malloc(16);
+  memcpy(owned, data, 16);
+  MemoryBuffer allocated(16, owned, true);
+  allocated.increase(32);
+  CHECK(!allocated.isPooled() && allocated.getCapacity() == 32);
+  CHECK(string(allocated.begin(), 16) == string(data, 16));
+  CHECK(pool.getStats().inUse == base);
+
+  cout << "growth OK" << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    sizeClasses();
+    reuse();
+    cap();
+    concurrent();
+    growth();
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+
+  return 1;
+}
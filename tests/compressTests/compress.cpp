@@ -0,0 +1,209 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/iostream/ParallelCompressor.h>
+#include <cbang/iostream/BZip2Decompressor.h>
+#include <cbang/tar/TarFileReader.h>
+#include <cbang/tar/TarFileWriter.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <sstream>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/copy.hpp>
+
+using namespace std;
+using namespace cb;
+
+
+int usage(const char *name) {
+  cerr << "Usage: " << name << " [-b <MiB>]" << endl;
+  return 1;
+}
+
+
+const char *formats[] = {"gzip", "zlib", "bzip2"};
+
+
+// Compressible pseudo random text
+string randomData(unsigned length, uint32_t seed) {
+  string data(length, 0);
+  uint32_t x = seed;
+
+  for (unsigned i = 0; i < length; i++) {
+    x = x * 1103515245 + 12345;
+    data[i] = 'a' + (x >> 16) % 16;
+  }
+
+  return data;
+}
+
+
+string compress(const string &data, ParallelCompressor::format_t format,
+                unsigned threads, unsigned blockSize) {
+  ostringstream str;
+
+  io::filtering_ostream out;
+  out.push(ParallelCompressor(format, threads, blockSize));
+  out.push(str);
+
+  // Write in odd sized pieces to exercise block boundaries
+  for (unsigned i = 0; i < data.size(); i += 1000)
+    out.write(data.data() + i, min((size_t)1000, data.size() - i));
+
+  out.reset();
+
+  return str.str();
+}
+
+
+string decompress(const string &data, ParallelCompressor::format_t format) {
+  istringstream str(data);
+  ostringstream result;
+
+  io::filtering_istream in;
+  switch (format) {
+  case ParallelCompressor::PARALLEL_GZIP:
+    in.push(io::gzip_decompressor());
+    break;
+  case ParallelCompressor::PARALLEL_ZLIB:
+    in.push(io::zlib_decompressor());
+    break;
+  case ParallelCompressor::PARALLEL_BZIP2: in.push(BZip2Decompressor()); break;
+  }
+  in.push(str);
+
+  io::copy(in, result);
+
+  return result.str();
+}
+
+
+void roundTrip() {
+  const unsigned blockSize = 4096;
+  const unsigned sizes[] = {0, 1, blockSize - 1, blockSize, blockSize + 1,
+                            100000};
+  const unsigned threads[] = {1, 4, 16};
+
+  for (unsigned f = 0; f < 3; f++) {
+    ParallelCompressor::format_t format = (ParallelCompressor::format_t)f;
+
+    for (unsigned s = 0; s < 6; s++) {
+      string data = randomData(sizes[s], s);
+      string first;
+
+      for (unsigned t = 0; t < 3; t++) {
+        string result = compress(data, format, threads[t], blockSize);
+
+        // Output must not depend on the thread count
+        if (!t) first = result;
+        bool same = result == first;
+        bool ok = decompress(result, format) == data;
+
+        cout << formats[f] << ' ' << sizes[s] << " bytes, " << threads[t]
+             << " threads: " << (ok ? "OK" : "FAILED")
+             << (same ? "" : " output differs") << endl;
+      }
+    }
+  }
+}
+
+
+void tarRoundTrip() {
+  const TarFile::compression_t types[] =
+    {TarFile::TARFILE_GZIP, TarFile::TARFILE_BZIP2};
+
+  for (unsigned i = 0; i < 2; i++) {
+    string data = randomData(3000000, i);
+    stringstream str;
+
+    {
+      TarFileWriter writer(str, types[i], 4);
+      writer.add(data.data(), data.size(), "file.txt");
+    }
+
+    TarFileReader reader(str, types[i]);
+    ostringstream result;
+    string filename = reader.extract(result);
+
+    cout << "tar " << formats[2 * i] << ": " << filename << ' '
+         << (result.str() == data ? "OK" : "FAILED") << endl;
+  }
+}
+
+
+void benchmark(unsigned mib) {
+  string data = randomData(mib << 20, 0);
+  const unsigned threads[] = {1, 4, 16};
+
+  for (unsigned f = 0; f < 3; f++) {
+    ParallelCompressor::format_t format = (ParallelCompressor::format_t)f;
+    double base = 0;
+
+    for (unsigned t = 0; t < 3; t++) {
+      double start = Timer::now();
+      string result = compress(data, format, threads[t], 0);
+      double delta = Timer::now() - start;
+      if (!t) base = delta;
+
+      cout << formats[f] << ' ' << threads[t] << " threads:"
+           << String::printf(" %.1f MiB/s", mib / delta)
+           << String::printf(" %.2fx", base / delta)
+           << String::printf(" ratio %.3f", (double)result.size() / data.size())
+           << endl;
+    }
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 3 && string("-b") == argv[1])
+      benchmark(String::parseU32(argv[2]));
+
+    else if (argc == 1) {
+      roundTrip();
+      tarRoundTrip();
+
+    } else return usage(argv[0]);
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
@@ -0,0 +1,229 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/config/Options.h>
+#include <cbang/config/CommandLine.h>
+#include <cbang/config/OptionRef.h>
+#include <cbang/config/OptionValue.h>
+#include <cbang/config/MinMaxConstraint.h>
+#include <cbang/os/Thread.h>
+#include <cbang/log/Logger.h>
+#include <cbang/String.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <string.h>
+
+using namespace std;
+using namespace cb;
+
+
+struct Config {
+  Options options;
+
+  OptionRef<int64_t> port;
+  OptionRef<string> name;
+  OptionRef<bool> debug;
+  OptionRef<double> ratio;
+  OptionRef<Option::strings_t> hosts;
+
+  Config() {
+    options.add("port", "Listen port",
+                new MinMaxConstraint<int64_t>(1, 65535))->setDefault(80);
+    options.add("name", "Server name")->setDefault("default");
+    options.add("debug", "Enable debugging")->setDefault(false);
+    options.add("ratio", "A ratio")->setDefault(0.5);
+    options.add("hosts", "Allowed hosts")->setType(Option::STRINGS_TYPE);
+
+    port = OptionRef<int64_t>(options, "port");
+    name = OptionRef<string>(options, "name");
+    debug = OptionRef<bool>(options, "debug");
+    ratio = OptionRef<double>(options, "ratio");
+    hosts = OptionRef<Option::strings_t>(options, "hosts");
+  }
+
+
+  void print() const {
+    cout << "port=" << port << " name=" << name.get()
+         << " debug=" << String(debug.get()) << " ratio=" << ratio
+         << " hosts=" << String::join(hosts.get(Option::strings_t()), ",")
+         << endl;
+  }
+};
+
+
+struct Reader : public Thread {
+  Config &config;
+  unsigned reads;
+  unsigned errors;
+
+  Reader(Config &config) : config(config), reads(0), errors(0) {}
+
+  // From Thread
+  void run() {
+    while (!shouldShutdown()) {
+      int64_t port = config.port;
+      if (port != 1000 && port != 2000) errors++;
+
+      // Options changed by one reload are seen together
+      shared_ptr<const Options::values_t> values =
+        config.options.getSnapshot();
+      port = values->at("port")->toInteger();
+      const string &name = values->at("name")->str;
+      if ((port == 1000) != (name == "a")) errors++;
+
+      reads++;
+    }
+  }
+};
+
+
+int reload(Config &config) {
+  // Configurations on stdin are separated by lines containing only "---"
+  string line;
+  string xml;
+
+  while (true) {
+    bool done = !getline(cin, line);
+
+    if (done || line == "---") {
+      try {
+        istringstream stream(xml);
+        unsigned changed = config.options.reload(stream);
+        cout << changed << " changed: ";
+        config.print();
+
+      } catch (const Exception &e) {
+        cout << "rejected: " << e.getMessage();
+        if (!e.getCause().isNull()) cout << ": " << e.getCause()->getMessage();
+        cout << endl << "unchanged: ";
+        config.print();
+      }
+
+      xml.clear();
+      if (done) break;
+
+    } else xml += line + "\n";
+  }
+
+  return 0;
+}
+
+
+int concurrent(Config &config) {
+  string a = "<config><port v=\"1000\"/><name v=\"a\"/></config>";
+  string b = "<config><port v=\"2000\"/><name v=\"b\"/></config>";
+
+  istringstream stream(a);
+  config.options.reload(stream);
+
+  Reader reader(config);
+  reader.start();
+
+  for (unsigned i = 0; i < 10000; i++) {
+    istringstream stream(i & 1 ? a : b);
+    config.options.reload(stream);
+  }
+
+  reader.stop();
+  reader.join();
+
+  cout << "errors " << reader.errors << endl;
+
+  return reader.errors ? 1 : 0;
+}
+
+
+int invalidSet(Config &config) {
+  config.options["port"].set("8080");
+
+  try {
+    config.options["port"].set("99999");
+    cout << "accepted" << endl;
+
+  } catch (const Exception &e) {
+    cout << "rejected: " << e.getCause()->getMessage() << endl;
+  }
+
+  // The invalid value was never published
+  cout << "unchanged: ";
+  config.print();
+  cout << "snapshot port="
+       << config.options.getSnapshot()->at("port")->toInteger() << endl;
+
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    Config config;
+
+    cout << "defaults: ";
+    config.print();
+
+    if (argc == 2 && !strcmp(argv[1], "--reload")) return reload(config);
+    if (argc == 2 && !strcmp(argv[1], "--concurrent"))
+      return concurrent(config);
+    if (argc == 2 && !strcmp(argv[1], "--invalid-set"))
+      return invalidSet(config);
+
+    if (2 < argc && !strcmp(argv[1], "--command-line")) {
+      // Options given on the command line survive a reload
+      CommandLine cmdLine;
+      cmdLine.setKeywordOptions(&config.options);
+      cmdLine.parse(vector<string>(argv + 1, argv + argc));
+      cout << "command line: ";
+      config.print();
+      return reload(config);
+    }
+
+    if (argc == 3 && !strcmp(argv[1], "--reload-file")) {
+      Logger::instance().setLogTime(false);
+      unsigned changed = config.options.reload(argv[2]);
+      cout << changed << " changed: ";
+      config.print();
+      return 0;
+    }
+
+    cerr << "Usage: " << argv[0]
+         << " --reload | --concurrent | --invalid-set | --reload-file <file> |"
+            " --command-line <args>..." << endl;
+    return 1;
+
+  } CATCH_ERROR;
+
+  return 1;
+}
@@ -0,0 +1,186 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/openssl/Cipher.h>
+#include <cbang/event/Buffer.h>
+#include <cbang/event/CipherFilter.h>
+#include <cbang/iostream/CipherStream.h>
+#include <cbang/iostream/NullDevice.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <cbang/Catch.h>
+
+#include <iostream>
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+using namespace std;
+using namespace cb;
+
+
+const char key[] = "0123456789abcdef0123456789abcdef";
+const char iv[] = "0123456789abcdef";
+
+
+int usage(const char *name) {
+  cerr << "Usage: " << name << " [-b <MiB>]" << endl;
+  return 1;
+}
+
+
+string randomData(unsigned length) {
+  string data(length, 0);
+  uint32_t x = 0x12345678;
+
+  for (unsigned i = 0; i < length; i++) {
+    x = x * 1103515245 + 12345;
+    data[i] = (char)(x >> 16);
+  }
+
+  return data;
+}
+
+
+// Filter @param data in chunks of @param chunk bytes
+string filter(const string &cipher, bool encrypt, const string &data,
+              unsigned chunk) {
+  Event::CipherFilter filter(new Cipher(cipher, encrypt, key, iv));
+  Event::Buffer result;
+
+  for (unsigned i = 0; i < data.length(); i += chunk) {
+    Event::Buffer buf(data.substr(i, chunk));
+    filter.filter(buf);
+    result.add(buf);
+  }
+
+  filter.finish(result);
+
+  return result.toString();
+}
+
+
+void check() {
+  const char *ciphers[] = {
+    "aes-256-gcm", "chacha20-poly1305", "aes-256-ctr", "aes-256-cbc", 0};
+  string data = randomData(100000);
+
+  for (unsigned i = 0; ciphers[i]; i++) {
+    string encrypted = filter(ciphers[i], true, data, 100000);
+
+    // Chunking must not change the result
+    unsigned chunks[] = {1, 15, 16, 17, 4096, 0};
+    for (unsigned j = 0; chunks[j]; j++) {
+      if (filter(ciphers[i], true, data, chunks[j]) != encrypted)
+        THROW(ciphers[i] << " encrypt mismatch with chunk " << chunks[j]);
+
+      if (filter(ciphers[i], false, encrypted, chunks[j]) != data)
+        THROW(ciphers[i] << " decrypt mismatch with chunk " << chunks[j]);
+    }
+
+    // Must match the separate buffer API
+    Cipher c(ciphers[i], true, key, iv);
+    string expected(data.length() + 32, 0);
+    unsigned n = c.update(&expected[0], expected.length(), data.data(),
+                          data.length());
+    n += c.final(&expected[n], expected.length() - n);
+    expected.resize(n);
+
+    if (c.isAEAD()) {
+      if (c.getTagLength() != 16) THROW(ciphers[i] << " tag length");
+      char tag[16];
+      c.getTag(tag, 16);
+      expected.append(tag, 16);
+    }
+
+    if (expected != encrypted) THROW(ciphers[i] << " does not match update()");
+
+    // Tampering must be detected
+    bool failed = false;
+    if (c.isAEAD()) {
+      encrypted[1000] ^= 1;
+
+      try {
+        filter(ciphers[i], false, encrypted, 4096);
+      } catch (const Exception &) {failed = true;}
+    }
+
+    cout << ciphers[i] << " OK" << (failed ? " tamper detected" : "") << endl;
+  }
+}
+
+
+void benchmark(unsigned mib) {
+  string data = randomData(1 << 20);
+
+  // Current boost iostreams path
+  io::filtering_ostream stream;
+  stream.push(CipherStream(new Cipher("aes-256-gcm", true, key, iv)));
+  stream.push(NullDevice<char>());
+
+  double start = Timer::now();
+  for (unsigned i = 0; i < mib; i++) stream.write(data.data(), data.length());
+  stream.reset();
+  double streamTime = Timer::now() - start;
+
+  // Event::Buffer filter
+  Event::CipherFilter filter(new Cipher("aes-256-gcm", true, key, iv));
+  Event::Buffer buf;
+
+  start = Timer::now();
+  for (unsigned i = 0; i < mib; i++) {
+    buf.add(data);
+    filter.filter(buf);
+    buf.clear();
+  }
+  filter.finish(buf);
+  double filterTime = Timer::now() - start;
+
+  cout << "CipherStream "
+       << String::printf("%.2f", mib / 1024.0 / streamTime) << " GiB/s" << endl;
+  cout << "CipherFilter "
+       << String::printf("%.2f", mib / 1024.0 / filterTime) << " GiB/s" << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 1) check();
+    else if (argc == 3 && string("-b") == argv[1])
+      benchmark(String::parseU32(argv[2]));
+    else return usage(argv[0]);
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
@@ -0,0 +1,160 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/openssl/Digest.h>
+#include <cbang/event/Buffer.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace cb;
+
+
+int usage(const char *name) {
+  cerr << "Usage: " << name << " [-b <seconds>]" << endl;
+  return 1;
+}
+
+
+vector<string> makeMessages(unsigned count, unsigned size) {
+  vector<string> msgs(count);
+
+  for (unsigned i = 0; i < count; i++) {
+    msgs[i].resize(size);
+    for (unsigned j = 0; j < size; j++) msgs[i][j] = (char)(i * 31 + j);
+  }
+
+  return msgs;
+}
+
+
+void check() {
+  const char *algorithms[] = {"md5", "sha1", "sha256", "sha512", 0};
+  vector<string> msgs = makeMessages(8, 1000);
+  msgs.push_back("");
+  msgs.push_back("abc");
+
+  for (unsigned i = 0; algorithms[i]; i++) {
+    string alg = algorithms[i];
+    Digest digest(alg);
+
+    vector<string> batch;
+    digest.computeBatch(msgs, batch);
+
+    for (unsigned j = 0; j < msgs.size(); j++) {
+      string expected = Digest::hash(msgs[j], alg);
+
+      if (batch[j] != expected) THROW(alg << " batch mismatch " << j);
+      if (digest.compute(msgs[j]) != expected)
+        THROW(alg << " compute mismatch " << j);
+
+      // Split across several chunks of an event buffer chain
+      Event::Buffer buf;
+      for (unsigned k = 0; k < msgs[j].length(); k += 300)
+        buf.add(msgs[j].substr(k, 300));
+
+      digest.reset();
+      buf.digest(digest);
+      if (digest.toString() != expected || buf.getLength() != msgs[j].length())
+        THROW(alg << " Event::Buffer mismatch " << j);
+    }
+
+    cout << alg << "(abc) = " << String::hexEncode(batch.back()) << endl;
+  }
+}
+
+
+template <typename F>
+double rate(unsigned count, double seconds, F f) {
+  unsigned n = 0;
+  double start = Timer::now();
+  double elapsed;
+
+  do {
+    f();
+    n += count;
+    elapsed = Timer::now() - start;
+  } while (elapsed < seconds);
+
+  return n / elapsed;
+}
+
+
+void benchmark(double seconds) {
+  unsigned sizes[] = {64, 1024, 65536, 0};
+
+  for (unsigned i = 0; sizes[i]; i++) {
+    unsigned count = 256;
+    vector<string> msgs = makeMessages(count, sizes[i]);
+    vector<const uint8_t *> data;
+    vector<unsigned> lengths;
+    for (unsigned j = 0; j < count; j++) {
+      data.push_back((const uint8_t *)msgs[j].data());
+      lengths.push_back(msgs[j].length());
+    }
+
+    Digest digest("sha256");
+    vector<uint8_t> out(count * digest.size());
+
+    double hash = rate(count, seconds, [&] () {
+        for (unsigned j = 0; j < count; j++) Digest::hash(msgs[j], "sha256");
+      });
+
+    double batch = rate(count, seconds, [&] () {
+        digest.computeBatch(&data[0], &lengths[0], count, &out[0]);
+      });
+
+    cout << sizes[i] << " B hash() "
+         << String::printf("%.0f", hash) << " msgs/s" << endl;
+    cout << sizes[i] << " B computeBatch() "
+         << String::printf("%.0f", batch) << " msgs/s" << endl;
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 1) check();
+    else if (argc == 3 && string("-b") == argv[1])
+      benchmark(String::parseDouble(argv[2]));
+    else return usage(argv[0]);
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
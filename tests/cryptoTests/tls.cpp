@@ -0,0 +1,172 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/openssl/SSL.h>
+#include <cbang/openssl/SSLContext.h>
+#include <cbang/openssl/KeyPair.h>
+#include <cbang/openssl/Certificate.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/time/Time.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <cbang/Catch.h>
+
+#include <iostream>
+
+#include <openssl/ssl.h>
+
+using namespace std;
+using namespace cb;
+
+
+int usage(const char *name) {
+  cerr << "Usage: " << name << " [-b <handshakes>]" << endl;
+  return 1;
+}
+
+
+// Handshake over a loopback BIO pair
+void handshake(SSLContext &serverCtx, SSLContext &clientCtx) {
+  ::SSL *server = SSL_new(serverCtx.getCTX());
+  ::SSL *client = SSL_new(clientCtx.getCTX());
+  clientCtx.resumeSession(client, "localhost");
+
+  BIO *serverBIO, *clientBIO;
+  BIO_new_bio_pair(&serverBIO, 0, &clientBIO, 0);
+  SSL_set_bio(server, serverBIO, serverBIO);
+  SSL_set_bio(client, clientBIO, clientBIO);
+  SSL_set_accept_state(server);
+  SSL_set_connect_state(client);
+
+  bool serverDone = false;
+  bool clientDone = false;
+
+  for (unsigned i = 0; !serverDone || !clientDone; i++) {
+    if (100 < i) THROW("Handshake did not complete");
+
+    for (unsigned j = 0; j < 2; j++) {
+      ::SSL *ssl = j ? server : client;
+      bool &done = j ? serverDone : clientDone;
+      if (done) continue;
+
+      int ret = SSL_do_handshake(ssl);
+      if (ret == 1) done = true;
+      else if (SSL_get_error(ssl, ret) != SSL_ERROR_WANT_READ)
+        THROW("Handshake failed: " << cb::SSL::getErrorStr());
+    }
+  }
+
+  // Read any TLS 1.3 session tickets
+  char buf[1];
+  SSL_read(client, buf, 1);
+
+  SSL_free(client);
+  SSL_free(server);
+}
+
+
+struct Contexts {
+  SSLContext server;
+  SSLContext client;
+
+  Contexts(const KeyPair &key, const Certificate &cert, bool resume) {
+    server.useCertificate(cert);
+    server.usePrivateKey(key);
+    client.setVerifyNone();
+
+    if (resume) server.setSessionTicketLifetime(3600);
+    else {
+      server.setSessionCacheSize(0);
+      server.setSessionTickets(false);
+      client.setClientSessionCacheSize(0);
+    }
+  }
+};
+
+
+void run(const KeyPair &key, const Certificate &cert, unsigned count,
+         bool resume, bool timed) {
+  Contexts ctxs(key, cert, resume);
+
+  double start = Timer::now();
+  double startCPU = SystemUtilities::getCPUTime();
+
+  for (unsigned i = 0; i < count; i++) handshake(ctxs.server, ctxs.client);
+
+  double delta = Timer::now() - start;
+  double cpu = SystemUtilities::getCPUTime() - startCPU;
+
+  cout << "Resumption " << (resume ? "on" : "off") << ": "
+       << ctxs.server.getResumedHandshakes() << " resumed of "
+       << ctxs.server.getHandshakes() << " server, "
+       << ctxs.client.getResumedHandshakes() << " resumed of "
+       << ctxs.client.getHandshakes() << " client";
+
+  if (timed)
+    cout << ", " << String::printf("%.0f", count / delta) << " handshakes/s, "
+         << String::printf("%.3f", cpu * 1000 / count) << " ms CPU/handshake";
+
+  cout << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    unsigned count = 3;
+    bool timed = false;
+
+    if (argc == 3 && string("-b") == argv[1]) {
+      count = String::parseU32(argv[2]);
+      timed = true;
+
+    } else if (argc != 1) return usage(argv[0]);
+
+    KeyPair key;
+    key.generateRSA(2048);
+
+    Certificate cert;
+    cert.setPublicKey(key);
+    cert.setNotBefore();
+    cert.setNotAfter(Time::SEC_PER_DAY);
+    cert.addNameEntry("CN", "localhost");
+    cert.setIssuer(cert);
+    cert.sign(key);
+
+    run(key, cert, count, false, timed);
+    run(key, cert, count, true, timed);
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
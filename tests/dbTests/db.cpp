@@ -0,0 +1,439 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/Exception.h>
+#include <cbang/db/Database.h>
+#include <cbang/db/DatabasePool.h>
+#include <cbang/db/NameValueTable.h>
+#include <cbang/db/StatementCache.h>
+#include <cbang/db/EventSQLite.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/json/JSON.h>
+#include <cbang/os/Thread.h>
+#include <cbang/os/TemporaryDirectory.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace cb;
+using namespace cb::DB;
+using namespace std;
+
+
+void printCache(Database &db) {
+  StatementCache &cache = db.getCache();
+  cout << "cache size=" << cache.size() << " hits=" << cache.getHits()
+       << " misses=" << cache.getMisses() << endl;
+}
+
+
+int cache() {
+  Database db;
+  db.open(":memory:");
+  db.setCacheSize(2);
+
+  db.execute("CREATE TABLE t (x INTEGER)");
+  for (int i = 0; i < 3; i++) db.execute("INSERT INTO t VALUES (1)");
+  printCache(db);
+
+  int64_t count;
+  for (int i = 0; i < 3; i++) db.execute("SELECT COUNT(*) FROM t", count);
+  cout << "count=" << count << endl;
+  printCache(db);
+
+  // Evicts the least recently used INSERT
+  db.execute("SELECT SUM(x) FROM t", count);
+  db.execute("INSERT INTO t VALUES (1)");
+  printCache(db);
+
+  // Several statements are run but not cached
+  db.execute("INSERT INTO t VALUES (2); INSERT INTO t VALUES (3);");
+  db.execute("SELECT SUM(x) FROM t", count);
+  cout << "sum=" << count << endl;
+  printCache(db);
+
+  db.execute("");
+
+  try {
+    db.execute("INSERT INTO missing VALUES (1)");
+  } catch (const Exception &e) {cout << e.getMessage() << endl;}
+
+  try {
+    db.execute("CREATE TABLE u (x INTEGER PRIMARY KEY)");
+    db.execute("INSERT INTO u VALUES (1)");
+    db.execute("INSERT INTO u VALUES (1)");
+  } catch (const Exception &e) {cout << e.getMessage() << endl;}
+
+  db.setCacheSize(0);
+  printCache(db);
+
+  return 0;
+}
+
+
+int batch() {
+  Database db;
+  db.open(":memory:");
+
+  NameValueTable table(db, "config");
+  table.create();
+  table.init();
+
+  db.batch([&] () {
+      table.set("a", string("1"));
+      table.set("b", (int64_t)2);
+
+      // Joins the outer transaction
+      db.batch([&] () {table.set("c", 3.5);});
+    });
+
+  try {
+    db.batch([&] () {
+        table.set("a", string("changed"));
+        table.unset("b");
+        THROW("Abort batch");
+      });
+  } catch (const Exception &e) {cout << e.getMessage() << endl;}
+
+  cout << "in transaction=" << db.inTransaction() << endl;
+  cout << "a=" << table.getString("a") << endl;
+  cout << "b=" << table.getInteger("b") << endl;
+  cout << "c=" << table.getDouble("c") << endl;
+  cout << "d=" << table.getString("d", "default") << endl;
+  cout << "has d=" << table.has("d") << endl;
+
+  try {
+    table.getString("d");
+  } catch (const Exception &e) {cout << e.getMessage() << endl;}
+
+  return 0;
+}
+
+
+class Reader : public Thread {
+  DatabasePool &pool;
+
+public:
+  bool ok;
+
+  Reader(DatabasePool &pool) : pool(pool), ok(false) {}
+
+  void run() {
+    Database &db = pool.getReader();
+
+    // The writer holds the total equal to the row count
+    int64_t rows = 0;
+    int64_t total = 0;
+    for (int i = 0; i < 200; i++) {
+      db.execute("SELECT COUNT(*) FROM t", rows);
+      db.execute("SELECT total FROM sum", total);
+      if (total < rows) return;
+    }
+
+    ok = &db == &pool.getReader();
+  }
+};
+
+
+int pool() {
+  TemporaryDirectory tmp(".");
+  DatabasePool pool(tmp.getPath() + "/pool.db");
+  pool.open();
+
+  pool.write([] (Database &db) {
+      db.execute("CREATE TABLE t (x INTEGER)");
+      db.execute("CREATE TABLE sum (total INTEGER)");
+      db.execute("INSERT INTO sum VALUES (0)");
+    });
+
+  vector<SmartPointer<Reader> > readers;
+  for (int i = 0; i < 4; i++) {
+    readers.push_back(new Reader(pool));
+    readers.back()->start();
+  }
+
+  for (int i = 0; i < 100; i++)
+    pool.write([] (Database &db) {
+        db.execute("UPDATE sum SET total = total + 1");
+        db.execute("INSERT INTO t VALUES (1)");
+      });
+
+  for (unsigned i = 0; i < readers.size(); i++) {
+    readers[i]->join();
+    cout << "reader " << i << " ok=" << readers[i]->ok << endl;
+  }
+
+  int64_t rows;
+  pool.getReader().execute("SELECT COUNT(*) FROM t", rows);
+  cout << "rows=" << rows << endl;
+
+  try {
+    pool.getReader().execute("INSERT INTO t VALUES (1)");
+  } catch (const Exception &) {cout << "read only" << endl;}
+
+  pool.close();
+
+  try {
+    pool.getReader();
+  } catch (const Exception &) {cout << "closed" << endl;}
+
+  return 0;
+}
+
+
+class EventTest {
+  Event::Base base;
+  TemporaryDirectory tmp;
+  EventSQLite db;
+  SmartPointer<Event::Event> failsafe;
+
+  unsigned pending;
+  unsigned errors;
+  JSON::Writer writer;
+
+public:
+  EventTest() :
+    base(true), tmp("."), db(base, tmp.getPath() + "/event.db"),
+    failsafe(base.newEvent(this, &EventTest::timeout)), pending(0),
+    errors(0), writer(cout, 0, true) {}
+
+
+  void timeout() {
+    cout << "Test timed out" << endl;
+    base.loopExit();
+  }
+
+
+  void written(EventSQLite::state_t state) {
+    if (state == EventSQLite::EVENTDB_ERROR) {
+      cout << "write error: " << db.getError() << endl;
+      errors++;
+    }
+
+    if (!--pending) {
+      cout << "writes done errors=" << errors << endl;
+      query();
+    }
+  }
+
+
+  void write() {
+    db.write([] (EventSQLite::state_t state) {},
+             "CREATE TABLE t (id INTEGER PRIMARY KEY, name TEXT)");
+
+    // Queued together so they are committed as a group
+    for (int i = 1; i <= 100; i++) {
+      pending++;
+      JSON::ValuePtr params = new JSON::List;
+      params->append(i == 50 ? 1 : i); // Duplicate key
+      params->append(String::printf("name%d", i));
+
+      db.write(this, &EventTest::written,
+               "INSERT INTO t (id, name) VALUES (?, ?)", params);
+    }
+  }
+
+
+  void rows(EventSQLite::state_t state) {
+    switch (state) {
+    case EventSQLite::EVENTDB_BEGIN_RESULT:
+      cout << "columns " << db.getRow() << endl;
+      break;
+    case EventSQLite::EVENTDB_ROW: cout << "row " << db.getRow() << endl; break;
+    case EventSQLite::EVENTDB_END_RESULT: cout << "end" << endl; break;
+    case EventSQLite::EVENTDB_ERROR:
+      cout << "error " << db.getError() << endl;
+      break;
+
+    case EventSQLite::EVENTDB_DONE:
+      cout << "done" << endl;
+      sink();
+      break;
+    }
+  }
+
+
+  void query() {
+    JSON::ValuePtr params = new JSON::Dict;
+    params->insert("min", 97);
+
+    db.query(this, &EventTest::rows,
+             "SELECT COUNT(*), SUM(id) FROM t WHERE id < :min", params);
+  }
+
+
+  void sink() {
+    JSON::ValuePtr params = new JSON::List;
+    params->append(97);
+
+    db.query(writer, [this] (EventSQLite::state_t state) {
+        if (state == EventSQLite::EVENTDB_DONE) {
+          cout << endl;
+          slow();
+        }
+      }, "SELECT id, name FROM t WHERE ? < id ORDER BY id", params);
+  }
+
+
+  void slow() {
+    const char *sql = "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL "
+      "SELECT x + 1 FROM c) SELECT COUNT(*) FROM c";
+
+    // Canceled queries never call back
+    uint64_t id = db.query([] (EventSQLite::state_t state) {
+        cout << "canceled query called back" << endl;
+      }, sql);
+    cout << "canceled=" << db.cancel(id) << endl;
+
+    db.query([this] (EventSQLite::state_t state) {
+        if (state == EventSQLite::EVENTDB_ERROR) {
+          cout << "slow query: " << db.getError() << endl;
+          finish();
+        }
+      }, sql, 0, 0.1);
+  }
+
+
+  void finish() {
+    // Readers still work after a query is interrupted
+    db.query([this] (EventSQLite::state_t state) {
+        if (state == EventSQLite::EVENTDB_ROW)
+          cout << "count " << db.getRow() << endl;
+
+        if (state == EventSQLite::EVENTDB_DONE) {
+          cout << "canceled=" << db.cancel(1) << endl;
+          base.loopExit();
+        }
+      }, "SELECT COUNT(*) FROM t");
+  }
+
+
+  int run() {
+    db.start();
+    failsafe->add(30);
+
+    write();
+    base.dispatch();
+
+    db.stop();
+    return 0;
+  }
+};
+
+
+string rate(unsigned count, double delta) {
+  return String::printf("%.0f", count / delta);
+}
+
+
+int benchmark(unsigned count) {
+  Database db;
+  db.open(":memory:");
+
+  NameValueTable table(db, "config");
+  table.create();
+  table.init();
+
+  vector<string> names;
+  for (unsigned i = 0; i < count; i++)
+    names.push_back(String::printf("name%u", i));
+
+  double start = Timer::now();
+  for (unsigned i = 0; i < count; i++) table.set(names[i], (int64_t)i);
+  double setTime = Timer::now() - start;
+
+  start = Timer::now();
+  db.batch([&] () {
+      for (unsigned i = 0; i < count; i++) table.set(names[i], (int64_t)i);
+    });
+  double batchTime = Timer::now() - start;
+
+  uint64_t sum = 0;
+  start = Timer::now();
+  for (unsigned i = 0; i < count; i++) sum += table.getInteger(names[i]);
+  for (unsigned i = 0; i < count; i++)
+    sum += table.getInteger(names[i] + "x", 0);
+  double getTime = Timer::now() - start;
+
+  if (sum != (uint64_t)count * (count - 1) / 2) {
+    cerr << "Wrong sum " << sum << endl;
+    return 1;
+  }
+
+  // Ad hoc queries with and without the statement cache
+  int64_t x;
+  double times[2];
+  for (int i = 0; i < 2; i++) {
+    db.setCacheSize(i ? 64 : 0);
+
+    start = Timer::now();
+    for (unsigned j = 0; j < count; j++)
+      db.execute("SELECT value FROM config WHERE name='name1'", x);
+    times[i] = Timer::now() - start;
+  }
+
+  cout << "set " << rate(count, setTime) << " ops/s" << endl;
+  cout << "batched set " << rate(count, batchTime) << " ops/s" << endl;
+  cout << "get " << rate(2 * count, getTime) << " ops/s" << endl;
+  cout << "uncached execute " << rate(count, times[0]) << " ops/s" << endl;
+  cout << "cached execute " << rate(count, times[1]) << " ops/s" << endl;
+
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 3 && string("--bench") == argv[1])
+      return benchmark(String::parseU32(argv[2]));
+
+    if (argc == 2 && string("--cache") == argv[1]) return cache();
+    if (argc == 2 && string("--batch") == argv[1]) return batch();
+    if (argc == 2 && string("--pool") == argv[1]) return pool();
+    if (argc == 2 && string("--event") == argv[1]) return EventTest().run();
+
+    cerr << "Usage: " << argv[0]
+         << " --cache | --batch | --pool | --event | --bench <count>"
+         << endl;
+
+  } catch (const Exception &e) {
+    cerr << "Exception: " << e << endl;
+
+  } catch (const std::exception &e) {
+    cerr << "std::exception: " << e.what() << endl;
+  }
+
+  return 1;
+}
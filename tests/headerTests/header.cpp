@@ -0,0 +1,231 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/Exception.h>
+#include <cbang/http/Request.h>
+#include <cbang/http/Response.h>
+#include <cbang/util/StringMap.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <string.h>
+
+using namespace cb;
+using namespace cb::HTTP;
+using namespace std;
+
+
+// The parse which HTTP::Header used before it had its own buffer
+void mapParse(const string &data, CIStringMap &map) {
+  istringstream stream(data);
+  string line;
+  string key;
+
+  getline(stream, line); // Header line
+
+  while (getline(stream, line)) {
+    string::size_type len = line.length();
+    while (len && isspace(line[len - 1])) len--;
+    line.resize(len);
+
+    if (line.empty()) break;
+
+    if (!key.empty() && isspace(line[0]))
+      map.set(key, map.get(key) + " " + String::trim(line));
+
+    else {
+      string::size_type colon = line.find(':');
+      if (colon == string::npos) THROW("Invalid header '" << line << "'");
+
+      key = line.substr(0, colon);
+      map.set(key, String::trim(line.substr(colon + 1)));
+    }
+  }
+}
+
+
+void readCorpus(vector<string> &corpus) {
+  string data;
+  string line;
+
+  while (getline(cin, line)) {
+    data += line + "\n";
+
+    if (String::trim(line).empty()) {
+      if (!String::trim(data).empty()) corpus.push_back(data);
+      data.clear();
+    }
+  }
+}
+
+
+Message *parse(const string &data) {
+  Message *msg;
+  if (data.compare(0, 5, "HTTP/") == 0) msg = new Response;
+  else msg = new Request;
+
+  msg->read(data);
+  return msg;
+}
+
+
+int benchmark(unsigned iterations) {
+  vector<string> corpus;
+  readCorpus(corpus);
+
+  // Check that both parsers agree before timing them
+  unsigned fields = 0;
+  for (unsigned i = 0; i < corpus.size(); i++) {
+    SmartPointer<Message> msg = parse(corpus[i]);
+    CIStringMap map;
+    mapParse(corpus[i], map);
+
+    for (CIStringMap::iterator it = map.begin(); it != map.end(); it++)
+      if (msg->get(it->first) != it->second) {
+        cerr << "Mismatch: " << it->first << endl;
+        return 1;
+      }
+
+    fields += msg->size();
+  }
+
+  double start = Timer::now();
+  for (unsigned j = 0; j < iterations; j++)
+    for (unsigned i = 0; i < corpus.size(); i++) {
+      CIStringMap map;
+      mapParse(corpus[i], map);
+      if (map.has("Content-Length")) map.get("Content-Length");
+    }
+  double mapTime = Timer::now() - start;
+
+  Request request;
+  Response response;
+  start = Timer::now();
+  for (unsigned j = 0; j < iterations; j++)
+    for (unsigned i = 0; i < corpus.size(); i++) {
+      const string &data = corpus[i];
+      Message &msg = data.compare(0, 5, "HTTP/") ? (Message &)request :
+        (Message &)response;
+      msg.parse(data.data(), data.length());
+      msg.getContentLength();
+    }
+  double headerTime = Timer::now() - start;
+
+  unsigned count = iterations * corpus.size();
+  cout << corpus.size() << " headers " << fields << " fields OK" << endl;
+  cout << "CIStringMap " << String::printf("%.0f", count / mapTime)
+       << " headers/s" << endl;
+  cout << "Header " << String::printf("%.0f", count / headerTime)
+       << " headers/s" << endl;
+
+  return 0;
+}
+
+
+void print(const Header &header) {
+  for (unsigned i = 0; i < header.size(); i++)
+    cout << "  " << header.getFieldName(i).toString() << " = '"
+         << header.getFieldValue(i).toString() << "'\n";
+}
+
+
+int edit() {
+  Response response(StatusCode::HTTP_OK);
+
+  response.set("Server", "cbang");
+  response.add("Set-Cookie", "a=1");
+  response.add("Set-Cookie", "b=2");
+  response.set("X-Custom", "one");
+  response.append("x-custom", "two");
+  response.setContentType("text/plain");
+  response.setContentLength(1234);
+  cout << "Added:\n";
+  print(response);
+
+  response.set("SET-COOKIE", "c=3");
+  response.unset("Server");
+  response.set(Header::HEADER_CONTENT_LENGTH, "0");
+  response.setPersistent(false);
+  cout << "Edited:\n";
+  print(response);
+
+  cout << "Content-Length: " << response.getContentLength() << '\n';
+  cout << "Has server: " << response.has(Header::HEADER_SERVER) << '\n';
+  cout << "Persistent: " << response.isPersistent() << '\n';
+  cout << response;
+
+  return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 3 && string("--bench") == argv[1])
+      return benchmark(String::parseU32(argv[2]));
+
+    if (argc == 2 && string("--edit") == argv[1]) return edit();
+
+    vector<string> corpus;
+    readCorpus(corpus);
+
+    for (unsigned i = 0; i < corpus.size(); i++) {
+      try {
+        SmartPointer<Message> msg = parse(corpus[i]);
+
+        cout << msg->getHeaderLine() << " {\n";
+        print(*msg);
+        cout << "  Host: " << msg->get("Host", "<none>") << '\n';
+        cout << "  Content-Length: " << msg->getContentLength() << '\n';
+        cout << "  Chunked: " << msg->isChunked() << '\n';
+        cout << "  Persistent: " << msg->isPersistent() << '\n';
+        cout << "}\n";
+
+      } catch (const Exception &e) {
+        cout << "INVALID: " << e.getMessage() << endl;
+      }
+    }
+
+    return 0;
+
+  } catch (const Exception &e) {
+    cerr << "Exception: " << e << endl;
+
+  } catch (const std::exception &e) {
+    cerr << "std::exception: " << e.what() << endl;
+  }
+
+  return 1;
+}
@@ -0,0 +1,207 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/Catch.h>
+#include <cbang/String.h>
+#include <cbang/config/Options.h>
+#include <cbang/http/Server.h>
+#include <cbang/http/Connection.h>
+#include <cbang/buffer/FileBuffer.h>
+#include <cbang/buffer/MemoryBuffer.h>
+#include <cbang/os/SystemUtilities.h>
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace cb;
+
+
+// Accepts at most limit bytes per call, like a congested connection
+class TrickleSocket : public Socket {
+  unsigned limit;
+  bool fileOK;
+
+public:
+  string sent;
+  unsigned calls;
+
+  TrickleSocket(unsigned limit, bool fileOK) :
+    limit(limit), fileOK(fileOK), calls(0) {}
+
+  // From Socket
+  bool isOpen() const {return true;}
+
+  streamsize write(const char *data, streamsize length, unsigned flags) {
+    Segment segment = {data, (unsigned)length};
+    return writev(&segment, 1, flags);
+  }
+
+  streamsize writev(const Segment *segments, unsigned count, unsigned flags) {
+    calls++;
+    unsigned total = 0;
+
+    for (unsigned i = 0; i < count && total < limit; i++) {
+      unsigned n = min(segments[i].length, limit - total);
+      sent.append(segments[i].data, n);
+      total += n;
+    }
+
+    return total;
+  }
+
+  bool canSendFile() const {return fileOK;}
+
+  streamsize sendFile(int fd, uint64_t offset, streamsize length,
+                      unsigned flags) {
+    calls++;
+    string buf(min((streamsize)limit, length), 0);
+    ssize_t n = pread(fd, &buf[0], buf.length(), offset);
+    if (n < 0) THROW("pread() failed");
+    sent.append(buf.data(), n);
+    return n;
+  }
+};
+
+
+string randomData(unsigned length, uint32_t seed) {
+  string data(length, 0);
+  uint32_t x = seed;
+
+  for (unsigned i = 0; i < length; i++) {
+    x = x * 1103515245 + 12345;
+    data[i] = 'a' + (x >> 16) % 26;
+  }
+
+  return data;
+}
+
+
+string body(const string &response) {
+  size_t i = response.find("\r\n\r\n");
+  if (i == string::npos) THROW("Missing end of header");
+  return response.substr(i + 4);
+}
+
+
+void add(HTTP::Connection &con, const string &data) {
+  MemoryBuffer *buf = new MemoryBuffer(data.length());
+  buf->write(data.data(), data.length());
+  con.addResponseBuffer(buf);
+}
+
+
+void partialWrites() {
+  Options options;
+  HTTP::Server server(options);
+
+  string file = randomData(100000, 1);
+  SystemUtilities::oopen("file.txt")->write(file.data(), file.length());
+
+  unsigned limits[] = {1, 3, 7, 4096, 1 << 20, 0};
+  for (unsigned i = 0; limits[i]; i++)
+    for (int fileOK = 0; fileOK < 2; fileOK++) {
+      SmartPointer<TrickleSocket> socket =
+        new TrickleSocket(limits[i], fileOK);
+      HTTP::Connection con(server, socket, IPAddress("127.0.0.1"));
+
+      // Many small buffers, an empty one and runs split by a file
+      string expected;
+      for (unsigned j = 0; j < 100; j++) {
+        string data = randomData(j * 13 % 97, j);
+        add(con, data);
+        expected += data;
+      }
+      add(con, "");
+      con.addResponseBuffer(new FileBuffer("file.txt"));
+      expected += file;
+      string tail = randomData(5000, 2);
+      add(con, tail);
+      expected += tail;
+
+      ostringstream capture;
+      con.writeResponse(capture);
+      if (body(capture.str()) != expected) THROW("Capture mismatch");
+
+      while (!con.writeHeader()) continue;
+      while (!con.write()) continue;
+
+      if (body(socket->sent) != expected)
+        THROW("Mismatch with limit " << limits[i] << " sendfile " << fileOK);
+
+      if (socket->sent.find(String::printf("Content-Length: %u\r\n",
+                                           (unsigned)expected.length())) ==
+          string::npos) THROW("Wrong Content-Length");
+
+      cout << "limit " << limits[i] << (fileOK ? " sendfile" : "") << " OK";
+      if (limits[i] == 1 << 20) cout << " in " << socket->calls << " calls";
+      cout << endl;
+    }
+
+  // A file which shrinks after it is queued must fail, not stall
+  SmartPointer<TrickleSocket> socket = new TrickleSocket(4096, true);
+  HTTP::Connection con(server, socket, IPAddress("127.0.0.1"));
+  con.addResponseBuffer(new FileBuffer("file.txt"));
+  SystemUtilities::truncate("file.txt", 50000);
+
+  try {
+    while (!con.writeHeader()) continue;
+    while (!con.write()) continue;
+    THROW("Short file not detected");
+
+  } catch (const Exception &e) {
+    cout << "Short file: " << e.getMessage() << endl;
+  }
+
+  // Files over 4GiB
+  SystemUtilities::truncate("file.txt", 5ULL << 30);
+  SmartPointer<FileBuffer> large = new FileBuffer("file.txt");
+  con.clearResponseBuffer();
+  con.addResponseBuffer(large);
+  cout << "Large file " << large->getLength() << " bytes, fill "
+       << large->getFill() << ", response " << con.getResponseSize() << endl;
+
+  SystemUtilities::unlink("file.txt");
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    partialWrites();
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
@@ -0,0 +1,274 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/Exception.h>
+#include <cbang/db/maria/EventDBPool.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Event.h>
+#include <cbang/String.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <set>
+
+using namespace cb;
+using namespace cb::MariaDB;
+using namespace std;
+
+
+/**
+ * Plays the part of a server, so the pool can be tested without one.
+ * Statements are separated by ";\n".  A SELECT returns one row holding
+ * its quoted literal, or 1 when there is none.  Statements which mention
+ * no_such fail and the first time a 'deadlock...' literal is reached the
+ * whole query is retried, as EventDB does after a deadlock.
+ */
+class ScriptedDB : public EventDB {
+  SmartPointer<Event::Event> event;
+  callback_t cb;
+  vector<string> statements;
+  set<string> deadlocked;
+  string value;
+
+public:
+  ScriptedDB(Event::Base &base) :
+    EventDB(base), event(base.newEvent(this, &ScriptedDB::run)) {}
+
+  const string &getValue() const {return value;}
+
+
+  void run() {
+    // Callbacks may start the next query
+    callback_t cb = this->cb;
+    vector<string> statements = this->statements;
+
+    for (unsigned i = 0; i < statements.size();) {
+      const string &sql = statements[i++];
+
+      if (sql.find("no_such") != string::npos) return cb(EVENTDB_ERROR);
+      if (!String::startsWith(sql, "SELECT")) continue;
+
+      size_t start = sql.find('\'');
+      value = start == string::npos ? "1" :
+        sql.substr(start + 1, sql.rfind('\'') - start - 1);
+
+      if (String::startsWith(value, "deadlock") && !deadlocked.count(value)) {
+        deadlocked.insert(value);
+        cb(EVENTDB_RETRY);
+        i = 0; // Start over
+        continue;
+      }
+
+      cb(EVENTDB_BEGIN_RESULT);
+      cb(EVENTDB_ROW);
+      cb(EVENTDB_END_RESULT);
+    }
+
+    cb(EVENTDB_DONE);
+  }
+
+
+  // From EventDB
+  void connect(callback_t cb, const string &host, const string &user,
+               const string &password, const string &dbName, unsigned port,
+               const string &socketName, flags_t flags) {
+    this->cb = cb;
+    statements.clear();
+    event->activate();
+  }
+
+
+  void query(callback_t cb, const string &s,
+             const SmartPointer<const JSON::Value> &dict) {
+    this->cb = cb;
+    statements.clear();
+
+    for (size_t start = 0; start < s.length();) {
+      size_t end = s.find(";\n", start);
+      if (end == string::npos) end = s.length();
+      statements.push_back(s.substr(start, end - start));
+      start = end + 2;
+    }
+
+    event->activate();
+  }
+};
+
+
+class ScriptedPool : public EventDBPool {
+public:
+  ScriptedPool(Event::Base &base) : EventDBPool(base, 1, 1) {}
+
+  // From EventDBPool
+  SmartPointer<EventDB> createDB() {return new ScriptedDB(base);}
+};
+
+
+class PoolTest {
+  Event::Base base;
+  ScriptedPool pool;
+  SmartPointer<Event::Event> failsafe;
+  unsigned pending;
+
+public:
+  PoolTest() :
+    base(true), pool(base), failsafe(base.newEvent(this, &PoolTest::timeout)),
+    pending(0) {}
+
+
+  string getValue() {
+    return dynamic_cast<ScriptedDB &>(pool.getDB()).getValue();
+  }
+
+
+  void timeout() {
+    cout << "Test timed out" << endl;
+    base.loopExit();
+  }
+
+
+  void done() {if (!--pending) base.loopExit();}
+
+
+  void add(const string &name, const string &sql, int priority = 0) {
+    pending++;
+
+    pool.query([this, name] (EventDB::state_t state) {
+        switch (state) {
+        case EventDB::EVENTDB_ROW:
+          cout << name << " row " << getValue() << endl;
+          break;
+
+        case EventDB::EVENTDB_ERROR:
+          cout << name << " error" << endl;
+          done();
+          break;
+
+        case EventDB::EVENTDB_DONE:
+          cout << name << " done" << endl;
+          done();
+          break;
+
+        default: break;
+        }
+      }, sql, 0, priority);
+  }
+
+
+  void batch() {
+    add("b", "SELECT 'b'", 5);
+    add("c", "SET @x = 1", 5); // Not merged
+    add("d", "SELECT 'd'", 5);
+    add("a", "SELECT 'a'");
+    add("e", "SELECT @x");
+    add("f", "SELECT * FROM no_such_db.no_such_table");
+    add("g", "SELECT 'g'"); // Requeued after f fails
+    run();
+  }
+
+
+  void fair() {
+    pool.setFairness(2);
+    pool.setMaxBatch(1);
+
+    add("a0", "SELECT 'a0'");
+    for (int i = 1; i <= 4; i++) {
+      string name = String::printf("h%d", i);
+      add(name, "SELECT '" + name + "'", 1);
+    }
+
+    run();
+  }
+
+
+  void retry() {
+    add("a", "SELECT 'a'");
+    add("b", "SELECT 'deadlock b'");
+    add("c", "SELECT 'c'");
+    add("d", "SELECT 'd'");
+    add("e", "SELECT 'deadlock e'");
+    run();
+  }
+
+
+  void run() {
+    pool.start();
+    failsafe->add(30);
+    base.dispatch();
+
+    cout << "batches=" << pool.getBatchCount() << endl;
+  }
+};
+
+
+void usage(const char *name) {
+  cout
+    << "Usage: " << name << " [OPTIONS]\n\n"
+    << "OPTIONS:\n"
+    << "\t--help                           Print this help screen and exit.\n"
+    << "\t--batch                          Merge queued queries into batches.\n"
+    << "\t--fair                           Share batches between priorities.\n"
+    << "\t--retry                          Retry batches that deadlock.\n"
+    << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "--help") {
+        usage(argv[0]);
+        return 0;
+
+      } else if (arg == "--batch") {
+        PoolTest().batch();
+
+      } else if (arg == "--fair") {
+        PoolTest().fair();
+
+      } else if (arg == "--retry") {
+        PoolTest().retry();
+
+      } else {
+        usage(argv[0]);
+        THROWS("Invalid arg '" << arg << "'");
+      }
+    }
+
+    return 0;
+
+  } CATCH_ERROR;
+
+  return 1;
+}
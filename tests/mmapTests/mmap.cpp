@@ -0,0 +1,205 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/io/MMapFile.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/String.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <string.h>
+
+using namespace std;
+using namespace cb;
+
+
+const char *path = "mmap.dat";
+
+
+void write(const string &data) {ofstream(path, ios::binary) << data;}
+
+
+string read() {
+  ostringstream str;
+  str << ifstream(path, ios::binary).rdbuf();
+  return str.str();
+}
+
+
+void print(const MMapFile &file) {
+  cout << "length=" << file.getLength()
+       << " empty=" << String(file.isEmpty())
+       << " writable=" << String(file.isWritable())
+       << " data=\"" << String::escapeC(string(file.begin(), file.end()))
+       << '"' << endl;
+}
+
+
+void testRead() {
+  write("one\ntwo\nthree\n");
+
+  SmartPointer<MMapFile> file = new MMapFile(path, MMapFile::MMAP_SEQUENTIAL);
+  print(*file);
+
+  // Read-only mappings don't hand out writable memory
+  try {
+    file->getData();
+    cout << "getData() allowed" << endl;
+  } catch (const Exception &e) {cout << e.getMessage() << endl;}
+
+  // The stream keeps the mapping alive
+  MMapStream stream(file);
+  file.release();
+
+  string line;
+  while (getline(stream, line)) cout << "line: " << line << endl;
+}
+
+
+void testWrite() {
+  SystemUtilities::unlink(path);
+
+  {
+    // Create and size a new file
+    MMapFile file(path, MMapFile::MMAP_READ_WRITE, 8);
+    print(file);
+
+    memcpy(file.getData(), "abcdefgh", 8);
+    file.sync();
+  }
+  cout << "file=\"" << read() << '"' << endl;
+
+  {
+    // Grow, new bytes are zero
+    MMapFile file(path, MMapFile::MMAP_READ_WRITE, 10);
+    print(file);
+    file.getData()[9] = '!';
+  }
+  cout << "file=\"" << String::escapeC(read()) << '"' << endl;
+
+  {
+    // Shrink
+    MMapFile file(path, MMapFile::MMAP_READ_WRITE, 3);
+    print(file);
+  }
+  cout << "file=\"" << read() << '"' << endl;
+
+  {
+    // A zero length keeps the file's size
+    MMapFile file(path, MMapFile::MMAP_READ_WRITE);
+    print(file);
+  }
+}
+
+
+void testEmpty() {
+  write("");
+
+  SmartPointer<MMapFile> file = new MMapFile(path);
+  print(*file);
+  cout << "begin == end: " << String(file->begin() == file->end()) << endl;
+
+  MMapStream stream(file);
+  int c = stream.get();
+  cout << "stream get=" << c << " eof=" << String(stream.eof())
+       << " bad=" << String(stream.bad()) << endl;
+
+  // A new writable file with no length is also empty
+  SystemUtilities::unlink(path);
+  MMapFile created(path, MMapFile::MMAP_READ_WRITE);
+  print(created);
+  created.sync();
+}
+
+
+void testErrors() {
+  const char *paths[] = {"missing.dat", ".", 0};
+
+  for (unsigned i = 0; paths[i]; i++)
+    try {
+      MMapFile file(paths[i]);
+      cout << paths[i] << ": mapped" << endl;
+    } catch (const Exception &e) {cout << e.getMessage() << endl;}
+}
+
+
+void usage(const char *name) {
+  cout
+    << "Usage: " << name << " [OPTIONS]\n\n"
+    << "OPTIONS:\n"
+    << "\t--help                           Print this help screen and exit.\n"
+    << "\t--read                           Read a mapped file.\n"
+    << "\t--write                          Write through a mapping.\n"
+    << "\t--empty                          Map an empty file.\n"
+    << "\t--errors                         Report mapping errors.\n"
+    << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "--help") {
+        usage(argv[0]);
+        return 0;
+
+      } else if (arg == "--read") {
+        testRead();
+
+      } else if (arg == "--write") {
+        testWrite();
+
+      } else if (arg == "--empty") {
+        testEmpty();
+
+      } else if (arg == "--errors") {
+        testErrors();
+
+      } else {
+        usage(argv[0]);
+        THROWS("Invalid arg '" << arg << "'");
+      }
+    }
+
+    SystemUtilities::unlink(path);
+    return 0;
+
+  } CATCH_ERROR;
+
+  SystemUtilities::unlink(path);
+  return 1;
+}
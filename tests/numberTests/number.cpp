@@ -0,0 +1,236 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/util/Numeric.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+#include <cbang/Math.h>
+
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <vector>
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+using namespace cb;
+
+
+int usage(const char *name) {
+  cerr << "Usage: " << name << " -f <count> | -g | -b <count>" << endl;
+  return 1;
+}
+
+
+uint64_t randomBits() {
+  static uint64_t x = 0x123456789abcdefULL;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+
+  return x;
+}
+
+
+double randomDouble() {
+  while (true) {
+    uint64_t bits = randomBits();
+    double x;
+    memcpy(&x, &bits, sizeof(x));
+
+    if (Math::isfinite(x)) return x;
+  }
+}
+
+
+string format(double x) {
+  char buf[Numeric::BUFFER_SIZE];
+  return string(buf, Numeric::format(buf, x));
+}
+
+
+template <typename T, typename Parsed>
+void checkInteger(T x) {
+  char buf[Numeric::BUFFER_SIZE];
+  const char *end = buf + Numeric::format(buf, x);
+
+  Parsed y;
+  if (Numeric::parse(buf, end, y) != end || x != y ||
+      string((const char *)buf, end) != SSTR(x))
+    THROW("Integer round trip failed for " << x);
+}
+
+
+void checkDouble(double x) {
+  char buf[Numeric::BUFFER_SIZE];
+  const char *end = buf + Numeric::format(buf, x);
+
+  // Bit exact, except that -0 is written as 0
+  double y;
+  if (Numeric::parse(buf, end, y) != end ||
+      (memcmp(&x, &y, sizeof(x)) && x))
+    THROW("Round trip failed for " << String::printf("%.17g", x) << " -> "
+          << string((const char *)buf, end));
+
+  // No shorter decimal round trips
+  char digits[17];
+  int exp;
+  unsigned len = Numeric::shortest(digits, fabs(x), exp);
+  string shorter = String::printf("%.*e", (int)len - 2, x);
+  if (1 < len && strtod(shorter.c_str(), 0) == x)
+    THROW("Not shortest " << string((const char *)buf, end) << " -> "
+          << shorter);
+
+  // The parser must agree with strtod() on arbitrary decimal input and
+  // reject overflow
+  string s = String::printf("%.*g", (int)(randomBits() % 20) + 1, x);
+  const char *sEnd = s.data() + s.length();
+  double expected = strtod(s.c_str(), 0);
+
+  if (Math::isinf(expected) ? Numeric::parse(s.data(), sEnd, y) != 0 :
+      Numeric::parse(s.data(), sEnd, y) != sEnd || y != expected)
+    THROW("Parse of '" << s << "' disagrees with strtod()");
+}
+
+
+void fuzz(unsigned count) {
+  const double extremes[] = {
+    DBL_MAX, -DBL_MAX, DBL_MIN, DBL_MIN - 5e-324, 5e-324, 1e-323, 1e22, 1e23,
+    9007199254740991.0, 9007199254740992.0, 0.1, 1.5e300,
+  };
+
+  for (unsigned i = 0; i < sizeof(extremes) / sizeof(double); i++)
+    checkDouble(extremes[i]);
+
+  for (unsigned i = 0; i < count; i++) {
+    checkDouble(randomDouble());
+
+    // Short decimals exercise the fast path
+    int64_t m = (int64_t)(randomBits() % 2000001) - 1000000;
+    checkDouble(m * pow(10, (int)(randomBits() % 61) - 30));
+
+    uint64_t bits = randomBits();
+    checkInteger<uint64_t, uint64_t>(bits);
+    checkInteger<int64_t, int64_t>(bits);
+    checkInteger<uint32_t, uint64_t>(bits);
+    checkInteger<int32_t, int64_t>(bits);
+  }
+
+  cout << count << " OK" << endl;
+}
+
+
+void golden() {
+  string line;
+
+  while (getline(cin, line)) {
+    double x;
+    const char *end = line.data() + line.length();
+
+    if (Numeric::parse(line.data(), end, x) != end)
+      cout << line << " invalid" << endl;
+    else cout << line << " -> " << format(x) << " " << String(x) << endl;
+  }
+}
+
+
+void benchmark(unsigned count) {
+  vector<double> values;
+  vector<string> strings;
+
+  for (unsigned i = 0; i < count; i++) {
+    double x = randomDouble();
+    values.push_back(x);
+
+    // Typical JSON numbers, e.g. 1234.56
+    int64_t m = (int64_t)(randomBits() % 20000001) - 10000000;
+    strings.push_back(String::printf("%.*f", (int)(randomBits() % 7),
+                                     m / 100.0));
+  }
+
+  char buf[Numeric::BUFFER_SIZE];
+  unsigned total = 0;
+
+  double start = Timer::now();
+  for (unsigned i = 0; i < count; i++)
+    total += Numeric::format(buf, values[i]);
+  double formatTime = Timer::now() - start;
+
+  start = Timer::now();
+  for (unsigned i = 0; i < count; i++)
+    total += snprintf(buf, sizeof(buf), "%.17g", values[i]);
+  double printfTime = Timer::now() - start;
+
+  double sum = 0;
+  start = Timer::now();
+  for (unsigned i = 0; i < count; i++) {
+    double x;
+    const string &s = strings[i];
+    Numeric::parse(s.data(), s.data() + s.length(), x);
+    sum += x;
+  }
+  double parseTime = Timer::now() - start;
+
+  start = Timer::now();
+  for (unsigned i = 0; i < count; i++) sum += strtod(strings[i].c_str(), 0);
+  double strtodTime = Timer::now() - start;
+
+  if (!total || Math::isnan(sum)) cerr << "?";
+
+  cout << "format " << String::printf("%.1f", count / formatTime / 1e6)
+       << " M/s" << endl;
+  cout << "printf " << String::printf("%.1f", count / printfTime / 1e6)
+       << " M/s" << endl;
+  cout << "parse " << String::printf("%.1f", count / parseTime / 1e6)
+       << " M/s" << endl;
+  cout << "strtod " << String::printf("%.1f", count / strtodTime / 1e6)
+       << " M/s" << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 2 && string("-g") == argv[1]) golden();
+    else if (argc != 3) return usage(argv[0]);
+    else if (string("-f") == argv[1]) fuzz(String::parseU32(argv[2]));
+    else if (string("-b") == argv[1]) benchmark(String::parseU32(argv[2]));
+    else return usage(argv[0]);
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
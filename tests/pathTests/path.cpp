@@ -33,15 +33,103 @@
 #include <cbang/Exception.h>
 #include <cbang/String.h>
 #include <cbang/os/SystemUtilities.h>
+#include <cbang/os/DirectoryWalker.h>
+#include <cbang/os/Mutex.h>
+#include <cbang/util/SmartLock.h>
 #include <cbang/Catch.h>
 
 #include <iostream>
 #include <iomanip>
+#include <set>
 
 using namespace cb;
 using namespace std;
 
 
+struct CopyCallback : public TransferCallback {
+  uint64_t total;
+  bool stop;
+  CopyCallback(bool stop = false) : total(0), stop(stop) {}
+  bool transferCallback(streamsize bytes) {total += bytes; return !stop;}
+};
+
+
+void copy(unsigned size) {
+  // A file with a hole in the middle
+  string data = String::printf("%u bytes", size);
+  {
+    SmartPointer<iostream> f = SystemUtilities::open("copy-src", ios::out);
+    *f << data;
+    f->seekp(size - data.length());
+    *f << data;
+  }
+
+  SmartPointer<CopyCallback> cb = new CopyCallback;
+  uint64_t bytes = SystemUtilities::cp("copy-src", "copy-dst", ~0, cb);
+
+  string src = SystemUtilities::read("copy-src");
+  string dst = SystemUtilities::read("copy-dst");
+
+  cout << "copied " << bytes << " bytes "
+       << (src == dst ? "matched" : "differed") << endl;
+  // Holes may be skipped so the callback can see fewer bytes
+  cout << "callback "
+       << (cb->total && cb->total <= bytes ? "called" : "not called") << endl;
+
+  // Partial copy
+  bytes = SystemUtilities::cp("copy-src", "copy-dst", 5);
+  cout << "copied " << bytes << " bytes '"
+       << SystemUtilities::read("copy-dst") << "'" << endl;
+
+  // Stopped by the callback, into a new directory
+  cb = new CopyCallback(true);
+  bytes = SystemUtilities::cp("copy-src", "copy-dir/copy-dst", ~0, cb);
+  bool stopped = bytes < size && cb->total == bytes &&
+    SystemUtilities::read("copy-dir/copy-dst") == src.substr(0, bytes);
+  cout << "callback " << (stopped ? "stopped" : "did not stop") << " copy"
+       << endl;
+
+  SystemUtilities::unlink("copy-src");
+  SystemUtilities::unlink("copy-dst");
+  SystemUtilities::rmdir("copy-dir", true);
+}
+
+
+void copyPseudo(const string &path) {
+  uint64_t bytes = SystemUtilities::cp(path, "copy-dst");
+  string data = SystemUtilities::read("copy-dst");
+
+  cout << "copy " << (bytes && bytes == data.length() &&
+                      data == SystemUtilities::read(path) ?
+                      "matched" : "differed") << endl;
+
+  SystemUtilities::unlink("copy-dst");
+}
+
+
+void walk(const string &root) {
+  DirectoryWalker walker(root);
+  set<string> files;
+  while (walker.hasNext()) files.insert(walker.next());
+
+  for (set<string>::iterator it = files.begin(); it != files.end(); it++)
+    cout << *it << endl;
+
+  for (unsigned threads = 1; threads <= 4; threads *= 4) {
+    Mutex lock;
+    set<string> found;
+
+    walker.walk([&] (const string &path) {
+        SmartLock l(&lock);
+        found.insert(path);
+      }, threads);
+
+    cout << "walk(" << threads << ") "
+         << (found == files ? "matched" : "differed") << endl;
+  }
+}
+
+
 void usage(const char *name) {
   cout
     << "Usage: " << name << " [OPTIONS]\n\n"
@@ -72,6 +160,15 @@ int main(int argc, char *argv[]) {
       } else if (arg == "--is_absolute" && i < argc - 1) {
         cout << String(SystemUtilities::isAbsolute(argv[++i])) << endl;
 
+      } else if (arg == "--copy" && i < argc - 1) {
+        copy(String::parseU32(argv[++i]));
+
+      } else if (arg == "--copy-pseudo" && i < argc - 1) {
+        copyPseudo(argv[++i]);
+
+      } else if (arg == "--walk" && i < argc - 1) {
+        walk(argv[++i]);
+
       } else if (arg == "--canonical" && i < argc - 1) {
         cout << String(SystemUtilities::getCanonicalPath(argv[++i])) << endl;
 
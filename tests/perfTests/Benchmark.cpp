@@ -0,0 +1,163 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Benchmark.h"
+
+#include <cbang/Exception.h>
+#include <cbang/json/JSON.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+using namespace cb;
+using namespace std;
+
+
+namespace {
+  volatile uint64_t kept = 0;
+
+
+  string format(double ns) {
+    return String::printf(ns < 10 ? "%.2f" : "%.0f", ns);
+  }
+}
+
+
+void Benchmark::add(const string &name, func_t func) {
+  benchmarks.push_back(make_pair(name, func));
+}
+
+
+void Benchmark::run(ostream &stream) {
+  results.clear();
+
+  for (unsigned i = 0; i < benchmarks.size(); i++) {
+    const string &name = benchmarks[i].first;
+    const func_t &func = benchmarks[i].second;
+
+    if (!filter.empty() && name.find(filter) == string::npos) continue;
+
+    // Calibrate
+    uint64_t count = 1;
+    while (time(func, count) < minTime && count < (1ULL << 40)) count *= 2;
+
+    for (unsigned j = 0; j < warmup; j++) time(func, count);
+
+    vector<double> samples;
+    for (unsigned j = 0; j < reps; j++)
+      samples.push_back(time(func, count) * 1e9 / count);
+    sort(samples.begin(), samples.end());
+
+    unsigned n = samples.size();
+    Result result;
+    result.name = name;
+    result.iterations = count;
+    result.median = n & 1 ? samples[n / 2] :
+      (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    result.p99 = samples[(unsigned)ceil(0.99 * n) - 1];
+    result.min = samples[0];
+    results.push_back(result);
+
+    stream << String::printf("%-24s", name.c_str())
+           << " median " << format(result.median) << " ns"
+           << " p99 " << format(result.p99) << " ns" << endl;
+  }
+}
+
+
+void Benchmark::write(JSON::Sink &sink) const {
+  sink.beginDict();
+  sink.insert("warmup", warmup);
+  sink.insert("reps", reps);
+  sink.insert("min_time", minTime);
+
+  sink.insertDict("benchmarks");
+  for (unsigned i = 0; i < results.size(); i++) {
+    const Result &r = results[i];
+
+    sink.insertDict(r.name);
+    sink.insert("iterations", r.iterations);
+    sink.insert("median", r.median);
+    sink.insert("p99", r.p99);
+    sink.insert("min", r.min);
+    sink.endDict();
+  }
+  sink.endDict();
+
+  sink.endDict();
+}
+
+
+unsigned Benchmark::compare(const JSON::Value &baseline, double tolerance,
+                            ostream &stream) const {
+  const JSON::Value &base = *baseline.get("benchmarks");
+  unsigned regressions = 0;
+
+  for (unsigned i = 0; i < results.size(); i++) {
+    const Result &r = results[i];
+    stream << String::printf("%-24s", r.name.c_str());
+
+    if (!base.has(r.name)) {
+      stream << " new" << endl;
+      continue;
+    }
+
+    double median = base.get(r.name)->getNumber("median");
+    double change = median ? r.median / median - 1 : 0;
+
+    if (tolerance < change) {
+      stream << " REGRESSION";
+      regressions++;
+
+    } else if (change < -tolerance) stream << " improved";
+    else stream << " ok";
+
+    stream << " median " << format(r.median) << " ns baseline "
+           << format(median) << " ns " << String::printf("%+.0f", change * 100)
+           << '%' << endl;
+  }
+
+  return regressions;
+}
+
+
+void Benchmark::keep(uint64_t x) {kept = kept + x;}
+
+
+double Benchmark::time(const func_t &func, uint64_t count) const {
+  double start = Timer::now();
+  func(count);
+  return Timer::now() - start;
+}
@@ -0,0 +1,103 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#pragma once
+
+#include <cbang/StdTypes.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace cb {
+  namespace JSON {
+    class Sink;
+    class Value;
+  }
+}
+
+
+/**
+ * Times each benchmark function over a number of repetitions.  The
+ * iterations per repetition are first doubled until one repetition takes
+ * at least the minimum time, then warm-up repetitions are run and
+ * discarded.  The median, 99th percentile and fastest time per iteration
+ * of the remaining repetitions are reported in nanoseconds.
+ */
+class Benchmark {
+public:
+  /// Runs @param count iterations of the code under test
+  typedef std::function<void (uint64_t count)> func_t;
+
+  struct Result {
+    std::string name;
+    uint64_t iterations;
+    double median;
+    double p99;
+    double min;
+  };
+
+protected:
+  std::vector<std::pair<std::string, func_t> > benchmarks;
+  std::vector<Result> results;
+
+  unsigned warmup;
+  unsigned reps;
+  double minTime;
+  std::string filter;
+
+public:
+  Benchmark() : warmup(2), reps(50), minTime(0.002) {}
+
+  void setWarmup(unsigned x) {warmup = x;}
+  void setReps(unsigned x) {reps = x ? x : 1;}
+  void setMinTime(double x) {minTime = x;}
+  /// Only run benchmarks whose name contains @param x
+  void setFilter(const std::string &x) {filter = x;}
+
+  const std::vector<Result> &getResults() const {return results;}
+
+  void add(const std::string &name, func_t func);
+  void run(std::ostream &stream);
+  void write(cb::JSON::Sink &sink) const;
+
+  /// @return the number of benchmarks slower than @param baseline by more
+  /// than @param tolerance.
+  unsigned compare(const cb::JSON::Value &baseline, double tolerance,
+                   std::ostream &stream) const;
+
+  /// Keeps the optimizer from discarding otherwise unused results
+  static void keep(uint64_t x);
+
+protected:
+  double time(const func_t &func, uint64_t count) const;
+};
@@ -0,0 +1,410 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include "Benchmark.h"
+
+#include <cbang/Exception.h>
+#include <cbang/String.h>
+#include <cbang/json/JSON.h>
+#include <cbang/log/Logger.h>
+#include <cbang/net/Base64.h>
+#include <cbang/net/URI.h>
+#include <cbang/net/IPAddress.h>
+#include <cbang/http/Header.h>
+#include <cbang/util/OrderedDict.h>
+#include <cbang/config/Options.h>
+#include <cbang/config/OptionRef.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/iostream/NullDevice.h>
+#include <cbang/iostream/ParallelCompressor.h>
+#include <cbang/buffer/MemoryBuffer.h>
+
+#include <cbang/event/Base.h>
+#include <cbang/event/DNSBase.h>
+#include <cbang/event/Client.h>
+#include <cbang/event/HTTP.h>
+#include <cbang/event/HTTPHandler.h>
+#include <cbang/event/Request.h>
+#include <cbang/event/PendingRequest.h>
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <iostream>
+#include <vector>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+using namespace cb;
+using namespace std;
+
+
+string jsonDocument() {
+  JSON::Builder builder;
+
+  builder.beginList();
+  for (int i = 0; i < 20; i++) {
+    builder.appendDict();
+    builder.insert("id", i);
+    builder.insert("name", String::printf("item %d", i));
+    builder.insert("score", i * 1.25);
+    builder.insertBoolean("active", i & 1);
+    builder.insertList("tags");
+    for (int j = 0; j < 3; j++) builder.append(String::printf("tag%d", j));
+    builder.endList();
+    builder.endDict();
+  }
+  builder.endList();
+
+  return builder.getRoot()->toString(0, true);
+}
+
+
+void addJSON(Benchmark &bench) {
+  string doc = jsonDocument();
+  JSON::ValuePtr value = JSON::Reader::parseString(doc);
+
+  bench.add("json-parse", [doc] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(JSON::Reader::parseString(doc)->size());
+    });
+
+  bench.add("json-write", [value] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(value->toString(0, true).length());
+    });
+
+  bench.add("json-dict-get", [value] (uint64_t count) {
+      const JSON::Value &dict = *value->get(10);
+
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(dict.getU32("id") + dict.get("tags")->size());
+    });
+}
+
+
+void addOrderedDict(Benchmark &bench) {
+  SmartPointer<OrderedDict<int> > dict = new OrderedDict<int>;
+  vector<string> keys;
+
+  for (int i = 0; i < 100; i++) {
+    keys.push_back(String::printf("key%d", i));
+    dict->insert(keys.back(), i);
+  }
+
+  bench.add("ordered-dict-lookup", [dict, keys] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(dict->get(keys[i % keys.size()]));
+    });
+}
+
+
+void addOptions(Benchmark &bench) {
+  SmartPointer<Options> options = new Options;
+  options->add("max-connections", "")->setDefault(1000);
+  options->add("timeout", "")->setDefault(30.5);
+  options->set("max-connections", "4096");
+
+  bench.add("option-get", [options] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep((*options)["max-connections"].toInteger() +
+                        (*options)["timeout"].toDouble());
+    });
+
+  OptionRef<int64_t> maxConns(*options, "max-connections");
+  OptionRef<double> timeout(*options, "timeout");
+
+  bench.add("option-ref", [options, maxConns, timeout] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(maxConns + timeout);
+    });
+}
+
+
+void addLogger(Benchmark &bench) {
+  Logger &log = Logger::instance();
+  log.setScreenStream(new NullStream<char>);
+  log.setVerbosity(1);
+
+  bench.add("log-filtered", [] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++) LOG_INFO(5, "value " << i);
+    });
+
+  bench.add("log-info", [] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++) LOG_INFO(1, "value " << i);
+    });
+}
+
+
+void addBase64(Benchmark &bench) {
+  string data;
+  for (int i = 0; i < 1024; i++) data += (char)(i * 7);
+  string encoded = Base64().encode(data);
+
+  bench.add("base64-encode", [data] (uint64_t count) {
+      Base64 base64;
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(base64.encode(data).length());
+    });
+
+  bench.add("base64-decode", [encoded] (uint64_t count) {
+      Base64 base64;
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(base64.decode(encoded).length());
+    });
+}
+
+
+void addURI(Benchmark &bench) {
+  bench.add("uri-parse", [] (uint64_t count) {
+      const char *s =
+        "https://user@www.example.com:8443/api/v1/items?id=42&sort=name#top";
+
+      for (uint64_t i = 0; i < count; i++)
+        Benchmark::keep(URI(s).getPort());
+    });
+}
+
+
+void addHeader(Benchmark &bench) {
+  string data =
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:119.0) Gecko/20100101\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=0123456789abcdef; theme=dark\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "\r\n";
+
+  bench.add("http-header-parse", [data] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++) {
+        HTTP::Header header;
+        Benchmark::keep(header.parse(data.data(), data.length()));
+      }
+    });
+}
+
+
+void addMemoryBuffer(Benchmark &bench) {
+  // The buffers of one legacy HTTP::Connection handling a request
+  bench.add("memory-buffer-churn", [] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++) {
+        MemoryBuffer readBuf(4096);
+        MemoryBuffer utilBuf(4096);
+        MemoryBuffer dataBuf;
+        dataBuf.increase(1024 << (i % 8));
+        MemoryBuffer response(16 * 1024);
+        Benchmark::keep(readBuf.getSpace() + dataBuf.getSpace() +
+                        response.getSpace() + utilBuf.getSpace());
+      }
+    });
+}
+
+
+void addParallelCompressor(Benchmark &bench) {
+  string data;
+  for (int i = 0; i < 16 * 1024; i++) data += (char)('a' + i % 7 * i % 26);
+
+  // Many short streams, as when compressing HTTP responses
+  bench.add("parallel-gzip-small", [data] (uint64_t count) {
+      for (uint64_t i = 0; i < count; i++) {
+        boost::iostreams::filtering_ostream out;
+        out.push(ParallelCompressor(ParallelCompressor::PARALLEL_GZIP, 2,
+                                    4096));
+        out.push(NullDevice<char>());
+        out.write(data.data(), data.length());
+        out.reset();
+      }
+    });
+}
+
+
+class HTTPRoundTrip : public Event::HTTPHandler {
+  Event::Base base;
+  Event::DNSBase dns;
+  Event::Client client;
+  Event::HTTP http;
+  URI uri;
+  uint64_t remaining;
+
+public:
+  HTTPRoundTrip() :
+    dns(base), client(base, dns),
+    http(base, SmartPointer<Event::HTTPHandler>::Phony(this)), remaining(0) {
+    // Bind to any free port
+    int fd = http.bind(IPAddress("127.0.0.1", 0));
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(fd, (sockaddr *)&addr, &len))
+      THROW("getsockname() failed");
+
+    uri = URI(String::printf("http://127.0.0.1:%d/", ntohs(addr.sin_port)));
+  }
+
+
+  void run(uint64_t count) {
+    remaining = count;
+    request();
+    base.dispatch();
+  }
+
+
+  void request() {
+    client.call(uri, Event::RequestMethod::HTTP_GET, this,
+                &HTTPRoundTrip::response)->send();
+  }
+
+
+  void response(Event::Request *req, int err) {
+    if (!req || err) THROW("HTTP request failed");
+    if (--remaining) request();
+    else base.loopExit();
+  }
+
+
+  // From Event::HTTPHandler
+  Event::Request *createRequest(evhttp_request *req)
+  {return new Event::Request(req);}
+
+  bool handleRequest(Event::Request &req) {
+    req.reply("OK", 2);
+    return true;
+  }
+
+  void endRequest(Event::Request *req) {}
+};
+
+
+void throwDeep(unsigned depth) {
+  if (!depth) THROW("Benchmark exception");
+  throwDeep(depth - 1);
+  Benchmark::keep(depth); // Not a tail call
+}
+
+
+void addException(Benchmark &bench) {
+  // Traces are captured when thrown but only symbolized when printed
+  bench.add("exception-throw", [] (uint64_t count) {
+      bool traces = Exception::enableStackTraces;
+      Exception::enableStackTraces = true;
+
+      for (uint64_t i = 0; i < count; i++)
+        try {throwDeep(10);} catch (const Exception &e) {
+          Benchmark::keep(e.getMessage().length());
+        }
+
+      Exception::enableStackTraces = traces;
+    });
+
+  bench.add("exception-print", [] (uint64_t count) {
+      bool traces = Exception::enableStackTraces;
+      Exception::enableStackTraces = true;
+      NullStream<char> null;
+
+      for (uint64_t i = 0; i < count; i++)
+        try {throwDeep(10);} catch (const Exception &e) {e.print(null);}
+
+      Exception::enableStackTraces = traces;
+    });
+}
+
+
+void addEventHTTP(Benchmark &bench) {
+  SmartPointer<HTTPRoundTrip> rt = new HTTPRoundTrip;
+  bench.add("event-http-get", [rt] (uint64_t count) {rt->run(count);});
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    Benchmark bench;
+    string jsonPath;
+    string comparePath;
+    double tolerance = 0.1;
+
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (i + 1 == argc) THROW("Missing value for " << arg);
+      else if (arg == "--warmup") bench.setWarmup(String::parseU32(argv[++i]));
+      else if (arg == "--reps") bench.setReps(String::parseU32(argv[++i]));
+      else if (arg == "--min-time")
+        bench.setMinTime(String::parseDouble(argv[++i]));
+      else if (arg == "--filter") bench.setFilter(argv[++i]);
+      else if (arg == "--json") jsonPath = argv[++i];
+      else if (arg == "--compare") comparePath = argv[++i];
+      else if (arg == "--tolerance")
+        tolerance = String::parseDouble(argv[++i]);
+      else THROW("Invalid argument " << arg);
+    }
+
+    addJSON(bench);
+    addOrderedDict(bench);
+    addOptions(bench);
+    addLogger(bench);
+    addBase64(bench);
+    addURI(bench);
+    addHeader(bench);
+    addMemoryBuffer(bench);
+    addParallelCompressor(bench);
+    addException(bench);
+    addEventHTTP(bench);
+
+    bench.run(cout);
+
+    if (!jsonPath.empty()) {
+      SmartPointer<ostream> stream = SystemUtilities::oopen(jsonPath);
+      JSON::Writer writer(*stream);
+      bench.write(writer);
+      *stream << endl;
+    }
+
+    if (!comparePath.empty()) {
+      JSON::ValuePtr baseline = comparePath == "-" ?
+        JSON::Reader::parse(InputSource(cin)) :
+        JSON::Reader::parse(comparePath);
+      if (bench.compare(*baseline, tolerance, cout)) return 1;
+    }
+
+    return 0;
+
+  } catch (const Exception &e) {
+    cerr << "Exception: " << e << endl;
+    cerr << "Usage: " << argv[0] << " [--warmup <n>] [--reps <n>] "
+      "[--min-time <seconds>] [--filter <name>] [--json <file>] "
+      "[--compare <baseline.json | ->] [--tolerance <fraction>]" << endl;
+  }
+
+  return 1;
+}
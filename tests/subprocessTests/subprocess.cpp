@@ -0,0 +1,204 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/os/Subprocess.h>
+#include <cbang/event/Base.h>
+#include <cbang/event/Subprocess.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <set>
+
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace cb;
+
+
+const char *modeName(ProcessPriority priority) {
+  return priority == ProcessPriority::PRIORITY_INHERIT ? "spawn" : "fork";
+}
+
+
+// Any priority other than INHERIT takes the fork() path
+const ProcessPriority modes[] = {
+  ProcessPriority::PRIORITY_INHERIT, ProcessPriority::PRIORITY_NORMAL,
+};
+
+
+void testStdOut() {
+  for (auto priority: modes) {
+    Subprocess proc;
+    proc.exec("sh -c \"echo hello; echo world; echo ignored >&2\"",
+              Subprocess::SHELL | Subprocess::REDIR_STDOUT |
+              Subprocess::NULL_STDERR, priority);
+
+    string line;
+    while (getline(proc.getStdOut(), line))
+      cout << modeName(priority) << ": " << line << endl;
+
+    cout << modeName(priority) << ": returned " << proc.wait() << endl;
+  }
+}
+
+
+void testMissing() {
+  for (auto priority: modes)
+    try {
+      Subprocess proc;
+      proc.exec("/nonexistent/program", Subprocess::REDIR_STDOUT, priority);
+      cout << modeName(priority) << ": started, returned " << proc.wait()
+           << endl;
+
+    } catch (const Exception &e) {
+      cout << modeName(priority) << ": " << e.getMessage() << endl;
+    }
+}
+
+
+multiset<ino_t> pipeInodes(uint64_t pid) {
+  string dir = pid ? SSTR("/proc/" << pid << "/fd") : "/proc/self/fd";
+  multiset<ino_t> inodes;
+
+  DIR *d = opendir(dir.c_str());
+  if (!d) THROW("Failed to open " << dir);
+
+  for (struct dirent *e = readdir(d); e; e = readdir(d)) {
+    struct stat s;
+    if (e->d_name[0] != '.' && !stat((dir + "/" + e->d_name).c_str(), &s) &&
+        S_ISFIFO(s.st_mode)) inodes.insert(s.st_ino);
+  }
+
+  closedir(d);
+
+  return inodes;
+}
+
+
+void testFDs() {
+  // Pipes inherited from the test harness are not leaks
+  multiset<ino_t> inherited = pipeInodes(0);
+
+  for (auto priority: modes) {
+    Subprocess proc;
+    proc.exec("sleep 5", Subprocess::SHELL | Subprocess::REDIR_STDIN |
+              Subprocess::REDIR_STDOUT | Subprocess::REDIR_STDERR, priority);
+
+    // Only stdin, stdout and stderr should refer to the new pipes
+    unsigned count = 0;
+    for (auto inode: pipeInodes(proc.getPID()))
+      if (!inherited.count(inode)) count++;
+
+    cout << modeName(priority) << ": " << count << " pipes" << endl;
+
+    proc.kill();
+    proc.wait();
+  }
+}
+
+
+void testEventExit() {
+  Event::Base base;
+  unsigned running = 0;
+
+  // Several children at once share the exit handling of the Base
+  for (int code = 0; code < 3; code++) {
+    auto proc = new Event::Subprocess(base);
+    running++;
+
+    proc->setExitCallback([proc, code, &running, &base] () {
+      string out = proc->getStdOutBuffer().toString();
+      cout << "child " << code << " returned " << proc->wait()
+           << " output: " << out;
+
+      delete proc;
+      if (!--running) base.loopExit();
+    });
+
+    proc->setStdOutCallback([] (Event::Buffer &) {}); // Keep the output
+    proc->exec(SSTR("sh -c \"sleep 0." << (3 - code) << "; echo " << code
+                    << "; exit " << code << '"'),
+               Subprocess::SHELL | Subprocess::REDIR_STDOUT);
+  }
+
+  base.dispatch();
+}
+
+
+void usage(const char *name) {
+  cout
+    << "Usage: " << name << " [OPTIONS]\n\n"
+    << "OPTIONS:\n"
+    << "\t--help                           Print this help screen and exit.\n"
+    << "\t--stdout                         Capture standard output.\n"
+    << "\t--missing                        Run a missing program.\n"
+    << "\t--fds                            Check for leaked pipes.\n"
+    << "\t--event-exit                     Report exits to an event loop.\n"
+    << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "--help") {
+        usage(argv[0]);
+        return 0;
+
+      } else if (arg == "--stdout") {
+        testStdOut();
+
+      } else if (arg == "--missing") {
+        testMissing();
+
+      } else if (arg == "--fds") {
+        testFDs();
+
+      } else if (arg == "--event-exit") {
+        testEventExit();
+
+      } else {
+        usage(argv[0]);
+        THROWS("Invalid arg '" << arg << "'");
+      }
+    }
+
+    return 0;
+
+  } CATCH_ERROR;
+
+  return 1;
+}
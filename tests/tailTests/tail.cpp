@@ -0,0 +1,211 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/log/TailFileToLog.h>
+#include <cbang/log/TailFileWatcher.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/time/Timer.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+using namespace cb;
+
+
+class Tail : public TailFileToLog {
+public:
+  unsigned lines;
+
+  Tail(const string &filename) : TailFileToLog(filename), lines(0) {}
+
+  // From TailFileToLog
+  void log(const char *line) {
+    cout << "> " << line << endl;
+    lines++;
+  }
+};
+
+
+class TailTest {
+  TailFileWatcher watcher;
+  SmartPointer<Tail> tail;
+
+public:
+  TailTest(const string &path) : watcher(0.05), tail(new Tail(path)) {
+    cleanup();
+    watcher.add(tail);
+  }
+
+  ~TailTest() {cleanup();}
+
+
+  void cleanup() {
+    const string &path = tail->getFilename();
+    SystemUtilities::unlink(path);
+    SystemUtilities::unlink(path + ".1");
+
+    string dir = SystemUtilities::dirname(path);
+    if (!dir.empty() && dir != "." && SystemUtilities::exists(dir))
+      SystemUtilities::rmdir(dir);
+  }
+
+
+  void write(const string &data, const string &suffix = string()) {
+    ofstream(tail->getFilename() + suffix, ios::app) << data;
+  }
+
+
+  void waitFor(unsigned lines) {
+    double start = Timer::now();
+
+    while (tail->lines < lines) {
+      if (5 < Timer::now() - start) THROW("Timed out waiting for " << lines);
+      watcher.waitForChanges(0.01);
+    }
+  }
+
+
+  void settle() {for (int i = 0; i < 5; i++) watcher.waitForChanges(0.01);}
+
+
+  void append() {
+    write("one\ntwo\r\n");
+    waitFor(2);
+
+    // A line written in pieces is logged once it is complete
+    write("thr");
+    settle();
+    write("ee\n");
+    waitFor(3);
+  }
+
+
+  void truncate() {
+    write("first\nsecond\n");
+    waitFor(2);
+
+    SystemUtilities::truncate(tail->getFilename(), 0);
+    write("third\n");
+    waitFor(3);
+  }
+
+
+  void rotate() {
+    write("before\npartial");
+    waitFor(1);
+
+    // Writes to the renamed file are followed until a new one appears
+    SystemUtilities::rename(tail->getFilename(), tail->getFilename() + ".1");
+    write(" line\n", ".1");
+    waitFor(2);
+
+    // A partial line is logged as is when the new file appears
+    write("unfinished", ".1");
+    settle();
+    write("after\n");
+    waitFor(4);
+  }
+
+
+  void create() {
+    settle();
+    write("created\n");
+    waitFor(1);
+  }
+
+
+  void poll() {
+    // The directory does not exist yet so it cannot be watched
+    settle();
+    SystemUtilities::mkdir(SystemUtilities::dirname(tail->getFilename()));
+    write("polled\n");
+    waitFor(1);
+
+    // Once it exists the file is watched
+    write("watched\n");
+    waitFor(2);
+  }
+};
+
+
+void usage(const char *name) {
+  cout
+    << "Usage: " << name << " [OPTIONS]\n\n"
+    << "OPTIONS:\n"
+    << "\t--help                           Print this help screen and exit.\n"
+    << "\t--append                         Log lines appended to a file.\n"
+    << "\t--truncate                       Follow a truncated file.\n"
+    << "\t--rotate                         Follow a rotated file.\n"
+    << "\t--create                         Wait for a file to be created.\n"
+    << "\t--poll                           Poll for a missing directory.\n"
+    << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "--help") {
+        usage(argv[0]);
+        return 0;
+
+      } else if (arg == "--append") {
+        TailTest("tail.log").append();
+
+      } else if (arg == "--truncate") {
+        TailTest("tail.log").truncate();
+
+      } else if (arg == "--rotate") {
+        TailTest("tail.log").rotate();
+
+      } else if (arg == "--create") {
+        TailTest("tail.log").create();
+
+      } else if (arg == "--poll") {
+        TailTest("missing/tail.log").poll();
+
+      } else {
+        usage(argv[0]);
+        THROWS("Invalid arg '" << arg << "'");
+      }
+    }
+
+    return 0;
+
+  } CATCH_ERROR;
+
+  return 1;
+}
@@ -0,0 +1,185 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/tar/TarFileIndex.h>
+#include <cbang/tar/TarFileReader.h>
+#include <cbang/tar/TarFileWriter.h>
+#include <cbang/io/MMapFile.h>
+#include <cbang/event/Buffer.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
+
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace cb;
+
+
+int usage(const char *name) {
+  cerr << "Usage: " << name << " [-b <MiB>]" << endl;
+  return 1;
+}
+
+
+// Compressible pseudo random text
+string randomData(unsigned length, uint32_t seed) {
+  string data(length, 0);
+  uint32_t x = seed;
+
+  for (unsigned i = 0; i < length; i++) {
+    x = x * 1103515245 + 12345;
+    data[i] = 'a' + (x >> 16) % 16;
+  }
+
+  return data;
+}
+
+
+vector<string> writeArchive(const string &path, unsigned count,
+                            unsigned maxSize) {
+  vector<string> files;
+  TarFileWriter writer(path, ios::trunc);
+
+  for (unsigned i = 0; i < count; i++) {
+    files.push_back(randomData((i * 7919) % maxSize, i));
+    writer.add(files.back().data(), files.back().size(),
+               String::printf("dir/file%03u.txt", i));
+  }
+
+  return files;
+}
+
+
+void check() {
+  const char *paths[] = {"index-test.tar", "index-test.tar.gz",
+                         "index-test.tar.bz2", 0};
+
+  for (unsigned i = 0; paths[i]; i++) {
+    vector<string> files = writeArchive(paths[i], 50, 200000);
+    TarFileIndex index(paths[i], TarFile::TARFILE_AUTO, 65536);
+
+    if (index.size() != files.size()) THROW("Wrong index size");
+
+    // Read members in reverse order
+    for (unsigned j = files.size(); j; j--) {
+      string name = String::printf("dir/file%03u.txt", j - 1);
+      const TarFileIndex::Entry &entry = index.lookup(name);
+      if (entry.filename != name) THROW("Wrong entry for " << name);
+
+      ostringstream str;
+      str << index.open(entry)->rdbuf();
+      if (str.str() != files[j - 1]) THROW("Stream mismatch for " << name);
+
+      Event::Buffer buf;
+      index.read(entry, buf);
+      if (buf.toString() != files[j - 1])
+        THROW("Buffer mismatch for " << name);
+    }
+
+    if (index.find("missing")) THROW("Found missing file");
+
+    // Sequential read through a memory mapping
+    TarFileReader reader(new MMapFile(paths[i], MMapFile::MMAP_SEQUENTIAL));
+    for (unsigned j = 0; j < files.size(); j++) {
+      if (!reader.hasMore()) THROW("Mapped read ended at " << j);
+      ostringstream str;
+      string name = reader.extract(str);
+      if (str.str() != files[j]) THROW("Mapped read mismatch for " << name);
+    }
+
+    cout << paths[i] << ' ' << index.size() << " members"
+         << (index.getCheckpointCount() ? " with checkpoints" : "") << " OK"
+         << endl;
+
+    SystemUtilities::unlink(paths[i]);
+  }
+}
+
+
+void benchmark(unsigned mib) {
+  const char *path = "index-bench.tar.gz";
+  vector<string> files = writeArchive(path, mib * 4, 1 << 19);
+  string last = String::printf("dir/file%03u.txt", mib * 4 - 1);
+
+  // Sequential scan to the last member
+  double start = Timer::now();
+  TarFileReader reader(path);
+  while (reader.hasMore() && reader.getFilename() != last) reader.next();
+  ostringstream seq;
+  reader.extract(seq);
+  double seqTime = Timer::now() - start;
+
+  // Build the index once
+  start = Timer::now();
+  TarFileIndex index(path);
+  double indexTime = Timer::now() - start;
+
+  // Then open members directly
+  start = Timer::now();
+  const unsigned count = 100;
+  for (unsigned i = 0; i < count; i++) {
+    Event::Buffer buf;
+    index.read(last, buf);
+    if (buf.getLength() != files.back().size()) THROW("Wrong size");
+  }
+  double readTime = (Timer::now() - start) / count;
+
+  if (seq.str() != files.back()) THROW("Sequential read mismatch");
+
+  cout << "Sequential " << String::printf("%.2f", seqTime * 1000) << " ms"
+       << endl;
+  cout << "Index " << String::printf("%.2f", indexTime * 1000) << " ms"
+       << endl;
+  cout << "Indexed read " << String::printf("%.2f", readTime * 1000) << " ms"
+       << endl;
+
+  SystemUtilities::unlink(path);
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc == 1) check();
+    else if (argc == 3 && string("-b") == argv[1])
+      benchmark(String::parseU32(argv[2]));
+    else return usage(argv[0]);
+
+    return 0;
+
+  } CBANG_CATCH_ERROR;
+  return 1;
+}
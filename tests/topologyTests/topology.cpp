@@ -0,0 +1,241 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/os/SystemInfo.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/os/TemporaryDirectory.h>
+#include <cbang/String.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+using namespace cb;
+
+
+struct Topology {
+  const char *name;
+  const char *online;   // cpu/online
+  const char *nodes[3]; // node<i>/cpulist, no node directory if empty
+  const char *cpus;     // physical_package_id:core_id of each online CPU
+  bool caches;
+};
+
+
+const Topology topologies[] = {
+  // Linux numbers SMT siblings one core count apart
+  {"smt", "0-7", {"0-7"}, "0:0 0:1 0:2 0:3 0:0 0:1 0:2 0:3", true},
+
+  // Core IDs repeat across sockets and need not be contiguous
+  {"two-socket", "0-7", {"0-3", "4-7"}, "0:0 0:0 0:4 0:4 1:0 1:0 1:4 1:4",
+   false},
+
+  // An offline CPU and no NUMA information
+  {"offline", "0-1,3", {}, "0:0 0:1 0:3", false},
+
+  // Some VMs report a package ID of -1
+  {"vm", "0", {}, "-1:0", false},
+};
+
+
+void write(const string &path, const string &data) {
+  SystemUtilities::ensureDirectory(SystemUtilities::dirname(path));
+  ofstream(path.c_str()) << data << '\n';
+}
+
+
+void writeTopology(const string &root, const Topology &topo) {
+  write(root + "/cpu/online", topo.online);
+
+  if (topo.nodes[0]) {
+    string online;
+
+    for (unsigned i = 0; i < 3 && topo.nodes[i]; i++) {
+      write(SSTR(root << "/node/node" << i << "/cpulist"), topo.nodes[i]);
+      online = i ? SSTR("0-" << i) : "0";
+    }
+
+    write(root + "/node/online", online);
+  }
+
+  SystemInfo::cpus_t online = SystemInfo::parseCPUList(topo.online);
+  vector<string> cpus;
+  String::tokenize(topo.cpus, cpus);
+
+  for (unsigned i = 0; i < online.size(); i++) {
+    string dir = SSTR(root << "/cpu/cpu" << online[i] << "/topology/");
+    string::size_type colon = cpus[i].find(':');
+    write(dir + "physical_package_id", cpus[i].substr(0, colon));
+    write(dir + "core_id", cpus[i].substr(colon + 1));
+  }
+
+  if (topo.caches) {
+    const char *caches[][4] = {
+      {"1", "Data", "32K", "0,4"},
+      {"1", "Instruction", "32K", "0,4"},
+      {"2", "Unified", "1024K", "0,4"},
+      {"3", "Unified", "16M", "0-7"},
+    };
+
+    for (unsigned i = 0; i < 4; i++) {
+      string dir = SSTR(root << "/cpu/cpu0/cache/index" << i << "/");
+      write(dir + "level", caches[i][0]);
+      write(dir + "type", caches[i][1]);
+      write(dir + "size", caches[i][2]);
+      write(dir + "shared_cpu_list", caches[i][3]);
+    }
+  }
+}
+
+
+void printCPUs(const SystemInfo::cpus_t &cpus, const char *sep) {
+  for (unsigned i = 0; i < cpus.size(); i++)
+    cout << (i ? sep : "") << cpus[i];
+}
+
+
+void printTopology(const SystemInfo &info) {
+  cout << "  sockets=" << info.getSocketCount()
+       << " cores=" << info.getCoreCount()
+       << " threads=" << info.getThreadsPerCore()
+       << " nodes=" << info.getNUMANodeCount() << '\n';
+
+  const vector<SystemInfo::cpu_t> &cpus = info.getCPUs();
+  for (unsigned i = 0; i < cpus.size(); i++)
+    cout << "  cpu" << cpus[i].id << ": core=" << cpus[i].core
+         << " thread=" << cpus[i].thread << " socket=" << cpus[i].socket
+         << " node=" << cpus[i].node << '\n';
+
+  const vector<SystemInfo::cache_t> &caches = info.getCaches();
+  for (unsigned i = 0; i < caches.size(); i++)
+    cout << "  L" << caches[i].level << ' ' << caches[i].type << ": "
+         << caches[i].size << " bytes shared by " << caches[i].shared << '\n';
+
+  for (unsigned node = 0; node < info.getNUMANodeCount(); node++) {
+    cout << "  node" << node << ": ";
+    printCPUs(info.getNUMANodeCPUs(node), " ");
+    cout << '\n';
+  }
+
+  for (unsigned i = 0; i < ThreadPlacement::getCount(); i++) {
+    ThreadPlacement placement = ThreadPlacement::getValue(i);
+    vector<SystemInfo::cpus_t> threads =
+      info.getPlacement(placement, info.getCPUs().size() + 1);
+
+    cout << "  " << placement << ':';
+    for (unsigned j = 0; j < threads.size(); j++) {
+      cout << ' ';
+      if (threads[j].empty()) cout << '*';
+      printCPUs(threads[j], ",");
+    }
+    cout << '\n';
+  }
+}
+
+
+void testTopologies() {
+  SystemInfo &info = SystemInfo::instance();
+
+  for (unsigned i = 0; i < sizeof(topologies) / sizeof(Topology); i++) {
+    TemporaryDirectory tmp(".");
+    writeTopology(tmp.getPath(), topologies[i]);
+
+    cout << topologies[i].name << ":\n";
+    if (info.readSysFSTopology(tmp.getPath())) printTopology(info);
+    else cout << "  not read\n";
+  }
+
+  // No sysfs tree
+  TemporaryDirectory tmp(".");
+  cout << "missing: " << (info.readSysFSTopology(tmp.getPath()) ? "" : "not ")
+       << "read" << endl;
+}
+
+
+void testCPULists() {
+  const char *lists[] = {
+    "0", "0-3", "0-3,8,10-11", " 1,3\n", "", "7-7", "3-1", "a", "1-", 0,
+  };
+
+  for (unsigned i = 0; lists[i]; i++) {
+    cout << '"' << String::escapeC(lists[i]) << "\": ";
+
+    try {
+      printCPUs(SystemInfo::parseCPUList(lists[i]), " ");
+      cout << endl;
+
+    } catch (const Exception &e) {
+      cout << "error" << endl;
+    }
+  }
+}
+
+
+void usage(const char *name) {
+  cout
+    << "Usage: " << name << " [OPTIONS]\n\n"
+    << "OPTIONS:\n"
+    << "\t--help                           Print this help screen and exit.\n"
+    << "\t--cpu-list                       Parse CPU lists.\n"
+    << "\t--sysfs                          Read CPU topologies from sysfs.\n"
+    << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "--help") {
+        usage(argv[0]);
+        return 0;
+
+      } else if (arg == "--cpu-list") {
+        testCPULists();
+
+      } else if (arg == "--sysfs") {
+        testTopologies();
+
+      } else {
+        usage(argv[0]);
+        THROWS("Invalid arg '" << arg << "'");
+      }
+    }
+
+    return 0;
+
+  } CATCH_ERROR;
+
+  return 1;
+}
@@ -32,16 +32,129 @@
 
 #include <cbang/Exception.h>
 #include <cbang/net/URI.h>
+#include <cbang/net/URIView.h>
+#include <cbang/time/Timer.h>
+#include <cbang/String.h>
 
 #include <exception>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 using namespace cb;
 using namespace std;
 
+
+void printView(ostream &stream, const URIView &uri) {
+  stream << uri.getScheme() << '|' << uri.getHost() << '|' << uri.getPort()
+         << '|' << uri.getPath().toString() << '|' << uri.getUser() << '|'
+         << uri.getPass() << '|';
+
+  for (URIView::QueryIterator it(uri.getQuery()); it.next();)
+    stream << it.getName().toString() << "='" << it.getValue().toString()
+           << "' ";
+}
+
+
+int benchmark(unsigned iterations) {
+  vector<string> corpus;
+  string line;
+  while (getline(cin, line)) if (!line.empty()) corpus.push_back(line);
+
+  // The parsed components are checked against the expected output
+  for (unsigned i = 0; i < corpus.size(); i++) {
+    printView(cout, URIView(corpus[i]));
+    cout << endl;
+  }
+
+  double start = Timer::now();
+  for (unsigned j = 0; j < iterations; j++)
+    for (unsigned i = 0; i < corpus.size(); i++) URI uri(corpus[i]);
+  double uriTime = Timer::now() - start;
+
+  unsigned args = 0;
+  start = Timer::now();
+  for (unsigned j = 0; j < iterations; j++)
+    for (unsigned i = 0; i < corpus.size(); i++) {
+      URIView uri(corpus[i]);
+      for (URIView::QueryIterator it(uri.getQuery()); it.next();) args++;
+    }
+  double viewTime = Timer::now() - start;
+
+  unsigned count = iterations * corpus.size();
+  cout << corpus.size() << " URIs OK" << endl;
+  cout << "URI " << String::printf("%.0f", count / uriTime) << " URIs/s"
+       << endl;
+  cout << "URIView " << String::printf("%.0f", count / viewTime) << " URIs/s"
+       << endl;
+
+  return 0;
+}
+
+
+void view(int argc, char *argv[]) {
+  unsigned int w = 11;
+
+  for (int i = 0; i < argc; i++) {
+    cout << argv[i] << " => ";
+
+    try {
+      URIView uri(argv[i]);
+
+      cout << "{" << endl;
+      cout << setw(w) << "Scheme: " << uri.getScheme() << endl;
+      cout << setw(w) << "Host: " << uri.getHost() << endl;
+      cout << setw(w) << "Port: " << uri.getPort() << endl;
+      cout << setw(w) << "Path: " << uri.getPath() << endl;
+      cout << setw(w) << "Decoded: " << uri.getPath().toString() << endl;
+      cout << setw(w) << "Ext: " << uri.getExtension() << endl;
+      cout << setw(w) << "User: " << uri.getUser() << endl;
+      cout << setw(w) << "Pass: " << uri.getPass() << endl;
+
+      cout << setw(w) << "Segments: ";
+      for (URIView::SegmentIterator it(uri.getPath()); it.next();)
+        cout << "'" << it.get().toString() << "' ";
+      cout << endl;
+
+      cout << setw(w) << "Query: ";
+      for (URIView::QueryIterator it(uri.getQuery()); it.next();) {
+        const URIView::Slice &name = it.getName();
+        URIView::Slice value;
+
+        // Lookups of repeated names must agree on the last value
+        if (!uri.hasArg(name.toString().c_str()) ||
+            !uri.getArg(name.toString().c_str(), value))
+          THROW("Lookup of '" << name << "' failed");
+
+        cout << name.toString() << "='" << it.getValue().toString() << "'"
+             << (it.getValue().isEscaped() ? "* " : " ");
+        if (value != uri.getArg(name.toString().c_str()))
+          THROW("Lookups of '" << name << "' disagree");
+      }
+      cout << endl;
+
+      cout << setw(w) << "Copy: " << URI(uri) << endl;
+      cout << "}";
+
+    } catch (const Exception &e) {
+      cout << "INVALID: " << e.getMessage() << endl;
+    }
+
+    cout << endl;
+  }
+}
+
+
 int main(int argc, char *argv[]) {
   try {
+    if (argc == 3 && string("--bench") == argv[1])
+      return benchmark(String::parseU32(argv[2]));
+
+    if (1 < argc && string("--view") == argv[1]) {
+      view(argc - 2, argv + 2);
+      return 0;
+    }
+
     unsigned int w = 10;
 
     for (int i = 1; i < argc; i++) {
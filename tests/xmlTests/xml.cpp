@@ -0,0 +1,255 @@
+/******************************************************************************\
+
+          This file is part of the C! library.  A.K.A the cbang library.
+
+                Copyright (c) 2003-2019, Cauldron Development LLC
+                   Copyright (c) 2003-2017, Stanford University
+                               All rights reserved.
+
+         The C! library is free software: you can redistribute it and/or
+        modify it under the terms of the GNU Lesser General Public License
+       as published by the Free Software Foundation, either version 2.1 of
+               the License, or (at your option) any later version.
+
+        The C! library is distributed in the hope that it will be useful,
+          but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+                 Lesser General Public License for more details.
+
+         You should have received a copy of the GNU Lesser General Public
+                 License along with the C! library.  If not, see
+                         <http://www.gnu.org/licenses/>.
+
+        In addition, BSD licensing may be granted on a case by case basis
+        by written permission from at least one of the copyright holders.
+           You may request written permission by emailing the authors.
+
+                  For information regarding this software email:
+                                 Joseph Coffland
+                          joseph@cauldrondevelopment.com
+
+\******************************************************************************/
+
+#include <cbang/xml/XMLAdapter.h>
+#include <cbang/xml/XMLViewHandler.h>
+#include <cbang/os/SystemUtilities.h>
+#include <cbang/String.h>
+#include <cbang/Catch.h>
+
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+using namespace cb;
+
+
+const char *path = "xml.dat";
+
+
+void write(const string &data) {ofstream(path, ios::binary) << data;}
+
+
+class PrintHandler : public XMLViewHandler {
+public:
+  bool truncate;
+  unsigned elements;
+  bool print;
+
+  PrintHandler() : truncate(false), elements(0), print(true) {}
+
+
+  // From XMLHandler
+  void pushFile(const string &filename) {
+    if (print) cout << "push " << filename << endl;
+  }
+
+
+  void popFile() {if (print) cout << "pop" << endl;}
+
+
+  // From XMLViewHandler
+  void startElementView(const XMLStringView &name,
+                        const XMLAttributesView &attrs) {
+    // Rewrite the file under the parser
+    if (truncate && !elements) SystemUtilities::truncate(path, 0);
+    elements++;
+    if (!print) return;
+
+    cout << "start " << name;
+    for (unsigned i = 0; i < attrs.size(); i++)
+      cout << ' ' << attrs.getName(i) << "=\"" << attrs.getValue(i) << '"';
+    cout << endl;
+  }
+
+
+  void endElementView(const XMLStringView &name) {
+    if (print) cout << "end " << name << endl;
+  }
+
+
+  void textView(const XMLStringView &text) {
+    string s = String::trim(text.toString());
+    if (print && !s.empty()) cout << "text \"" << s << '"' << endl;
+  }
+};
+
+
+void testViews() {
+  const char *data = "name=value";
+  XMLStringView name(data, 4);
+  XMLStringView value(data + 5);
+
+  cout << "name=" << name << " length=" << name.getLength()
+       << " empty=" << String(name.empty()) << endl;
+  cout << "value=" << value << " string=" << value.toString() << endl;
+  cout << "name == \"name\": " << String(name == "name") << endl;
+  cout << "name != \"names\": " << String(name != "names") << endl;
+  cout << "name == string: " << String(name == string("name")) << endl;
+  cout << "default empty=" << String(XMLStringView().empty()) << endl;
+
+  const char *pairs[] = {"id", "42", "type", "", "id", "dup", 0};
+  XMLAttributesView attrs(pairs);
+
+  cout << "size=" << attrs.size() << endl;
+  for (unsigned i = 0; i < attrs.size(); i++)
+    cout << attrs.getName(i) << "=\"" << attrs.getValue(i) << '"' << endl;
+
+  // The last of duplicate names wins
+  cout << "get(id)=" << attrs.get("id") << endl;
+  cout << "has(type)=" << String(attrs.has("type"))
+       << " get(type) empty=" << String(attrs.get("type").empty()) << endl;
+  cout << "has(missing)=" << String(attrs.has("missing"))
+       << " get(missing, x)=" << attrs.get("missing", "x") << endl;
+
+  XMLAttributes map = attrs.toAttributes();
+  cout << "toAttributes size=" << map.size() << " id=" << map["id"] << endl;
+
+  XMLAttributesView none;
+  cout << "null size=" << none.size()
+       << " has(id)=" << String(none.has("id")) << endl;
+}
+
+
+void testHandler() {
+  PrintHandler handler;
+
+  // String callbacks are passed on as views
+  XMLAttributes attrs;
+  attrs["b"] = "2";
+  attrs["a"] = "1";
+  handler.startElement("element", attrs);
+  handler.text("  some text  ");
+  handler.endElement("element");
+  handler.startElement("empty", XMLAttributes());
+  handler.endElement("empty");
+}
+
+
+void parse(PrintHandler &handler) {
+  SmartPointer<XMLAdapter> adapter = XMLAdapter::create();
+  adapter->pushHandler(&handler);
+  adapter->read(path);
+}
+
+
+void testRead() {
+  write("<config>\n"
+        "  <port v=\"8080\"/>\n"
+        "  <name>server &amp; co</name>\n"
+        "  <hosts a=\"x\" b=\"y\">one two</hosts>\n"
+        "</config>\n");
+
+  PrintHandler handler;
+  parse(handler);
+}
+
+
+void testTruncate() {
+  string data = "<config>\n";
+  for (unsigned i = 0; i < 1000; i++)
+    data += String::printf("  <item id=\"%u\">%u</item>\n", i, i);
+  data += "</config>\n";
+
+  // Small files are copied so a rewrite cannot fault the parser
+  write(data);
+
+  PrintHandler handler;
+  handler.truncate = true;
+  handler.print = false;
+  parse(handler);
+
+  cout << "elements=" << handler.elements
+       << " size=" << SystemUtilities::getFileSize(path) << endl;
+}
+
+
+void testMap() {
+  string data = "<config>\n";
+  unsigned count = 0;
+  for (; data.size() <= XMLAdapter::MAX_COPY_SIZE; count++)
+    data += String::printf("  <item id=\"%u\">%u</item>\n", count, count);
+  data += "</config>\n";
+
+  // Large files are mapped
+  write(data);
+
+  PrintHandler handler;
+  handler.print = false;
+  parse(handler);
+
+  cout << "items=" << count << " elements=" << handler.elements << endl;
+}
+
+
+void usage(const char *name) {
+  cout
+    << "Usage: " << name << " [OPTIONS]\n\n"
+    << "OPTIONS:\n"
+    << "\t--help                           Print this help screen and exit.\n"
+    << "\t--views                          Use string and attribute views.\n"
+    << "\t--handler                        Parse with an XMLViewHandler.\n"
+    << "\t--read                           Read a file.\n"
+    << "\t--truncate                       Read a file as it is truncated.\n"
+    << "\t--map                            Read a memory mapped file.\n"
+    << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+  try {
+    for (int i = 1; i < argc; i++) {
+      string arg = argv[i];
+
+      if (arg == "--help") {
+        usage(argv[0]);
+        return 0;
+
+      } else if (arg == "--views") {
+        testViews();
+
+      } else if (arg == "--handler") {
+        testHandler();
+
+      } else if (arg == "--read") {
+        testRead();
+
+      } else if (arg == "--truncate") {
+        testTruncate();
+
+      } else if (arg == "--map") {
+        testMap();
+
+      } else {
+        usage(argv[0]);
+        THROWS("Invalid arg '" << arg << "'");
+      }
+    }
+
+    SystemUtilities::unlink(path);
+    return 0;
+
+  } CATCH_ERROR;
+
+  SystemUtilities::unlink(path);
+  return 1;
+}